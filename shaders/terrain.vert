@@ -0,0 +1,56 @@
+#version 450
+// v4.7.0: Compact split-stream terrain vertex (see graphics/terrain_vertex.h)
+// Binding 0 (geometry):   height + octahedral normal
+// Binding 1 (attributes): RGBA8 colour, unorm16 log-flux/sediment, packed basin/soil IDs
+layout(location = 0) in float inHeight;
+layout(location = 1) in vec2 inOctNormal;   // R16G16_SNORM
+layout(location = 2) in vec4 inColor;       // R8G8B8A8_UNORM
+layout(location = 3) in vec2 inFluxSed;     // R16G16_UNORM
+layout(location = 4) in uint inIds;         // R32_UINT: basin << 8 | soil
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out float fragViewDist;
+layout(location = 3) out vec2 fragUV;
+layout(location = 4) flat out float fragAux;
+layout(location = 5) out float fragAuxSmooth;
+layout(location = 6) out vec3 fragWorldPos;
+layout(location = 7) flat out float fragSoilId;
+
+// Must match TerrainRenderer::render (PushConstantsPacked)
+layout(push_constant) uniform PushConstants {
+    layout(offset = 0) mat4 mvp;
+    layout(offset = 112) uint flags;
+    layout(offset = 116) float gridScale;
+    layout(offset = 120) uint gridWidth;
+} pc;
+
+// Keep in sync with terrain_vertex::kMaxLogFlux / kMaxSediment
+const float kMaxLogFlux = 16.635532;
+const float kMaxSediment = 1.0;
+
+vec3 decodeOct(vec2 e) {
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    if (n.y < 0.0) {
+        vec2 s = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+        n.xz = (1.0 - abs(n.zx)) * s;
+    }
+    return normalize(n);
+}
+
+void main() {
+    uint idx = uint(gl_VertexIndex);
+    float x = float(idx % pc.gridWidth) * pc.gridScale;
+    float z = float(idx / pc.gridWidth) * pc.gridScale;
+    vec3 position = vec3(x, inHeight, z);
+
+    gl_Position = pc.mvp * vec4(position, 1.0);
+    fragColor = inColor.rgb;
+    fragNormal = decodeOct(inOctNormal);
+    fragUV = vec2(exp(inFluxSed.x * kMaxLogFlux), inFluxSed.y * kMaxSediment);
+    fragAux = float(inIds >> 8);
+    fragAuxSmooth = fragAux;
+    fragWorldPos = position;
+    fragSoilId = float(inIds & 0xFFu);
+    fragViewDist = gl_Position.w;
+}
@@ -9,6 +9,11 @@
 #include "math/noise.h"
 #include "../terrain/watershed.h" // v3.6.3
 #include "../terrain/pattern_validator.h" // v4.4.2
+#include "../terrain/terrain_raycast.h" // v4.7.0
+#include "../terrain/world_snapshot.h" // v4.7.0
+#include "../terrain/dem_importer.h" // v4.7.0
+#include "../terrain/raster_export.h" // v4.7.0
+#include "../terrain/timeline_recorder.h" // v4.7.0
 #include "../imgui_backend.h"
 #include "../math/math_types.h"
 #include "preferences.h" // v3.4.0
@@ -27,32 +32,19 @@
 #include <cstring> // for std::memcpy
 #include <iomanip> // v3.7.0
 #include <iterator>
+#include <utility> // v4.7.0: std::as_const
 
 namespace core {
 
 // Helper for Raycasting Finite Terrain
+// v4.7.0: Exact hierarchical query (see terrain/terrain_raycast.h); was a fixed 0.5-cell march
 bool raycastFiniteTerrain(const terrain::TerrainMap& map, const math::Ray& ray, float maxDist, float gridScale, int& outX, int& outZ, math::Vec3& outHitPos) {
-    float t = 0.0f;
-    float step = 0.5f * gridScale; // Precision scales with grid
-    
-    while (t < maxDist) {
-        math::Vec3 p = ray.origin + ray.direction * t;
-        
-        int x = static_cast<int>(std::round(p.x / gridScale));
-        int z = static_cast<int>(std::round(p.z / gridScale));
-        
-        if (x >= 0 && x < map.getWidth() && z >= 0 && z < map.getHeight()) {
-            float h = map.getHeight(x, z);
-            if (p.y <= h) {
-                outX = x;
-                outZ = z;
-                outHitPos = p; // Capture exact hit position
-                return true;
-            }
-        }
-        t += step;
-    }
-    return false;
+    terrain::RayHit hit = terrain::raycast(map, ray, maxDist, gridScale);
+    if (!hit.hit) return false;
+    outX = hit.x;
+    outZ = hit.z;
+    outHitPos = hit.position; // Capture exact hit position
+    return true;
 }
 
 Application::Application() 
@@ -161,19 +153,32 @@ void Application::init() {
     deferredConfig_.height = 1024;
     deferredConfig_.maxHeight = 80.0f;
     deferredConfig_.seed = currentSeed_;
-    finiteGenerator_->generateBaseTerrain(*finiteMap_, config); // Will re-seed
-    
-    // Re-enable erosion for Drainage Visualization
-    finiteGenerator_->applyErosion(*finiteMap_, 250000);
-    
-    // v3.6.3: Ensure Drainage is calculated on startup
-    finiteGenerator_->calculateDrainage(*finiteMap_);
-    
-    // v3.7.3: Semantic Soil Classification
-    finiteGenerator_->classifySoil(*finiteMap_, config);
+    // v4.7.0: Warm start from the on-disk cache. The startup chain differs from the
+    // regeneration pipeline (erosion, no SCORPAN sync), so it is keyed separately.
+    worldCache_ = std::make_shared<terrain::WorldCache>("world_cache");
+    terrain::ContentHash startupHash;
+    startupHash.add(std::string("startup")).add(terrain::TerrainPipeline::kGeneratorRevision).add(terrain::WorldSnapshot::kFormatVersion);
+    startupHash.add(finiteMap_->getWidth()).add(finiteMap_->getHeight()).add(config.seed).add(config.maxHeight);
+    startupHash.add(config.resolution).add(config.noiseScale).add(config.persistence).add(config.octaves).add(config.model);
+    const uint64_t startupKey = startupHash.value();
+
+    if (!worldCache_->load(startupKey, *finiteMap_)) {
+        finiteGenerator_->generateBaseTerrain(*finiteMap_, config); // Will re-seed
+        
+        // Re-enable erosion for Drainage Visualization
+        finiteGenerator_->applyErosion(*finiteMap_, 250000);
+        
+        // v3.6.3: Ensure Drainage is calculated on startup
+        finiteGenerator_->calculateDrainage(*finiteMap_);
+        
+        // v3.7.3: Semantic Soil Classification
+        finiteGenerator_->classifySoil(*finiteMap_, config);
+
+        // v4.0.0: Initialize Landscape Systems (Soil, Hydro)
+        finiteGenerator_->generateLandscape(*finiteMap_);
 
-    // v4.0.0: Initialize Landscape Systems (Soil, Hydro)
-    finiteGenerator_->generateLandscape(*finiteMap_);
+        worldCache_->store(startupKey, *finiteMap_);
+    }
     
     // v4.0.0 ML Service Initialization
     mlService_ = std::make_unique<ml::MLService>();
@@ -194,6 +199,7 @@ void Application::init() {
 
     // Update mesh for 3D View
     finiteRenderer_->buildMesh(*finiteMap_, worldResolution_, showMLSoil_ ? mlService_.get() : nullptr);
+    startSimulation(); // v4.7.0
 
     camera_.setCameraMode(graphics::CameraMode::FreeFlight);
     float cx = 1024.0f / 2.0f;
@@ -233,6 +239,14 @@ void Application::init() {
             // }
         },
         [this]() { // resetVegetation (v3.9.1)
+            // v4.7.0: The simulation thread owns the grid; the next frame carries the reset
+            if (simulation_) {
+                const int seed = currentSeed_;
+                simulation_->post([seed](terrain::TerrainMap& map) {
+                    if (map.getVegetation()) vegetation::VegetationSystem::initialize(*map.getVegetation(), seed);
+                });
+                return;
+            }
             if (finiteMap_ && finiteMap_->getVegetation()) {
                 vegetation::VegetationSystem::initialize(*finiteMap_->getVegetation(), currentSeed_);
                 // Force immediate upload? Or let next update cycle handle it?
@@ -243,11 +257,17 @@ void Application::init() {
             }
         },
         [this]() { // triggerFireEvent (v3.9.2)
+            vegetation::DisturbanceRegime firePulse;
+            firePulse.type = vegetation::DisturbanceType::Fire;
+            firePulse.spatialExtent = 1.0f;
+            firePulse.fireFrequency = 1.0f;
+            if (simulation_) { // v4.7.0
+                simulation_->post([firePulse](terrain::TerrainMap& map) {
+                    if (map.getVegetation()) vegetation::VegetationSystem::applyDisturbance(*map.getVegetation(), firePulse);
+                });
+                return;
+            }
             if (finiteMap_ && finiteMap_->getVegetation()) {
-                 vegetation::DisturbanceRegime firePulse;
-                 firePulse.type = vegetation::DisturbanceType::Fire;
-                 firePulse.spatialExtent = 1.0f; 
-                 firePulse.fireFrequency = 1.0f; 
                  vegetation::VegetationSystem::applyDisturbance(*finiteMap_->getVegetation(), firePulse);
                  if (finiteRenderer_) finiteRenderer_->updateVegetation(*finiteMap_->getVegetation());
             }
@@ -273,6 +293,7 @@ void Application::init() {
                  } else if (!sibcsConfig_.applyConstraints || sibcsConfig_.pendingChanges || !sibcsConfig_.domainConfirmed) {
                      std::cout << "[App] SCORPAN recompute blocked: user domain not confirmed/applied." << std::endl;
                  } else {
+                     terrain::SimulationThread::Pause pause(simulation_.get()); // v4.7.0
                      landscape::SoilSystem::initialize(*soil, currentSeed_, *finiteMap_, currentSiBCSLevel_, &sibcsConfig_);
                      finiteGenerator_->classifySoilFromSCORPAN(*finiteMap_, &sibcsConfig_);
                  }
@@ -296,6 +317,7 @@ void Application::init() {
                  } else if (!sibcsConfig_.applyConstraints || sibcsConfig_.pendingChanges || !sibcsConfig_.domainConfirmed) {
                      std::cout << "[App] SCORPAN sync blocked: user domain not confirmed/applied." << std::endl;
                  } else {
+                     terrain::SimulationThread::Pause pause(simulation_.get()); // v4.7.0
                      landscape::SoilSystem::initialize(*soil, currentSeed_, *finiteMap_, currentSiBCSLevel_, &sibcsConfig_);
                      finiteGenerator_->classifySoilFromSCORPAN(*finiteMap_, &sibcsConfig_);
                  }
@@ -308,16 +330,17 @@ void Application::init() {
                  isTraining_ = true;
                  std::cout << "[SisterApp] Starting Async Training 'soil_color'..." << std::endl;
                  
-                 trainingFuture_ = std::async(std::launch::async, [this, epochs, lr]() {
+                 trainingJob_ = core::JobSystem::instance().submit([this, epochs, lr]() {
                      mlService_->trainModel("soil_color", epochs, lr);
                      // isTraining_ = false; // MOVED to Main Thread Check
-                 });
+                 }, {}, core::JobOptions::longRunning());
              }
         },
         [this](int samples) { // mlCollectData (Soil Color) - MOVED DOWN
              if (!finiteMap_ || !mlService_) return;
              std::cout << "[SisterApp] Collecting " << samples << " samples for 'soil_color'..." << std::endl;
              std::srand(static_cast<unsigned int>(std::time(nullptr)));
+             terrain::SimulationThread::Pause pause(simulation_.get()); // v4.7.0: Samples from one tick
              int w = finiteMap_->getWidth();
              int h = finiteMap_->getHeight();
              
@@ -341,6 +364,7 @@ void Application::init() {
         [this](int samples) { // mlCollectHydroData
              if (!finiteMap_ || !mlService_) return;
              std::cout << "[SisterApp] Collecting " << samples << " samples for 'hydro_runoff'..." << std::endl;
+             terrain::SimulationThread::Pause pause(simulation_.get()); // v4.7.0
              
              int w = finiteMap_->getWidth();
              int h = finiteMap_->getHeight();
@@ -373,9 +397,9 @@ void Application::init() {
              if(mlService_ && !isTraining_) {
                  isTraining_ = true;
                  std::cout << "[SisterApp] Training 'hydro_runoff'..." << std::endl;
-                 trainingFuture_ = std::async(std::launch::async, [this, epochs, lr]() {
+                 trainingJob_ = core::JobSystem::instance().submit([this, epochs, lr]() {
                      mlService_->trainModel("hydro_runoff", epochs, lr);
-                 });
+                 }, {}, core::JobOptions::longRunning());
              }
         },
         
@@ -405,9 +429,9 @@ void Application::init() {
              if(mlService_ && !isTraining_) {
                  isTraining_ = true;
                  std::cout << "[SisterApp] Training 'fire_risk'..." << std::endl;
-                 trainingFuture_ = std::async(std::launch::async, [this, epochs, lr]() {
+                 trainingJob_ = core::JobSystem::instance().submit([this, epochs, lr]() {
                      mlService_->trainModel("fire_risk", epochs, lr);
-                 });
+                 }, {}, core::JobOptions::longRunning());
              }
         },
         
@@ -435,12 +459,29 @@ void Application::init() {
              if(mlService_ && !isTraining_) {
                  isTraining_ = true;
                  std::cout << "[SisterApp] Training 'biomass_growth'..." << std::endl;
-                 trainingFuture_ = std::async(std::launch::async, [this, epochs, lr]() {
+                 trainingJob_ = core::JobSystem::instance().submit([this, epochs, lr]() {
                      mlService_->trainModel("biomass_growth", epochs, lr);
-                 });
+                 }, {}, core::JobOptions::longRunning());
              }
         }
     };
+    // v4.7.0: Cancel (the current world and renderer stay untouched)
+    uiCallbacks.cancelRegeneration = [this]() {
+        if (isRegenerating_ && regenControl_) {
+            std::cout << "[SisterApp] Cancelling regeneration..." << std::endl;
+            regenControl_->cancel();
+        }
+    };
+
+    uiCallbacks.saveWorldSnapshot = [this](bool compress) { saveWorldSnapshot("world_snapshot.world", compress); };
+    uiCallbacks.loadWorldSnapshot = [this]() { loadWorldSnapshot("world_snapshot.world"); };
+    uiCallbacks.importDem = [this](const std::string& path, float resolution) { importDem(path, resolution); };
+    uiCallbacks.exportRasters = [this]() { exportRasters("raster_export"); };
+    uiCallbacks.startRecording = [this]() { startRecording("simulation_timeline.tl"); };
+    uiCallbacks.stopRecording = [this]() { stopRecording(); };
+    uiCallbacks.setReplay = [this](bool active) { setReplay(active); };
+    uiCallbacks.seekReplay = [this](int frame) { seekReplay(frame); };
+
     // UI Layer
     // UI Layer
     uiLayer_ = std::make_unique<ui::UiLayer>(*ctx_, uiCallbacks);
@@ -450,6 +491,14 @@ void Application::init() {
 }
 
 void Application::cleanup() {
+    // v4.7.0: Stop a running regeneration at its next checkpoint instead of finishing it
+    if (isRegenerating_ && regenJob_) {
+        if (regenControl_) regenControl_->cancel();
+        regenJob_.wait();
+    }
+    stopRecording(); // v4.7.0: Flush the queued frames
+    stopSimulation();
+
     // Shutdown in reverse order
     if (uiLayer_) {
         uiLayer_.reset(); // Destroy UI and Minimap BEFORE shutting down Vulkan context
@@ -463,6 +512,7 @@ void Application::cleanup() {
     // Terrain contains Vulkan buffers that must be destroyed while device is valid
     // terrain_ removed
     finiteRenderer_.reset();
+    previewRenderer_.reset();
     finiteGenerator_.reset();
     finiteMap_.reset();
     
@@ -538,10 +588,10 @@ void Application::run() {
         }
         
         // v4.0.0 Async Training Check
-        if (isTraining_ && trainingFuture_.valid() && 
-            trainingFuture_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        if (isTraining_ && trainingJob_ && trainingJob_.done()) {
             
-            trainingFuture_.get(); // Join/Rethrow exceptions
+            trainingJob_.get(); // Rethrows exceptions
+            trainingJob_ = core::JobSystem::Handle();
             isTraining_ = false;
             std::cout << "[SisterApp] Async Training Completed." << std::endl;
             performMeshUpdate();
@@ -550,6 +600,12 @@ void Application::run() {
         if (meshUpdateRequested_) {
             performMeshUpdate();
         }
+        if (finiteRenderer_ && finiteMap_ && finiteRenderer_->hasDirtyAttributes()) {
+            // v4.7.0: Taxonomy colours read nothing the simulation writes; ML colours
+            // read the evolving soil grid and wait for the tick in progress
+            terrain::SimulationThread::Pause pause(showMLSoil_ ? simulation_.get() : nullptr);
+            finiteRenderer_->flushDirtyAttributes(*finiteMap_, mlService_.get(), soilClassificationMode_, showMLSoil_);
+        }
 
         if (running_) {
             render(currentFrame_);
@@ -609,6 +665,7 @@ void Application::processEvents(double dt) {
                      int hitX, hitZ;
                      math::Vec3 hitPos;
                      if (raycastFiniteTerrain(*finiteMap_, ray, 1000.0f * worldResolution_, worldResolution_, hitX, hitZ, hitPos)) {
+                         terrain::SimulationThread::Pause pause(simulation_.get()); // v4.7.0: Probe reads the live grids
                          // Calculate Slope
                          float hL = finiteMap_->getHeight(std::max(0, hitX-1), hitZ);
                          float hR = finiteMap_->getHeight(std::min(finiteMap_->getWidth()-1, hitX+1), hitZ);
@@ -641,7 +698,7 @@ void Application::processEvents(double dt) {
                              
                              // Reconstruct State for Classification
                              auto storedType = static_cast<const landscape::SoilType>(soil->soil_type[idx]);
-                             auto storedSub = static_cast<const landscape::SiBCSSubOrder>(soil->suborder[idx]);
+                             auto storedSub = soil->taxonAt(static_cast<size_t>(idx)).suborder;
                              std::string subStr = "";
 
                              switch(storedSub) {
@@ -677,7 +734,8 @@ void Application::processEvents(double dt) {
                          // v3.7.1: Expanded Probe Data
                          float elevation = finiteMap_->getHeight(hitX, hitZ);
                          float flux = finiteMap_->fluxMap()[hitZ * finiteMap_->getWidth() + hitX];
-                         int basinID = finiteMap_->watershedMap()[hitZ * finiteMap_->getWidth() + hitX];
+                         const auto& basins = std::as_const(*finiteMap_).watershedMap(); // v4.7.0: Lazy, do not allocate on read
+                         int basinID = basins.empty() ? 0 : basins[hitZ * finiteMap_->getWidth() + hitX];
                          
                          std::stringstream ss;
                          ss << "Loc: (" << hitX << ", " << hitZ << ")\n";
@@ -753,8 +811,7 @@ void Application::processEvents(double dt) {
                               auto* hydro = finiteMap_->getLandscapeHydro();
                               int idx = hitZ * finiteMap_->getWidth() + hitX;
                               if (idx >= 0 && idx < hydro->water_depth.size()) {
-                                  float dtSim = vegUpdateInterval_;
-                                  if (dtSim <= 0.0001f) dtSim = 0.1f; // Safety
+                                  float dtSim = static_cast<float>(terrain::SimulationSettings().stepSeconds); // v4.7.0: Simulated time per tick
                                   
                                   // Convert m/step to mm/h
                                   // flow_flux [m] / dt [s] = m/s
@@ -983,119 +1040,19 @@ void Application::update(double dt) {
 
     camera_.update(static_cast<float>(dt));
     
-    // v3.9.0 Vegetation Simulation
     // v3.9.0 Vegetation & Landscape Simulation
-    if (finiteMap_) {
-            auto* veg = finiteMap_->getVegetation();
-            auto* soil = finiteMap_->getLandscapeSoil();
-            auto* hydro = finiteMap_->getLandscapeHydro();
-
-            // v3.9.1 Throttling: Run Simulation at 10Hz (0.1s)
-            // Reduced update frequency prevents CPU saturation on large maps (2048+)
-            vegUpdateTimer_ += static_cast<float>(dt);
-            
-             // 1. Time-Sliced Soil Update (Reduces main thread load)
-             // We process a chunk of rows every frame instead of the whole map
-             if (soil) {
-                 int mapH = finiteMap_->getHeight();
-                 int endRow = currentSoilRow_ + constSoilSliceRows_;
-                 if (endRow > mapH) endRow = mapH;
-
-                 bool allowSoilSimulation = true;
-                 if (soilClassificationMode_ >= 1) {
-                     allowSoilSimulation = sibcsConfig_.applyConstraints && sibcsConfig_.domainConfirmed && !sibcsConfig_.pendingChanges;
-                 }
-                 
-                 if (allowSoilSimulation) {
-                     // Update Slice
-                     // v4.6.6: Pass user-selected SiBCS level for dynamic depth calculation
-                     landscape::SiBCSLevel targetLevel = landscape::SiBCSLevel::Suborder; // Default
-                     if (soilClassificationMode_ >= 1 && soilClassificationMode_ <= 6) {
-                         targetLevel = static_cast<landscape::SiBCSLevel>(soilClassificationMode_);
-                     }
-
-                     landscape::SoilSystem::update(*soil, static_cast<float>(dt), soilClimate_, soilOrganism_, soilParentMaterial_, *finiteMap_, currentSoilRow_, endRow, targetLevel);
-
-                     // Keep TerrainMap semantic soil buffer in sync with the evolving SiBCS classification.
-                     // This avoids probe/type vs minimap/other views drifting over time.
-                     if (soilClassificationMode_ >= 1) {
-                         int w = finiteMap_->getWidth();
-                         auto& soilMap = finiteMap_->soilMap();
-                         for (int y = currentSoilRow_; y < endRow; ++y) {
-                         int rowBase = y * w;
-                         for (int x = 0; x < w; ++x) {
-                             int idx = rowBase + x;
-                             uint8_t value = soil->soil_type[idx];
-                             if (value > static_cast<uint8_t>(terrain::SoilType::Organossolo)) {
-                                 value = static_cast<uint8_t>(terrain::SoilType::None);
-                             }
-                             soilMap[idx] = value;
-                         }
-                     }
-                 }
-                 } else {
-                     // Passive state while the user edits the domain: keep visuals cleared.
-                     if (soilClassificationMode_ >= 1) {
-                         int w = finiteMap_->getWidth();
-                         auto& soilMap = finiteMap_->soilMap();
-                         for (int y = currentSoilRow_; y < endRow; ++y) {
-                             int rowBase = y * w;
-                             for (int x = 0; x < w; ++x) {
-                                 soilMap[rowBase + x] = static_cast<uint8_t>(terrain::SoilType::None);
-                             }
-                         }
-                     }
-                 }
-                 
-                 // Advance Slice
-                 currentSoilRow_ = endRow;
-                 if (currentSoilRow_ >= mapH) {
-                     currentSoilRow_ = 0;
-
-                     // If we're actively visualizing SiBCS (SCORPAN), refresh the mesh colors
-                     // after a full soil sweep to keep the rendered palette consistent with the probe.
-                     if (showSoilVis_ && soilClassificationMode_ >= 1 && !showMLSoil_ && allowSoilSimulation) {
-                         meshUpdateRequested_ = true;
-                     }
-                 }
-             }
-
-             // v3.9.1 Throttling: Run Vegetation/Hydro at 10Hz (0.1s)
-             vegUpdateTimer_ += static_cast<float>(dt);
-            
-             if (vegUpdateTimer_ >= vegUpdateInterval_) {
-                 float dtSim = vegUpdateTimer_; // Use actual time passed
-                 
-                 // 2. Hydro (Global Flow - needs consistent state, harder to slice)
-                 if (soil && hydro && veg) {
-                     landscape::HydroSystem::update(*hydro, *soil, *veg, rainIntensity_, dtSim);
-                 }
-     
-                 // Soil was handled by time-slice
-                 
-                 // 3. Vegetation (Growth/Recovery) & Disturbance
-                 if (veg && veg->isValid()) { 
-                       // Disturbance (Fire)
-                       if (disturbanceParams_.fireFrequency > 0.0f) {
-                           float prob = disturbanceParams_.fireFrequency * dtSim;
-                           if (static_cast<float>(rand()) / static_cast<float>(RAND_MAX) < prob) {
-                               disturbanceParams_.type = vegetation::DisturbanceType::Fire;
-                               vegetation::VegetationSystem::applyDisturbance(*veg, disturbanceParams_);
-                               std::cout << "[Vegetation] Fire Event Triggered!" << std::endl;
-                           }
-                       }
-     
-                       // Growth
-                       vegetation::VegetationSystem::update(*veg, dtSim, disturbanceParams_, soil, hydro);
-                 
-                       // Upload to GPU - ONLY when simulation updated
-                       if (finiteRenderer_) {
-                           finiteRenderer_->updateVegetation(*veg);
-                       }
-                 }
-                 
-                 vegUpdateTimer_ = 0.0f;
-            }
+    // v4.7.0: Stepped by SimulationThread; here only UI edits go out (commands)
+    // and published frames come in, so heavy ticks never stall a frame
+    if (simulation_) {
+        const terrain::SimulationParameters params = simulationParameters();
+        if (params != postedSimParameters_ && simulation_->setParameters(params)) {
+            postedSimParameters_ = params; // Retried next frame if the queue was full
+        }
+        if (simulationRate_ != appliedSimulationRate_) {
+            simulation_->setRate(simulationRate_);
+            appliedSimulationRate_ = simulationRate_;
+        }
+        consumeSimulationFrame();
     }
 
     // Update animations
@@ -1276,8 +1233,15 @@ void Application::render(size_t frameIndex) {
         if (worldWidth > 0.001f) uvScale = 1.0f / worldWidth;
     }
 
+    // v4.7.0: Coarse preview of the world being generated replaces the current one
+    shape::TerrainRenderer* worldRenderer = finiteRenderer_.get();
+    if (showPreview_ && previewRenderer_) {
+        worldRenderer = previewRenderer_.get();
+        uvScale = previewWorldWidth_ > 0.001f ? 1.0f / previewWorldWidth_ : 0.0f;
+    }
+
     // Render Finite World if active
-    if (finiteRenderer_) {
+    if (worldRenderer) {
          std::array<float, 16> mvpArray;
          std::copy(std::begin(mvp), std::end(mvp), mvpArray.begin());
 
@@ -1287,7 +1251,7 @@ void Application::render(size_t frameIndex) {
              vegetationModeForRender = 0;
          }
 
-         finiteRenderer_->render(cmd, mvpArray, swapchain_->extent(), 
+         worldRenderer->render(cmd, mvpArray, swapchain_->extent(), 
           /* slope */ showSlopeAnalysis_,
     /* drainage */ showDrainage_, drainageIntensity_,
     /* watershed */ showWatershedVis_, showBasinOutlines_, 
@@ -1328,6 +1292,19 @@ void Application::render(size_t frameIndex) {
         /* seeding & resolution */ currentSeed_, worldResolution_, // v3.7.8
         /* light */ lightIntensity_, // v3.8.1
         /* async */ isRegenerating_, // v3.8.3
+        /* progress */ regenControl_ ? regenControl_->progress() : 0.0f, // v4.7.0
+
+        // v4.7.0 Timeline
+        timelineRecorder_ && timelineRecorder_->isRecording(),
+        timelineRecorder_ ? static_cast<size_t>(timelineRecorder_->stats().written) : 0,
+        timelineRecorder_ ? static_cast<size_t>(timelineRecorder_->stats().dropped) : 0,
+        replayActive_,
+        replayFrame_,
+        timelineReader_ ? static_cast<int>(timelineReader_->frameCount()) : 0,
+        timelineReader_ && replayActive_ ? timelineReader_->timeOf(static_cast<size_t>(replayFrame_)) : simTime_,
+        simulationRate_,
+        simTicksPerSecond_,
+        simStepMs_,
         
         // v3.9.0 Vegetation
         vegetationMode_,
@@ -1456,9 +1433,11 @@ void Application::deleteBookmark(size_t index) {
 // V3.5.0: Map Regeneration
 // V3.5.0: Map Regeneration
 void Application::regenerateFiniteWorld(const terrain::TerrainConfig& config) {
-    if (isRegenerating_) {
-        std::cout << "[SisterApp] Regeneration already in progress, request ignored." << std::endl;
-        return;
+    // v4.7.0: A new request supersedes the running one; it starts once the worker
+    // reaches its next checkpoint and unwinds
+    if (isRegenerating_ && regenControl_) {
+        std::cout << "[SisterApp] Regeneration in progress: cancelling it for the new request." << std::endl;
+        regenControl_->cancel();
     }
     
     deferredConfig_ = config;
@@ -1467,112 +1446,523 @@ void Application::regenerateFiniteWorld(const terrain::TerrainConfig& config) {
     std::cout << "[SisterApp] regenRequested_ set to TRUE." << std::endl;
 }
 
+void Application::importDem(const std::string& path, float resolution) {
+    terrain::DemGrid header;
+    std::string error;
+    if (!terrain::DemImporter::probe(path, header, &error)) {
+        std::cerr << "[SisterApp] DEM import failed (" << path << "): " << error << std::endl;
+        return;
+    }
+
+    // Coarsen rather than allocate grids past the largest supported map
+    constexpr int kMaxSide = 8192;
+    resolution = std::max(resolution, 0.1f);
+    int width = 0, height = 0;
+    terrain::DemImporter::targetSize(header, resolution, width, height);
+    if (std::max(width, height) > kMaxSide) {
+        const double extent = static_cast<double>(std::max(header.width, header.height) - 1) * header.cellSize;
+        resolution = static_cast<float>(extent / (kMaxSide - 1)) * 1.001f;
+        terrain::DemImporter::targetSize(header, resolution, width, height);
+        std::cout << "[SisterApp] DEM too large at the requested resolution; using " << resolution << " m cells." << std::endl;
+    }
+
+    terrain::TerrainConfig config = deferredConfig_;
+    config.model = terrain::TerrainConfig::FiniteTerrainModel::ImportedDem;
+    config.demPath = path;
+    config.width = width;
+    config.height = height;
+    config.resolution = resolution;
+    std::cout << "[SisterApp] Importing DEM " << path << " (" << header.width << "x" << header.height << " @ "
+              << header.cellSize << " m) as " << width << "x" << height << " @ " << resolution << " m" << std::endl;
+    regenerateFiniteWorld(config);
+}
+
 void Application::performMeshUpdate() {
     if (!finiteRenderer_ || !finiteMap_) return;
 
-    // Safety: Wait for all GPU operations to finish before destroying the old mesh
-    // This prevents "CS rejected" or "Device Lost" errors due to use-after-free
-    vkDeviceWaitIdle(ctx_->device());
-
     std::cout << "[SisterApp] Performing deferred mesh update..." << std::endl;
-    finiteRenderer_->buildMesh(*finiteMap_, worldResolution_, mlService_.get(), soilClassificationMode_, showMLSoil_);
+    terrain::SimulationThread::Pause pause(simulation_.get()); // ML colours read the live soil grid
+    // v4.7.0: Deferred updates only change colours/attributes (basins, ML, soil recompute);
+    // the attribute stream is re-encoded and streamed through the staging ring, so no
+    // device-wide wait is needed. Geometry and the cached index buffer are kept.
+    finiteRenderer_->refreshAttributes(*finiteMap_, worldResolution_, mlService_.get(), soilClassificationMode_, showMLSoil_);
     
     meshUpdateRequested_ = false;
 }
 
+bool Application::saveWorldSnapshot(const std::string& path, bool compress) {
+    if (!finiteMap_ || isRegenerating_) return false;
+    terrain::SimulationThread::Pause pause(simulation_.get()); // Consistent tick
+
+    terrain::SnapshotInfo info;
+    info.resolution = worldResolution_;
+    info.seed = currentSeed_;
+    info.maxHeight = deferredConfig_.maxHeight;
+    info.waterLevel = deferredConfig_.waterLevel;
+    terrain::SnapshotOptions options;
+    options.compress = compress;
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (!terrain::WorldSnapshot::save(path, *finiteMap_, info, options)) {
+        std::cerr << "[SisterApp] Failed to save world snapshot to '" << path << "'" << std::endl;
+        return false;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[SisterApp] World snapshot saved to '" << path << "' (" << ms << " ms)" << std::endl;
+    return true;
+}
+
+int Application::exportRasters(const std::string& directory) {
+    if (!finiteMap_ || isRegenerating_) return 0;
+    terrain::SimulationThread::Pause pause(simulation_.get());
+
+    terrain::RasterExportOptions options;
+    options.resolution = worldResolution_;
+    // An imported DEM keeps its georeference: lattice point (0,0) is the centre of its north-west cell
+    terrain::DemGrid dem;
+    if (deferredConfig_.model == terrain::TerrainConfig::FiniteTerrainModel::ImportedDem &&
+        terrain::DemImporter::probe(deferredConfig_.demPath, dem)) {
+        const double res = worldResolution_;
+        const double north = dem.yllCorner + (dem.height - 0.5) * dem.cellSize + 0.5 * res;
+        options.originX = dem.xllCorner + 0.5 * dem.cellSize - 0.5 * res;
+        options.originY = north - finiteMap_->getHeight() * res;
+    }
+
+    std::vector<terrain::RasterLayer> layers;
+    for (int l = 0; l < static_cast<int>(terrain::RasterLayer::Count); ++l) layers.push_back(static_cast<terrain::RasterLayer>(l));
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::string error;
+    const int written = terrain::RasterExporter::exportLayers(directory, *finiteMap_, layers, options, &error);
+    if (!error.empty()) std::cerr << "[SisterApp] Raster export failed: " << error << std::endl;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[SisterApp] Exported " << written << " rasters to '" << directory << "/' (" << ms << " ms)" << std::endl;
+    return written;
+}
+
+terrain::SimulationParameters Application::simulationParameters() const {
+    terrain::SimulationParameters params;
+    params.rainIntensity = rainIntensity_;
+    params.disturbance = disturbanceParams_;
+    params.climate = soilClimate_;
+    params.organism = soilOrganism_;
+    params.parent = soilParentMaterial_;
+    // v4.6.6: User-selected SiBCS level for dynamic depth calculation
+    if (soilClassificationMode_ >= 1 && soilClassificationMode_ <= 6) {
+        params.soilLevel = static_cast<landscape::SiBCSLevel>(soilClassificationMode_);
+    }
+    // Passive while the user edits the domain
+    if (soilClassificationMode_ >= 1) {
+        params.soilSimulation = sibcsConfig_.applyConstraints && sibcsConfig_.domainConfirmed && !sibcsConfig_.pendingChanges;
+    }
+    return params;
+}
+
+void Application::startSimulation() {
+    stopSimulation();
+    if (!finiteMap_) return;
+    terrain::SimulationSettings settings;
+    settings.ticksPerSecond = simulationRate_;
+    settings.seed = static_cast<uint32_t>(currentSeed_);
+    postedSimParameters_ = simulationParameters();
+    appliedSimulationRate_ = simulationRate_;
+    consumedSoilRows_ = 0;
+    simTick_ = 0;
+    simTime_ = 0.0;
+    simulation_ = std::make_unique<terrain::SimulationThread>();
+    simulation_->start(*finiteMap_, postedSimParameters_, settings);
+}
+
+void Application::stopSimulation() {
+    if (!simulation_) return;
+    stopRecording(); // Its tick observer runs on the simulation thread
+    simulation_->stop();
+    simulation_.reset();
+}
+
+void Application::consumeSimulationFrame() {
+    terrain::SimulationThread::FrameRef frame = simulation_->acquire();
+    if (!frame || frame->tick == simTick_ || !finiteMap_) return;
+    simTick_ = frame->tick;
+    simTime_ = frame->time;
+    simTicksPerSecond_ = frame->ticksPerSecond;
+    simStepMs_ = frame->stepMs;
+
+    // Texture streaming diffs the snapshot against what it uploaded last
+    if (finiteRenderer_ && frame->vegetation.isValid() && !replayActive_) {
+        finiteRenderer_->updateVegetation(frame->vegetation);
+    }
+
+    // Soil rows evolved since the last frame consumed (frames may have been skipped).
+    // The taxonomy only changes under a Pause, so soil_type is safe to read here.
+    const auto* soil = finiteMap_->getLandscapeSoil();
+    const int w = finiteMap_->getWidth();
+    const int h = finiteMap_->getHeight();
+    const uint64_t swept = frame->soilRowsSwept;
+    if (!soil || h <= 0 || swept <= consumedSoilRows_) return;
+
+    const bool active = frame->soilSimulation;
+    // v4.7.0: The semantic soil map views the evolving SiBCS classification
+    // (no per-row copy). Passive state while the user edits the domain: an own
+    // buffer of None keeps the visuals cleared.
+    if (soilClassificationMode_ >= 1 && finiteMap_->soilShared() != active) {
+        finiteMap_->shareSoilTypes(active);
+        if (finiteRenderer_) finiteRenderer_->markAttributesDirty(0, h);
+    }
+    auto syncRows = [&](int rowBegin, int rowEnd) {
+        if (soilClassificationMode_ >= 1) {
+            finiteMap_->markDirty(0, rowBegin, w, rowEnd); // Soil pyramid tiles
+        }
+        // Only these rows are re-encoded and streamed
+        if (finiteRenderer_ && (soilClassificationMode_ >= 1 || showMLSoil_)) {
+            finiteRenderer_->markAttributesDirty(rowBegin, rowEnd);
+        }
+    };
+    const uint64_t rows = std::min<uint64_t>(swept - consumedSoilRows_, static_cast<uint64_t>(h));
+    const int first = static_cast<int>((swept - rows) % static_cast<uint64_t>(h));
+    const int last = first + static_cast<int>(rows);
+    syncRows(first, std::min(last, h));
+    if (last > h) syncRows(0, last - h);
+
+    // Minimap reads the pyramid (only the swept tiles are recomputed), once per full sweep
+    const bool sweepDone = swept / static_cast<uint64_t>(h) > consumedSoilRows_ / static_cast<uint64_t>(h);
+    consumedSoilRows_ = swept;
+    if (sweepDone && uiLayer_ && soilClassificationMode_ >= 1) {
+        uiLayer_->onTerrainUpdated(*finiteMap_, backgroundConfig_);
+    }
+}
+
+void Application::TimelineGrid::read(std::vector<float>& out) const {
+    if (floats) {
+        out.assign(floats->begin(), floats->end());
+    } else {
+        out.resize(packed->size());
+        packed->load(0, out.size(), out.data());
+    }
+}
+
+void Application::TimelineGrid::write(const std::vector<float>& values) const {
+    if (floats) {
+        floats->assign(values.begin(), values.end());
+    } else if (values.size() == packed->size()) {
+        packed->store(0, values.size(), values.data());
+    }
+}
+
+std::vector<Application::TimelineGrid> Application::timelineGrids() {
+    std::vector<TimelineGrid> grids;
+    if (!finiteMap_) return grids;
+    if (auto* veg = finiteMap_->getVegetation()) {
+        grids.push_back({"vegetation_ei", nullptr, &veg->ei_coverage});
+        grids.push_back({"vegetation_es", nullptr, &veg->es_coverage});
+    }
+    if (auto* soil = finiteMap_->getLandscapeSoil()) grids.push_back({"soil_depth", &soil->depth, nullptr});
+    if (auto* hydro = finiteMap_->getLandscapeHydro()) grids.push_back({"erosion_risk", &hydro->erosion_risk, nullptr});
+    return grids;
+}
+
+bool Application::startRecording(const std::string& path) {
+    if (!finiteMap_ || isRegenerating_ || replayActive_) return false;
+    stopRecording();
+
+    std::vector<terrain::TimelineChannel> channels;
+    for (const auto& grid : timelineGrids()) channels.push_back({grid.name, grid.floats, grid.packed});
+    std::string error;
+    timelineRecorder_ = std::make_unique<terrain::TimelineRecorder>();
+    if (!timelineRecorder_->start(path, finiteMap_->getWidth(), finiteMap_->getHeight(), channels, {}, &error)) {
+        std::cerr << "[SisterApp] Cannot record timeline to '" << path << "': " << error << std::endl;
+        timelineRecorder_.reset();
+        return false;
+    }
+    // Captured on the simulation thread right after each tick
+    if (simulation_) {
+        terrain::SimulationThread::Pause pause(simulation_.get());
+        terrain::TimelineRecorder* recorder = timelineRecorder_.get();
+        simulation_->setTickObserver([recorder](uint64_t tick, double time) { recorder->capture(tick, time); });
+    }
+    std::cout << "[SisterApp] Recording simulation timeline to '" << path << "'" << std::endl;
+    return true;
+}
+
+void Application::stopRecording() {
+    if (!timelineRecorder_ || !timelineRecorder_->isRecording()) return;
+    if (simulation_) {
+        terrain::SimulationThread::Pause pause(simulation_.get());
+        simulation_->setTickObserver(nullptr);
+    }
+    const bool ok = timelineRecorder_->stop();
+    const terrain::TimelineStats stats = timelineRecorder_->stats();
+    std::cout << "[SisterApp] Timeline " << (ok ? "saved" : "FAILED") << ": " << stats.written << " frames ("
+              << stats.keyframes << " keyframes, " << stats.dropped << " dropped), "
+              << stats.bytes / (1024 * 1024) << " MB" << std::endl;
+}
+
+void Application::setReplay(bool active) {
+    if (active == replayActive_) return;
+    if (!active) {
+        // Back to the live simulation
+        if (finiteMap_) {
+            terrain::SimulationThread::Pause pause(simulation_.get());
+            std::vector<TimelineGrid> grids = timelineGrids();
+            for (size_t c = 0; c < grids.size() && c < replayBackup_.size(); ++c) grids[c].write(replayBackup_[c]);
+            if (auto* veg = finiteMap_->getVegetation()) {
+                veg->touchAll();
+                if (finiteRenderer_) finiteRenderer_->updateVegetation(*veg);
+            }
+        }
+        replayBackup_.clear();
+        timelineReader_.reset();
+        replayActive_ = false;
+        if (simulation_) simulation_->setSuspended(false);
+        std::cout << "[SisterApp] Replay closed, simulation resumed." << std::endl;
+        return;
+    }
+
+    if (!finiteMap_ || isRegenerating_ || !timelineRecorder_) return;
+    stopRecording();
+    std::string error;
+    auto reader = std::make_unique<terrain::TimelineReader>();
+    if (!reader->open(timelineRecorder_->path(), &error)) {
+        std::cerr << "[SisterApp] Cannot open timeline: " << error << std::endl;
+        return;
+    }
+    if (reader->frameCount() == 0 || reader->width() != finiteMap_->getWidth() || reader->height() != finiteMap_->getHeight()) {
+        std::cerr << "[SisterApp] Timeline does not match the current world." << std::endl;
+        return;
+    }
+    // The simulation holds still while recorded values sit in its grids
+    if (simulation_) simulation_->setSuspended(true);
+    {
+        terrain::SimulationThread::Pause pause(simulation_.get());
+        replayBackup_.clear();
+        for (const auto& grid : timelineGrids()) {
+            replayBackup_.emplace_back();
+            grid.read(replayBackup_.back());
+        }
+    }
+    timelineReader_ = std::move(reader);
+    replayActive_ = true;
+    std::cout << "[SisterApp] Replaying " << timelineReader_->frameCount() << " recorded frames." << std::endl;
+    seekReplay(static_cast<int>(timelineReader_->frameCount()) - 1);
+}
+
+void Application::seekReplay(int frame) {
+    if (!replayActive_ || !timelineReader_ || !finiteMap_) return;
+    frame = std::clamp(frame, 0, static_cast<int>(timelineReader_->frameCount()) - 1);
+    const auto* values = timelineReader_->read(static_cast<size_t>(frame));
+    if (!values) return;
+    replayFrame_ = frame;
+
+    terrain::SimulationThread::Pause pause(simulation_.get());
+    for (const auto& grid : timelineGrids()) {
+        const int c = timelineReader_->channelIndex(grid.name);
+        if (c >= 0) grid.write((*values)[static_cast<size_t>(c)]);
+    }
+    if (auto* veg = finiteMap_->getVegetation()) {
+        veg->touchAll();
+        if (finiteRenderer_) finiteRenderer_->updateVegetation(*veg);
+    }
+}
+
+void Application::loadWorldSnapshot(const std::string& path) {
+    if (isRegenerating_) {
+        std::cout << "[SisterApp] Regeneration in progress, snapshot load ignored." << std::endl;
+        return;
+    }
+    std::cout << "[SisterApp] Loading world snapshot '" << path << "'..." << std::endl;
+
+    // Same hand-over as a regeneration: the worker fills the background map + mesh
+    isRegenerating_ = true;
+    regenControl_ = std::make_shared<terrain::RegenerationControl>();
+    std::shared_ptr<terrain::RegenerationControl> control = regenControl_;
+    terrain::TerrainConfig config = deferredConfig_;
+    const int soilMode = soilClassificationMode_;
+    const bool useMLColor = showMLSoil_;
+
+    regenJob_ = core::JobSystem::instance().submit([this, path, config, control, soilMode, useMLColor]() {
+        auto map = std::make_unique<terrain::TerrainMap>(1, 1);
+        terrain::SnapshotInfo info;
+        if (!terrain::WorldSnapshot::load(path, *map, &info, control.get())) {
+            throw std::runtime_error("cannot load world snapshot '" + path + "'");
+        }
+        terrain::TerrainConfig loaded = config;
+        loaded.width = info.width;
+        loaded.height = info.height;
+        loaded.resolution = info.resolution;
+        loaded.seed = info.seed;
+        loaded.maxHeight = info.maxHeight;
+        loaded.waterLevel = info.waterLevel;
+
+        control->checkpoint();
+        this->backgroundMeshData_ = shape::TerrainRenderer::generateMeshData(*map, loaded.resolution, this->mlService_.get(), soilMode, useMLColor);
+        this->backgroundMap_ = std::move(map);
+        this->backgroundConfig_ = loaded;
+    }, {}, core::JobOptions::longRunning());
+}
+
 void Application::performRegeneration() {
     // Phase 1: Start Async Task
     if (regenRequested_ && !isRegenerating_) {
         std::cout << "[SisterApp] Starting Async Regeneration: " << deferredConfig_.width << "x" << deferredConfig_.height << std::endl;
         
         // Capture parameters locally to avoid race conditions if variables change
-        // We can just copy the config struct now!
-        terrain::TerrainConfig config = deferredConfig_;
-        int currentSoilMode = soilClassificationMode_;
-        landscape::SiBCSUserConfig domainCopy = sibcsConfig_;
+        terrain::RegenerationInputs inputs;
+        inputs.config = deferredConfig_;
+        inputs.soilMode = soilClassificationMode_;
+        inputs.domain = sibcsConfig_;
 
         regenRequested_ = false;
         isRegenerating_ = true;
 
-        regenFuture_ = std::async(std::launch::async, [=]() {
-            // 1. Create independent resources
-            auto map = std::make_unique<terrain::TerrainMap>(config.width, config.height);
-            auto gen = std::make_unique<terrain::TerrainGenerator>(config.seed);
-
-            // 2. Setup Config (Already copied)
-            // Explicitly ensure internal consistency if needed (e.g. width/height)
-            // Config is passed entirely.
-
-
-            // 3. Generate High-Cost Data
-            gen->generateBaseTerrain(*map, config);
-            gen->calculateDrainage(*map);
-            gen->classifySoil(*map, config);
-            
-            // v4.0.0: Initialize Landscape Systems
-            gen->generateLandscape(*map);
+        // v4.7.0: Stage graph; only stages whose inputs changed since the last run execute
+        if (!regenPipeline_) {
+            regenPipeline_ = std::make_unique<terrain::TerrainPipeline>();
+            regenPipeline_->setDiskCache(worldCache_); // v4.7.0: Warm start across sessions
+            terrain::TerrainPipeline* pipeline = regenPipeline_.get();
+            // 4. Prepare Mesh Data (CPU Heavy). Not memoized: it also reads ML model state.
+            pipeline->graph().addStage({
+                "mesh",
+                {terrain::TerrainPipeline::kDrainage, terrain::TerrainPipeline::kScorpan, terrain::TerrainPipeline::kVegetation},
+                nullptr,
+                [this, pipeline](terrain::TerrainMap& map) {
+                    const terrain::RegenerationInputs& in = pipeline->inputs();
+                    // v4.5.10: Explicitly pass showMLSoil to prevent unwanted color overrides
+                    this->backgroundMeshData_ = shape::TerrainRenderer::generateMeshData(map, in.config.resolution, this->mlService_.get(), in.soilMode, this->showMLSoil_);
+                },
+                nullptr
+            });
+        }
 
-            // v4.5.11: Transform Vectors to Soil Types immediately if in SCORPAN mode
-            if (currentSoilMode == 1) {
-                gen->classifySoilFromSCORPAN(*map, &domainCopy);
+        // v4.7.0: Previews only pay off when the heights are actually recomputed
+        std::vector<int> previewFactors;
+        if (!regenPipeline_->reusesBaseTerrain(inputs)) {
+            previewFactors = terrain::TerrainPipeline::previewFactors(inputs.config);
+        }
+        regenControl_ = std::make_shared<terrain::RegenerationControl>();
+        std::shared_ptr<terrain::RegenerationControl> control = regenControl_;
+        const bool useMLColor = showMLSoil_;
+
+        regenJob_ = core::JobSystem::instance().submit([this, inputs, previewFactors, control, useMLColor]() {
+            // 0. Coarse previews first (coarsest first), handed to the main thread
+            for (int factor : previewFactors) {
+                auto preview = std::make_unique<RegenPreview>();
+                preview->map = terrain::TerrainPipeline::generatePreview(inputs, factor, control.get());
+                preview->resolution = inputs.config.resolution * static_cast<float>(factor);
+                // Soil patterns only (no SiBCS grids yet): pattern palette
+                preview->mesh = shape::TerrainRenderer::generateMeshData(*preview->map, preview->resolution, this->mlService_.get(), 0, useMLColor);
+                control->checkpoint();
+                std::lock_guard<std::mutex> lock(previewMutex_);
+                pendingPreview_ = std::move(preview);
             }
 
-            // v3.9.0: Initialize Vegetation (Async)
-            if (map->getVegetation()) {
-                vegetation::VegetationSystem::initialize(*map->getVegetation(), config.seed);
-            }
+            // 1. Create independent resources
+            auto map = std::make_unique<terrain::TerrainMap>(inputs.config.width, inputs.config.height);
 
-            // 4. Prepare Mesh Data (CPU Heavy)
-            // v4.5.10: Explicitly pass showMLSoil to prevent unwanted color overrides
-            auto meshData = shape::TerrainRenderer::generateMeshData(*map, config.resolution, this->mlService_.get(), currentSoilMode, this->showMLSoil_);
+            // 2-4. Base terrain, drainage, soil, landscape, SCORPAN, vegetation and mesh
+            // (unchanged stages are restored from the previous run); throws
+            // RegenerationCancelled between tiles once cancelled
+            regenPipeline_->regenerate(*map, inputs, control.get());
 
-            // 5. Output to Background Members (Thread Safe? No, member access needs care.)
-            // Since main thread checks "future.valid/ready" and doesn't touch these until then, 
-            // we can just write them here. But wait, `this` capture.
-            // Better: Return a struct and using shared_ptr or move? 
-            // Easier: Write to members. Main thread is NOT reading them yet.
+            // 5. Output to Background Members: the main thread does not read them
+            // until the future is ready
             this->backgroundMap_ = std::move(map);
-            this->backgroundMeshData_ = std::move(meshData);
-            this->backgroundConfig_ = config;
-        });
+            this->backgroundConfig_ = inputs.config;
+        }, {}, core::JobOptions::longRunning());
 
         return; // Return immediately to keep UI running
     }
 
     // Phase 2: Check Completion
     if (isRegenerating_) {
+        // v4.7.0: Show the latest preview while the full map is being built
+        std::unique_ptr<RegenPreview> preview;
+        {
+            std::lock_guard<std::mutex> lock(previewMutex_);
+            preview = std::move(pendingPreview_);
+        }
+        if (preview && !regenControl_->isCancelled()) {
+            vkDeviceWaitIdle(ctx_->device());
+            if (!previewRenderer_) {
+                previewRenderer_ = std::make_unique<shape::TerrainRenderer>(*ctx_, swapchain_->renderPass(), commandPool_->handle());
+            }
+            previewRenderer_->uploadMesh(std::move(preview->mesh));
+            if (preview->map->getVegetation()) {
+                previewRenderer_->updateVegetation(*preview->map->getVegetation());
+            }
+            previewWorldWidth_ = static_cast<float>(preview->map->getWidth()) * preview->resolution;
+            showPreview_ = true;
+            std::cout << "[SisterApp] Preview " << preview->map->getWidth() << "x" << preview->map->getHeight() << " shown." << std::endl;
+        }
+
         // Check if ready (non-blocking)
-        if (regenFuture_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-            regenFuture_.get(); // Retrieve result (rethrows exceptions)
+        if (regenJob_.done()) {
+            try {
+                regenJob_.get(); // Retrieve result (rethrows exceptions)
+            } catch (const terrain::RegenerationCancelled&) {
+                // Current world untouched; a superseding request (if any) starts next frame
+                std::cout << "[SisterApp] Regeneration cancelled." << std::endl;
+                showPreview_ = false;
+                isRegenerating_ = false;
+                return;
+            } catch (const std::exception& e) {
+                // v4.7.0: e.g. an unreadable snapshot; keep the current world
+                std::cerr << "[SisterApp] Regeneration failed: " << e.what() << std::endl;
+                showPreview_ = false;
+                isRegenerating_ = false;
+                return;
+            }
+            showPreview_ = false;
             
             std::cout << "[SisterApp] Async Generation Finished. Uploading to GPU..." << std::endl;
 
             // Safe to touch GPU now
             vkDeviceWaitIdle(ctx_->device());
 
+            // v4.7.0: Recorded channels belong to the old world; the simulation
+            // thread must let go of the map before it is replaced
+            setReplay(false);
+            stopRecording();
+            stopSimulation();
+
             // Swap Maps
             finiteMap_ = std::move(backgroundMap_);
             currentSeed_ = backgroundConfig_.seed;
             // deferredRegenResolution_ = backgroundConfig_.resolution; // deleted
             worldResolution_ = backgroundConfig_.resolution;
 
-            // Recreate Renderer
-            finiteRenderer_.reset();
-            finiteRenderer_ = std::make_unique<shape::TerrainRenderer>(*ctx_, swapchain_->renderPass(), commandPool_->handle());
-            
-            // Upload Mesh (Fast Transfer)
-            finiteRenderer_->uploadMesh(backgroundMeshData_);
+            // v4.7.0: Channel memory of the new world (lazy and shared channels hold nothing)
+            {
+                size_t held = 0;
+                size_t deferred = 0;
+                std::string idle;
+                for (const core::ChannelUsage& u : finiteMap_->memoryReport()) {
+                    held += u.bytes;
+                    if (u.state == core::ChannelState::Allocated) continue;
+                    deferred += u.reserved;
+                    idle += (idle.empty() ? "" : ", ") + u.name + (u.state == core::ChannelState::Shared ? " (shared)" : "");
+                }
+                std::cout << "[Memory] World grids: " << held / (1024 * 1024) << " MiB allocated, "
+                          << deferred / (1024 * 1024) << " MiB deferred [" << idle << "]" << std::endl;
+            }
+
+            // v4.7.0: Keep the renderer so the index buffer is reused when the grid size is unchanged
+            if (!finiteRenderer_) {
+                finiteRenderer_ = std::make_unique<shape::TerrainRenderer>(*ctx_, swapchain_->renderPass(), commandPool_->handle());
+            }
             
-            // Clean up heavy data
-            backgroundMeshData_.vertices.clear();
-            backgroundMeshData_.vertices.shrink_to_fit();
-            backgroundMeshData_.indices.clear();
-            backgroundMeshData_.indices.shrink_to_fit();
+            // Upload Mesh (Fast Transfer); renderer takes ownership of the vertex data
+            finiteRenderer_->uploadMesh(std::move(backgroundMeshData_));
+            backgroundMeshData_ = {};
+
+            if (finiteMap_->getVegetation()) {
+                finiteRenderer_->updateVegetation(*finiteMap_->getVegetation());
+            }
 
             // Update Minimap
             if (uiLayer_) {
                 uiLayer_->onTerrainUpdated(*finiteMap_, backgroundConfig_);
             }
+            startSimulation(); // v4.7.0
 
             // Teleport
             float cx = (static_cast<float>(finiteMap_->getWidth()) / 2.0f) * worldResolution_;
@@ -17,14 +17,19 @@
 #include "../ui/ui_layer.h"
 #include "../ui/bookmark.h"
 #include "input_manager.h"
+#include "job_system.h" // v4.7.0
 #include "../terrain/terrain_map.h"
 #include "../terrain/terrain_generator.h"
 #include "../terrain/terrain_renderer.h"
+#include "../terrain/terrain_pipeline.h"
+#include "../terrain/timeline_recorder.h" // v4.7.0
+#include "../terrain/simulation_thread.h" // v4.7.0
 #include "../vegetation/vegetation_types.h"
 #include "../landscape/soil_services.h" // v4.5.1
 #include <vector>
 #include <memory>
 #include <future>
+#include <mutex>
 #include <atomic>
 #include <chrono>
 #include <string>
@@ -99,6 +104,14 @@ namespace core {
         void requestTerrainReset(int warmupRadius = 1);
         void regenerateFiniteWorld(const terrain::TerrainConfig& config); // v3.8.3 Struct-based
         void performRegeneration(); // v3.5.0 internal
+        bool saveWorldSnapshot(const std::string& path, bool compress); // v4.7.0: Checkpoint all grids
+        void loadWorldSnapshot(const std::string& path);                // v4.7.0: Resume (async, like regeneration)
+        void importDem(const std::string& path, float resolution);       // v4.7.0: Real terrain via the regeneration pipeline
+        int exportRasters(const std::string& directory);                 // v4.7.0: Every layer as a tiled GeoTIFF
+        bool startRecording(const std::string& path);                    // v4.7.0: Simulation timeline (10 Hz ticks)
+        void stopRecording();
+        void setReplay(bool active);                                     // v4.7.0: Pauses the simulation and shows recorded frames
+        void seekReplay(int frame);
 
 
     private:    // --- Core Systems ---
@@ -196,11 +209,27 @@ namespace core {
         float lightIntensity_ = 1.0f; // v3.8.1
         
         // v3.8.3: Async Regeneration
-        std::future<void> regenFuture_;
+        core::JobSystem::Handle regenJob_; // v4.7.0: Background job on the shared pool
         std::atomic<bool> isRegenerating_{false};
         std::unique_ptr<terrain::TerrainMap> backgroundMap_;
         shape::TerrainRenderer::MeshData backgroundMeshData_;
         terrain::TerrainConfig backgroundConfig_; // Store config for main thread use (Minimap)
+        std::unique_ptr<terrain::TerrainPipeline> regenPipeline_; // v4.7.0: Memoized stage graph (worker thread only while regenerating)
+        std::shared_ptr<terrain::WorldCache> worldCache_; // v4.7.0: On-disk warm-start cache (startup + regenerations)
+        std::shared_ptr<terrain::RegenerationControl> regenControl_; // v4.7.0: Cancel token + progress of the running regeneration
+
+        // v4.7.0: Coarse previews published by the worker, drawn instead of the current
+        // world until the full map is ready (renderer kept across regenerations)
+        struct RegenPreview {
+            std::unique_ptr<terrain::TerrainMap> map;
+            shape::TerrainRenderer::MeshData mesh;
+            float resolution = 1.0f;
+        };
+        std::mutex previewMutex_;
+        std::unique_ptr<RegenPreview> pendingPreview_; // Guarded by previewMutex_
+        std::unique_ptr<shape::TerrainRenderer> previewRenderer_;
+        bool showPreview_ = false;
+        float previewWorldWidth_ = 0.0f;
         
         // v3.6.3 Deferred Update Flag
         bool meshUpdateRequested_ = false;
@@ -215,13 +244,38 @@ namespace core {
         int vegetationMode_ = 1; // Default to Realistic (1)
         vegetation::DisturbanceRegime disturbanceParams_; // Default constructor has sensible defaults?
         
-        // v3.9.1 Throttle Vegetation Updates (Optimized for Large Maps)
-        float vegUpdateTimer_ = 0.0f; // Accumulator
-        float vegUpdateInterval_ = 0.1f; // 10Hz (0.1s)
-        
-        // v4.5.9 Time Slicing State
-        int currentSoilRow_ = 0;
-        const int constSoilSliceRows_ = 32; // Reduced from 128 to 32 for 2048+ maps
+        // v4.7.0: Hydro/soil/vegetation step on their own thread at simulationRate_
+        // (10 Hz = real time, 0 = unthrottled). The frame loop forwards UI edits as
+        // commands and consumes the published frames (vegetation texture, soil rows).
+        std::unique_ptr<terrain::SimulationThread> simulation_;
+        terrain::SimulationParameters postedSimParameters_;
+        float simulationRate_ = 10.0f;
+        float appliedSimulationRate_ = 10.0f;
+        uint64_t consumedSoilRows_ = 0;
+        uint64_t simTick_ = 0;   // Of the last consumed frame
+        double simTime_ = 0.0;   // Simulated seconds
+        double simTicksPerSecond_ = 0.0;
+        double simStepMs_ = 0.0;
+        void startSimulation();
+        void stopSimulation();
+        terrain::SimulationParameters simulationParameters() const;
+        void consumeSimulationFrame();
+
+        // v4.7.0: Timeline recording / replay. Replay swaps the recorded channels into
+        // the live grids; the live values are kept aside and restored on exit.
+        std::unique_ptr<terrain::TimelineRecorder> timelineRecorder_;
+        std::unique_ptr<terrain::TimelineReader> timelineReader_;
+        std::vector<std::vector<float>> replayBackup_;
+        bool replayActive_ = false;
+        int replayFrame_ = 0;
+        struct TimelineGrid { // A recorded channel of finiteMap_: float or packed storage
+            std::string name;
+            core::GridVector<float>* floats = nullptr;
+            core::PackedChannel* packed = nullptr;
+            void read(std::vector<float>& out) const;
+            void write(const std::vector<float>& values) const;
+        };
+        std::vector<TimelineGrid> timelineGrids();
         
         // v4.0: Landscape Integration
         float rainIntensity_ = 50.0f; // mm/h (Heavy Rain for Testing)
@@ -240,7 +294,7 @@ namespace core {
         
         // v4.2.1 Advanced ML Controls
         bool isTraining_ = false;
-        std::future<void> trainingFuture_;
+        core::JobSystem::Handle trainingJob_;
         
         int mlTrainingEpochs_ = 50;
         float mlLearningRate_ = 0.1f;
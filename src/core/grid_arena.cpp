@@ -0,0 +1,300 @@
+#include "grid_arena.h"
+#include "job_system.h"
+#include "packed_channel.h"
+#include <algorithm>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace core {
+
+namespace {
+
+constexpr size_t kMinRegion = size_t(64) << 10;
+constexpr size_t kPageSize = size_t(4) << 10;
+constexpr size_t kHugePageSize = size_t(2) << 20;
+
+std::mutex gPoolMutex;
+GridArenaConfig gConfig;
+
+} // namespace
+
+// Guarded by gPoolMutex
+std::vector<GridArena::Region>& GridArena::pool() {
+    static auto* regions = new std::vector<Region>(); // Outlives static destructors
+    return *regions;
+}
+
+void GridArena::configure(const GridArenaConfig& config) {
+    std::lock_guard<std::mutex> lock(gPoolMutex);
+    gConfig = config;
+}
+
+GridArena::GridArena() {
+    std::lock_guard<std::mutex> lock(gPoolMutex);
+    hugePages_ = gConfig.hugePages;
+}
+
+GridArena::~GridArena() {
+    for (const Region& region : regions_) recycleRegion(region);
+}
+
+GridArena::Region GridArena::acquireRegion(size_t bytes, bool huge) {
+    const size_t page = huge ? kHugePageSize : kPageSize;
+    const size_t size = (std::max(bytes, kMinRegion) + page - 1) / page * page;
+    {
+        // Best fit among recycled regions, unless it would waste more than half
+        std::lock_guard<std::mutex> lock(gPoolMutex);
+        auto best = pool().end();
+        for (auto it = pool().begin(); it != pool().end(); ++it) {
+            if (it->huge == huge && it->size >= size && it->size / 2 <= size &&
+                (best == pool().end() || it->size < best->size)) {
+                best = it;
+            }
+        }
+        if (best != pool().end()) {
+            Region region = *best;
+            pool().erase(best);
+            return region;
+        }
+    }
+
+    Region region;
+    region.size = size;
+    region.huge = huge;
+#ifdef __linux__
+    // Over-map by one huge page so the region can start on a huge-page boundary
+    const size_t slack = huge ? kHugePageSize : 0;
+    void* p = mmap(nullptr, size + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+    uint8_t* base = static_cast<uint8_t*>(p);
+    if (huge) {
+        const uintptr_t addr = reinterpret_cast<uintptr_t>(base);
+        uint8_t* aligned = base + ((kHugePageSize - addr % kHugePageSize) % kHugePageSize);
+        if (aligned > base) munmap(base, static_cast<size_t>(aligned - base));
+        const size_t tail = static_cast<size_t>(base + size + slack - (aligned + size));
+        if (tail > 0) munmap(aligned + size, tail);
+        base = aligned;
+        madvise(base, size, MADV_HUGEPAGE); // A hint: THP may be disabled system-wide
+    }
+    region.base = base;
+    region.mapped = true;
+#else
+    region.base = static_cast<uint8_t*>(::operator new(size, std::align_val_t(kAlignment)));
+#endif
+    return region;
+}
+
+void GridArena::recycleRegion(Region region) {
+    std::lock_guard<std::mutex> lock(gPoolMutex);
+    pool().push_back(region);
+    // Oldest first out
+    while (static_cast<int>(pool().size()) > std::max(gConfig.cachedRegions, 0)) {
+        freeRegion(pool().front());
+        pool().erase(pool().begin());
+    }
+}
+
+void GridArena::freeRegion(const Region& region) {
+#ifdef __linux__
+    if (region.mapped) {
+        munmap(region.base, region.size);
+        return;
+    }
+#endif
+    ::operator delete(region.base, std::align_val_t(kAlignment));
+}
+
+void* GridArena::allocate(size_t bytes) {
+    bytes = roundUp(std::max<size_t>(bytes, 1));
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (regions_.empty() || offset_ + bytes > regions_.back().size) {
+        // Full: another region at least as large as everything so far
+        regions_.push_back(acquireRegion(std::max(bytes, totalSize()), hugePages_));
+        offset_ = 0;
+    }
+    void* p = regions_.back().base + offset_;
+    offset_ += bytes;
+    used_ += bytes;
+    ++live_;
+    return p;
+}
+
+void GridArena::deallocate(void* p) {
+    if (!p) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    --live_;
+}
+
+bool GridArena::reset(size_t bytes) {
+    bytes = roundUp(bytes);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (live_ > 0) return false;
+    if (regions_.size() != 1 || regions_.front().size < bytes) {
+        for (const Region& region : regions_) recycleRegion(region);
+        regions_.clear();
+        if (bytes > 0) regions_.push_back(acquireRegion(bytes, hugePages_));
+    }
+    offset_ = 0;
+    used_ = 0;
+    return true;
+}
+
+void GridArena::discard(void* p, size_t bytes) {
+#ifdef __linux__
+    const uintptr_t begin = (reinterpret_cast<uintptr_t>(p) + kPageSize - 1) / kPageSize * kPageSize;
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(p) + bytes) / kPageSize * kPageSize;
+    if (end > begin) madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+#else
+    (void)p;
+    (void)bytes;
+#endif
+}
+
+void GridArena::trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (regions_.empty()) return;
+    const Region& region = regions_.back();
+    discard(region.base + offset_, region.size - offset_);
+}
+
+size_t GridArena::totalSize() const {
+    size_t total = 0;
+    for (const Region& region : regions_) total += region.size;
+    return total;
+}
+
+size_t GridArena::capacity() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totalSize();
+}
+
+size_t GridArena::used() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+}
+
+size_t GridArena::regionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return regions_.size();
+}
+
+// --- GridLayout ---
+
+GridLayout::GridLayout(int width, int height, std::shared_ptr<GridArena> arena)
+    : width_(width), height_(height), arena_(std::move(arena)) {}
+
+GridLayout::Entry* GridLayout::find(const void* channel) {
+    for (Entry& e : entries_) {
+        if (e.channel == channel) return &e;
+    }
+    return nullptr;
+}
+
+GridLayout::Entry* GridLayout::find(const std::string& name) {
+    for (Entry& e : entries_) {
+        if (e.name == name) return &e;
+    }
+    return nullptr;
+}
+
+const GridLayout::Entry* GridLayout::find(const std::string& name) const {
+    for (const Entry& e : entries_) {
+        if (e.name == name) return &e;
+    }
+    return nullptr;
+}
+
+void GridLayout::add(const std::string& name, PackedChannel& channel, float value) {
+    channel.precision_ = PackedChannel::precisionFor(name, channel.preferred_);
+    if (channel.precision_ == ChannelPrecision::Float32) {
+        channel.u16_ = GridVector<uint16_t>();
+        add(name, channel.f32_, value);
+    } else {
+        channel.f32_ = GridVector<float>();
+        add(name, channel.u16_, PackedChannel::encode16(channel.precision_, value));
+    }
+}
+
+void GridLayout::fill(const std::vector<const Entry*>& entries) const {
+    const size_t w = static_cast<size_t>(width_);
+    JobSystem::instance().parallelFor(0, height_, 0, [&](int y0, int y1) {
+        for (const Entry* e : entries) {
+            if (e->perCell) e->fill(static_cast<size_t>(y0) * w, static_cast<size_t>(y1) * w);
+        }
+    });
+    for (const Entry* e : entries) {
+        if (!e->perCell) e->fill(0, e->count);
+    }
+}
+
+void GridLayout::apply() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t total = 0;
+    for (Entry& e : entries_) {
+        e.release(false);
+        e.allocated = false;
+        total += e.bytes; // Lazy channels reserve their space too
+    }
+    if (arena_) arena_->reset(total);
+
+    std::vector<const Entry*> eager;
+    for (Entry& e : entries_) {
+        if (e.lazy) continue;
+        e.allocate();
+        e.allocated = true;
+        eager.push_back(&e);
+    }
+    fill(eager);
+    // Reservations and stale pages of a recycled region go back to the OS
+    if (arena_) arena_->trim();
+}
+
+bool GridLayout::materializeEntry(Entry* e) {
+    if (!e) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!e->allocated) {
+        e->allocate();
+        fill({e});
+        e->allocated = true;
+    }
+    return true;
+}
+
+bool GridLayout::releaseEntry(Entry* e) {
+    if (!e) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (e->allocated) {
+        e->release(true);
+        e->allocated = false;
+    }
+    return true;
+}
+
+bool GridLayout::isLazy(const std::string& name) const {
+    const Entry* e = find(name);
+    return e && e->lazy;
+}
+
+bool GridLayout::isAllocated(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Entry* e = find(name);
+    return e && e->allocated;
+}
+
+std::vector<ChannelUsage> GridLayout::usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ChannelUsage> report;
+    report.reserve(entries_.size());
+    for (const Entry& e : entries_) {
+        ChannelUsage u;
+        u.name = e.name;
+        u.state = e.allocated ? ChannelState::Allocated : (e.lazy ? ChannelState::Lazy : ChannelState::Released);
+        u.bytes = e.allocated ? e.bytes : 0;
+        u.reserved = e.bytes;
+        report.push_back(std::move(u));
+    }
+    return report;
+}
+
+} // namespace core
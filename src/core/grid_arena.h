@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace core {
+
+class PackedChannel;
+
+struct GridArenaConfig {
+    bool hugePages = false;   // Back regions with transparent huge pages (Linux)
+    int cachedRegions = 2;    // Regions of destroyed arenas kept for the next world
+};
+
+/**
+ * @brief v4.7.0: One region holding every channel of a world.
+ *
+ * Blocks are 64-byte aligned and bump-allocated; freeing one is a no-op until
+ * reset() rewinds the whole arena. reset() keeps the region when it is large
+ * enough, and the region of a destroyed arena is recycled by the next one, so
+ * back-to-back regenerations do not return memory to the OS and fault it in
+ * again. On Linux regions are mmap'ed: no page is touched until a GridLayout
+ * fills it, which decides its NUMA node.
+ */
+class GridArena {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    // Settings of arenas created afterwards
+    static void configure(const GridArenaConfig& config);
+
+    GridArena();
+    ~GridArena();
+    GridArena(const GridArena&) = delete;
+    GridArena& operator=(const GridArena&) = delete;
+
+    void* allocate(size_t bytes);            // Grows with another region when full
+    void deallocate(void* p);
+    // Returns the whole pages inside [p, p + bytes) to the OS; they read as
+    // zeros when touched again. For blocks that will not be written soon.
+    void discard(void* p, size_t bytes);
+    // discard() for everything past the last block
+    void trim();
+    // Starts over with at least `bytes` in a single region. Returns false (and
+    // keeps allocating after the live blocks) while blocks are still in use.
+    bool reset(size_t bytes);
+
+    size_t capacity() const;                 // Bytes reserved
+    size_t used() const;                     // Bytes handed out since the last reset
+    size_t regionCount() const;
+    bool hugePages() const { return hugePages_; }
+
+    static size_t roundUp(size_t bytes) { return (bytes + kAlignment - 1) & ~(kAlignment - 1); }
+
+private:
+    struct Region {
+        uint8_t* base = nullptr;
+        size_t size = 0;
+        bool mapped = false;
+        bool huge = false;
+    };
+
+    static std::vector<Region>& pool(); // Regions of destroyed arenas
+    static Region acquireRegion(size_t bytes, bool huge);
+    static void recycleRegion(Region region);
+    static void freeRegion(const Region& region);
+    size_t totalSize() const; // Caller holds mutex_
+
+    mutable std::mutex mutex_;
+    std::vector<Region> regions_;
+    size_t offset_ = 0;   // Into regions_.back()
+    size_t used_ = 0;
+    size_t live_ = 0;     // Blocks not deallocated yet
+    bool hugePages_ = false;
+};
+
+/**
+ * @brief Aligned allocator drawing from a GridArena (or the heap without one).
+ *
+ * Value-less construction leaves trivial elements uninitialised so resize()
+ * does not touch the pages; GridLayout fills them in parallel instead. Copies
+ * of a container go to the heap: a snapshot must not pin its world's arena.
+ */
+template <typename T>
+class GridAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    GridAllocator() noexcept = default;
+    explicit GridAllocator(std::shared_ptr<GridArena> arena) noexcept : arena_(std::move(arena)) {}
+    template <typename U>
+    GridAllocator(const GridAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(size_t n) {
+        const size_t bytes = GridArena::roundUp(n * sizeof(T));
+        if (arena_) return static_cast<T*>(arena_->allocate(bytes));
+        return static_cast<T*>(::operator new(bytes, std::align_val_t(GridArena::kAlignment)));
+    }
+    void deallocate(T* p, size_t) noexcept {
+        if (arena_) arena_->deallocate(p);
+        else ::operator delete(p, std::align_val_t(GridArena::kAlignment));
+    }
+
+    template <typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible<U>::value) {
+        ::new (static_cast<void*>(p)) U; // Default-, not value-initialised
+    }
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    GridAllocator select_on_container_copy_construction() const { return GridAllocator(); }
+
+    const std::shared_ptr<GridArena>& arena() const { return arena_; }
+
+    template <typename U>
+    bool operator==(const GridAllocator<U>& other) const { return arena_ == other.arena(); }
+    template <typename U>
+    bool operator!=(const GridAllocator<U>& other) const { return arena_ != other.arena(); }
+
+private:
+    std::shared_ptr<GridArena> arena_;
+};
+
+template <typename T>
+using GridVector = std::vector<T, GridAllocator<T>>;
+
+enum class ChannelState {
+    Allocated,
+    Lazy,       // Registered, not written yet
+    Released,   // Freed by its owner (e.g. replaced by a view)
+    Shared      // A view of another channel (reported by the owner)
+};
+
+struct ChannelUsage {
+    std::string name;
+    ChannelState state = ChannelState::Allocated;
+    size_t bytes = 0;      // Held now (0 unless Allocated)
+    size_t reserved = 0;   // Once allocated
+};
+
+/**
+ * @brief Sizes a set of named channels and writes their initial values.
+ *
+ * apply() frees every listed channel, rewinds the arena to their total size,
+ * reallocates them uninitialised and fills the per-cell ones in row bands on
+ * the job system, chunked like the simulation kernels (grain 0), so each page
+ * is first touched by a worker that later processes those rows.
+ *
+ * v4.7.0: Lazy channels are registered with their default but left empty by
+ * apply(); their space is reserved in the region (untouched pages cost no
+ * memory) and materialize() allocates and fills them on first write. A layout
+ * kept by its owner is the registry of its channels: usage() reports them.
+ */
+class GridLayout {
+public:
+    GridLayout(int width, int height, std::shared_ptr<GridArena> arena = nullptr);
+    GridLayout(const GridLayout&) = delete;
+    GridLayout& operator=(const GridLayout&) = delete;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    size_t cells() const { return static_cast<size_t>(width_) * static_cast<size_t>(height_); }
+
+    // One value per cell
+    template <typename T>
+    void add(const std::string& name, GridVector<T>& channel, typename GridVector<T>::value_type value) {
+        addEntry(name, channel, value, cells(), true, false);
+    }
+    // Any other length (e.g. per tile); filled serially
+    template <typename T>
+    void add(const std::string& name, GridVector<T>& channel, typename GridVector<T>::value_type value, size_t count) {
+        addEntry(name, channel, value, count, false, false);
+    }
+    // One value per cell, allocated by materialize()
+    template <typename T>
+    void addLazy(const std::string& name, GridVector<T>& channel, typename GridVector<T>::value_type value) {
+        addEntry(name, channel, value, cells(), true, true);
+    }
+
+    // v4.7.0: One value per cell in the channel's precision (PackedChannel::precisionFor)
+    void add(const std::string& name, PackedChannel& channel, float value);
+
+    void apply();
+
+    // Allocates and fills a registered channel that is not allocated (lazy or
+    // released); no-op otherwise. Safe from several threads, but must not race
+    // with readers of the same channel. False if `channel` is not registered.
+    template <typename T>
+    bool materialize(GridVector<T>& channel) { return materializeEntry(find(&channel)); }
+    bool materialize(const std::string& name) { return materializeEntry(find(name)); }
+    // Frees a channel and discards its pages; its arena space comes back on the next apply()
+    template <typename T>
+    bool release(GridVector<T>& channel) { return releaseEntry(find(&channel)); }
+    bool release(const std::string& name) { return releaseEntry(find(name)); }
+
+    bool contains(const std::string& name) const { return find(name) != nullptr; }
+    bool isLazy(const std::string& name) const;
+    bool isAllocated(const std::string& name) const;
+    std::vector<ChannelUsage> usage() const; // In registration order
+
+private:
+    struct Entry {
+        std::string name;
+        const void* channel = nullptr;
+        size_t count = 0;
+        size_t bytes = 0;
+        bool perCell = false;
+        bool lazy = false;
+        bool allocated = false;   // Guarded by mutex_ after apply()
+        std::function<void(bool)> release; // true: discard the pages first
+        std::function<void()> allocate;
+        std::function<void(size_t, size_t)> fill;
+    };
+
+    template <typename T>
+    void addEntry(const std::string& name, GridVector<T>& channel, T value, size_t count, bool perCell, bool lazy) {
+        Entry e;
+        e.name = name;
+        e.channel = &channel;
+        e.count = count;
+        e.bytes = GridArena::roundUp(count * sizeof(T));
+        e.perCell = perCell;
+        e.lazy = lazy;
+        e.release = [&channel](bool discard) {
+            GridArena* arena = channel.get_allocator().arena().get();
+            if (discard && arena && !channel.empty()) arena->discard(channel.data(), channel.capacity() * sizeof(T));
+            channel = GridVector<T>();
+        };
+        e.allocate = [this, &channel, count]() {
+            channel = GridVector<T>(GridAllocator<T>(arena_));
+            channel.resize(count);
+        };
+        e.fill = [&channel, value](size_t begin, size_t end) {
+            T* data = channel.data();
+            for (size_t i = begin; i < end; ++i) data[i] = value;
+        };
+        entries_.push_back(std::move(e));
+    }
+
+    Entry* find(const void* channel);
+    Entry* find(const std::string& name);
+    const Entry* find(const std::string& name) const;
+    bool materializeEntry(Entry* e);
+    bool releaseEntry(Entry* e);
+    void fill(const std::vector<const Entry*>& entries) const; // Per-cell ones in row bands
+
+    int width_;
+    int height_;
+    std::shared_ptr<GridArena> arena_;
+    std::vector<Entry> entries_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace core
@@ -0,0 +1,370 @@
+#include "job_system.h"
+#include <chrono>
+#include <iostream>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace core {
+
+namespace {
+
+enum JobState { kWaiting = 0, kQueued = 1, kRunning = 2 };
+
+// Bound of every sleep: a missed notification costs at most this much
+constexpr std::chrono::milliseconds kMaxSleep(5);
+
+thread_local const JobSystem* tlsPool = nullptr;
+thread_local int tlsWorker = -1;
+thread_local int tlsThreadLimit = 0; // 0 = no limit
+
+std::mutex gInstanceMutex;
+JobSystemConfig gInstanceConfig;
+bool gInstanceCreated = false;
+
+} // namespace
+
+struct JobSystem::Job {
+    JobSystem* system = nullptr;
+    std::function<void()> task;
+    JobOptions options;
+    std::atomic<int> pending{1};          // Unfinished dependencies + the submission itself
+    std::atomic<int> state{kWaiting};     // Waiting -> Queued -> Running (claimed once)
+    std::atomic<bool> done{false};
+
+    std::mutex mutex;                     // Guards the fields below
+    bool finished = false;
+    std::exception_ptr error;
+    std::exception_ptr inherited;         // First failed dependency
+    std::vector<std::shared_ptr<Job>> successors;
+};
+
+// --- Handle ---
+
+bool JobSystem::Handle::done() const {
+    return !job_ || job_->done.load(std::memory_order_acquire);
+}
+
+void JobSystem::Handle::wait() const {
+    if (job_) job_->system->wait(job_);
+}
+
+void JobSystem::Handle::get() const {
+    if (!job_) return;
+    wait();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(job_->mutex);
+        error = job_->error;
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+JobSystem::ThreadLimit::ThreadLimit(int threads) : previous_(tlsThreadLimit) {
+    tlsThreadLimit = std::max(1, threads);
+}
+
+JobSystem::ThreadLimit::~ThreadLimit() {
+    tlsThreadLimit = previous_;
+}
+
+// --- JobSystem ---
+
+JobSystem& JobSystem::instance() {
+    static JobSystem* pool = []() {
+        std::lock_guard<std::mutex> lock(gInstanceMutex);
+        gInstanceCreated = true;
+        return new JobSystem(gInstanceConfig); // Outlives static destructors that may still submit
+    }();
+    return *pool;
+}
+
+bool JobSystem::configure(const JobSystemConfig& config) {
+    std::lock_guard<std::mutex> lock(gInstanceMutex);
+    if (gInstanceCreated) return false;
+    gInstanceConfig = config;
+    return true;
+}
+
+JobSystem::JobSystem(const JobSystemConfig& config) {
+    int count = config.workers;
+    if (count <= 0) count = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    count = std::max(count, 1);
+
+    for (int i = 0; i < count; ++i) workers_.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < count; ++i) {
+        workers_[static_cast<size_t>(i)]->thread = std::thread(&JobSystem::workerLoop, this, i);
+#ifdef __linux__
+        if (config.pinWorkers) {
+            const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(static_cast<unsigned>(i + 1) % cores, &set);
+            pthread_setaffinity_np(workers_[static_cast<size_t>(i)]->thread.native_handle(), sizeof(set), &set);
+        }
+#endif
+    }
+    std::cout << "[JobSystem] " << count << " workers" << (config.pinWorkers ? " (pinned)" : "") << std::endl;
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+int JobSystem::currentWorker() const {
+    return tlsPool == this ? tlsWorker : -1;
+}
+
+int JobSystem::chunkSize(int begin, int end, int grain) const {
+    if (grain > 0) return grain;
+    return std::max(1, (end - begin) / (threadCount() * 4));
+}
+
+JobSystem::Handle JobSystem::submit(std::function<void()> task, const std::vector<Handle>& dependsOn, const JobOptions& options) {
+    auto job = std::make_shared<Job>();
+    job->system = this;
+    job->task = std::move(task);
+    job->options = options;
+    if (job->options.affinity >= workerCount()) job->options.affinity = -1;
+    job->pending.store(1 + static_cast<int>(dependsOn.size()));
+
+    for (const Handle& dep : dependsOn) {
+        bool resolved = true;
+        std::exception_ptr error;
+        if (dep.job_) {
+            std::lock_guard<std::mutex> lock(dep.job_->mutex);
+            if (!dep.job_->finished) {
+                dep.job_->successors.push_back(job);
+                resolved = false;
+            } else {
+                error = dep.job_->error;
+            }
+        }
+        if (resolved) {
+            if (error) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                if (!job->inherited) job->inherited = error;
+            }
+            release(job);
+        }
+    }
+    release(job);
+    return Handle(job);
+}
+
+void JobSystem::release(const std::shared_ptr<Job>& job) {
+    if (job->pending.fetch_sub(1) != 1) return;
+    std::exception_ptr inherited;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        inherited = job->inherited;
+    }
+    if (inherited) {
+        finish(*job, inherited); // Skipped: an upstream job failed
+    } else {
+        enqueue(job);
+    }
+}
+
+void JobSystem::enqueue(const std::shared_ptr<Job>& job) {
+    job->state.store(kQueued);
+    const int self = currentWorker();
+    if (job->options.affinity >= 0) {
+        Worker& worker = *workers_[static_cast<size_t>(job->options.affinity)];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.pinned.push_back(job);
+    } else if (job->options.background) {
+        std::lock_guard<std::mutex> lock(sharedMutex_);
+        background_.push_back(job);
+    } else if (self >= 0) {
+        Worker& worker = *workers_[static_cast<size_t>(self)];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.jobs.push_back(job);
+    } else {
+        std::lock_guard<std::mutex> lock(sharedMutex_);
+        shared_.push_back(job);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        ++epoch_;
+    }
+    // Pinned work needs its own worker awake; waiters may help with the rest
+    if (job->options.affinity >= 0) wake_.notify_all();
+    else wake_.notify_one();
+    finished_.notify_all();
+}
+
+std::shared_ptr<JobSystem::Job> JobSystem::take(int self, bool allowBackground) {
+    auto claim = [](std::deque<std::shared_ptr<Job>>& queue, bool back) -> std::shared_ptr<Job> {
+        while (!queue.empty()) {
+            std::shared_ptr<Job> job;
+            if (back) {
+                job = std::move(queue.back());
+                queue.pop_back();
+            } else {
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            // A waiter may have run it directly already
+            int expected = kQueued;
+            if (job->state.compare_exchange_strong(expected, kRunning)) return job;
+        }
+        return nullptr;
+    };
+
+    if (self >= 0) {
+        Worker& own = *workers_[static_cast<size_t>(self)];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (auto job = claim(own.pinned, false)) return job;
+        if (auto job = claim(own.jobs, true)) return job; // Newest first: still warm in cache
+    }
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex_);
+        if (auto job = claim(shared_, false)) return job;
+    }
+    // Worker queues hold jobs submitted by pool jobs (regeneration stages, their chunks): a
+    // thread off the pool waiting on its own work must not end up running one of those
+    if (self < 0) return nullptr;
+    // Steal the oldest job of another worker, starting at a random victim
+    const int n = workerCount();
+    const int start = static_cast<int>(stealSeed_.fetch_add(1) % static_cast<unsigned>(n));
+    for (int k = 0; k < n; ++k) {
+        const int victim = (start + k) % n;
+        if (victim == self) continue;
+        Worker& worker = *workers_[static_cast<size_t>(victim)];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (auto job = claim(worker.jobs, false)) return job;
+    }
+    if (allowBackground) {
+        std::lock_guard<std::mutex> lock(sharedMutex_);
+        if (auto job = claim(background_, false)) return job;
+    }
+    return nullptr;
+}
+
+bool JobSystem::runOne(int self, bool allowBackground) {
+    std::shared_ptr<Job> job = take(self, allowBackground);
+    if (!job) return false;
+    execute(job);
+    return true;
+}
+
+void JobSystem::execute(const std::shared_ptr<Job>& job) {
+    std::exception_ptr error;
+    try {
+        job->task();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    job->task = nullptr; // Release captures before dependents run
+    finish(*job, error);
+}
+
+void JobSystem::finish(Job& job, std::exception_ptr error) {
+    std::vector<std::shared_ptr<Job>> successors;
+    {
+        std::lock_guard<std::mutex> lock(job.mutex);
+        job.error = error;
+        job.finished = true;
+        successors.swap(job.successors);
+    }
+    job.done.store(true, std::memory_order_release);
+
+    for (const auto& next : successors) {
+        if (error) {
+            std::lock_guard<std::mutex> lock(next->mutex);
+            if (!next->inherited) next->inherited = error;
+        }
+        release(next);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    finished_.notify_all();
+}
+
+void JobSystem::wait(const std::shared_ptr<Job>& job) {
+    const int self = currentWorker();
+    while (!job->done.load(std::memory_order_acquire)) {
+        // Nobody picked it up yet: run it here (unless it is pinned elsewhere)
+        int expected = kQueued;
+        if ((job->options.affinity < 0 || job->options.affinity == self) &&
+            job->state.compare_exchange_strong(expected, kRunning)) {
+            execute(job);
+            continue;
+        }
+        unsigned long long seen;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            seen = epoch_;
+        }
+        if (runOne(self, false)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        finished_.wait_for(lock, kMaxSleep, [&]() {
+            return job->done.load(std::memory_order_acquire) || epoch_ != seen;
+        });
+    }
+}
+
+void JobSystem::workerLoop(int index) {
+    tlsPool = this;
+    tlsWorker = index;
+    for (;;) {
+        unsigned long long seen;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            seen = epoch_;
+        }
+        if (runOne(index, true)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        if (stopping_) return; // Nothing left this worker could take
+        wake_.wait_for(lock, kMaxSleep, [&]() { return stopping_ || epoch_ != seen; });
+    }
+}
+
+void JobSystem::parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body) {
+    if (end <= begin) return;
+    const int g = chunkSize(begin, end, grain);
+    const int chunks = (end - begin + g - 1) / g;
+    int helpers = std::min(chunks - 1, workerCount());
+    if (tlsThreadLimit > 0) helpers = std::min(helpers, tlsThreadLimit - 1);
+    if (helpers == 0) {
+        for (int c = 0; c < chunks; ++c) body(begin + c * g, std::min(end, begin + (c + 1) * g));
+        return;
+    }
+
+    std::atomic<int> next{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto drain = [&]() {
+        for (;;) {
+            const int c = next.fetch_add(1);
+            if (c >= chunks) return;
+            try {
+                body(begin + c * g, std::min(end, begin + (c + 1) * g));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+                next.store(chunks); // Skip the remaining chunks
+            }
+        }
+    };
+
+    // Helpers claim chunks dynamically; one that starts late finds none left
+    std::vector<Handle> pending;
+    pending.reserve(static_cast<size_t>(helpers));
+    for (int i = 0; i < helpers; ++i) pending.push_back(submit(drain));
+    drain();
+    for (const Handle& h : pending) h.wait();
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace core
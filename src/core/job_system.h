@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace core {
+
+struct JobSystemConfig {
+    int workers = 0;          // 0 = hardware threads - 1 (a waiting thread helps), at least 1
+    bool pinWorkers = false;  // Bind worker i to core i + 1 (Linux); core 0 stays with the main thread
+};
+
+struct JobOptions {
+    int affinity = -1;        // Worker that must run the job (-1 = any)
+    bool background = false;  // Long job (regeneration, training): never picked up by a waiting thread
+
+    static JobOptions longRunning() {
+        JobOptions options;
+        options.background = true;
+        return options;
+    }
+};
+
+/**
+ * @brief v4.7.0: One pool for every CPU-heavy path (simulation kernels,
+ * regeneration stages, ML training, reports).
+ *
+ * Each worker owns a deque: it pushes and pops its own jobs at the back,
+ * idle workers steal from the front of the others. Jobs submitted from other
+ * threads go to a shared queue. A job starts once all the jobs it depends on
+ * finished; if one of them failed it fails with the same exception without
+ * running.
+ *
+ * A thread waiting on a job runs queued jobs meanwhile (including the awaited
+ * one if nobody claimed it yet), so jobs may wait on jobs and nested
+ * parallelFor calls never deadlock. Background jobs are only taken by idle
+ * workers, so a short wait is never stuck behind a whole regeneration. Threads
+ * off the pool only help with the shared queue: the render or simulation
+ * thread never picks up a job some pool job queued.
+ */
+class JobSystem {
+    struct Job;
+
+public:
+    class Handle {
+    public:
+        Handle() = default;
+        explicit operator bool() const { return job_ != nullptr; }
+        bool done() const;
+        void wait() const;   // Helps with queued work meanwhile
+        void get() const;    // wait() + rethrows the job's exception
+    private:
+        friend class JobSystem;
+        explicit Handle(std::shared_ptr<Job> job) : job_(std::move(job)) {}
+        std::shared_ptr<Job> job_;
+    };
+
+    // Caps the threads of the parallelFor calls made on this thread (the caller
+    // included; 1 = inline) while it lives. E.g. a background encoder that must
+    // leave cores to the simulation, or a thread-count independence test.
+    class ThreadLimit {
+    public:
+        explicit ThreadLimit(int threads);
+        ~ThreadLimit();
+        ThreadLimit(const ThreadLimit&) = delete;
+        ThreadLimit& operator=(const ThreadLimit&) = delete;
+    private:
+        int previous_;
+    };
+
+    // Process-wide pool, created on first use
+    static JobSystem& instance();
+    // Settings of instance(); false once it exists
+    static bool configure(const JobSystemConfig& config);
+
+    explicit JobSystem(const JobSystemConfig& config = {});
+    ~JobSystem(); // Finishes queued jobs
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    Handle submit(std::function<void()> task, const std::vector<Handle>& dependsOn = {}, const JobOptions& options = {});
+
+    // body(begin, end) over [begin, end) in chunks of `grain` items (0 = a few
+    // chunks per thread). The caller runs chunks too; returns when all are done
+    // and rethrows the first exception of a chunk.
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+
+    // Chunk results combined in chunk order, so the result does not depend on scheduling
+    template <typename T, typename Chunk, typename Combine>
+    T parallelReduce(int begin, int end, int grain, T identity, Chunk chunk, Combine combine) {
+        const int g = chunkSize(begin, end, grain);
+        const int chunks = end > begin ? (end - begin + g - 1) / g : 0;
+        std::vector<T> partial(static_cast<size_t>(chunks), identity);
+        parallelFor(0, chunks, 1, [&](int c0, int c1) {
+            for (int c = c0; c < c1; ++c) {
+                partial[static_cast<size_t>(c)] = chunk(begin + c * g, std::min(end, begin + (c + 1) * g));
+            }
+        });
+        T result = identity;
+        for (const T& p : partial) result = combine(result, p);
+        return result;
+    }
+
+    int workerCount() const { return static_cast<int>(workers_.size()); }
+    int threadCount() const { return workerCount() + 1; } // Workers + the waiting caller
+
+    // Index of the calling worker in this pool, -1 on any other thread
+    int currentWorker() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Job>> jobs;    // Stealable
+        std::deque<std::shared_ptr<Job>> pinned;  // affinity == this worker
+        std::thread thread;
+    };
+
+    int chunkSize(int begin, int end, int grain) const;
+    void release(const std::shared_ptr<Job>& job); // One dependency (or the submission) resolved
+    void enqueue(const std::shared_ptr<Job>& job);
+    std::shared_ptr<Job> take(int self, bool allowBackground);
+    bool runOne(int self, bool allowBackground);
+    void execute(const std::shared_ptr<Job>& job);
+    void finish(Job& job, std::exception_ptr error);
+    void wait(const std::shared_ptr<Job>& job);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex sharedMutex_;
+    std::deque<std::shared_ptr<Job>> shared_;      // Submitted off the pool
+    std::deque<std::shared_ptr<Job>> background_;
+
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;                 // Workers: new work / stop
+    std::condition_variable finished_;             // Waiters: some job finished
+    unsigned long long epoch_ = 0;                 // Bumped per enqueue; guarded by sleepMutex_
+    std::atomic<unsigned> stealSeed_{0};
+    bool stopping_ = false;
+};
+
+} // namespace core
@@ -0,0 +1,85 @@
+#include "packed_channel.h"
+#include <cstring>
+#include <mutex>
+
+namespace core {
+
+namespace {
+
+std::mutex gConfigMutex;
+PrecisionConfig gConfig;
+
+} // namespace
+
+const char* precisionName(ChannelPrecision precision) {
+    switch (precision) {
+        case ChannelPrecision::Float16: return "float16";
+        case ChannelPrecision::Unorm16: return "unorm16";
+        default: return "float32";
+    }
+}
+
+size_t precisionBytes(ChannelPrecision precision) {
+    return precision == ChannelPrecision::Float32 ? sizeof(float) : sizeof(uint16_t);
+}
+
+void PackedChannel::configure(const PrecisionConfig& config) {
+    std::lock_guard<std::mutex> lock(gConfigMutex);
+    gConfig = config;
+}
+
+PrecisionConfig PackedChannel::configuration() {
+    std::lock_guard<std::mutex> lock(gConfigMutex);
+    return gConfig;
+}
+
+ChannelPrecision PackedChannel::precisionFor(const std::string& name, ChannelPrecision fallback) {
+    std::lock_guard<std::mutex> lock(gConfigMutex);
+    if (gConfig.forceFloat32) return ChannelPrecision::Float32;
+    auto it = gConfig.channels.find(name);
+    return it != gConfig.channels.end() ? it->second : fallback;
+}
+
+uint16_t PackedChannel::encode16(ChannelPrecision precision, float value) {
+    return precision == ChannelPrecision::Float16 ? math::floatToHalf(value) : math::floatToUnorm16(value);
+}
+
+void PackedChannel::decode(ChannelPrecision precision, const void* src, size_t count, float* out) {
+    switch (precision) {
+        case ChannelPrecision::Float16: math::halfsToFloat(static_cast<const uint16_t*>(src), count, out); break;
+        case ChannelPrecision::Unorm16: math::unorm16sToFloat(static_cast<const uint16_t*>(src), count, out); break;
+        default: std::memcpy(out, src, count * sizeof(float)); break;
+    }
+}
+
+void PackedChannel::encode(ChannelPrecision precision, const float* values, size_t count, void* dst) {
+    switch (precision) {
+        case ChannelPrecision::Float16: math::floatsToHalf(values, count, static_cast<uint16_t*>(dst)); break;
+        case ChannelPrecision::Unorm16: math::floatsToUnorm16(values, count, static_cast<uint16_t*>(dst)); break;
+        default: std::memcpy(dst, values, count * sizeof(float)); break;
+    }
+}
+
+void PackedChannel::load(size_t begin, size_t count, float* out) const {
+    decode(precision_, static_cast<const uint8_t*>(data()) + begin * elementSize(), count, out);
+}
+
+void PackedChannel::store(size_t begin, size_t count, const float* values) {
+    encode(precision_, values, count, static_cast<uint8_t*>(data()) + begin * elementSize());
+}
+
+void PackedChannel::copyFrom(const PackedChannel& other, size_t begin, size_t count) {
+    const size_t bytes = elementSize();
+    std::memcpy(static_cast<uint8_t*>(data()) + begin * bytes,
+                static_cast<const uint8_t*>(other.data()) + begin * bytes, count * bytes);
+}
+
+const void* PackedChannel::data() const {
+    return precision_ == ChannelPrecision::Float32 ? static_cast<const void*>(f32_.data()) : u16_.data();
+}
+
+void* PackedChannel::data() {
+    return precision_ == ChannelPrecision::Float32 ? static_cast<void*>(f32_.data()) : u16_.data();
+}
+
+} // namespace core
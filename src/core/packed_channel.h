@@ -0,0 +1,131 @@
+#pragma once
+
+#include "grid_arena.h"
+#include "../math/half.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace core {
+
+// Storage format of a PackedChannel
+enum class ChannelPrecision : uint8_t {
+    Float32,
+    Float16,   // IEEE half: relative precision 2^-11
+    Unorm16    // [0, 1] in 65535 steps; values outside are clamped
+};
+
+const char* precisionName(ChannelPrecision precision);
+size_t precisionBytes(ChannelPrecision precision);
+
+struct PrecisionConfig {
+    std::map<std::string, ChannelPrecision> channels; // By layout name ("veg.ei_vigor"); others keep their default
+    bool forceFloat32 = false;                        // Reference runs: every packed channel stores float32
+};
+
+/**
+ * @brief v4.7.0: A per-cell float grid stored as float32, half or unorm16.
+ *
+ * For slowly varying bounded fields (fractions, coverage, vigor) 16 bits are
+ * plenty and halve the memory and bandwidth of the kernels that stream them.
+ * Each channel declares a default precision; PrecisionConfig (read when a
+ * GridLayout registers the channel, i.e. when a world is sized) may override
+ * it by name.
+ *
+ * Values are always seen as floats: operator[] converts one cell, load()/store()
+ * convert a run of cells with the batch (SIMD) conversions, which is what the
+ * kernels use on their row buffers.
+ */
+class PackedChannel {
+public:
+    using value_type = float;
+
+    // Writable cell (converts on every read and write)
+    class Ref {
+    public:
+        Ref(PackedChannel& channel, size_t index) : channel_(channel), index_(index) {}
+        operator float() const { return channel_.get(index_); }
+        Ref& operator=(float value) { channel_.set(index_, value); return *this; }
+        Ref& operator=(const Ref& other) { return *this = static_cast<float>(other); }
+        Ref& operator+=(float value) { return *this = static_cast<float>(*this) + value; }
+        Ref& operator-=(float value) { return *this = static_cast<float>(*this) - value; }
+        Ref& operator*=(float value) { return *this = static_cast<float>(*this) * value; }
+
+    private:
+        PackedChannel& channel_;
+        size_t index_;
+    };
+
+    // Overrides of channels registered afterwards
+    static void configure(const PrecisionConfig& config);
+    static PrecisionConfig configuration();
+    static ChannelPrecision precisionFor(const std::string& name, ChannelPrecision fallback);
+
+    PackedChannel() = default;
+    explicit PackedChannel(ChannelPrecision preferred) : preferred_(preferred), precision_(preferred) {}
+
+    ChannelPrecision precision() const { return precision_; }
+    ChannelPrecision preferredPrecision() const { return preferred_; }
+
+    size_t size() const { return precision_ == ChannelPrecision::Float32 ? f32_.size() : u16_.size(); }
+    bool empty() const { return size() == 0; }
+    size_t elementSize() const { return precisionBytes(precision_); }
+    size_t bytes() const { return size() * elementSize(); }
+
+    float get(size_t i) const {
+        switch (precision_) {
+            case ChannelPrecision::Float16: return math::halfToFloat(u16_[i]);
+            case ChannelPrecision::Unorm16: return math::unorm16ToFloat(u16_[i]);
+            default: return f32_[i];
+        }
+    }
+    void set(size_t i, float value) {
+        switch (precision_) {
+            case ChannelPrecision::Float16: u16_[i] = math::floatToHalf(value); break;
+            case ChannelPrecision::Unorm16: u16_[i] = math::floatToUnorm16(value); break;
+            default: f32_[i] = value; break;
+        }
+    }
+    // Nearest value the channel can hold
+    float round(float value) const {
+        switch (precision_) {
+            case ChannelPrecision::Float16: return math::halfToFloat(math::floatToHalf(value));
+            case ChannelPrecision::Unorm16: return math::unorm16ToFloat(math::floatToUnorm16(value));
+            default: return value;
+        }
+    }
+    float operator[](size_t i) const { return get(i); }
+    Ref operator[](size_t i) { return Ref(*this, i); }
+
+    // Cells [begin, begin + count) to / from floats
+    void load(size_t begin, size_t count, float* out) const;
+    void store(size_t begin, size_t count, const float* values);
+    // Raw copy from a channel of the same precision and size
+    void copyFrom(const PackedChannel& other, size_t begin, size_t count);
+
+    // Stored elements (elementSize() bytes each)
+    const void* data() const;
+    void* data();
+
+    // Encoded value of `value` in a 16-bit precision
+    static uint16_t encode16(ChannelPrecision precision, float value);
+    // Batch conversions between floats and elements stored in `precision`
+    static void decode(ChannelPrecision precision, const void* src, size_t count, float* out);
+    static void encode(ChannelPrecision precision, const float* values, size_t count, void* dst);
+
+    bool operator==(const PackedChannel& other) const {
+        return precision_ == other.precision_ && f32_ == other.f32_ && u16_ == other.u16_;
+    }
+    bool operator!=(const PackedChannel& other) const { return !(*this == other); }
+
+private:
+    friend class GridLayout;
+
+    ChannelPrecision preferred_ = ChannelPrecision::Float32;
+    ChannelPrecision precision_ = ChannelPrecision::Float32;
+    GridVector<float> f32_;
+    GridVector<uint16_t> u16_;
+};
+
+} // namespace core
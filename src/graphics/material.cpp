@@ -10,9 +10,10 @@ Material::Material(const core::GraphicsContext& context, VkRenderPass renderPass
                    std::shared_ptr<Shader> vertShader, std::shared_ptr<Shader> fragShader,
                    VkPrimitiveTopology topology, VkPolygonMode polygonMode,
                    bool enableBlend, bool depthWrite,
-                   VkDescriptorSetLayout descriptorLayout)
+                   VkDescriptorSetLayout descriptorLayout,
+                   const VertexInputLayout* vertexInput)
     : device_(context.device()), vertShader_(vertShader), fragShader_(fragShader) {
-    createPipeline(renderPass, extent, topology, polygonMode, enableBlend, depthWrite, descriptorLayout);
+    createPipeline(renderPass, extent, topology, polygonMode, enableBlend, depthWrite, descriptorLayout, vertexInput);
 }
 
 Material::~Material() {
@@ -48,7 +49,7 @@ void Material::bind(VkCommandBuffer cmd) const {
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
 }
 
-void Material::createPipeline(VkRenderPass renderPass, VkExtent2D extent, VkPrimitiveTopology topology, VkPolygonMode polygonMode, bool enableBlend, bool depthWrite, VkDescriptorSetLayout descriptorLayout) {
+void Material::createPipeline(VkRenderPass renderPass, VkExtent2D extent, VkPrimitiveTopology topology, VkPolygonMode polygonMode, bool enableBlend, bool depthWrite, VkDescriptorSetLayout descriptorLayout, const VertexInputLayout* vertexInput) {
     // ... (previous logic same until PipelineLayout) ...
 
     // 9. Pipeline Layout (Push Consts + DescriptorSet)
@@ -94,10 +95,18 @@ void Material::createPipeline(VkRenderPass renderPass, VkExtent2D extent, VkPrim
 
     VkPipelineVertexInputStateCreateInfo vi{};
     vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vi.vertexBindingDescriptionCount = 1;
-    vi.pVertexBindingDescriptions = &binding;
-    vi.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrs.size());
-    vi.pVertexAttributeDescriptions = attrs.data();
+    if (vertexInput) {
+        // v4.7.0: Custom layout (e.g. split terrain streams)
+        vi.vertexBindingDescriptionCount = static_cast<uint32_t>(vertexInput->bindings.size());
+        vi.pVertexBindingDescriptions = vertexInput->bindings.data();
+        vi.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInput->attributes.size());
+        vi.pVertexAttributeDescriptions = vertexInput->attributes.data();
+    } else {
+        vi.vertexBindingDescriptionCount = 1;
+        vi.pVertexBindingDescriptions = &binding;
+        vi.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrs.size());
+        vi.pVertexAttributeDescriptions = attrs.data();
+    }
 
     // 3. Input Assembly
     VkPipelineInputAssemblyStateCreateInfo ia{};
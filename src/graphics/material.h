@@ -8,6 +8,15 @@
 
 namespace graphics {
 
+/**
+ * @brief Vertex input state for a pipeline (bindings + attributes).
+ * When not provided, Material uses the interleaved graphics::Vertex layout.
+ */
+struct VertexInputLayout {
+    std::vector<VkVertexInputBindingDescription> bindings;
+    std::vector<VkVertexInputAttributeDescription> attributes;
+};
+
 /**
  * @brief Encapsulates a Vulkan graphics pipeline and its layout.
  * 
@@ -28,6 +37,7 @@ public:
      * @param extent Swapchain extent for viewport/scissor
      * @param vertShader Vertex shader module
      * @param fragShader Fragment shader module
+     * @param vertexInput Optional custom vertex input (defaults to graphics::Vertex)
      */
     Material(const core::GraphicsContext& context, VkRenderPass renderPass, VkExtent2D extent, 
              std::shared_ptr<Shader> vertShader, std::shared_ptr<Shader> fragShader,
@@ -35,7 +45,8 @@ public:
              VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL,
              bool enableBlend = false,
              bool depthWrite = true,
-             VkDescriptorSetLayout descriptorLayout = VK_NULL_HANDLE);
+             VkDescriptorSetLayout descriptorLayout = VK_NULL_HANDLE,
+             const VertexInputLayout* vertexInput = nullptr);
     ~Material();
 
     // No copy
@@ -51,7 +62,7 @@ public:
     VkPipeline pipeline() const { return pipeline_; }
 
 private:
-    void createPipeline(VkRenderPass renderPass, VkExtent2D extent, VkPrimitiveTopology topology, VkPolygonMode polygonMode, bool enableBlend, bool depthWrite, VkDescriptorSetLayout descriptorLayout);
+    void createPipeline(VkRenderPass renderPass, VkExtent2D extent, VkPrimitiveTopology topology, VkPolygonMode polygonMode, bool enableBlend, bool depthWrite, VkDescriptorSetLayout descriptorLayout, const VertexInputLayout* vertexInput);
 
     VkDevice device_;
     std::shared_ptr<Shader> vertShader_;
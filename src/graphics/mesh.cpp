@@ -1,6 +1,7 @@
 #include "mesh.h"
 #include <iostream>
 #include "../core/command_pool.h"
+#include <algorithm>
 
 namespace graphics {
 
@@ -50,23 +51,37 @@ std::array<VkVertexInputAttributeDescription, 6> Vertex::getAttributeDescription
 
 
 Mesh::Mesh(const core::GraphicsContext& context, const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices)
-    : indexCount_(static_cast<uint32_t>(indices.size())), indexType_(VK_INDEX_TYPE_UINT16) {
+    : vertexCount_(static_cast<uint32_t>(vertices.size())), indexCount_(static_cast<uint32_t>(indices.size())), indexType_(VK_INDEX_TYPE_UINT16) {
     
     VkDeviceSize vertexSize = sizeof(Vertex) * vertices.size();
-    vertexBuffer_ = createDeviceLocalBuffer(context, vertices.data(), vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    vertexBuffers_.push_back(createVertexBuffer(context, vertices.data(), vertexSize));
 
     VkDeviceSize indexSize = sizeof(uint16_t) * indices.size();
     indexBuffer_ = createDeviceLocalBuffer(context, indices.data(), indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
 }
 
 Mesh::Mesh(const core::GraphicsContext& context, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
-    : indexCount_(static_cast<uint32_t>(indices.size())), indexType_(VK_INDEX_TYPE_UINT32) {
+    : vertexCount_(static_cast<uint32_t>(vertices.size())), indexCount_(static_cast<uint32_t>(indices.size())), indexType_(VK_INDEX_TYPE_UINT32) {
 
     VkDeviceSize vertexSize = sizeof(Vertex) * vertices.size();
-    vertexBuffer_ = createDeviceLocalBuffer(context, vertices.data(), vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    vertexBuffers_.push_back(createVertexBuffer(context, vertices.data(), vertexSize));
 
+    indexBuffer_ = createIndexBuffer(context, indices);
+}
+
+Mesh::Mesh(std::vector<std::unique_ptr<resources::Buffer>> vertexStreams, uint32_t vertexCount,
+           std::shared_ptr<resources::Buffer> indexBuffer, uint32_t indexCount, VkIndexType indexType)
+    : vertexBuffers_(std::move(vertexStreams)), indexBuffer_(std::move(indexBuffer)),
+      vertexCount_(vertexCount), indexCount_(indexCount), indexType_(indexType) {
+}
+
+std::shared_ptr<resources::Buffer> Mesh::createIndexBuffer(const core::GraphicsContext& context, const std::vector<uint32_t>& indices) {
     VkDeviceSize indexSize = sizeof(uint32_t) * indices.size();
-    indexBuffer_ = createDeviceLocalBuffer(context, indices.data(), indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    return createDeviceLocalBuffer(context, indices.data(), indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+}
+
+std::unique_ptr<resources::Buffer> Mesh::createVertexBuffer(const core::GraphicsContext& context, const void* data, VkDeviceSize size) {
+    return createDeviceLocalBuffer(context, data, size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
 }
 
 std::unique_ptr<resources::Buffer> Mesh::createDeviceLocalBuffer(
@@ -74,6 +89,21 @@ std::unique_ptr<resources::Buffer> Mesh::createDeviceLocalBuffer(
     const void* data, 
     VkDeviceSize size, 
     VkBufferUsageFlags usage) 
+{
+    auto deviceBuffer = std::make_unique<resources::Buffer>(
+        context, size, 
+        usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+    copyToDeviceBuffer(context, data, size, *deviceBuffer);
+    return deviceBuffer;
+}
+
+void Mesh::copyToDeviceBuffer(
+    const core::GraphicsContext& context,
+    const void* data,
+    VkDeviceSize size,
+    resources::Buffer& dst)
 {
     // 1. Staging Buffer (Host Visible)
     resources::Buffer staging(
@@ -83,14 +113,7 @@ std::unique_ptr<resources::Buffer> Mesh::createDeviceLocalBuffer(
     );
     staging.upload(data, size);
 
-    // 2. Device Buffer (Device Local)
-    auto deviceBuffer = std::make_unique<resources::Buffer>(
-        context, size, 
-        usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-    );
-
-    // 3. Copy Command
+    // 2. Copy Command
     core::CommandPool pool(context, context.queueFamilyIndex());
     VkCommandBuffer cmd = pool.allocate(1)[0];
 
@@ -103,7 +126,7 @@ std::unique_ptr<resources::Buffer> Mesh::createDeviceLocalBuffer(
     copyRegion.srcOffset = 0;
     copyRegion.dstOffset = 0;
     copyRegion.size = size;
-    vkCmdCopyBuffer(cmd, staging.handle(), deviceBuffer->handle(), 1, &copyRegion);
+    vkCmdCopyBuffer(cmd, staging.handle(), dst.handle(), 1, &copyRegion);
 
     vkEndCommandBuffer(cmd);
 
@@ -114,15 +137,18 @@ std::unique_ptr<resources::Buffer> Mesh::createDeviceLocalBuffer(
 
     vkQueueSubmit(context.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
     vkQueueWaitIdle(context.graphicsQueue());
-
-    return deviceBuffer;
 }
 
 void Mesh::draw(VkCommandBuffer cmd) const {
-    VkBuffer buffers[] = { vertexBuffer_->handle() }; // Fix access to handle()
-    VkDeviceSize offsets[] = { 0 };
+    // v4.7.0: Bind every stream (binding i <- stream i)
+    VkBuffer buffers[4];
+    VkDeviceSize offsets[4] = { 0, 0, 0, 0 };
+    uint32_t streamCount = static_cast<uint32_t>(std::min<size_t>(vertexBuffers_.size(), 4));
+    for (uint32_t i = 0; i < streamCount; ++i) {
+        buffers[i] = vertexBuffers_[i]->handle();
+    }
     
-    vkCmdBindVertexBuffers(cmd, 0, 1, buffers, offsets);
+    vkCmdBindVertexBuffers(cmd, 0, streamCount, buffers, offsets);
     vkCmdBindIndexBuffer(cmd, indexBuffer_->handle(), 0, indexType_);
     
     vkCmdDrawIndexed(cmd, indexCount_, 1, 0, 0, 0);
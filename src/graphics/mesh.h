@@ -42,6 +42,27 @@ public:
      */
     Mesh(const core::GraphicsContext& context, const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices);
     Mesh(const core::GraphicsContext& context, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices); // u32 overload
+
+    /**
+     * @brief Creates a mesh from pre-uploaded vertex streams and a (possibly shared) index buffer.
+     * Stream i is bound to vertex binding i.
+     * @param indexBuffer Device-local index buffer (see createIndexBuffer)
+     * @param indexCount Number of indices in indexBuffer
+     */
+    Mesh(std::vector<std::unique_ptr<resources::Buffer>> vertexStreams, uint32_t vertexCount,
+         std::shared_ptr<resources::Buffer> indexBuffer, uint32_t indexCount,
+         VkIndexType indexType = VK_INDEX_TYPE_UINT32);
+
+    /**
+     * @brief Uploads a device-local u32 index buffer that several meshes may share.
+     */
+    static std::shared_ptr<resources::Buffer> createIndexBuffer(const core::GraphicsContext& context, const std::vector<uint32_t>& indices);
+
+    /**
+     * @brief Uploads a device-local vertex stream (also usable as a transfer destination
+     * for partial updates).
+     */
+    static std::unique_ptr<resources::Buffer> createVertexBuffer(const core::GraphicsContext& context, const void* data, VkDeviceSize size);
     
     // Non-copyable/moveable for now simplicty
     Mesh(const Mesh&) = delete;
@@ -49,18 +70,29 @@ public:
 
     void draw(VkCommandBuffer cmd) const;
 
+    uint32_t vertexCount() const { return vertexCount_; }
+    uint32_t indexCount() const { return indexCount_; }
+    resources::Buffer& vertexStream(size_t i) { return *vertexBuffers_[i]; }
+
 private:
-    std::unique_ptr<resources::Buffer> vertexBuffer_;
-    std::unique_ptr<resources::Buffer> indexBuffer_;
+    std::vector<std::unique_ptr<resources::Buffer>> vertexBuffers_; // v4.7.0: one per binding
+    std::shared_ptr<resources::Buffer> indexBuffer_; // v4.7.0: shareable between meshes of equal grid size
+    uint32_t vertexCount_ = 0;
     uint32_t indexCount_ = 0;
     VkIndexType indexType_ = VK_INDEX_TYPE_UINT16;
     
     // Helper for Staging Buffer Copy
-    std::unique_ptr<resources::Buffer> createDeviceLocalBuffer(
+    static std::unique_ptr<resources::Buffer> createDeviceLocalBuffer(
         const core::GraphicsContext& context, 
         const void* data, 
         VkDeviceSize size, 
         VkBufferUsageFlags usage);
+
+    static void copyToDeviceBuffer(
+        const core::GraphicsContext& context,
+        const void* data,
+        VkDeviceSize size,
+        resources::Buffer& dst);
 };
 
 } // namespace graphics
@@ -0,0 +1,172 @@
+#include "terrain_vertex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace graphics {
+namespace terrain_vertex {
+
+uint16_t packUnorm16(float v) {
+    float c = std::clamp(v, 0.0f, 1.0f);
+    return static_cast<uint16_t>(std::lround(c * 65535.0f));
+}
+
+float unpackUnorm16(uint16_t v) {
+    return static_cast<float>(v) / 65535.0f;
+}
+
+int16_t packSnorm16(float v) {
+    float c = std::clamp(v, -1.0f, 1.0f);
+    return static_cast<int16_t>(std::lround(c * 32767.0f));
+}
+
+float unpackSnorm16(int16_t v) {
+    // Matches VK_FORMAT_R16G16_SNORM: -32768 and -32767 both map to -1
+    return std::max(static_cast<float>(v) / 32767.0f, -1.0f);
+}
+
+uint8_t packUnorm8(float v) {
+    float c = std::clamp(v, 0.0f, 1.0f);
+    return static_cast<uint8_t>(std::lround(c * 255.0f));
+}
+
+namespace {
+inline float signNotZero(float v) { return v >= 0.0f ? 1.0f : -1.0f; }
+}
+
+void encodeOctNormal(const float n[3], int16_t out[2]) {
+    float l1 = std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]);
+    if (l1 <= 0.0f) {
+        // Degenerate input: treat as straight up (+Y)
+        out[0] = 0;
+        out[1] = 0;
+        return;
+    }
+
+    // Project onto the octahedron with Y as the principal axis (terrain normals
+    // are mostly +Y, which lands in the centre of the map with best precision).
+    float px = n[0] / l1;
+    float pz = n[2] / l1;
+    if (n[1] < 0.0f) {
+        float ox = (1.0f - std::abs(pz)) * signNotZero(px);
+        float oz = (1.0f - std::abs(px)) * signNotZero(pz);
+        px = ox;
+        pz = oz;
+    }
+    out[0] = packSnorm16(px);
+    out[1] = packSnorm16(pz);
+}
+
+void decodeOctNormal(const int16_t in[2], float n[3]) {
+    float x = unpackSnorm16(in[0]);
+    float z = unpackSnorm16(in[1]);
+    float y = 1.0f - std::abs(x) - std::abs(z);
+    if (y < 0.0f) {
+        float ox = (1.0f - std::abs(z)) * signNotZero(x);
+        float oz = (1.0f - std::abs(x)) * signNotZero(z);
+        x = ox;
+        z = oz;
+    }
+    float len = std::sqrt(x * x + y * y + z * z);
+    n[0] = x / len;
+    n[1] = y / len;
+    n[2] = z / len;
+}
+
+uint16_t packFlux(float flux) {
+    // Shader only uses log(flux) for flux > 1; store the log to keep precision
+    // across the whole accumulation range.
+    float l = flux > 1.0f ? std::log(flux) : 0.0f;
+    return packUnorm16(l / kMaxLogFlux);
+}
+
+float unpackFlux(uint16_t v) {
+    return std::exp(unpackUnorm16(v) * kMaxLogFlux);
+}
+
+uint16_t packSediment(float sediment) {
+    return packUnorm16(sediment / kMaxSediment);
+}
+
+float unpackSediment(uint16_t v) {
+    return unpackUnorm16(v) * kMaxSediment;
+}
+
+uint32_t packIds(int basinId, uint8_t soilId) {
+    uint32_t basin = basinId > 0 ? static_cast<uint32_t>(basinId) : 0u;
+    basin = std::min(basin, kMaxBasinId);
+    return (basin << 8) | soilId;
+}
+
+uint32_t unpackBasinId(uint32_t ids) {
+    return ids >> 8;
+}
+
+uint8_t unpackSoilId(uint32_t ids) {
+    return static_cast<uint8_t>(ids & 0xFFu);
+}
+
+TerrainGeometry packGeometry(float height, const float normal[3]) {
+    TerrainGeometry g{};
+    g.height = height;
+    encodeOctNormal(normal, g.normal);
+    return g;
+}
+
+uint16_t packHeight16(float height, float maxHeight) {
+    return maxHeight > 0.0f ? packUnorm16(height / maxHeight) : 0;
+}
+
+float unpackHeight16(uint16_t v, float maxHeight) {
+    return unpackUnorm16(v) * maxHeight;
+}
+
+TerrainGeometry16 packGeometry16(float height, float maxHeight, const float normal[3]) {
+    TerrainGeometry16 g{};
+    g.height = packHeight16(height, maxHeight);
+    encodeOctNormal(normal, g.normal);
+    return g;
+}
+
+TerrainGeometry toGeometry(const TerrainGeometry16& g, float maxHeight) {
+    TerrainGeometry out{};
+    out.height = unpackHeight16(g.height, maxHeight);
+    out.normal[0] = g.normal[0];
+    out.normal[1] = g.normal[1];
+    return out;
+}
+
+TerrainAttributes packAttributes(const float color[4], float flux, float sediment, int basinId, uint8_t soilId) {
+    TerrainAttributes a{};
+    for (int c = 0; c < 4; ++c) {
+        a.color[c] = packUnorm8(color[c]);
+    }
+    a.flux = packFlux(flux);
+    a.sediment = packSediment(sediment);
+    a.ids = packIds(basinId, soilId);
+    return a;
+}
+
+TerrainVertex pack(const TerrainVertexAttributes& a) {
+    TerrainVertex v{};
+    v.geometry = packGeometry(a.height, a.normal);
+    v.attributes = packAttributes(a.color, a.flux, a.sediment,
+                                  static_cast<int>(std::min(a.basinId, kMaxBasinId)), a.soilId);
+    return v;
+}
+
+TerrainVertexAttributes unpack(const TerrainVertex& v) {
+    TerrainVertexAttributes a;
+    a.height = v.geometry.height;
+    decodeOctNormal(v.geometry.normal, a.normal);
+    for (int c = 0; c < 4; ++c) {
+        a.color[c] = static_cast<float>(v.attributes.color[c]) / 255.0f;
+    }
+    a.flux = unpackFlux(v.attributes.flux);
+    a.sediment = unpackSediment(v.attributes.sediment);
+    a.basinId = unpackBasinId(v.attributes.ids);
+    a.soilId = unpackSoilId(v.attributes.ids);
+    return a;
+}
+
+} // namespace terrain_vertex
+} // namespace graphics
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace graphics {
+
+/**
+ * @brief Geometry stream of the compact terrain vertex (8 bytes).
+ * Only changes when heights change (i.e. on regeneration).
+ */
+struct TerrainGeometry {
+    float height;       ///< world-space Y
+    int16_t normal[2];  ///< octahedral-encoded unit normal (snorm16 x2)
+};
+static_assert(sizeof(TerrainGeometry) == 8, "TerrainGeometry must stay tightly packed");
+
+/**
+ * @brief 16-bit height variant of TerrainGeometry (6 bytes).
+ * Height is unorm16 of height / maxHeight (TerrainConfig::maxHeight), so the
+ * vertex shader rescales with one multiply; steps are maxHeight / 65535.
+ */
+struct TerrainGeometry16 {
+    uint16_t height;    ///< height / maxHeight (unorm16)
+    int16_t normal[2];  ///< octahedral-encoded unit normal (snorm16 x2)
+};
+static_assert(sizeof(TerrainGeometry16) == 6, "TerrainGeometry16 must stay tightly packed");
+
+/**
+ * @brief Attribute stream of the compact terrain vertex (12 bytes).
+ * Re-encoded per dirty tile on soil/basin/colour changes.
+ */
+struct TerrainAttributes {
+    uint8_t color[4];   ///< RGBA colour (unorm8 x4)
+    uint16_t flux;      ///< log(flux) / kMaxLogFlux (unorm16)
+    uint16_t sediment;  ///< sediment / kMaxSediment (unorm16)
+    uint32_t ids;       ///< basin ID (bits 8-31) | soil ID (bits 0-7)
+};
+static_assert(sizeof(TerrainAttributes) == 12, "TerrainAttributes must stay tightly packed");
+
+/**
+ * @brief Compact heightfield vertex (20 bytes vs 68 for graphics::Vertex).
+ *
+ * X/Z are implicit in the vertex index (x = i % width, z = i / width) and
+ * are rebuilt in terrain.vert from gl_VertexIndex and the grid scale.
+ * The renderer uploads the two halves as separate vertex streams
+ * (binding 0 = geometry, binding 1 = attributes).
+ *
+ * The packing helpers below are plain C++ (no Vulkan) so they can be
+ * exercised from tests.
+ */
+struct TerrainVertex {
+    TerrainGeometry geometry;
+    TerrainAttributes attributes;
+};
+static_assert(sizeof(TerrainVertex) == 20, "TerrainVertex must stay tightly packed");
+
+/**
+ * @brief Decoded (float) view of a TerrainVertex, used by tests and CPU consumers.
+ */
+struct TerrainVertexAttributes {
+    float height = 0.0f;
+    float normal[3] = {0.0f, 1.0f, 0.0f};
+    float color[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    float flux = 1.0f;
+    float sediment = 0.0f;
+    uint32_t basinId = 0;
+    uint8_t soilId = 0;
+};
+
+namespace terrain_vertex {
+
+// Flux is accumulated drainage area (>= 1 cell); 2^24 cells covers a 4096^2 map.
+constexpr float kMaxLogFlux = 16.635532f; // ln(2^24)
+// terrain.frag saturates the erosion overlay at sediment = 0.5
+constexpr float kMaxSediment = 1.0f;
+constexpr uint32_t kMaxBasinId = 0x00FFFFFFu;
+
+// Scalar codecs
+uint16_t packUnorm16(float v);
+float unpackUnorm16(uint16_t v);
+int16_t packSnorm16(float v);
+float unpackSnorm16(int16_t v);
+uint8_t packUnorm8(float v);
+
+// Octahedral normal encoding (input need not be normalized)
+void encodeOctNormal(const float n[3], int16_t out[2]);
+void decodeOctNormal(const int16_t in[2], float n[3]);
+
+uint16_t packFlux(float flux);
+float unpackFlux(uint16_t v);
+uint16_t packSediment(float sediment);
+float unpackSediment(uint16_t v);
+
+// Negative basin IDs (unassigned) map to 0; IDs above kMaxBasinId saturate.
+uint32_t packIds(int basinId, uint8_t soilId);
+uint32_t unpackBasinId(uint32_t ids);
+uint8_t unpackSoilId(uint32_t ids);
+
+TerrainGeometry packGeometry(float height, const float normal[3]);
+
+// Heights outside [0, maxHeight] saturate.
+uint16_t packHeight16(float height, float maxHeight);
+float unpackHeight16(uint16_t v, float maxHeight);
+TerrainGeometry16 packGeometry16(float height, float maxHeight, const float normal[3]);
+TerrainGeometry toGeometry(const TerrainGeometry16& g, float maxHeight);
+TerrainAttributes packAttributes(const float color[4], float flux, float sediment, int basinId, uint8_t soilId);
+
+TerrainVertex pack(const TerrainVertexAttributes& a);
+TerrainVertexAttributes unpack(const TerrainVertex& v);
+
+} // namespace terrain_vertex
+
+} // namespace graphics
@@ -2,7 +2,11 @@
 
 #include <vector>
 #include <cstdint>
-#include <vector>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include "../core/grid_arena.h"
+#include "../core/packed_channel.h"
 
 namespace landscape {
 
@@ -142,12 +146,102 @@ namespace landscape {
      */
     // v4.4.0: Geology Layer
     using LithologyID = uint8_t;
-    using SubOrderID = uint8_t; // v4.5.1
-    // v4.5.10: Deep Levels
-    using GreatGroupID = uint8_t;
-    using SubGroupID = uint8_t;
-    using FamilyID = uint8_t;
-    using SeriesID = uint8_t;
+    // v4.7.0: Index into a world's TaxonDictionary (SiBCS levels 2-6 of a cell)
+    using TaxonID = uint16_t;
+
+    // v4.7.0: SiBCS levels 2-6 of a cell; the order (level 1) stays in SoilGrid::soil_type
+    struct SoilTaxon {
+        SiBCSSubOrder suborder = SiBCSSubOrder::kNone;
+        SiBCSGreatGroup greatGroup = SiBCSGreatGroup::kNone;
+        SiBCSSubGroup subGroup = SiBCSSubGroup::kNone;
+        SiBCSFamily family = SiBCSFamily::kNone;
+        SiBCSSeries series = SiBCSSeries::kNone;
+
+        uint64_t key() const {
+            return static_cast<uint64_t>(suborder) | static_cast<uint64_t>(greatGroup) << 8 |
+                   static_cast<uint64_t>(subGroup) << 16 | static_cast<uint64_t>(family) << 24 |
+                   static_cast<uint64_t>(series) << 32;
+        }
+        bool operator==(const SoilTaxon& other) const { return key() == other.key(); }
+        bool operator!=(const SoilTaxon& other) const { return key() != other.key(); }
+    };
+    static_assert(sizeof(SoilTaxon) == 5 && std::is_trivially_copyable<SoilTaxon>::value,
+                  "SoilTaxon is written to snapshots as raw bytes");
+
+    /**
+     * @brief v4.7.0: The distinct taxa (levels 2-6) present in one world.
+     *
+     * Cells hold a TaxonID instead of one byte per level. A map carries a
+     * handful of taxa, so per-taxon properties (palette colour, domain
+     * membership) are computed once per entry with tabulate() and each cell
+     * costs one lookup. Entry 0 is the unrefined taxon (every level kNone).
+     * 16-bit IDs cover every combination of the level enums; intern() only
+     * runs out on values outside them and then answers kUnrefined.
+     *
+     * intern() appends: intern before handing the grid to parallel readers.
+     */
+    class TaxonDictionary {
+    public:
+        static constexpr TaxonID kUnrefined = 0;
+        static constexpr size_t kMaxTaxa = 65536;
+
+        TaxonDictionary() { clear(); }
+
+        TaxonID intern(const SoilTaxon& taxon) {
+            auto it = index_.find(taxon.key());
+            if (it != index_.end()) return it->second;
+            if (entries_.size() >= kMaxTaxa) return kUnrefined;
+            const TaxonID id = static_cast<TaxonID>(entries_.size());
+            entries_.push_back(taxon);
+            index_.emplace(taxon.key(), id);
+            return id;
+        }
+
+        // False if the world has no cell of this taxon yet
+        bool find(const SoilTaxon& taxon, TaxonID& id) const {
+            auto it = index_.find(taxon.key());
+            if (it == index_.end()) return false;
+            id = it->second;
+            return true;
+        }
+
+        const SoilTaxon& operator[](TaxonID id) const { return entries_[id]; }
+        size_t size() const { return entries_.size(); }
+        const std::vector<SoilTaxon>& entries() const { return entries_; }
+
+        // Replaces every entry (snapshot load). False, leaving the dictionary
+        // untouched, unless entry 0 is unrefined and no taxon repeats.
+        bool assign(const std::vector<SoilTaxon>& entries) {
+            if (entries.empty() || entries.size() > kMaxTaxa || entries[0] != SoilTaxon()) return false;
+            std::unordered_map<uint64_t, TaxonID> index;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (!index.emplace(entries[i].key(), static_cast<TaxonID>(i)).second) return false;
+            }
+            entries_ = entries;
+            index_ = std::move(index);
+            return true;
+        }
+
+        void clear() {
+            entries_.assign(1, SoilTaxon());
+            index_.clear();
+            index_.emplace(SoilTaxon().key(), kUnrefined);
+        }
+
+        // fn(taxon) for every entry, indexed by TaxonID
+        template <typename Fn>
+        auto tabulate(Fn&& fn) const -> std::vector<typename std::decay<decltype(fn(std::declval<const SoilTaxon&>()))>::type> {
+            std::vector<typename std::decay<decltype(fn(std::declval<const SoilTaxon&>()))>::type> table;
+            table.reserve(entries_.size());
+            for (const SoilTaxon& taxon : entries_) table.push_back(fn(taxon));
+            return table;
+        }
+
+    private:
+        std::vector<SoilTaxon> entries_;
+        std::unordered_map<uint64_t, TaxonID> index_;
+    };
+
     // v4.6.0: User Constraints for SiBCS (Moved here for shared access)
     struct SiBCSUserSelection {
         SiBCSOrder order = SiBCSOrder::kNone;
@@ -178,67 +272,74 @@ namespace landscape {
         int height = 0;
 
         // Physical Properties
-        std::vector<float> depth;          // [meters] Effective soil depth. 0 = Bedrock.
-        std::vector<float> infiltration;   // [mm/h] Base K_sat (Saturated Hydraulic Conductivity)
-        std::vector<float> compaction;     // [0.0 - 1.0] 0 = Porous, 1 = Sealed (Reduces infiltration)
-        std::vector<float> organic_matter; // [0.0 - 1.0] Enhances structure/water holding
+        core::GridVector<float> depth;          // [meters] Effective soil depth. 0 = Bedrock.
+        core::GridVector<float> infiltration;   // [mm/h] Base K_sat (Saturated Hydraulic Conductivity)
+        core::PackedChannel compaction{core::ChannelPrecision::Unorm16};     // [0.0 - 1.0] 0 = Porous, 1 = Sealed (Reduces infiltration)
+        core::GridVector<float> organic_matter; // [0.0 - 1.0] Enhances structure/water holding
 
         // Biological Memory (Resilience Factor)
-        std::vector<float> propagule_bank; // [0.0 - 1.0] Potential for regeneration (Seeds/Buds)
+        core::PackedChannel propagule_bank{core::ChannelPrecision::Unorm16}; // [0.0 - 1.0] Potential for regeneration (Seeds/Buds)
 
         // Classification & Geology
-        std::vector<uint8_t> soil_type;    // Maps to SoilType (SiBCS Order)
-        std::vector<SubOrderID> suborder;  // Maps to SiBCSSubOrder
-        std::vector<GreatGroupID> great_group; // Level 3
-        std::vector<SubGroupID> sub_group;     // Level 4
-        std::vector<FamilyID> family;          // Level 5
-        std::vector<SeriesID> series;          // Level 6
+        core::GridVector<uint8_t> soil_type;    // Maps to SoilType (SiBCS Order)
+        // v4.7.0: Levels 2-6 (suborder .. series) as one index into `taxa`
+        core::GridVector<TaxonID> taxon;
+        TaxonDictionary taxa;
         
-        std::vector<LithologyID> lithology_id; // v4.4.0: ID of Parent Material
+        core::GridVector<LithologyID> lithology_id; // v4.4.0: ID of Parent Material
 
         // Extended State for Reference Logic
-        std::vector<float> sand_fraction;
-        std::vector<float> clay_fraction;
-        std::vector<float> labile_carbon;
-        std::vector<float> recalcitrant_carbon;
-        std::vector<float> dead_biomass;
-        std::vector<float> water_content_soil;
-        std::vector<float> field_capacity;
-        std::vector<float> conductivity;
+        // v4.7.0: Bounded [0, 1] fields are stored as unorm16 (PackedChannel)
+        core::PackedChannel sand_fraction{core::ChannelPrecision::Unorm16};
+        core::PackedChannel clay_fraction{core::ChannelPrecision::Unorm16};
+        core::GridVector<float> labile_carbon;
+        core::GridVector<float> recalcitrant_carbon;
+        core::GridVector<float> dead_biomass;
+        core::GridVector<float> water_content_soil;
+        core::GridVector<float> field_capacity;
+        core::GridVector<float> conductivity;
 
-        void resize(int w, int h) {
-            width = w;
-            height = h;
-            size_t size = static_cast<size_t>(w * h);
-
-            depth.assign(size, 1.0f);           // Default 1m depth
-            infiltration.assign(size, 50.0f);   // Default 50mm/h (Loam)
-            compaction.assign(size, 0.0f);      // No compaction
-            organic_matter.assign(size, 0.05f);  // Realistic organic matter (5%)
-            propagule_bank.assign(size, 1.0f);  // Full regenerative potential
+        // v4.7.0: Registers every channel with its initial value; resize() and
+        // TerrainMap (arena-backed) apply the layout.
+        void describe(core::GridLayout& layout) {
+            width = layout.width();
+            height = layout.height();
+
+            layout.add("soil.depth", depth, 1.0f);           // Default 1m depth
+            layout.add("soil.infiltration", infiltration, 50.0f);   // Default 50mm/h (Loam)
+            layout.add("soil.compaction", compaction, 0.0f);      // No compaction
+            layout.add("soil.organic_matter", organic_matter, 0.05f);  // Realistic organic matter (5%)
+            layout.add("soil.propagule_bank", propagule_bank, 1.0f);  // Full regenerative potential
             
-            soil_type.assign(size, static_cast<uint8_t>(SoilType::Undefined)); // User must classify
-            suborder.assign(size, 0);   // None
-            great_group.assign(size, 0);
-            sub_group.assign(size, 0);
-            family.assign(size, 0);
-            series.assign(size, 0);
+            layout.add("soil.soil_type", soil_type, static_cast<uint8_t>(SoilType::Undefined)); // User must classify
+            taxa.clear();
+            layout.add("soil.taxon", taxon, TaxonDictionary::kUnrefined); // Levels 2-6 None
             
-            lithology_id.assign(size, 0);       // Default Lithology (0 = Generic)
+            layout.add("soil.lithology_id", lithology_id, 0);       // Default Lithology (0 = Generic)
 
             // Extended Logic State
-            sand_fraction.assign(size, 0.4f);
-            clay_fraction.assign(size, 0.2f);
-            labile_carbon.assign(size, 0.1f);
-            recalcitrant_carbon.assign(size, 0.05f);
-            dead_biomass.assign(size, 0.02f);
-            water_content_soil.assign(size, 0.2f); // Renamed to avoid confusion with HydroGrid water_depth
-            field_capacity.assign(size, 0.3f);
-            conductivity.assign(size, 0.05f);
+            layout.add("soil.sand_fraction", sand_fraction, 0.4f);
+            layout.add("soil.clay_fraction", clay_fraction, 0.2f);
+            layout.add("soil.labile_carbon", labile_carbon, 0.1f);
+            layout.add("soil.recalcitrant_carbon", recalcitrant_carbon, 0.05f);
+            layout.add("soil.dead_biomass", dead_biomass, 0.02f);
+            layout.add("soil.water_content_soil", water_content_soil, 0.2f); // Renamed to avoid confusion with HydroGrid water_depth
+            layout.add("soil.field_capacity", field_capacity, 0.3f);
+            layout.add("soil.conductivity", conductivity, 0.05f);
+        }
+
+        void resize(int w, int h) {
+            core::GridLayout layout(w, h);
+            describe(layout);
+            layout.apply();
         }
 
         size_t getSize() const { return depth.size(); }
 
+        // v4.7.0: Classification levels 2-6 of cell i
+        const SoilTaxon& taxonAt(size_t i) const { return taxa[taxon[i]]; }
+        void setTaxon(size_t i, const SoilTaxon& t) { taxon[i] = taxa.intern(t); }
+
         bool isValid() const {
             return !depth.empty() && 
                    depth.size() == lithology_id.size() &&
@@ -255,27 +356,32 @@ namespace landscape {
         int height = 0;
 
         // State Variables
-        std::vector<float> water_depth;      // [m] Surface water depth (Runoff)
-        std::vector<float> flow_flux;        // [m^3/s?? or Unitless Accumulation] Accumulated Flow
-        std::vector<float> erosion_risk;     // [0-1] Calculated Stream Power / Shear Stress
+        core::GridVector<float> water_depth;      // [m] Surface water depth (Runoff)
+        core::GridVector<float> flow_flux;        // [m^3/s?? or Unitless Accumulation] Accumulated Flow
+        core::GridVector<float> erosion_risk;     // [0-1] Calculated Stream Power / Shear Stress
 
         // Topological Cache for Fast Flow Routing
         // We compute flow directions once (static topography) and use this order to propagate water.
-        std::vector<int> receiver_index;     // [Cell Index] Where water goes (-1 = Sink)
-        std::vector<int> sort_order;         // [Cell Index] Order from High to Low elevation
-        std::vector<float> slope;            // [Tan theta] Pre-calculated physical slope
+        core::GridVector<int> receiver_index;     // [Cell Index] Where water goes (-1 = Sink)
+        core::GridVector<int> sort_order;         // [Cell Index] Order from High to Low elevation
+        core::GridVector<float> slope;            // [Tan theta] Pre-calculated physical slope
+
+        void describe(core::GridLayout& layout) {
+            width = layout.width();
+            height = layout.height();
+
+            layout.add("hydro.water_depth", water_depth, 0.0f);
+            layout.add("hydro.flow_flux", flow_flux, 0.0f);
+            layout.add("hydro.erosion_risk", erosion_risk, 0.0f);
+            layout.add("hydro.receiver_index", receiver_index, -1);
+            layout.add("hydro.sort_order", sort_order, 0);
+            layout.add("hydro.slope", slope, 0.0f);
+        }
 
         void resize(int w, int h) {
-            width = w;
-            height = h;
-            size_t size = static_cast<size_t>(w * h);
-
-            water_depth.assign(size, 0.0f);
-            flow_flux.assign(size, 0.0f);
-            erosion_risk.assign(size, 0.0f);
-            receiver_index.assign(size, -1);
-            sort_order.resize(size);
-            slope.assign(size, 0.0f);
+            core::GridLayout layout(w, h);
+            describe(layout);
+            layout.apply();
         }
 
         bool isValid() const {
@@ -1,9 +1,10 @@
 #include "soil_system.h"
 #include "lithology_registry.h"
 #include "../terrain/terrain_map.h"
+#include "../core/job_system.h"
 #include <cmath>
 #include <algorithm>
-#include <random>
+#include <atomic>
 #include <vector>
 #include <iostream>
 
@@ -103,17 +104,6 @@ namespace landscape {
             }
         }
 
-        SiBCSResult readCellClassification(const SoilGrid& grid, size_t idx) {
-            SiBCSResult result;
-            result.order = orderFromSoilType(grid.soil_type[idx]);
-            result.suborder = static_cast<SiBCSSubOrder>(grid.suborder[idx]);
-            result.greatGroup = static_cast<SiBCSGreatGroup>(grid.great_group[idx]);
-            result.subGroup = static_cast<SiBCSSubGroup>(grid.sub_group[idx]);
-            result.family = static_cast<SiBCSFamily>(grid.family[idx]);
-            result.series = static_cast<SiBCSSeries>(grid.series[idx]);
-            return result;
-        }
-
         // Build list of candidates based strictly on explicit user selections (no automatic combinations)
         std::vector<CandidateProfile> generateCandidates(const SiBCSUserConfig& config) {
             std::vector<CandidateProfile> candidates;
@@ -153,56 +143,104 @@ namespace landscape {
             return candidates;
         }
 
-        // Apply initialized properties based on the decided Classification
-        // This is INVERSE of the old system: We set properties TO MATCH the class.
-        void applyProfileEffects(SoilGrid& grid, int i_int, const CandidateProfile& profile, std::mt19937& rng) {
-            size_t i = static_cast<size_t>(i_int);
-            std::uniform_real_distribution<float> noise(0.9f, 1.1f);
-            
-            // Defaults (Cambissolo-ish)
-            float depth = 1.0f;
+        // v4.7.0: Candidate of every (order, taxon) pair of the world, compiled once
+        // per domain apply; a cell then costs one lookup instead of a scan over the
+        // candidates comparing six levels.
+        class DomainLookup {
+        public:
+            static constexpr int32_t kUnclassified = -2; // Order None: the user has not classified the cell
+            static constexpr int32_t kOutOfDomain = -1;
+
+            DomainLookup(const std::vector<CandidateProfile>& candidates, const TaxonDictionary& taxa)
+                : taxonCount_(taxa.size()) {
+                // Row 0: unclassified; row 1 + order otherwise
+                for (int stored = 0; stored < 256; ++stored) {
+                    const SiBCSOrder order = orderFromSoilType(static_cast<uint8_t>(stored));
+                    rowOf_[stored] = order == SiBCSOrder::kNone ? 0 : static_cast<uint8_t>(1 + static_cast<int>(order));
+                }
+                table_.assign(kRows * taxonCount_, kOutOfDomain);
+                std::fill(table_.begin(), table_.begin() + static_cast<std::ptrdiff_t>(taxonCount_), kUnclassified);
+                for (int row = 1; row < kRows; ++row) {
+                    SiBCSResult cell;
+                    cell.order = static_cast<SiBCSOrder>(row - 1);
+                    for (size_t t = 0; t < taxonCount_; ++t) {
+                        const SoilTaxon& taxon = taxa[static_cast<TaxonID>(t)];
+                        cell.suborder = taxon.suborder;
+                        cell.greatGroup = taxon.greatGroup;
+                        cell.subGroup = taxon.subGroup;
+                        cell.family = taxon.family;
+                        cell.series = taxon.series;
+                        for (size_t c = 0; c < candidates.size(); ++c) {
+                            if (matchesSelection(candidates[c].classification, cell)) {
+                                table_[static_cast<size_t>(row) * taxonCount_ + t] = static_cast<int32_t>(c);
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Candidate index, kOutOfDomain or kUnclassified
+            int32_t operator()(uint8_t storedType, TaxonID taxon) const {
+                return table_[rowOf_[storedType] * taxonCount_ + taxon];
+            }
+
+        private:
+            static constexpr int kRows = 1 + static_cast<int>(SiBCSOrder::kLuvissolo) + 1;
+            size_t taxonCount_;
+            uint8_t rowOf_[256];
+            std::vector<int32_t> table_;
+        };
+
+        // v4.7.0: What applyProfileEffects writes for a candidate, before the per-cell noise
+        struct ProfileEffects {
+            float depth = 1.0f; // Defaults (Cambissolo-ish)
             float clay = 0.3f;
             float sand = 0.4f;
             float om = 0.03f;
             float water = 0.2f;
+            uint8_t soilType = static_cast<uint8_t>(SoilType::Undefined);
+        };
 
+        ProfileEffects compileEffects(const CandidateProfile& profile) {
+            ProfileEffects e;
             switch(profile.classification.order) {
                  case SiBCSOrder::kLatossolo:
-                    depth = 2.5f; 
-                    clay = 0.45f;
-                    sand = 0.30f;
+                    e.depth = 2.5f; 
+                    e.clay = 0.45f;
+                    e.sand = 0.30f;
                     break;
                  case SiBCSOrder::kArgissolo:
-                    depth = 1.5f;
-                    clay = 0.35f; // B Horizon average
-                    sand = 0.40f;
+                    e.depth = 1.5f;
+                    e.clay = 0.35f; // B Horizon average
+                    e.sand = 0.40f;
                     break;
                  case SiBCSOrder::kCambissolo:
-                    depth = 0.8f;
-                    clay = 0.25f;
-                    sand = 0.45f;
+                    e.depth = 0.8f;
+                    e.clay = 0.25f;
+                    e.sand = 0.45f;
                     break;
                  case SiBCSOrder::kNeossoloLit:
-                    depth = 0.2f;
-                    clay = 0.10f;
-                    sand = 0.60f;
+                    e.depth = 0.2f;
+                    e.clay = 0.10f;
+                    e.sand = 0.60f;
                     break;
                  case SiBCSOrder::kNeossoloQuartz:
-                    depth = 1.8f;
-                    clay = 0.05f;
-                    sand = 0.90f;
+                    e.depth = 1.8f;
+                    e.clay = 0.05f;
+                    e.sand = 0.90f;
                     break;
                  case SiBCSOrder::kGleissolo:
-                    depth = 1.2f;
-                    clay = 0.40f;
-                    sand = 0.20f;
-                    water = 0.9f; // Saturated
-                    om = 0.08f;
+                    e.depth = 1.2f;
+                    e.clay = 0.40f;
+                    e.sand = 0.20f;
+                    e.water = 0.9f; // Saturated
+                    e.om = 0.08f;
                     break;
                  case SiBCSOrder::kOrganossolo:
-                    depth = 0.6f;
-                    om = 0.40f;
-                    water = 0.8f;
+                    e.depth = 0.6f;
+                    e.om = 0.40f;
+                    e.water = 0.8f;
                     break;
                  default: break;
             }
@@ -210,55 +248,71 @@ namespace landscape {
             // Suborder mods
             if (profile.classification.suborder == SiBCSSubOrder::kVermelho) {
                 // Chemical implication: Fe2O3. Physically: often well drained.
-                water *= 0.8f; 
+                e.water *= 0.8f; 
             }
             if (profile.classification.suborder == SiBCSSubOrder::kTiomorfico) {
-                om += 0.05f;
-                water = 0.95f; 
+                e.om += 0.05f;
+                e.water = 0.95f; 
+            }
+
+            // Classification Index
+            switch(profile.classification.order) {
+                case SiBCSOrder::kLatossolo: e.soilType = static_cast<uint8_t>(SoilType::Latossolo); break;
+                case SiBCSOrder::kArgissolo: e.soilType = static_cast<uint8_t>(SoilType::Argissolo); break;
+                case SiBCSOrder::kCambissolo: e.soilType = static_cast<uint8_t>(SoilType::Cambissolo); break;
+                case SiBCSOrder::kNeossoloLit: e.soilType = static_cast<uint8_t>(SoilType::Neossolo_Litolico); break;
+                case SiBCSOrder::kNeossoloQuartz: e.soilType = static_cast<uint8_t>(SoilType::Neossolo_Quartzarenico); break;
+                case SiBCSOrder::kGleissolo: e.soilType = static_cast<uint8_t>(SoilType::Gleissolo); break;
+                case SiBCSOrder::kOrganossolo: e.soilType = static_cast<uint8_t>(SoilType::Organossolo); break;
+                default: break;
             }
+            return e;
+        }
+
+        // v4.7.0: Counter-based hash (splitmix64) of (seed, cell): four 16-bit noise draws
+        // without seeding a generator per cell, independent of evaluation order
+        uint64_t cellHash(uint64_t seed, uint64_t cell) {
+            uint64_t z = seed * 0x9E3779B97F4A7C15ull + cell * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
 
+        // Draw k (0-3) of a cell hash, uniform in [0.9, 1.1)
+        float noiseDraw(uint64_t hash, int k) {
+            return 0.9f + 0.2f * static_cast<float>((hash >> (16 * k)) & 0xFFFFu) * (1.0f / 65536.0f);
+        }
+
+        // Apply initialized properties based on the decided Classification
+        // This is INVERSE of the old system: We set properties TO MATCH the class.
+        void applyProfileEffects(SoilGrid& grid, size_t i, const ProfileEffects& e, uint64_t hash) {
             // Apply to Grid with Noise
-            grid.depth[i] = depth * noise(rng);
-            grid.sand_fraction[i] = std::clamp(sand * noise(rng), 0.05f, 0.95f);
-            grid.clay_fraction[i] = std::clamp(clay * noise(rng), 0.05f, 0.95f);
+            grid.depth[i] = e.depth * noiseDraw(hash, 0);
+            float sand = std::clamp(e.sand * noiseDraw(hash, 1), 0.05f, 0.95f);
+            float clay = std::clamp(e.clay * noiseDraw(hash, 2), 0.05f, 0.95f);
             
             // Normalize Texture
-            if (grid.sand_fraction[i] + grid.clay_fraction[i] > 0.98f) {
-                float s = 0.98f / (grid.sand_fraction[i] + grid.clay_fraction[i]);
-                grid.sand_fraction[i] *= s;
-                grid.clay_fraction[i] *= s;
+            if (sand + clay > 0.98f) {
+                float s = 0.98f / (sand + clay);
+                sand *= s;
+                clay *= s;
             }
+            grid.sand_fraction[i] = sand;
+            grid.clay_fraction[i] = clay;
 
-            grid.organic_matter[i] = om * noise(rng);
-            grid.labile_carbon[i] = grid.organic_matter[i] * 0.5f;
-            grid.recalcitrant_carbon[i] = grid.organic_matter[i] * 0.5f;
+            const float om = e.om * noiseDraw(hash, 3);
+            grid.organic_matter[i] = om;
+            grid.labile_carbon[i] = om * 0.5f;
+            grid.recalcitrant_carbon[i] = om * 0.5f;
             
-            grid.water_content_soil[i] = water;
-            grid.field_capacity[i] = 0.1f + grid.clay_fraction[i] * 0.3f + grid.organic_matter[i] * 0.2f;
-            grid.conductivity[i] = 0.05f + (grid.sand_fraction[i] * 0.2f);
+            grid.water_content_soil[i] = e.water;
+            grid.field_capacity[i] = 0.1f + clay * 0.3f + om * 0.2f;
+            grid.conductivity[i] = 0.05f + (sand * 0.2f);
             grid.infiltration[i] = grid.conductivity[i] * 1000.0f; // Mock conversion
             
-            // Set Classification Indices
-            switch(profile.classification.order) {
-                case SiBCSOrder::kLatossolo: grid.soil_type[i] = static_cast<uint8_t>(SoilType::Latossolo); break;
-                case SiBCSOrder::kArgissolo: grid.soil_type[i] = static_cast<uint8_t>(SoilType::Argissolo); break;
-                case SiBCSOrder::kCambissolo: grid.soil_type[i] = static_cast<uint8_t>(SoilType::Cambissolo); break;
-                case SiBCSOrder::kNeossoloLit: grid.soil_type[i] = static_cast<uint8_t>(SoilType::Neossolo_Litolico); break;
-                case SiBCSOrder::kNeossoloQuartz: grid.soil_type[i] = static_cast<uint8_t>(SoilType::Neossolo_Quartzarenico); break;
-                case SiBCSOrder::kGleissolo: grid.soil_type[i] = static_cast<uint8_t>(SoilType::Gleissolo); break;
-                case SiBCSOrder::kOrganossolo: grid.soil_type[i] = static_cast<uint8_t>(SoilType::Organossolo); break;
-                default: grid.soil_type[i] = static_cast<uint8_t>(SoilType::Undefined); break;
-            }
-
-            if (profile.classification.suborder != SiBCSSubOrder::kNone) {
-                grid.suborder[i] = static_cast<uint8_t>(profile.classification.suborder);
-            }
-            if (profile.classification.greatGroup != SiBCSGreatGroup::kNone) {
-                grid.great_group[i] = static_cast<uint8_t>(profile.classification.greatGroup);
-            }
-            if (profile.classification.subGroup != SiBCSSubGroup::kNone) {
-                grid.sub_group[i] = static_cast<uint8_t>(profile.classification.subGroup);
-            }
+            // Set Classification Index. v4.7.0: Levels 2-6 stay as they are: a cell only
+            // gets a profile whose named levels it already carries (matchesSelection)
+            grid.soil_type[i] = e.soilType;
         }
     }
 
@@ -288,42 +342,43 @@ namespace landscape {
         int w = grid.width;
         int h = grid.height;
 
-        long long applied = 0;
-        long long skippedUndefined = 0;
-        long long skippedOutOfDomain = 0;
+        // v4.7.0: Domain and profile constants compiled once; per cell one lookup and a hash
+        const DomainLookup domain(candidates, grid.taxa);
+        std::vector<ProfileEffects> effects;
+        effects.reserve(candidates.size());
+        for (const CandidateProfile& c : candidates) effects.push_back(compileEffects(c));
+        const uint64_t noiseSeed = static_cast<uint64_t>(static_cast<int64_t>(seed));
 
-        // 2. Apply only on cells already classified by the user and inside the domain
-        #pragma omp parallel for reduction(+:applied, skippedUndefined, skippedOutOfDomain) collapse(2)
-        for (int y = 0; y < h; ++y) {
-            for (int x = 0; x < w; ++x) {
-                int i_int = y * w + x;
-                size_t i = static_cast<size_t>(i_int);
-                
-                SiBCSResult cellClass = readCellClassification(grid, i);
-                if (cellClass.order == SiBCSOrder::kNone) {
-                    skippedUndefined += 1;
-                    continue; // Not classified by user
-                }
+        std::atomic<long long> applied{0};
+        std::atomic<long long> skippedUndefined{0};
+        std::atomic<long long> skippedOutOfDomain{0};
 
-                int matchIdx = -1;
-                for (size_t c = 0; c < candidates.size(); ++c) {
-                    if (matchesSelection(candidates[c].classification, cellClass)) {
-                        matchIdx = static_cast<int>(c);
-                        break;
+        // 2. Apply only on cells already classified by the user and inside the domain
+        core::JobSystem::instance().parallelFor(0, h, 0, [&](int rowBegin, int rowEnd) {
+            long long chunkApplied = 0, chunkUndefined = 0, chunkOutOfDomain = 0;
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    size_t i = static_cast<size_t>(y) * static_cast<size_t>(w) + static_cast<size_t>(x);
+
+                    const int32_t match = domain(grid.soil_type[i], grid.taxon[i]);
+                    if (match == DomainLookup::kUnclassified) {
+                        chunkUndefined += 1;
+                        continue; // Not classified by user
+                    }
+                    if (match == DomainLookup::kOutOfDomain) {
+                        grid.soil_type[i] = static_cast<uint8_t>(SoilType::Undefined);
+                        chunkOutOfDomain += 1;
+                        continue;
                     }
-                }
 
-                if (matchIdx < 0) {
-                    grid.soil_type[i] = static_cast<uint8_t>(SoilType::Undefined);
-                    skippedOutOfDomain += 1;
-                    continue;
+                    applyProfileEffects(grid, i, effects[static_cast<size_t>(match)], cellHash(noiseSeed, i));
+                    chunkApplied += 1;
                 }
-
-                std::mt19937 localRng(static_cast<unsigned long>(seed + i_int)); 
-                applyProfileEffects(grid, i_int, candidates[static_cast<size_t>(matchIdx)], localRng);
-                applied += 1;
             }
-        }
+            applied += chunkApplied;
+            skippedUndefined += chunkUndefined;
+            skippedOutOfDomain += chunkOutOfDomain;
+        });
 
         std::cout << "[SoilSystem] Applied profiles to " << applied << " cells. "
                   << skippedOutOfDomain << " cells skipped (out of domain), "
@@ -352,53 +407,54 @@ namespace landscape {
 
         PedogenesisService pedogenesis;
 
-        #pragma omp parallel for collapse(2)
-        for (int y = startRow; y < endRow; ++y) {
-            for (int x = 0; x < w; ++x) {
-                int i_int = y * w + x;
-                size_t i = static_cast<size_t>(i_int);
+        core::JobSystem::instance().parallelFor(startRow, endRow, 0, [&](int rowBegin, int rowEnd) {
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    int i_int = y * w + x;
+                    size_t i = static_cast<size_t>(i_int);
                 
-                // 1. Construct State objects
-                ParentMaterial mat = parent; 
-                Relief relief;
-                relief.elevation = terrain.getHeight(x, y);
-                relief.slope = calculateSlope(x, y, terrain);
-                relief.curvature = calculateCurvature(x, y, terrain);
-
-                SoilState current;
-                current.mineral.depth = grid.depth[i];
-                current.mineral.sand_fraction = grid.sand_fraction[i];
-                current.mineral.clay_fraction = grid.clay_fraction[i];
-                current.organic.labile_carbon = grid.labile_carbon[i];
-                current.organic.recalcitrant_carbon = grid.recalcitrant_carbon[i];
-                current.organic.dead_biomass = grid.dead_biomass[i];
-                current.hydric.water_content = grid.water_content_soil[i];
-                current.hydric.field_capacity = grid.field_capacity[i];
-                current.hydric.conductivity = grid.conductivity[i];
-
-                // 2. Evolve (SCORPAN Processes)
-                SoilState next = pedogenesis.evolve(current, mat, relief, climate, pressure, dt);
-
-                // 3. Write Back
+                    // 1. Construct State objects
+                    ParentMaterial mat = parent; 
+                    Relief relief;
+                    relief.elevation = terrain.getHeight(x, y);
+                    relief.slope = calculateSlope(x, y, terrain);
+                    relief.curvature = calculateCurvature(x, y, terrain);
+
+                    SoilState current;
+                    current.mineral.depth = grid.depth[i];
+                    current.mineral.sand_fraction = grid.sand_fraction[i];
+                    current.mineral.clay_fraction = grid.clay_fraction[i];
+                    current.organic.labile_carbon = grid.labile_carbon[i];
+                    current.organic.recalcitrant_carbon = grid.recalcitrant_carbon[i];
+                    current.organic.dead_biomass = grid.dead_biomass[i];
+                    current.hydric.water_content = grid.water_content_soil[i];
+                    current.hydric.field_capacity = grid.field_capacity[i];
+                    current.hydric.conductivity = grid.conductivity[i];
+
+                    // 2. Evolve (SCORPAN Processes)
+                    SoilState next = pedogenesis.evolve(current, mat, relief, climate, pressure, dt);
+
+                    // 3. Write Back
                 
-                grid.depth[i] = static_cast<float>(next.mineral.depth);
-                grid.sand_fraction[i] = static_cast<float>(next.mineral.sand_fraction);
-                grid.clay_fraction[i] = static_cast<float>(next.mineral.clay_fraction);
+                    grid.depth[i] = static_cast<float>(next.mineral.depth);
+                    grid.sand_fraction[i] = static_cast<float>(next.mineral.sand_fraction);
+                    grid.clay_fraction[i] = static_cast<float>(next.mineral.clay_fraction);
                 
-                grid.labile_carbon[i] = static_cast<float>(next.organic.labile_carbon);
-                grid.recalcitrant_carbon[i] = static_cast<float>(next.organic.recalcitrant_carbon);
-                grid.dead_biomass[i] = static_cast<float>(next.organic.dead_biomass);
+                    grid.labile_carbon[i] = static_cast<float>(next.organic.labile_carbon);
+                    grid.recalcitrant_carbon[i] = static_cast<float>(next.organic.recalcitrant_carbon);
+                    grid.dead_biomass[i] = static_cast<float>(next.organic.dead_biomass);
                 
-                grid.water_content_soil[i] = static_cast<float>(next.hydric.water_content);
-                grid.field_capacity[i] = static_cast<float>(next.hydric.field_capacity);
-                grid.conductivity[i] = static_cast<float>(next.hydric.conductivity);
+                    grid.water_content_soil[i] = static_cast<float>(next.hydric.water_content);
+                    grid.field_capacity[i] = static_cast<float>(next.hydric.field_capacity);
+                    grid.conductivity[i] = static_cast<float>(next.hydric.conductivity);
 
-                grid.organic_matter[i] = grid.labile_carbon[i] + grid.recalcitrant_carbon[i];
-                grid.infiltration[i] = grid.conductivity[i] * 1000.0f; 
+                    grid.organic_matter[i] = grid.labile_carbon[i] + grid.recalcitrant_carbon[i];
+                    grid.infiltration[i] = grid.conductivity[i] * 1000.0f; 
 
-                // NO Classification Step.
+                    // NO Classification Step.
+                }
             }
-        }
+        });
     }
 
 } // namespace landscape
@@ -0,0 +1,171 @@
+#include "fft.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <cmath>
+
+namespace math {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Columns are gathered in blocks so each thread streams whole cache lines
+constexpr size_t kColumnBlock = 16;
+
+// e^{-2πi k/n} for k <= n/2 (real-FFT pre/post twiddles)
+std::vector<std::complex<float>> halfTwiddles(size_t n) {
+    std::vector<std::complex<float>> w(n / 2 + 1);
+    for (size_t k = 0; k <= n / 2; ++k) {
+        double a = -2.0 * kPi * static_cast<double>(k) / static_cast<double>(n);
+        w[k] = std::complex<float>(static_cast<float>(std::cos(a)), static_cast<float>(std::sin(a)));
+    }
+    return w;
+}
+
+// Length-n real forward FFT of one row into n/2 + 1 bins via an n/2 complex FFT
+void realRowForward(const float* in, std::complex<float>* out, const FFT& half,
+                    const std::vector<std::complex<float>>& tw, std::complex<float>* scratch) {
+    const size_t m = half.size();
+    for (size_t j = 0; j < m; ++j) scratch[j] = std::complex<float>(in[2 * j], in[2 * j + 1]);
+    half.transform(scratch, false);
+
+    // X[k] = Ze[k] + W^k Zo[k], with Ze/Zo split out of Z by conjugate symmetry
+    for (size_t k = 0; k <= m; ++k) {
+        const std::complex<float> a = scratch[k % m];
+        const std::complex<float> b = std::conj(scratch[(m - k) % m]);
+        const std::complex<float> even = 0.5f * (a + b);
+        const std::complex<float> odd = std::complex<float>(0.0f, -0.5f) * (a - b);
+        out[k] = even + tw[k] * odd;
+    }
+}
+
+// Inverse of realRowForward (unscaled by 1/m; caller applies the 2D scale)
+void realRowInverse(const std::complex<float>* in, float* out, const FFT& half,
+                    const std::vector<std::complex<float>>& tw, std::complex<float>* scratch) {
+    const size_t m = half.size();
+    for (size_t k = 0; k < m; ++k) {
+        const std::complex<float> a = in[k];
+        const std::complex<float> b = std::conj(in[m - k]);
+        const std::complex<float> even = 0.5f * (a + b);
+        const std::complex<float> odd = 0.5f * (a - b) * std::conj(tw[k]);
+        scratch[k] = even + std::complex<float>(0.0f, 1.0f) * odd;
+    }
+    half.transform(scratch, true);
+    for (size_t j = 0; j < m; ++j) {
+        out[2 * j] = scratch[j].real();
+        out[2 * j + 1] = scratch[j].imag();
+    }
+}
+
+// Transform every column of a rows x cols complex matrix (row-major), in place
+void transformColumns(std::complex<float>* data, size_t rows, size_t cols, bool inverse, float scale) {
+    const FFT plan(rows);
+    const int blocks = static_cast<int>((cols + kColumnBlock - 1) / kColumnBlock);
+
+    core::JobSystem::instance().parallelFor(0, blocks, 0, [&](int blockBegin, int blockEnd) {
+        std::vector<std::complex<float>> column(rows * kColumnBlock);
+
+        for (int b = blockBegin; b < blockEnd; ++b) {
+            const size_t c0 = static_cast<size_t>(b) * kColumnBlock;
+            const size_t nc = std::min(kColumnBlock, cols - c0);
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < nc; ++c) column[c * rows + r] = data[r * cols + c0 + c];
+            }
+            for (size_t c = 0; c < nc; ++c) plan.transform(column.data() + c * rows, inverse);
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < nc; ++c) data[r * cols + c0 + c] = column[c * rows + r] * scale;
+            }
+        }
+    });
+}
+
+} // namespace
+
+size_t FFT::nextPowerOfTwo(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+FFT::FFT(size_t n) : n_(n) {
+    twiddles_.resize(n / 2);
+    for (size_t k = 0; k < n / 2; ++k) {
+        double a = -2.0 * kPi * static_cast<double>(k) / static_cast<double>(n);
+        twiddles_[k] = std::complex<float>(static_cast<float>(std::cos(a)), static_cast<float>(std::sin(a)));
+    }
+
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < n) ++bits;
+    bitReverse_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+        bitReverse_[i] = r;
+    }
+}
+
+void FFT::transform(std::complex<float>* data, bool inverse) const {
+    const size_t n = n_;
+    for (size_t i = 0; i < n; ++i) {
+        if (i < bitReverse_[i]) std::swap(data[i], data[bitReverse_[i]]);
+    }
+
+    // Iterative Cooley-Tukey butterflies (explicit real arithmetic avoids the
+    // NaN/Inf recovery path of std::complex multiplication)
+    const float sign = inverse ? -1.0f : 1.0f;
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const size_t halfLen = len / 2;
+        const size_t step = n / len;
+        for (size_t start = 0; start < n; start += len) {
+            for (size_t k = 0; k < halfLen; ++k) {
+                const float wr = twiddles_[k * step].real();
+                const float wi = twiddles_[k * step].imag() * sign;
+                const std::complex<float> u = data[start + k];
+                const std::complex<float> d = data[start + k + halfLen];
+                const float vr = d.real() * wr - d.imag() * wi;
+                const float vi = d.real() * wi + d.imag() * wr;
+                data[start + k] = std::complex<float>(u.real() + vr, u.imag() + vi);
+                data[start + k + halfLen] = std::complex<float>(u.real() - vr, u.imag() - vi);
+            }
+        }
+    }
+}
+
+void fft2DRealForward(const float* in, size_t width, size_t height, std::complex<float>* spectrum) {
+    const size_t bins = width / 2 + 1;
+    const FFT half(width / 2);
+    const std::vector<std::complex<float>> tw = halfTwiddles(width);
+
+    core::JobSystem::instance().parallelFor(0, static_cast<int>(height), 0, [&](int rowBegin, int rowEnd) {
+        std::vector<std::complex<float>> scratch(width / 2);
+
+        for (int r = rowBegin; r < rowEnd; ++r) {
+            realRowForward(in + static_cast<size_t>(r) * width, spectrum + static_cast<size_t>(r) * bins, half, tw, scratch.data());
+        }
+    });
+
+    transformColumns(spectrum, height, bins, false, 1.0f);
+}
+
+void fft2DRealInverse(std::complex<float>* spectrum, size_t width, size_t height, float* out) {
+    const size_t bins = width / 2 + 1;
+    const FFT half(width / 2);
+    const std::vector<std::complex<float>> tw = halfTwiddles(width);
+
+    // 1/height on the columns, 1/(width/2) on the half-length rows
+    // (the even/odd split already halves the row spectrum)
+    transformColumns(spectrum, height, bins, true, 1.0f / static_cast<float>(height));
+
+    const float rowScale = 1.0f / static_cast<float>(width / 2);
+    core::JobSystem::instance().parallelFor(0, static_cast<int>(height), 0, [&](int rowBegin, int rowEnd) {
+        std::vector<std::complex<float>> scratch(width / 2);
+
+        for (int r = rowBegin; r < rowEnd; ++r) {
+            float* row = out + static_cast<size_t>(r) * width;
+            realRowInverse(spectrum + static_cast<size_t>(r) * bins, row, half, tw, scratch.data());
+            for (size_t x = 0; x < width; ++x) row[x] *= rowScale;
+        }
+    });
+}
+
+} // namespace math
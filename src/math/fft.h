@@ -0,0 +1,53 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace math {
+
+/**
+ * @brief v4.7.0: In-place radix-2 complex FFT for power-of-two sizes
+ *
+ * Twiddles and the bit-reversal permutation are computed once per size
+ * (in double precision) and shared by every transform of that size.
+ * transform() is const and re-entrant, so one plan serves many threads.
+ */
+class FFT {
+public:
+    explicit FFT(size_t n);
+
+    size_t size() const { return n_; }
+
+    /**
+     * @brief Unscaled transform: forward uses e^{-2πi jk/n}, inverse e^{+2πi jk/n}
+     */
+    void transform(std::complex<float>* data, bool inverse) const;
+
+    static bool isPowerOfTwo(size_t n) { return n != 0 && (n & (n - 1)) == 0; }
+    static size_t nextPowerOfTwo(size_t n);
+
+private:
+    size_t n_;
+    std::vector<std::complex<float>> twiddles_; // e^{-2πi k/n}, k < n/2
+    std::vector<size_t> bitReverse_;
+};
+
+/**
+ * @brief v4.7.0: 2D real <-> complex FFT (power-of-two width and height, width >= 2)
+ *
+ * The spectrum is the non-redundant half: height rows of (width / 2 + 1) bins,
+ * row-major. Each row is transformed as a half-length complex FFT; rows and
+ * columns are distributed over the job system. Lines are independent, so the
+ * result does not depend on the thread count.
+ */
+void fft2DRealForward(const float* in, size_t width, size_t height, std::complex<float>* spectrum);
+
+/**
+ * @brief Inverse of fft2DRealForward, scaled by 1 / (width * height).
+ * The spectrum is used as scratch and is overwritten. Hermitian symmetry of
+ * columns 0 and width/2 is assumed (as produced by a real input).
+ */
+void fft2DRealInverse(std::complex<float>* spectrum, size_t width, size_t height, float* out);
+
+} // namespace math
@@ -0,0 +1,136 @@
+#include "half.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HALF_SSE2 1
+#endif
+#if defined(__F16C__)
+#include <immintrin.h>
+#define HALF_F16C 1
+#endif
+
+namespace math {
+
+namespace {
+
+#ifdef HALF_SSE2
+// Low 16 bits of each 32-bit lane -> 8 x u16 (sign-extend so packs_epi32 cannot saturate)
+inline __m128i narrow16(__m128i lo, __m128i hi) {
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    return _mm_packs_epi32(lo, hi);
+}
+
+#ifndef HALF_F16C
+// Same steps as floatToHalf, branch-free over 4 lanes
+inline __m128i floatToHalf4(__m128 value) {
+    const __m128i signMask = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    const __m128i halfMax = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i subnormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(static_cast<int>(0xfffu + (static_cast<uint32_t>(15 - 127) << 23)));
+
+    const __m128i bits = _mm_castps_si128(value);
+    const __m128i sign = _mm_and_si128(bits, signMask);
+    const __m128i absBits = _mm_xor_si128(bits, sign);
+    const __m128 absValue = _mm_castsi128_ps(absBits);
+
+    const __m128i isNaN = _mm_castps_si128(_mm_cmpunord_ps(absValue, absValue));
+    const __m128i isRegular = _mm_cmpgt_epi32(halfMax, absBits);
+    const __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absBits);
+    const __m128i infOrNaN = _mm_or_si128(_mm_and_si128(isNaN, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+    const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absValue, _mm_castsi128_ps(subnormMagic))), subnormMagic);
+    const __m128i mantOdd = _mm_srli_epi32(_mm_slli_epi32(absBits, 31 - 13), 31);
+    const __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(absBits, normalBias), mantOdd), 13);
+
+    const __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+    const __m128i joined = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, infOrNaN));
+    return _mm_or_si128(joined, _mm_srli_epi32(sign, 16));
+}
+
+// Exact: the exponent is rebiased by a multiply (subnormal halves become normal floats)
+inline __m128 halfToFloat4(__m128i half) {
+    const __m128i expMant = _mm_and_si128(half, _mm_set1_epi32(0x7fff));
+    const __m128i sign = _mm_slli_epi32(_mm_xor_si128(half, expMant), 16);
+    const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMant, 13)),
+                                     _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+    const __m128i wasInfNaN = _mm_cmpgt_epi32(expMant, _mm_set1_epi32(0x7bff));
+    const __m128i infNaNExp = _mm_and_si128(wasInfNaN, _mm_set1_epi32(255 << 23));
+    return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infNaNExp)));
+}
+#endif
+#endif
+
+} // namespace
+
+void floatsToHalf(const float* src, size_t count, uint16_t* dst) {
+    size_t i = 0;
+#if defined(HALF_F16C)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i lo = _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        const __m128i hi = _mm_cvtps_ph(_mm_loadu_ps(src + i + 4), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi64(lo, hi));
+    }
+#elif defined(HALF_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i lo = floatToHalf4(_mm_loadu_ps(src + i));
+        const __m128i hi = floatToHalf4(_mm_loadu_ps(src + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), narrow16(lo, hi));
+    }
+#endif
+    for (; i < count; ++i) dst[i] = floatToHalf(src[i]);
+}
+
+void halfsToFloat(const uint16_t* src, size_t count, float* dst) {
+    size_t i = 0;
+#if defined(HALF_F16C)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_ps(dst + i, _mm_cvtph_ps(h));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(h, h)));
+    }
+#elif defined(HALF_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_ps(dst + i, halfToFloat4(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(dst + i + 4, halfToFloat4(_mm_unpackhi_epi16(h, zero)));
+    }
+#endif
+    for (; i < count; ++i) dst[i] = halfToFloat(src[i]);
+}
+
+void floatsToUnorm16(const float* src, size_t count, uint16_t* dst) {
+    size_t i = 0;
+#ifdef HALF_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(65535.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    auto encode = [&](const float* p) {
+        __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(p), zero), one); // max(NaN, 0) -> 0
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+    };
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), narrow16(encode(src + i), encode(src + i + 4)));
+    }
+#endif
+    for (; i < count; ++i) dst[i] = floatToUnorm16(src[i]);
+}
+
+void unorm16sToFloat(const uint16_t* src, size_t count, float* dst) {
+    size_t i = 0;
+#ifdef HALF_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(1.0f / 65535.0f);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(u, zero)), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(u, zero)), scale));
+    }
+#endif
+    for (; i < count; ++i) dst[i] = unorm16ToFloat(src[i]);
+}
+
+} // namespace math
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace math {
+
+/**
+ * @brief v4.7.0: 16-bit storage formats for grids that do not need float32.
+ *
+ * Half (IEEE 754 binary16): 11 significant bits, ~3 decimal digits anywhere in
+ * [6e-5, 65504]. Conversion rounds to nearest even, overflows to infinity and
+ * keeps NaN a NaN; halfToFloat() is exact.
+ *
+ * Unorm16: [0, 1] in 65535 even steps (1.5e-5), finer than half near 1.
+ * Values are clamped, NaN stores 0. Decoding then encoding returns the same code,
+ * so a kernel may rewrite values it did not change without drift.
+ *
+ * The scalar functions are inline for per-cell access; the batch versions
+ * convert 4 lanes per step (SSE2, or F16C for half when compiled with it) and
+ * give bit-identical results to the scalar ones for every non-NaN input.
+ */
+inline uint16_t floatToHalf(float value) {
+    uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+    const uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+
+    uint32_t h;
+    if (f >= (127u + 16u) << 23) {
+        h = f > (255u << 23) ? 0x7e00u : 0x7c00u; // NaN stays quiet NaN, too large -> inf
+    } else if (f < (127u - 14u) << 23) {
+        // Subnormal half (or zero): the float adder does the rounding
+        const uint32_t magicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+        float magic, sum;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        std::memcpy(&sum, &f, sizeof(sum));
+        sum += magic;
+        std::memcpy(&h, &sum, sizeof(h));
+        h -= magicBits;
+    } else {
+        // Rebias the exponent and round the 13 dropped mantissa bits to nearest even
+        const uint32_t mantOdd = (f >> 13) & 1u;
+        f += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffu + mantOdd;
+        h = f >> 13;
+    }
+    return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+inline float halfToFloat(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1fu;
+    const uint32_t mantissa = half & 0x3ffu;
+    uint32_t f;
+    if (exponent == 0) {
+        float v = static_cast<float>(mantissa) * 5.9604644775390625e-8f; // 2^-24
+        std::memcpy(&f, &v, sizeof(f));
+        f |= sign;
+    } else if (exponent == 31) {
+        f = sign | 0x7f800000u | (mantissa << 13);
+    } else {
+        f = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    }
+    float value;
+    std::memcpy(&value, &f, sizeof(value));
+    return value;
+}
+
+inline uint16_t floatToUnorm16(float value) {
+    const float c = value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+    return static_cast<uint16_t>(c * 65535.0f + 0.5f);
+}
+
+inline float unorm16ToFloat(uint16_t code) {
+    return static_cast<float>(code) * (1.0f / 65535.0f);
+}
+
+void floatsToHalf(const float* src, size_t count, uint16_t* dst);
+void halfsToFloat(const uint16_t* src, size_t count, float* dst);
+void floatsToUnorm16(const float* src, size_t count, uint16_t* dst);
+void unorm16sToFloat(const uint16_t* src, size_t count, float* dst);
+
+} // namespace math
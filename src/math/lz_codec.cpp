@@ -0,0 +1,164 @@
+#include "lz_codec.h"
+#include <cstring>
+#include <vector>
+
+namespace math {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;   // A block always ends with at least this many literals
+constexpr size_t kMatchSearchEnd = 12; // No match starts within this distance of the end
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashLog = 16;
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - kHashLog);
+}
+
+// Length continuation: 255-byte runs plus a final byte < 255
+inline bool putLength(size_t len, uint8_t*& op, const uint8_t* end) {
+    while (len >= 255) {
+        if (op >= end) return false;
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= end) return false;
+    *op++ = static_cast<uint8_t>(len);
+    return true;
+}
+
+inline bool emitSequence(const uint8_t* literals, size_t literalLen, size_t offset, size_t matchLen,
+                         uint8_t*& op, const uint8_t* end) {
+    if (op >= end) return false;
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>((literalLen >= 15 ? 15 : literalLen) << 4);
+    if (literalLen >= 15 && !putLength(literalLen - 15, op, end)) return false;
+    if (static_cast<size_t>(end - op) < literalLen) return false;
+    if (literalLen > 0) std::memcpy(op, literals, literalLen);
+    op += literalLen;
+    if (matchLen == 0) return true; // Last sequence
+
+    if (end - op < 2) return false;
+    *op++ = static_cast<uint8_t>(offset & 0xFF);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    const size_t code = matchLen - kMinMatch;
+    *token |= static_cast<uint8_t>(code >= 15 ? 15 : code);
+    if (code >= 15 && !putLength(code - 15, op, end)) return false;
+    return true;
+}
+
+inline bool getLength(const uint8_t*& ip, const uint8_t* end, size_t& len) {
+    uint8_t b;
+    do {
+        if (ip >= end) return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+} // namespace
+
+size_t lzCompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t lzCompress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+    uint8_t* op = dst;
+    const uint8_t* end = dst + capacity;
+    size_t anchor = 0;
+
+    if (size > kMatchSearchEnd) {
+        // Positions + 1 (0 = empty slot)
+        std::vector<uint32_t> table(size_t(1) << kHashLog, 0u);
+        const size_t searchEnd = size - kMatchSearchEnd;
+        const size_t matchEnd = size - kLastLiterals;
+        size_t ip = 1;
+        table[hash4(read32(src))] = 1;
+
+        while (ip < searchEnd) {
+            const uint32_t seq = read32(src + ip);
+            const uint32_t h = hash4(seq);
+            const size_t ref = table[h];
+            table[h] = static_cast<uint32_t>(ip + 1);
+            if (ref == 0 || ip - (ref - 1) > kMaxOffset || read32(src + ref - 1) != seq) {
+                // Skip faster through incompressible stretches
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+            size_t r = ref - 1;
+            size_t len = kMinMatch;
+            while (ip + len < matchEnd && src[r + len] == src[ip + len]) ++len;
+            while (ip > anchor && r > 0 && src[ip - 1] == src[r - 1]) {
+                --ip;
+                --r;
+                ++len;
+            }
+            if (!emitSequence(src + anchor, ip - anchor, ip - r, len, op, end)) return 0;
+            ip += len;
+            anchor = ip;
+            if (ip < searchEnd) table[hash4(read32(src + ip - 2))] = static_cast<uint32_t>(ip - 1);
+        }
+    }
+    if (!emitSequence(src + anchor, size - anchor, 0, 0, op, end)) return 0;
+    return static_cast<size_t>(op - dst);
+}
+
+bool lzDecompress(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize) {
+    const uint8_t* ip = src;
+    const uint8_t* const ipEnd = src + size;
+    uint8_t* op = dst;
+    uint8_t* const opEnd = dst + rawSize;
+
+    while (ip < ipEnd) {
+        const uint8_t token = *ip++;
+        size_t literalLen = token >> 4;
+        if (literalLen == 15 && !getLength(ip, ipEnd, literalLen)) return false;
+        if (static_cast<size_t>(ipEnd - ip) < literalLen || static_cast<size_t>(opEnd - op) < literalLen) return false;
+        if (literalLen > 0) std::memcpy(op, ip, literalLen);
+        ip += literalLen;
+        op += literalLen;
+        if (ip == ipEnd) break; // Last sequence
+
+        if (ipEnd - ip < 2) return false;
+        const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        size_t matchLen = token & 15;
+        if (matchLen == 15 && !getLength(ip, ipEnd, matchLen)) return false;
+        matchLen += kMinMatch;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst) || static_cast<size_t>(opEnd - op) < matchLen) return false;
+
+        const uint8_t* match = op - offset;
+        if (offset >= matchLen) {
+            std::memcpy(op, match, matchLen);
+            op += matchLen;
+        } else {
+            // Overlapping copy repeats the last `offset` bytes
+            for (size_t i = 0; i < matchLen; ++i) *op++ = match[i];
+        }
+    }
+    return op == opEnd;
+}
+
+void byteShuffle(const uint8_t* src, size_t count, size_t elemSize, uint8_t* dst) {
+    for (size_t b = 0; b < elemSize; ++b) {
+        uint8_t* plane = dst + b * count;
+        for (size_t i = 0; i < count; ++i) plane[i] = src[i * elemSize + b];
+    }
+}
+
+void byteUnshuffle(const uint8_t* src, size_t count, size_t elemSize, uint8_t* dst) {
+    for (size_t b = 0; b < elemSize; ++b) {
+        const uint8_t* plane = src + b * count;
+        for (size_t i = 0; i < count; ++i) dst[i * elemSize + b] = plane[i];
+    }
+}
+
+} // namespace math
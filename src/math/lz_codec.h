@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace math {
+
+/**
+ * @brief v4.7.0: Byte-oriented LZ77 block codec (LZ4-style sequences, no entropy stage)
+ *
+ * A block is a series of sequences: token (literal length | match length - 4,
+ * one nibble each, 15 = continued in 255-runs), literals, 16-bit little-endian
+ * back-reference offset, match length continuation. The last sequence carries
+ * literals only. Decompression is a bounds-checked copy loop at memory speed;
+ * compression uses a single-probe hash table, so it is fast but not tight.
+ * Blocks are limited to 4 GiB (32-bit positions).
+ */
+size_t lzCompressBound(size_t size);
+
+// Returns the compressed size, or 0 if it would exceed `capacity`
+size_t lzCompress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+
+// False if the block is malformed or does not decode to exactly rawSize bytes
+bool lzDecompress(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize);
+
+/**
+ * @brief Transposes `count` elements of `elemSize` bytes into elemSize byte planes.
+ * Neighbouring floats of a smooth field share sign/exponent bytes, which
+ * become long runs once grouped, so shuffling before lzCompress pays off for grids.
+ */
+void byteShuffle(const uint8_t* src, size_t count, size_t elemSize, uint8_t* dst);
+void byteUnshuffle(const uint8_t* src, size_t count, size_t elemSize, uint8_t* dst);
+
+} // namespace math
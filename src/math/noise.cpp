@@ -3,6 +3,11 @@
 #include <algorithm>
 #include <random>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NOISE_SSE2 1
+#endif
+
 namespace math {
 
 PerlinNoise::PerlinNoise(unsigned int seed) {
@@ -21,6 +26,16 @@ PerlinNoise::PerlinNoise(unsigned int seed) {
         permutation[i] = p[i];
         permutation[256 + i] = p[i];
     }
+
+    // v4.7.0: Corner (X, Z) uses permutation[permutation[permutation[X] + Z]];
+    // both indices wrap at 256, so the whole lattice fits in one table.
+    cornerHash_.resize(256 * 256);
+    for (int X = 0; X < 256; X++) {
+        for (int Z = 0; Z < 256; Z++) {
+            cornerHash_[static_cast<size_t>(X) * 256 + static_cast<size_t>(Z)] =
+                static_cast<uint8_t>(permutation[permutation[permutation[X] + Z]] & 7);
+        }
+    }
 }
 
 float PerlinNoise::fade(float t) {
@@ -90,4 +105,124 @@ float PerlinNoise::octaveNoise(float x, float z, int octaves, float persistence)
     return total / maxValue;  // Normalize to [0, 1]
 }
 
+namespace {
+
+constexpr size_t kOctaveChunk = 256;
+
+#ifdef NOISE_SSE2
+// Same operation order as PerlinNoise::fade / lerp / grad (no FMA contraction)
+inline __m128 fade4(__m128 t) {
+    __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+    return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+}
+
+inline __m128 lerp4(__m128 t, __m128 a, __m128 b) {
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+// h < 4 selects (x, z) else (z, x); bits 0/1 flip the signs (exact)
+inline __m128 grad4(__m128i h, __m128 x, __m128 z) {
+    const __m128 swap = _mm_castsi128_ps(_mm_cmpgt_epi32(h, _mm_set1_epi32(3)));
+    const __m128 u = _mm_or_ps(_mm_andnot_ps(swap, x), _mm_and_ps(swap, z));
+    const __m128 v = _mm_or_ps(_mm_andnot_ps(swap, z), _mm_and_ps(swap, x));
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i signU = _mm_slli_epi32(_mm_and_si128(h, one), 31);
+    const __m128i signV = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(h, 1), one), 31);
+    return _mm_add_ps(_mm_xor_ps(u, _mm_castsi128_ps(signU)), _mm_xor_ps(v, _mm_castsi128_ps(signV)));
+}
+
+// floor() for |x| < 2^31 (truncate, then step down where truncation rounded up)
+inline __m128 floor4(__m128 x) {
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+}
+#endif
+
+} // namespace
+
+void PerlinNoise::noise2DBatch(const float* x, const float* z, float* out, size_t n) const {
+    const uint8_t* hash = cornerHash_.data();
+    size_t i = 0;
+
+#ifdef NOISE_SSE2
+    for (; i + 4 <= n; i += 4) {
+        const __m128 px = _mm_loadu_ps(x + i);
+        const __m128 pz = _mm_loadu_ps(z + i);
+        const __m128 fx = floor4(px);
+        const __m128 fz = floor4(pz);
+
+        alignas(16) int32_t cx[4], cz[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(cx), _mm_and_si128(_mm_cvttps_epi32(fx), _mm_set1_epi32(255)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(cz), _mm_and_si128(_mm_cvttps_epi32(fz), _mm_set1_epi32(255)));
+
+        // Corner selectors: 4 table reads per lane
+        alignas(16) int32_t hAA[4], hBA[4], hAB[4], hBB[4];
+        for (int k = 0; k < 4; ++k) {
+            const size_t X0 = static_cast<size_t>(cx[k]) * 256;
+            const size_t X1 = static_cast<size_t>((cx[k] + 1) & 255) * 256;
+            const size_t Z0 = static_cast<size_t>(cz[k]);
+            const size_t Z1 = static_cast<size_t>((cz[k] + 1) & 255);
+            hAA[k] = hash[X0 + Z0];
+            hBA[k] = hash[X1 + Z0];
+            hAB[k] = hash[X0 + Z1];
+            hBB[k] = hash[X1 + Z1];
+        }
+
+        const __m128 rx = _mm_sub_ps(px, fx);
+        const __m128 rz = _mm_sub_ps(pz, fz);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 rx1 = _mm_sub_ps(rx, one);
+        const __m128 rz1 = _mm_sub_ps(rz, one);
+        const __m128 u = fade4(rx);
+        const __m128 v = fade4(rz);
+
+        const __m128 res = lerp4(v,
+            lerp4(u, grad4(_mm_load_si128(reinterpret_cast<const __m128i*>(hAA)), rx, rz),
+                     grad4(_mm_load_si128(reinterpret_cast<const __m128i*>(hBA)), rx1, rz)),
+            lerp4(u, grad4(_mm_load_si128(reinterpret_cast<const __m128i*>(hAB)), rx, rz1),
+                     grad4(_mm_load_si128(reinterpret_cast<const __m128i*>(hBB)), rx1, rz1)));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(res, one), _mm_set1_ps(0.5f)));
+    }
+#else
+    (void)hash;
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = noise2D(x[i], z[i]);
+    }
+}
+
+void PerlinNoise::octaveNoiseBatch(const float* x, const float* z, float* out, size_t n,
+                                   int octaves, float persistence) const {
+    float sx[kOctaveChunk], sz[kOctaveChunk], layer[kOctaveChunk];
+
+    for (size_t begin = 0; begin < n; begin += kOctaveChunk) {
+        const size_t m = std::min(kOctaveChunk, n - begin);
+        float* total = out + begin;
+        std::fill(total, total + m, 0.0f);
+
+        // Same accumulation order as octaveNoise
+        float frequency = 1.0f;
+        float amplitude = 1.0f;
+        float maxValue = 0.0f;
+        for (int o = 0; o < octaves; o++) {
+            for (size_t k = 0; k < m; ++k) {
+                sx[k] = x[begin + k] * frequency;
+                sz[k] = z[begin + k] * frequency;
+            }
+            noise2DBatch(sx, sz, layer, m);
+            for (size_t k = 0; k < m; ++k) {
+                total[k] += layer[k] * amplitude;
+            }
+            maxValue += amplitude;
+            amplitude *= persistence;
+            frequency *= 2.0f;
+        }
+
+        for (size_t k = 0; k < m; ++k) {
+            total[k] /= maxValue;
+        }
+    }
+}
+
 } // namespace math
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace math {
 
 /**
@@ -34,10 +38,28 @@ public:
      */
     float octaveNoise(float x, float z, int octaves = 4, float persistence = 0.5f) const;
 
+    /**
+     * @brief v4.7.0: noise2D over n points (e.g. a row of cells)
+     *
+     * Bit-identical to calling noise2D per point. Corner gradients come from a
+     * pre-hashed 256x256 table and the arithmetic runs 4 lanes wide (SSE2).
+     */
+    void noise2DBatch(const float* x, const float* z, float* out, size_t n) const;
+
+    /**
+     * @brief v4.7.0: octaveNoise over n points; bit-identical to the scalar path
+     */
+    void octaveNoiseBatch(const float* x, const float* z, float* out, size_t n,
+                          int octaves = 4, float persistence = 0.5f) const;
+
 private:
     // Permutation table for gradient selection
     int permutation[512];
 
+    // v4.7.0: Gradient selector (hash & 7) of lattice corner (X & 255, Z & 255),
+    // i.e. permutation[permutation[permutation[X] + Z]] resolved once per seed
+    std::vector<uint8_t> cornerHash_;
+
     // Fade function for smooth interpolation
     static float fade(float t);
 
@@ -1,5 +1,6 @@
 #include "ml_service.h"
 #include <iostream>
+#include <algorithm>
 
 namespace ml {
 
@@ -31,13 +32,29 @@ void MLService::init() {
         return 0.0f; // Default if model missing
     }
 
+    ModelHandle MLService::getModel(const std::string& modelName) const {
+        auto it = models_.find(modelName);
+        return it != models_.end() ? it->second.get() : nullptr;
+    }
+
+    void MLService::predictBatch(ModelHandle model, const float* const cols[], size_t n, float* out) const {
+        if (!model) {
+            std::fill(out, out + n, 0.0f); // Default if model missing
+            return;
+        }
+        model->inferBatch(cols, n, out);
+    }
+
     // Soil Color Wrapper (Maintains backward compatibility for UI)
     Eigen::Vector3f MLService::predictSoilColor(float n, float p, float k, float ph) const {
         Eigen::VectorXf input(4);
         input << n, p, k, ph;
         
         float output = predict("soil_color", input);
-        
+        return soilColorRamp(output);
+    }
+
+    Eigen::Vector3f MLService::soilColorRamp(float output) {
         // Map scalar [0,1] to Color Gradient (Blue -> Yellow -> Red)
         // 0.0 (Wet/Shallow) -> Blue
         // 0.5 (Mesic) -> Yellow
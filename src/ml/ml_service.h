@@ -8,6 +8,10 @@
 
 namespace ml {
 
+// v4.7.0: Resolved model reference for hot loops (avoids per-call name lookup).
+// Invalidated if the model is reloaded or recreated.
+using ModelHandle = const Perceptron*;
+
 class MLService {
 public:
     MLService();
@@ -24,9 +28,19 @@ public:
     // Returns scalar output [0-1]
     float predict(const std::string& modelName, const Eigen::VectorXf& inputs) const;
 
+    // v4.7.0: Look up a model once; nullptr if missing
+    ModelHandle getModel(const std::string& modelName) const;
+
+    // v4.7.0: Batched prediction over SoA inputs (cols[j] = feature j for all n samples).
+    // Missing model -> outputs 0 (same default as predict).
+    void predictBatch(ModelHandle model, const float* const cols[], size_t n, float* out) const;
+
     // Helper: Soil Color specific wrapper (keeps existing UI code working)
     Eigen::Vector3f predictSoilColor(float n, float p, float k, float ph) const;
 
+    // Maps a soil_color model output [0,1] to the Blue -> Yellow -> Red ramp
+    static Eigen::Vector3f soilColorRamp(float output);
+
     // Helper: Runoff specific wrapper
     float predictRunoff(float rain, float infil, float biomass) const;
 
@@ -1,4 +1,6 @@
 #include "perceptron.h"
+#include "../core/job_system.h"
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -22,6 +24,28 @@ float Perceptron::infer(const Eigen::VectorXf& input) const {
     return sigmoid(z);
 }
 
+void Perceptron::inferBatch(const float* const* cols, size_t n, float* out) const {
+    constexpr size_t kBlock = 1024;
+    const Eigen::Index features = weights_.size();
+    const size_t blocks = (n + kBlock - 1) / kBlock;
+
+    core::JobSystem::instance().parallelFor(0, static_cast<int>(blocks), 0, [&](int blockBegin, int blockEnd) {
+        for (int b = blockBegin; b < blockEnd; ++b) {
+            const size_t start = static_cast<size_t>(b) * kBlock;
+            const Eigen::Index len = static_cast<Eigen::Index>(std::min(kBlock, n - start));
+
+            // z = X_block * w + bias, accumulated column by column (SoA -> contiguous loads)
+            Eigen::Map<Eigen::ArrayXf> z(out + start, len);
+            z.setConstant(bias_);
+            for (Eigen::Index j = 0; j < features; ++j) {
+                Eigen::Map<const Eigen::ArrayXf> col(cols[j] + start, len);
+                z += weights_[j] * col;
+            }
+            z = 1.0f / (1.0f + (-z).exp());
+        }
+    });
+}
+
 bool Perceptron::load(const std::string& path) {
     std::ifstream file(path);
     if (!file.is_open()) {
@@ -57,6 +81,11 @@ bool Perceptron::load(const std::string& path) {
     }
 }
 
+    void Perceptron::setWeights(const Eigen::VectorXf& weights, float bias) {
+        weights_ = weights;
+        bias_ = bias;
+    }
+
     float Perceptron::sigmoidPrime(float z) {
         float s = sigmoid(z);
         return s * (1.0f - s);
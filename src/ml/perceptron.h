@@ -19,9 +19,17 @@ public:
     // Returns probability [0.0 - 1.0]
     float infer(const Eigen::VectorXf& input) const;
 
+    // v4.7.0: Batched inference over column-major (SoA) inputs.
+    // cols[j][i] is feature j of sample i; writes n probabilities to out.
+    // Processes fixed-size blocks as a matrix-vector product (parallel over blocks).
+    void inferBatch(const float* const* cols, size_t n, float* out) const;
+
     // Load pre-trained weights from JSON
     bool load(const std::string& path);
 
+    // Set weights directly (models built in code); the input size follows weights.size()
+    void setWeights(const Eigen::VectorXf& weights, float bias);
+
     // Getters for inspection
     int getInputSize() const { return static_cast<int>(weights_.size()); }
 
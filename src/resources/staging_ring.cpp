@@ -0,0 +1,91 @@
+#include "staging_ring.h"
+#include <stdexcept>
+
+namespace resources {
+
+StagingRing::StagingRing(const core::GraphicsContext& context, VkDeviceSize slotSize, uint32_t slotCount)
+    : ctx_(context), pool_(context, context.queueFamilyIndex()), slotSize_(slotSize) {
+    if (slotCount == 0) slotCount = 1;
+
+    std::vector<VkCommandBuffer> cmds = pool_.allocate(slotCount);
+    entries_.resize(slotCount);
+
+    for (uint32_t i = 0; i < slotCount; ++i) {
+        Entry& e = entries_[i];
+        e.buffer = std::make_unique<Buffer>(
+            ctx_, slotSize_,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (vkCreateFence(ctx_.device(), &fenceInfo, nullptr, &e.fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create staging ring fence!");
+        }
+
+        e.slot.buffer = e.buffer->handle();
+        e.slot.data = static_cast<uint8_t*>(e.buffer->map()); // Persistent mapping
+        e.slot.size = slotSize_;
+        e.slot.cmd = cmds[i];
+    }
+}
+
+StagingRing::~StagingRing() {
+    waitAll();
+    for (auto& e : entries_) {
+        if (e.fence != VK_NULL_HANDLE) vkDestroyFence(ctx_.device(), e.fence, nullptr);
+        if (e.buffer) e.buffer->unmap();
+    }
+    // Command buffers are freed with pool_
+}
+
+StagingRing::Slot& StagingRing::acquire() {
+    Entry& e = entries_[next_];
+    next_ = (next_ + 1) % static_cast<uint32_t>(entries_.size());
+
+    if (e.pending) {
+        // Back-pressure on this slot only (not vkDeviceWaitIdle)
+        vkWaitForFences(ctx_.device(), 1, &e.fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(ctx_.device(), 1, &e.fence);
+        e.pending = false;
+    }
+
+    vkResetCommandBuffer(e.slot.cmd, 0);
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(e.slot.cmd, &beginInfo);
+
+    return e.slot;
+}
+
+void StagingRing::submit(Slot& slot) {
+    for (auto& e : entries_) {
+        if (&e.slot != &slot) continue;
+
+        vkEndCommandBuffer(slot.cmd);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &slot.cmd;
+
+        if (vkQueueSubmit(ctx_.graphicsQueue(), 1, &submitInfo, e.fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit staging upload!");
+        }
+        e.pending = true;
+        return;
+    }
+}
+
+void StagingRing::waitAll() {
+    for (auto& e : entries_) {
+        if (!e.pending) continue;
+        vkWaitForFences(ctx_.device(), 1, &e.fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(ctx_.device(), 1, &e.fence);
+        e.pending = false;
+    }
+}
+
+} // namespace resources
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "buffer.h"
+#include "../core/command_pool.h"
+#include <memory>
+#include <vector>
+
+namespace resources {
+
+/**
+ * @brief Ring of persistently-mapped staging buffers for streaming uploads.
+ *
+ * Each slot owns a host-visible buffer (mapped once for its lifetime), a
+ * command buffer and a fence. acquire() only waits for the fence of the
+ * slot being reused, so uploads never stall the whole device; with N slots
+ * up to N transfers can be in flight while the CPU fills the next one.
+ *
+ * Typical use:
+ * @code
+ *   auto& slot = ring.acquire();
+ *   memcpy(slot.data, src, bytes);           // or encode in place
+ *   vkCmdCopyBuffer(slot.cmd, slot.buffer, dst, ...);
+ *   ring.submit(slot);
+ * @endcode
+ */
+class StagingRing {
+public:
+    struct Slot {
+        VkBuffer buffer = VK_NULL_HANDLE;   ///< Transfer source
+        uint8_t* data = nullptr;            ///< Persistently mapped (host-coherent)
+        VkDeviceSize size = 0;
+        VkCommandBuffer cmd = VK_NULL_HANDLE; ///< Already in recording state after acquire()
+    };
+
+    /**
+     * @param slotSize Bytes per staging buffer
+     * @param slotCount Number of buffers in the ring (>= 2 to overlap CPU and GPU)
+     */
+    StagingRing(const core::GraphicsContext& context, VkDeviceSize slotSize, uint32_t slotCount = 3);
+    ~StagingRing();
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    /**
+     * @brief Takes the next slot, waiting only on that slot's previous upload,
+     * and begins its command buffer.
+     */
+    Slot& acquire();
+
+    /**
+     * @brief Ends the slot's command buffer and submits it with the slot fence.
+     */
+    void submit(Slot& slot);
+
+    /**
+     * @brief Blocks until every submitted slot has completed (used before teardown).
+     */
+    void waitAll();
+
+    VkDeviceSize slotSize() const { return slotSize_; }
+
+private:
+    struct Entry {
+        std::unique_ptr<Buffer> buffer;
+        VkFence fence = VK_NULL_HANDLE;
+        bool pending = false;
+        Slot slot;
+    };
+
+    const core::GraphicsContext& ctx_;
+    core::CommandPool pool_;
+    VkDeviceSize slotSize_;
+    std::vector<Entry> entries_;
+    uint32_t next_ = 0;
+};
+
+} // namespace resources
@@ -0,0 +1,470 @@
+#include "dem_importer.h"
+#include "regeneration_graph.h"
+#include "world_snapshot.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+namespace terrain {
+
+namespace {
+
+using HeaderFields = std::map<std::string, std::string>;
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+std::string lower(std::string s) {
+    for (char& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+void setError(std::string* error, const std::string& message) {
+    if (error) *error = message;
+}
+
+// "key value" lines until the first line that starts with a number (ASCII grid data);
+// returns the offset of that line (or `size` for a pure header file)
+size_t parseHeader(const char* text, size_t size, HeaderFields& fields) {
+    size_t pos = 0;
+    while (pos < size) {
+        size_t lineEnd = pos;
+        while (lineEnd < size && text[lineEnd] != '\n') ++lineEnd;
+        size_t p = pos;
+        while (p < lineEnd && isSpace(text[p])) ++p;
+        if (p < lineEnd) {
+            const char c = text[p];
+            if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.') return pos;
+            size_t keyEnd = p;
+            while (keyEnd < lineEnd && !isSpace(text[keyEnd])) ++keyEnd;
+            size_t v = keyEnd;
+            while (v < lineEnd && isSpace(text[v])) ++v;
+            size_t vEnd = lineEnd;
+            while (vEnd > v && isSpace(text[vEnd - 1])) --vEnd;
+            fields[lower(std::string(text + p, keyEnd - p))] = std::string(text + v, vEnd - v);
+        }
+        pos = lineEnd + 1;
+    }
+    return size;
+}
+
+bool fieldNumber(const HeaderFields& fields, const char* key, double& out) {
+    auto it = fields.find(key);
+    if (it == fields.end()) return false;
+    // Header values may need more than float precision (coordinates)
+    char* parsedEnd = nullptr;
+    out = std::strtod(it->second.c_str(), &parsedEnd);
+    return parsedEnd != it->second.c_str();
+}
+
+// Shared by .asc headers and .hdr sidecars
+bool readGridHeader(const HeaderFields& fields, DemGrid& grid, std::string* error) {
+    double ncols = 0, nrows = 0, cellSize = 0, nodata = 0;
+    if (!fieldNumber(fields, "ncols", ncols) || !fieldNumber(fields, "nrows", nrows)) {
+        setError(error, "missing ncols/nrows");
+        return false;
+    }
+    if (!fieldNumber(fields, "cellsize", cellSize)) {
+        // Rectangular cells are averaged (terrain cells are square)
+        double dx = 0, dy = 0;
+        if (fieldNumber(fields, "dx", dx) && fieldNumber(fields, "dy", dy)) cellSize = 0.5 * (dx + dy);
+    }
+    if (ncols < 2 || nrows < 2 || ncols > 1e6 || nrows > 1e6 || !(cellSize > 0.0)) {
+        setError(error, "invalid dimensions or cell size");
+        return false;
+    }
+    grid.width = static_cast<int>(ncols);
+    grid.height = static_cast<int>(nrows);
+    grid.cellSize = cellSize;
+
+    double corner = 0;
+    if (fieldNumber(fields, "xllcorner", corner)) grid.xllCorner = corner;
+    else if (fieldNumber(fields, "xllcenter", corner)) grid.xllCorner = corner - 0.5 * cellSize;
+    if (fieldNumber(fields, "yllcorner", corner)) grid.yllCorner = corner;
+    else if (fieldNumber(fields, "yllcenter", corner)) grid.yllCorner = corner - 0.5 * cellSize;
+
+    grid.hasNodata = fieldNumber(fields, "nodata_value", nodata) || fieldNumber(fields, "nodata", nodata);
+    if (grid.hasNodata) {
+        // Compare against the value as the data parser would produce it
+        const std::string& text = fields.count("nodata_value") ? fields.at("nodata_value") : fields.at("nodata");
+        float v = static_cast<float>(nodata);
+        DemImporter::parseFloat(text.data(), text.data() + text.size(), v);
+        grid.nodata = v;
+    }
+    return true;
+}
+
+bool isAsciiGrid(const std::string& path) {
+    return lower(std::filesystem::path(path).extension().string()) == ".asc";
+}
+
+std::string sidecarPath(const std::string& path) {
+    return std::filesystem::path(path).replace_extension(".hdr").string();
+}
+
+bool readSidecar(const std::string& path, HeaderFields& fields, std::string* error) {
+    MappedFile hdr;
+    if (!hdr.open(sidecarPath(path))) {
+        setError(error, "missing header sidecar " + sidecarPath(path));
+        return false;
+    }
+    parseHeader(reinterpret_cast<const char*>(hdr.data()), hdr.size(), fields);
+    return true;
+}
+
+bool readAscii(const MappedFile& file, DemGrid& grid, std::string* error) {
+    const char* text = reinterpret_cast<const char*>(file.data());
+    HeaderFields fields;
+    const size_t dataOffset = parseHeader(text, file.size(), fields);
+    if (!readGridHeader(fields, grid, error)) return false;
+
+    const size_t count = static_cast<size_t>(grid.width) * static_cast<size_t>(grid.height);
+    grid.heights.assign(count, 0.0f);
+    const char* data = text + dataOffset;
+    const char* end = text + file.size();
+
+    // Chunks end on whitespace so no number straddles two of them
+    const size_t bytes = static_cast<size_t>(end - data);
+    const int chunks = static_cast<int>(std::max<size_t>(1, std::min<size_t>(bytes / (256 * 1024), static_cast<size_t>(core::JobSystem::instance().threadCount()) * 8)));
+    std::vector<const char*> bounds(static_cast<size_t>(chunks) + 1);
+    bounds[0] = data;
+    bounds[static_cast<size_t>(chunks)] = end;
+    for (int k = 1; k < chunks; ++k) {
+        const char* b = data + bytes * static_cast<size_t>(k) / static_cast<size_t>(chunks);
+        while (b < end && !isSpace(*b)) ++b;
+        bounds[static_cast<size_t>(k)] = std::max(b, bounds[static_cast<size_t>(k) - 1]);
+    }
+
+    // Pass 1: values per chunk -> where each chunk starts in the grid
+    std::vector<size_t> starts(static_cast<size_t>(chunks) + 1, 0);
+    core::JobSystem::instance().parallelFor(0, chunks, 1, [&](int chunkBegin, int chunkEnd) {
+        for (int k = chunkBegin; k < chunkEnd; ++k) {
+            size_t n = 0;
+            bool inToken = false;
+            for (const char* p = bounds[static_cast<size_t>(k)]; p < bounds[static_cast<size_t>(k) + 1]; ++p) {
+                const bool space = isSpace(*p);
+                n += (!space && !inToken) ? 1 : 0;
+                inToken = !space;
+            }
+            starts[static_cast<size_t>(k) + 1] = n;
+        }
+    });
+    for (int k = 0; k < chunks; ++k) starts[static_cast<size_t>(k) + 1] += starts[static_cast<size_t>(k)];
+    if (starts[static_cast<size_t>(chunks)] != count) {
+        setError(error, "expected " + std::to_string(count) + " values, found " + std::to_string(starts[static_cast<size_t>(chunks)]));
+        return false;
+    }
+
+    // Pass 2: parse in place
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::atomic<bool> malformed{false};
+    core::JobSystem::instance().parallelFor(0, chunks, 1, [&](int chunkBegin, int chunkEnd) {
+        for (int k = chunkBegin; k < chunkEnd; ++k) {
+            float* out = grid.heights.data() + starts[static_cast<size_t>(k)];
+            const char* p = bounds[static_cast<size_t>(k)];
+            const char* e = bounds[static_cast<size_t>(k) + 1];
+            while (p < e) {
+                while (p < e && isSpace(*p)) ++p;
+                if (p >= e) break;
+                float v = 0.0f;
+                const char* q = DemImporter::parseFloat(p, e, v);
+                if (q == p || (q < e && !isSpace(*q))) {
+                    malformed = true;
+                    break;
+                }
+                *out++ = (grid.hasNodata && v == grid.nodata) ? nan : v;
+                p = q;
+            }
+        }
+    });
+    if (malformed.load()) {
+        setError(error, "malformed number in grid data");
+        return false;
+    }
+    return true;
+}
+
+bool readBinary(const std::string& path, const MappedFile& file, DemGrid& grid, std::string* error) {
+    HeaderFields fields;
+    if (!readSidecar(path, fields, error) || !readGridHeader(fields, grid, error)) return false;
+
+    double nbits = 32, skip = 0;
+    fieldNumber(fields, "nbits", nbits);
+    fieldNumber(fields, "skipbytes", skip);
+    const std::string pixelType = fields.count("pixeltype") ? lower(fields.at("pixeltype")) : (nbits == 32 ? "float" : "signedint");
+    const std::string byteOrder = fields.count("byteorder") ? lower(fields.at("byteorder")) : "lsbfirst";
+    const bool bigEndian = byteOrder == "m" || byteOrder == "msbfirst";
+    const bool isFloat32 = nbits == 32 && pixelType == "float";
+    const bool isInt16 = nbits == 16 && pixelType == "signedint";
+    if (!isFloat32 && !isInt16) {
+        setError(error, "unsupported pixel type (need 32-bit float or 16-bit signed int)");
+        return false;
+    }
+
+    const size_t count = static_cast<size_t>(grid.width) * static_cast<size_t>(grid.height);
+    const size_t valueBytes = isFloat32 ? 4 : 2;
+    const size_t offset = static_cast<size_t>(skip);
+    if (file.size() < offset || (file.size() - offset) / valueBytes < count) {
+        setError(error, "file shorter than ncols * nrows values");
+        return false;
+    }
+
+    grid.heights.assign(count, 0.0f);
+    const unsigned char* src = file.data() + offset;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const int rows = grid.height;
+    const size_t cols = static_cast<size_t>(grid.width);
+    core::JobSystem::instance().parallelFor(0, rows, 0, [&](int rowBegin, int rowEnd) {
+        for (int r = rowBegin; r < rowEnd; ++r) {
+            for (size_t c = 0; c < cols; ++c) {
+                const size_t i = static_cast<size_t>(r) * cols + c;
+                unsigned char b[4];
+                std::memcpy(b, src + i * valueBytes, valueBytes);
+                if (bigEndian) std::reverse(b, b + valueBytes);
+                float v;
+                if (isFloat32) {
+                    std::memcpy(&v, b, 4);
+                } else {
+                    int16_t s;
+                    std::memcpy(&s, b, 2);
+                    v = static_cast<float>(s);
+                }
+                grid.heights[i] = (grid.hasNodata && v == grid.nodata) ? nan : v;
+            }
+        }
+    });
+    return true;
+}
+
+} // namespace
+
+const char* DemImporter::parseFloat(const char* p, const char* end, float& value) {
+    static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* q = p;
+    bool negative = false;
+    if (q < end && (*q == '-' || *q == '+')) {
+        negative = *q == '-';
+        ++q;
+    }
+
+    // Up to 19 significant digits in an integer mantissa; the rest only shift the exponent
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; q < end && *q >= '0' && *q <= '9'; ++q) {
+        any = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*q - '0');
+            digits += mantissa != 0 ? 1 : 0;
+        } else {
+            ++exponent;
+        }
+    }
+    if (q < end && *q == '.') {
+        for (++q; q < end && *q >= '0' && *q <= '9'; ++q) {
+            any = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*q - '0');
+                digits += mantissa != 0 ? 1 : 0;
+                --exponent;
+            }
+        }
+    }
+    if (!any) return p;
+
+    if (q < end && (*q == 'e' || *q == 'E')) {
+        const char* e = q + 1;
+        bool expNegative = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            expNegative = *e == '-';
+            ++e;
+        }
+        if (e < end && *e >= '0' && *e <= '9') {
+            int exp = 0;
+            for (; e < end && *e >= '0' && *e <= '9'; ++e) exp = std::min(exp * 10 + (*e - '0'), 1000);
+            exponent += expNegative ? -exp : exp;
+            q = e;
+        }
+    }
+
+    double v = static_cast<double>(mantissa);
+    if (mantissa != 0) {
+        if (exponent >= 0 && exponent <= 22) v *= kPow10[exponent];
+        else if (exponent < 0 && exponent >= -22) v /= kPow10[-exponent];
+        else v *= std::pow(10.0, exponent);
+    }
+    value = static_cast<float>(negative ? -v : v);
+    return q;
+}
+
+bool DemImporter::probe(const std::string& path, DemGrid& header, std::string* error) {
+    HeaderFields fields;
+    if (isAsciiGrid(path)) {
+        MappedFile file;
+        if (!file.open(path)) {
+            setError(error, "cannot open " + path);
+            return false;
+        }
+        // The header is a handful of short lines at the top
+        parseHeader(reinterpret_cast<const char*>(file.data()), std::min<size_t>(file.size(), 4096), fields);
+    } else if (!readSidecar(path, fields, error)) {
+        return false;
+    }
+    return readGridHeader(fields, header, error);
+}
+
+bool DemImporter::read(const std::string& path, DemGrid& grid, std::string* error) {
+    auto t0 = std::chrono::steady_clock::now();
+    MappedFile file;
+    if (!file.open(path)) {
+        setError(error, "cannot open " + path);
+        return false;
+    }
+    const bool ok = isAsciiGrid(path) ? readAscii(file, grid, error) : readBinary(path, file, grid, error);
+    if (!ok) return false;
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[DemImporter] Read " << grid.width << "x" << grid.height << " DEM (" << grid.cellSize
+              << " m cells) from " << path << " in " << ms << " ms" << std::endl;
+    return true;
+}
+
+bool DemImporter::fillNodata(DemGrid& grid, size_t* filled) {
+    // Pull: average valid cells up a 2x2 pyramid. Push: empty cells take their parent's value.
+    struct Level {
+        int w, h;
+        std::vector<float> value, weight;
+    };
+    std::vector<Level> levels(1);
+    Level& base = levels[0];
+    base.w = grid.width;
+    base.h = grid.height;
+    base.value.resize(grid.heights.size());
+    base.weight.resize(grid.heights.size());
+    size_t missing = 0;
+    for (size_t i = 0; i < grid.heights.size(); ++i) {
+        const bool valid = !std::isnan(grid.heights[i]);
+        base.value[i] = valid ? grid.heights[i] : 0.0f;
+        base.weight[i] = valid ? 1.0f : 0.0f;
+        missing += valid ? 0 : 1;
+    }
+    if (filled) *filled = missing;
+    if (missing == 0) return true;
+    if (missing == grid.heights.size()) return false;
+
+    while (levels.back().w > 1 || levels.back().h > 1) {
+        const Level& fine = levels.back();
+        Level coarse;
+        coarse.w = (fine.w + 1) / 2;
+        coarse.h = (fine.h + 1) / 2;
+        const size_t fw = static_cast<size_t>(fine.w);
+        const size_t fh = static_cast<size_t>(fine.h);
+        const size_t cw = static_cast<size_t>(coarse.w);
+        coarse.value.assign(cw * static_cast<size_t>(coarse.h), 0.0f);
+        coarse.weight.assign(coarse.value.size(), 0.0f);
+        for (size_t y = 0; y < fh; ++y) {
+            for (size_t x = 0; x < fw; ++x) {
+                const size_t fi = y * fw + x;
+                const size_t ci = (y / 2) * cw + x / 2;
+                coarse.value[ci] += fine.value[fi] * fine.weight[fi];
+                coarse.weight[ci] += fine.weight[fi];
+            }
+        }
+        for (size_t i = 0; i < coarse.value.size(); ++i) {
+            if (coarse.weight[i] > 0.0f) coarse.value[i] /= coarse.weight[i];
+            coarse.weight[i] = std::min(coarse.weight[i], 1.0f);
+        }
+        levels.push_back(std::move(coarse));
+    }
+
+    for (size_t k = levels.size() - 1; k-- > 0;) {
+        Level& fine = levels[k];
+        const Level& coarse = levels[k + 1];
+        const size_t fw = static_cast<size_t>(fine.w);
+        const size_t fh = static_cast<size_t>(fine.h);
+        const size_t cw = static_cast<size_t>(coarse.w);
+        for (size_t y = 0; y < fh; ++y) {
+            for (size_t x = 0; x < fw; ++x) {
+                const size_t fi = y * fw + x;
+                if (fine.weight[fi] > 0.0f) continue;
+                fine.value[fi] = coarse.value[(y / 2) * cw + x / 2];
+                fine.weight[fi] = 1.0f;
+            }
+        }
+    }
+    const std::vector<float>& result = levels[0].value; // `base` dangles after the pyramid grew
+    for (size_t i = 0; i < grid.heights.size(); ++i) {
+        if (std::isnan(grid.heights[i])) grid.heights[i] = result[i];
+    }
+    return true;
+}
+
+void DemImporter::targetSize(const DemGrid& grid, float resolution, int& width, int& height) {
+    const double step = static_cast<double>(resolution) / grid.cellSize;
+    width = static_cast<int>(std::floor((grid.width - 1) / step + 1e-6)) + 1;
+    height = static_cast<int>(std::floor((grid.height - 1) / step + 1e-6)) + 1;
+}
+
+void DemImporter::resample(const DemGrid& grid, int width, int height, float resolution, core::GridVector<float>& out) {
+    out.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+    const float step = static_cast<float>(resolution / grid.cellSize);
+    const int gw = grid.width;
+    const int gh = grid.height;
+    const size_t srcStride = static_cast<size_t>(gw);
+    const size_t dstStride = static_cast<size_t>(width);
+    const float* src = grid.heights.data();
+
+    core::JobSystem::instance().parallelFor(0, height, 0, [&](int rowBegin, int rowEnd) {
+        for (int z = rowBegin; z < rowEnd; ++z) {
+            const float v = std::min(static_cast<float>(z) * step, static_cast<float>(gh - 1));
+            const int y0 = std::min(static_cast<int>(v), gh - 2);
+            const float fy = v - static_cast<float>(y0);
+            const float* r0 = src + static_cast<size_t>(y0) * srcStride;
+            const float* r1 = r0 + srcStride;
+            float* dst = out.data() + static_cast<size_t>(z) * dstStride;
+            for (int x = 0; x < width; ++x) {
+                const float u = std::min(static_cast<float>(x) * step, static_cast<float>(gw - 1));
+                const int x0 = std::min(static_cast<int>(u), gw - 2);
+                const float fx = u - static_cast<float>(x0);
+                const float top = r0[x0] + (r0[x0 + 1] - r0[x0]) * fx;
+                const float bottom = r1[x0] + (r1[x0 + 1] - r1[x0]) * fx;
+                dst[x] = top + (bottom - top) * fy;
+            }
+        }
+    });
+}
+
+void DemImporter::importHeights(const std::string& path, int width, int height, float resolution,
+                                core::GridVector<float>& out, RegenerationControl* control) {
+    DemGrid grid;
+    std::string error;
+    if (!read(path, grid, &error)) {
+        throw std::runtime_error("DEM import failed (" + path + "): " + error);
+    }
+    if (control) control->checkpoint();
+
+    size_t filled = 0;
+    if (!fillNodata(grid, &filled)) {
+        throw std::runtime_error("DEM import failed (" + path + "): no valid elevation");
+    }
+    if (filled > 0) std::cout << "[DemImporter] Filled " << filled << " nodata cells." << std::endl;
+    if (control) control->checkpoint();
+
+    resample(grid, width, height, resolution, out);
+}
+
+} // namespace terrain
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../core/grid_arena.h"
+
+namespace terrain {
+
+class RegenerationControl;
+
+// v4.7.0: Elevation raster as stored in the file (row 0 = northernmost row)
+struct DemGrid {
+    int width = 0;            // Columns
+    int height = 0;           // Rows
+    double cellSize = 1.0;    // Metres per cell
+    double xllCorner = 0.0;   // Lower-left corner (informational)
+    double yllCorner = 0.0;
+    bool hasNodata = false;
+    float nodata = -9999.0f;
+    std::vector<float> heights; // Row-major; nodata cells are NaN after read()
+};
+
+/**
+ * @brief v4.7.0: Streaming importer for real elevation data.
+ *
+ * Formats:
+ *   .asc                  ESRI ASCII grid (ncols/nrows/xllcorner|xllcenter/
+ *                         yllcorner|yllcenter/cellsize/[nodata_value] header)
+ *   .flt/.bil/.raw/other  binary raster with an ESRI-style .hdr sidecar (same
+ *                         keys plus nbits 16|32, pixeltype float|signedint,
+ *                         byteorder lsbfirst|msbfirst); 32 bits default to float
+ *
+ * Files are memory mapped and never copied whole. ASCII values are parsed by
+ * a hand-written number scanner in parallel chunks: a counting pass finds where
+ * each chunk starts in the grid, a second pass parses straight into place.
+ */
+class DemImporter {
+public:
+    // Header only (dimensions, cell size, nodata); cheap even for huge files
+    static bool probe(const std::string& path, DemGrid& header, std::string* error = nullptr);
+
+    // Header and values; nodata cells become NaN
+    static bool read(const std::string& path, DemGrid& grid, std::string* error = nullptr);
+
+    // Replaces NaN cells by pull-push interpolation of the valid ones; returns the
+    // number of filled cells. False if the grid has no valid cell at all.
+    static bool fillNodata(DemGrid& grid, size_t* filled = nullptr);
+
+    // Lattice covering the DEM extent at `resolution` metres per cell
+    static void targetSize(const DemGrid& grid, float resolution, int& width, int& height);
+
+    // Bilinear samples on a width x height lattice, `resolution` metres apart,
+    // starting at the centre of the north-west cell (clamped at the far edges)
+    static void resample(const DemGrid& grid, int width, int height, float resolution, core::GridVector<float>& out);
+
+    /**
+     * @brief Full import for TerrainGenerator: read, fill nodata, resample.
+     * Throws std::runtime_error with the reason if the file cannot be used.
+     * With a control, throws RegenerationCancelled between passes once cancelled.
+     */
+    static void importHeights(const std::string& path, int width, int height, float resolution,
+                              core::GridVector<float>& out, RegenerationControl* control = nullptr);
+
+    // Decimal number scanner (sign, digits, fraction, exponent; "nan"/"inf" not accepted).
+    // Returns the position after the number, or `p` itself if there is none.
+    static const char* parseFloat(const char* p, const char* end, float& value);
+};
+
+} // namespace terrain
@@ -1,5 +1,6 @@
 #include "hydrology_report.h"
 #include "terrain_map.h"
+#include "../core/job_system.h"
 #include <cmath>
 #include <fstream>
 #include <algorithm>
@@ -47,6 +48,49 @@ float HydrologyReport::calculateSlope(const TerrainMap& map, int x, int y) {
     return maxSlope;
 }
 
+HydrologyReport::WetnessTerms HydrologyReport::twiAt(const TerrainMap& map, int x, int y, float resolution) {
+    const int dx[] = {0, 1, 1, 1, 0, -1, -1, -1};
+    const int dy[] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    const float distMult[] = {1.0f, 1.41421356f, 1.0f, 1.41421356f, 1.0f, 1.41421356f, 1.0f, 1.41421356f};
+
+    // 1. Slope: Max Drop / (Dist * Res); a local flat/pit keeps slope = 0
+    const float elev = map.getHeight(x, y);
+    float maxSlope = 0.0f;
+    for (int i = 0; i < 8; ++i) {
+        const int nx = x + dx[i];
+        const int ny = y + dy[i];
+        if (!map.isValid(nx, ny)) continue;
+        const float drop = elev - map.getHeight(nx, ny);
+        if (drop > 0) maxSlope = std::max(maxSlope, drop / (distMult[i] * resolution));
+    }
+
+    // 2. Specific Catchment Area (a)
+    // a = CatchmentArea / ContourWidth
+    // CatchmentArea = FluxCells * CellArea = FluxCells * Res * Res
+    // ContourWidth ~= Resolution (approx)
+    // So a = FluxCells * Res
+    const float specificArea = map.getFlux(x, y) * resolution;
+
+    // 3. TWI = ln(a / tanB)
+    const float tanB = std::max(maxSlope, 0.001f); // Avoid div by zero, 0.1% slope min
+    return {maxSlope, specificArea, std::log(specificArea / tanB)};
+}
+
+void HydrologyReport::computeTWI(const TerrainMap& map, float resolution, std::vector<float>& out) {
+    if (resolution <= 0.0f) resolution = 1.0f;
+    const int w = map.getWidth();
+    const int h = map.getHeight();
+    const size_t stride = static_cast<size_t>(w);
+    out.resize(stride * static_cast<size_t>(h));
+
+    core::JobSystem::instance().parallelFor(0, h, 0, [&](int rowBegin, int rowEnd) {
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            float* row = out.data() + static_cast<size_t>(y) * stride;
+            for (int x = 0; x < w; ++x) row[x] = twiAt(map, x, y, resolution).twi;
+        }
+    });
+}
+
 HydrologyStats HydrologyReport::analyze(const TerrainMap& map, float resolution, float streamThreshold) {
     if (resolution <= 0.0f) resolution = 1.0f;
     float cellArea = resolution * resolution;
@@ -85,145 +129,177 @@ HydrologyStats HydrologyReport::analyze(const TerrainMap& map, float resolution,
     };
     std::map<int, Accumulator> basinAccMap;
     
-    // Directions and Distances for Slope/Length
-    const int dx[] = {0, 1, 1, 1, 0, -1, -1, -1};
-    const int dy[] = {-1, -1, 0, 1, 1, 1, 0, -1};
-    const float distMult[] = {1.0f, 1.41421356f, 1.0f, 1.41421356f, 1.0f, 1.41421356f, 1.0f, 1.41421356f};
-
-    double g_sumElev = 0.0;
-    double g_sumSlope = 0.0;
-    double g_sumTWI = 0.0;
-    int g_twiCount = 0;
-    float g_streamLength = 0.0f; // Physical Length in Meters
-
-    for (int y = 0; y < h; ++y) {
-        for (int x = 0; x < w; ++x) {
-            float elev = map.getHeight(x, y);
-            float fluxCells = map.getFlux(x, y);
-            int idx = y * w + x;
-            int bid = !map.watershedMap().empty() ? map.watershedMap()[idx] : 0;
-
-            // --- PHYSICAL PARAMETERS ---
-            // 1. Slope: Max Drop / (Dist * Res)
-            float maxSlope = 0.0f;
-            for (int i = 0; i < 8; ++i) {
-                int nx = x + dx[i];
-                int ny = y + dy[i];
-                if (map.isValid(nx, ny)) {
-                    float drop = elev - map.getHeight(nx, ny);
-                    if (drop > 0) {
-                        float dist = distMult[i] * resolution;
-                        float s = drop / dist;
-                        if (s > maxSlope) maxSlope = s;
+    // v4.7.0: Bands of rows on the job system, merged in band order. The band
+    // height is fixed so the sums do not depend on the number of threads.
+    constexpr int kBandRows = 16;
+    struct Band {
+        HydrologyStats stats;
+        Accumulator acc;
+        std::map<int, HydrologyStats> basinStats;
+        std::map<int, Accumulator> basinAcc;
+    };
+    std::vector<Band> partial(static_cast<size_t>((h + kBandRows - 1) / kBandRows));
+
+    core::JobSystem::instance().parallelFor(0, static_cast<int>(partial.size()), 1, [&](int bandBegin, int bandEnd) {
+        for (int b = bandBegin; b < bandEnd; ++b) {
+            Band& band = partial[static_cast<size_t>(b)];
+            band.stats.initRanges();
+            HydrologyStats& globalStats = band.stats;
+            std::map<int, HydrologyStats>& basinStatsMap = band.basinStats;
+            std::map<int, Accumulator>& basinAccMap = band.basinAcc;
+            double& g_sumElev = band.acc.sumElev;
+            double& g_sumSlope = band.acc.sumSlope;
+            double& g_sumTWI = band.acc.sumTWI;
+            int& g_twiCount = band.acc.twiCount;
+            float& g_streamLength = band.acc.streamLength;
+
+            for (int y = b * kBandRows; y < std::min(h, (b + 1) * kBandRows); ++y) {
+                for (int x = 0; x < w; ++x) {
+                    float elev = map.getHeight(x, y);
+                    float fluxCells = map.getFlux(x, y);
+                    int idx = y * w + x;
+                    int bid = !map.watershedMap().empty() ? map.watershedMap()[idx] : 0;
+
+                    // --- PHYSICAL PARAMETERS ---
+                    const WetnessTerms terms = twiAt(map, x, y, resolution);
+                    const float maxSlope = terms.slope;
+                    const float specificArea = terms.specificArea;
+                    const float twi = terms.twi;
+
+                    // 4. Stream Channel
+                    // Threshold is usually on FluxCells.
+                    bool isStream = (fluxCells >= streamThreshold);
+                    float localStreamLen = 0.0f;
+                    if (isStream) {
+                        // If it's a stream, what length does it contribute?
+                        // For D8, it flows to 1 receiver. We can take half distance to receiver + half from upstream?
+                        // Simplification: Each stream cell adds 'Resolution' length?
+                        // Or better: Distance to receiver?
+                        // Let's check receiver.
+                        int receiver = map.flowDirMap().empty() ? -1 : map.flowDirMap()[idx];
+                        if (receiver != -1) {
+                            int rx = receiver % w;
+                            int ry = receiver / w;
+                            int dX = std::abs(rx - x);
+                            int dY = std::abs(ry - y);
+                            float distFactor = (dX+dY == 2) ? 1.41421356f : 1.0f; // 2 means diagonal (1+1)
+                            localStreamLen = distFactor * resolution;
+                        } else {
+                            localStreamLen = resolution; // Outline/sink
+                        }
                     }
-                }
-            }
-            // If local flat/pit, slope=0
-
-            // 2. Specific Catchment Area (a)
-            // a = CatchmentArea / ContourWidth
-            // CatchmentArea = FluxCells * CellArea = FluxCells * Res * Res
-            // ContourWidth ~= Resolution (approx)
-            // So a = FluxCells * Res
-            float specificArea = fluxCells * resolution;
-            
-            // 3. TWI = ln(a / tanB)
-            float tanB = std::max(maxSlope, 0.001f); // Avoid div by zero, 0.1% slope min
-            float twi = std::log(specificArea / tanB);
-
-            // 4. Stream Channel
-            // Threshold is usually on FluxCells.
-            bool isStream = (fluxCells >= streamThreshold);
-            float localStreamLen = 0.0f;
-            if (isStream) {
-                // If it's a stream, what length does it contribute?
-                // For D8, it flows to 1 receiver. We can take half distance to receiver + half from upstream?
-                // Simplification: Each stream cell adds 'Resolution' length?
-                // Or better: Distance to receiver?
-                // Let's check receiver.
-                int receiver = map.flowDirMap().empty() ? -1 : map.flowDirMap()[idx];
-                if (receiver != -1) {
-                    int rx = receiver % w;
-                    int ry = receiver / w;
-                    int dX = std::abs(rx - x);
-                    int dY = std::abs(ry - y);
-                    float distFactor = (dX+dY == 2) ? 1.41421356f : 1.0f; // 2 means diagonal (1+1)
-                    localStreamLen = distFactor * resolution;
-                } else {
-                    localStreamLen = resolution; // Outline/sink
-                }
-            }
 
-            // --- GLOBAL STATS ---
-            // Elevation
-            if (elev < globalStats.minElevation) globalStats.minElevation = elev;
-            if (elev > globalStats.maxElevation) globalStats.maxElevation = elev;
-            g_sumElev += elev;
+                    // --- GLOBAL STATS ---
+                    // Elevation
+                    if (elev < globalStats.minElevation) globalStats.minElevation = elev;
+                    if (elev > globalStats.maxElevation) globalStats.maxElevation = elev;
+                    g_sumElev += elev;
 
-            // Slope (tan beta)
-            if (maxSlope < globalStats.minSlope) globalStats.minSlope = maxSlope;
-            if (maxSlope > globalStats.maxSlope) globalStats.maxSlope = maxSlope;
-            g_sumSlope += maxSlope;
+                    // Slope (tan beta)
+                    if (maxSlope < globalStats.minSlope) globalStats.minSlope = maxSlope;
+                    if (maxSlope > globalStats.maxSlope) globalStats.maxSlope = maxSlope;
+                    g_sumSlope += maxSlope;
 
-            // Flow Accumulation (Physical Area m2)
-            float flowArea = fluxCells * cellArea;
-            if (flowArea > globalStats.maxFlowAccumulation) globalStats.maxFlowAccumulation = flowArea;
+                    // Flow Accumulation (Physical Area m2)
+                    float flowArea = fluxCells * cellArea;
+                    if (flowArea > globalStats.maxFlowAccumulation) globalStats.maxFlowAccumulation = flowArea;
             
-            // Stream Power (SPI = A * S) -> Specific Area * Slope ? Or Total Area?
-            // Usually SPI = a * tanB.
-            float spi = specificArea * maxSlope; 
-            if (spi > globalStats.maxStreamPower) globalStats.maxStreamPower = spi;
-
-            // TWI
-            if (twi < globalStats.minTWI) globalStats.minTWI = twi;
-            if (twi > globalStats.maxTWI) globalStats.maxTWI = twi;
-            g_sumTWI += twi;
-            g_twiCount++;
-            if (twi > 8.0f) globalStats.saturatedAreaPct += 1.0f;
-
-            // Network
-            g_streamLength += localStreamLen;
-
-
-            // --- BASIN STATS ---
-            if (bid > 0) {
-                if (basinStatsMap.find(bid) == basinStatsMap.end()) {
-                    basinStatsMap[bid].initRanges();
-                    basinStatsMap[bid].id = bid;
-                    basinStatsMap[bid].areaCells = 0;
-                }
+                    // Stream Power (SPI = A * S) -> Specific Area * Slope ? Or Total Area?
+                    // Usually SPI = a * tanB.
+                    float spi = specificArea * maxSlope; 
+                    if (spi > globalStats.maxStreamPower) globalStats.maxStreamPower = spi;
+
+                    // TWI
+                    if (twi < globalStats.minTWI) globalStats.minTWI = twi;
+                    if (twi > globalStats.maxTWI) globalStats.maxTWI = twi;
+                    g_sumTWI += twi;
+                    g_twiCount++;
+                    if (twi > 8.0f) globalStats.saturatedAreaPct += 1.0f;
+
+                    // Network
+                    g_streamLength += localStreamLen;
+
+
+                    // --- BASIN STATS ---
+                    if (bid > 0) {
+                        if (basinStatsMap.find(bid) == basinStatsMap.end()) {
+                            basinStatsMap[bid].initRanges();
+                            basinStatsMap[bid].id = bid;
+                            basinStatsMap[bid].areaCells = 0;
+                        }
                 
-                HydrologyStats& bStats = basinStatsMap[bid];
-                Accumulator& bAcc = basinAccMap[bid];
-
-                bStats.areaCells++;
-
-                // Elev
-                if (elev < bStats.minElevation) bStats.minElevation = elev;
-                if (elev > bStats.maxElevation) bStats.maxElevation = elev;
-                bAcc.sumElev += elev;
-
-                // Slope
-                if (maxSlope < bStats.minSlope) bStats.minSlope = maxSlope;
-                if (maxSlope > bStats.maxSlope) bStats.maxSlope = maxSlope;
-                bAcc.sumSlope += maxSlope;
-
-                // Flow
-                if (flowArea > bStats.maxFlowAccumulation) bStats.maxFlowAccumulation = flowArea;
-                if (spi > bStats.maxStreamPower) bStats.maxStreamPower = spi;
-
-                // TWI
-                if (twi < bStats.minTWI) bStats.minTWI = twi;
-                if (twi > bStats.maxTWI) bStats.maxTWI = twi;
-                bAcc.sumTWI += twi;
-                bAcc.twiCount++;
-                if (twi > 8.0f) bStats.saturatedAreaPct += 1.0f;
-
-                // Network
-                bAcc.streamLength += localStreamLen;
+                        HydrologyStats& bStats = basinStatsMap[bid];
+                        Accumulator& bAcc = basinAccMap[bid];
+
+                        bStats.areaCells++;
+
+                        // Elev
+                        if (elev < bStats.minElevation) bStats.minElevation = elev;
+                        if (elev > bStats.maxElevation) bStats.maxElevation = elev;
+                        bAcc.sumElev += elev;
+
+                        // Slope
+                        if (maxSlope < bStats.minSlope) bStats.minSlope = maxSlope;
+                        if (maxSlope > bStats.maxSlope) bStats.maxSlope = maxSlope;
+                        bAcc.sumSlope += maxSlope;
+
+                        // Flow
+                        if (flowArea > bStats.maxFlowAccumulation) bStats.maxFlowAccumulation = flowArea;
+                        if (spi > bStats.maxStreamPower) bStats.maxStreamPower = spi;
+
+                        // TWI
+                        if (twi < bStats.minTWI) bStats.minTWI = twi;
+                        if (twi > bStats.maxTWI) bStats.maxTWI = twi;
+                        bAcc.sumTWI += twi;
+                        bAcc.twiCount++;
+                        if (twi > 8.0f) bStats.saturatedAreaPct += 1.0f;
+
+                        // Network
+                        bAcc.streamLength += localStreamLen;
+                    }
+                }
+            }
+        }
+    });
+
+    auto mergeStats = [](HydrologyStats& into, const HydrologyStats& from) {
+        into.minElevation = std::min(into.minElevation, from.minElevation);
+        into.maxElevation = std::max(into.maxElevation, from.maxElevation);
+        into.minSlope = std::min(into.minSlope, from.minSlope);
+        into.maxSlope = std::max(into.maxSlope, from.maxSlope);
+        into.maxFlowAccumulation = std::max(into.maxFlowAccumulation, from.maxFlowAccumulation);
+        into.maxStreamPower = std::max(into.maxStreamPower, from.maxStreamPower);
+        into.minTWI = std::min(into.minTWI, from.minTWI);
+        into.maxTWI = std::max(into.maxTWI, from.maxTWI);
+        into.saturatedAreaPct += from.saturatedAreaPct;
+    };
+    auto mergeAcc = [](Accumulator& into, const Accumulator& from) {
+        into.sumElev += from.sumElev;
+        into.sumSlope += from.sumSlope;
+        into.sumTWI += from.sumTWI;
+        into.twiCount += from.twiCount;
+        into.streamLength += from.streamLength;
+    };
+    Accumulator total;
+    for (const Band& band : partial) {
+        mergeStats(globalStats, band.stats);
+        mergeAcc(total, band.acc);
+        for (const auto& kv : band.basinStats) {
+            auto it = basinStatsMap.find(kv.first);
+            if (it == basinStatsMap.end()) {
+                basinStatsMap[kv.first] = kv.second;
+            } else {
+                mergeStats(it->second, kv.second);
+                it->second.areaCells += kv.second.areaCells;
             }
         }
+        for (const auto& kv : band.basinAcc) mergeAcc(basinAccMap[kv.first], kv.second);
     }
+    const double g_sumElev = total.sumElev;
+    const double g_sumSlope = total.sumSlope;
+    const double g_sumTWI = total.sumTWI;
+    const int g_twiCount = total.twiCount;
+    const float g_streamLength = total.streamLength;
 
     // --- FINALIZE GLOBAL ---
     globalStats.avgElevation = static_cast<float>(g_sumElev / count);
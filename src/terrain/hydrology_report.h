@@ -67,8 +67,19 @@ public:
     // Generates a formatted report and saves to filepath.
     static bool generateToFile(const TerrainMap& map, float resolution, const std::string& filepath);
 
+    // v4.7.0: Per-cell TWI = ln(a / tanB), same terms as analyze() (for raster export)
+    static void computeTWI(const TerrainMap& map, float resolution, std::vector<float>& out);
+
 private:
     static float calculateSlope(const TerrainMap& map, int x, int y);
+
+    // Terms of TWI = ln(a / tanB) at one cell (resolution > 0)
+    struct WetnessTerms {
+        float slope;         // tanB: steepest drop to a neighbour, 0 on flats and pits
+        float specificArea;  // a: upslope area per unit contour width
+        float twi;
+    };
+    static WetnessTerms twiAt(const TerrainMap& map, int x, int y, float resolution);
 };
 
 } // namespace terrain
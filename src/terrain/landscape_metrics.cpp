@@ -18,12 +18,13 @@ std::map<SoilType, ClassMetrics> LandscapeMetricCalculator::analyzeGlobal(const
     int w = map.getWidth();
     int h = map.getHeight();
     const auto& soilMap = map.soilMap();
+    const SoilMask shown = map.soilView(); // v4.7.0: SCORPAN domain of the shared view
 
     // Single Pass: Count Pixels and Edges
     for (int z = 0; z < h; ++z) {
         for (int x = 0; x < w; ++x) {
             int idx = z * w + x;
-            SoilType current = static_cast<SoilType>(soilMap[idx]);
+            SoilType current = soilTypeOf(soilMap[idx], shown);
             if (current == SoilType::None) continue;
 
             results[current].pixelCount++;
@@ -33,28 +34,28 @@ std::map<SoilType, ClassMetrics> LandscapeMetricCalculator::analyzeGlobal(const
             
             // North
             if (z + 1 < h) {
-                if (static_cast<SoilType>(soilMap[idx + w]) != current) results[current].edgeCount++;
+                if (soilTypeOf(soilMap[idx + w], shown) != current) results[current].edgeCount++;
             } else {
                 results[current].edgeCount++; // Boundary
             }
 
             // South
             if (z - 1 >= 0) {
-                if (static_cast<SoilType>(soilMap[idx - w]) != current) results[current].edgeCount++;
+                if (soilTypeOf(soilMap[idx - w], shown) != current) results[current].edgeCount++;
             } else {
                 results[current].edgeCount++;
             }
 
             // East
             if (x + 1 < w) {
-                if (static_cast<SoilType>(soilMap[idx + 1]) != current) results[current].edgeCount++;
+                if (soilTypeOf(soilMap[idx + 1], shown) != current) results[current].edgeCount++;
             } else {
                 results[current].edgeCount++;
             }
 
             // West
             if (x - 1 >= 0) {
-                if (static_cast<SoilType>(soilMap[idx - 1]) != current) results[current].edgeCount++;
+                if (soilTypeOf(soilMap[idx - 1], shown) != current) results[current].edgeCount++;
             } else {
                 results[current].edgeCount++;
             }
@@ -92,7 +93,9 @@ std::map<int, std::map<SoilType, ClassMetrics>> LandscapeMetricCalculator::analy
     int w = map.getWidth();
     int h = map.getHeight();
     const auto& soilMap = map.soilMap();
+    const SoilMask shown = map.soilView();
     const auto& watershedMap = map.watershedMap();
+    if (watershedMap.empty()) return basinResults; // v4.7.0: No segmentation yet
 
     // Pass
     for (int z = 0; z < h; ++z) {
@@ -103,7 +106,7 @@ std::map<int, std::map<SoilType, ClassMetrics>> LandscapeMetricCalculator::analy
             // Only analyze main basins (ID > 0)
             if (basinId <= 0) continue;
 
-            SoilType current = static_cast<SoilType>(soilMap[idx]);
+            SoilType current = soilTypeOf(soilMap[idx], shown);
             if (current == SoilType::None) continue;
 
             ClassMetrics& m = basinResults[basinId][current];
@@ -115,7 +118,7 @@ std::map<int, std::map<SoilType, ClassMetrics>> LandscapeMetricCalculator::analy
                 if (nx < 0 || nx >= w || nz < 0 || nz >= h) return true; // Boundary
                 int nidx = nz * w + nx;
                 if (watershedMap[nidx] != basinId) return true; // Basin Boundary
-                if (static_cast<SoilType>(soilMap[nidx]) != current) return true;      // Soil Boundary
+                if (soilTypeOf(soilMap[nidx], shown) != current) return true;      // Soil Boundary
                 return false;
             };
 
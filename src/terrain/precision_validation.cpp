@@ -0,0 +1,83 @@
+#include "precision_validation.h"
+#include <algorithm>
+#include <cmath>
+
+namespace terrain {
+
+namespace {
+
+// Packed channels of the simulated grids, by layout name
+std::vector<std::pair<const char*, const core::PackedChannel*>> packedChannels(const TerrainMap& map) {
+    std::vector<std::pair<const char*, const core::PackedChannel*>> channels;
+    if (const auto* soil = map.getLandscapeSoil()) {
+        channels.push_back({"soil.compaction", &soil->compaction});
+        channels.push_back({"soil.propagule_bank", &soil->propagule_bank});
+        channels.push_back({"soil.sand_fraction", &soil->sand_fraction});
+        channels.push_back({"soil.clay_fraction", &soil->clay_fraction});
+    }
+    if (const auto* veg = map.getVegetation()) {
+        channels.push_back({"veg.ei_coverage", &veg->ei_coverage});
+        channels.push_back({"veg.es_coverage", &veg->es_coverage});
+        channels.push_back({"veg.ei_vigor", &veg->ei_vigor});
+        channels.push_back({"veg.es_vigor", &veg->es_vigor});
+    }
+    return channels;
+}
+
+} // namespace
+
+std::vector<PrecisionDrift> validatePrecision(const std::function<std::unique_ptr<TerrainMap>()>& buildWorld,
+                                              SimulationParameters parameters, int ticks,
+                                              const SimulationSettings& settings) {
+    parameters.disturbance.fireFrequency = 0.0f;
+
+    const core::PrecisionConfig configured = core::PackedChannel::configuration();
+    core::PrecisionConfig reference = configured;
+    reference.forceFloat32 = true;
+    core::PackedChannel::configure(reference);
+    std::unique_ptr<TerrainMap> exact;
+    try {
+        exact = buildWorld();
+    } catch (...) {
+        core::PackedChannel::configure(configured);
+        throw;
+    }
+    core::PackedChannel::configure(configured);
+    std::unique_ptr<TerrainMap> packed = buildWorld();
+    if (!exact || !packed) return {};
+
+    for (TerrainMap* map : {exact.get(), packed.get()}) {
+        SimulationThread simulation;
+        simulation.attach(*map, parameters, settings);
+        for (int t = 0; t < ticks; ++t) simulation.step();
+    }
+
+    const auto expected = packedChannels(*exact);
+    const auto actual = packedChannels(*packed);
+    std::vector<PrecisionDrift> report;
+    std::vector<float> a, b;
+    for (size_t c = 0; c < actual.size() && c < expected.size(); ++c) {
+        const core::PackedChannel& want = *expected[c].second;
+        const core::PackedChannel& got = *actual[c].second;
+        PrecisionDrift drift;
+        drift.name = actual[c].first;
+        drift.precision = got.precision();
+        if (want.size() == got.size() && !got.empty()) {
+            a.resize(got.size());
+            b.resize(got.size());
+            want.load(0, a.size(), a.data());
+            got.load(0, b.size(), b.data());
+            double sum = 0.0;
+            for (size_t i = 0; i < a.size(); ++i) {
+                const double error = std::abs(static_cast<double>(b[i]) - static_cast<double>(a[i]));
+                drift.maxError = std::max(drift.maxError, error);
+                sum += error;
+            }
+            drift.meanError = sum / static_cast<double>(a.size());
+        }
+        report.push_back(drift);
+    }
+    return report;
+}
+
+} // namespace terrain
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "simulation_thread.h"
+#include "../core/packed_channel.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace terrain {
+
+// v4.7.0: Drift of one packed channel after a long run, against float32 storage
+struct PrecisionDrift {
+    std::string name;
+    core::ChannelPrecision precision = core::ChannelPrecision::Float32;
+    double maxError = 0.0;    // Largest |packed - float32| over the cells
+    double meanError = 0.0;
+};
+
+/**
+ * @brief v4.7.0: Precision validation mode. Builds the world twice, once with
+ * every packed channel forced to float32 (PrecisionConfig::forceFloat32) and
+ * once with the configured precisions, steps both `ticks` times with the same
+ * parameters and compares the packed channels cell by cell. Fire events are
+ * disabled: their draws would not match between the two runs.
+ */
+std::vector<PrecisionDrift> validatePrecision(const std::function<std::unique_ptr<TerrainMap>()>& buildWorld,
+                                              SimulationParameters parameters, int ticks,
+                                              const SimulationSettings& settings = {});
+
+} // namespace terrain
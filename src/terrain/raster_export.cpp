@@ -0,0 +1,612 @@
+#include "raster_export.h"
+#include "hydrology_report.h"
+#include "terrain_map.h"
+#include "world_snapshot.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+
+namespace terrain {
+
+namespace {
+
+// --- TIFF LZW ---
+
+constexpr uint32_t kLzwClear = 256;
+constexpr uint32_t kLzwEoi = 257;
+constexpr uint32_t kLzwFirst = 258;
+constexpr uint32_t kLzwMaxCode = 4095; // 12-bit codes
+constexpr int kLzwHashLog = 14;
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+    void put(uint32_t code, int width) {
+        acc_ = (acc_ << width) | code;
+        bits_ += width;
+        while (bits_ >= 8) {
+            bits_ -= 8;
+            out_.push_back(static_cast<uint8_t>(acc_ >> bits_));
+        }
+        acc_ &= (1u << bits_) - 1u;
+    }
+    void flush() {
+        if (bits_ > 0) out_.push_back(static_cast<uint8_t>(acc_ << (8 - bits_)));
+        acc_ = 0;
+        bits_ = 0;
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint32_t acc_ = 0;
+    int bits_ = 0;
+};
+
+// --- TIFF directory ---
+
+enum TiffType : uint16_t { kAscii = 2, kShort = 3, kLong = 4, kDouble = 12 };
+
+inline void put16(std::vector<uint8_t>& b, uint16_t v) {
+    b.push_back(static_cast<uint8_t>(v));
+    b.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+inline void put32(std::vector<uint8_t>& b, uint32_t v) {
+    for (int i = 0; i < 4; ++i) b.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+class Ifd {
+public:
+    void shorts(uint16_t tag, const std::vector<uint16_t>& v) {
+        Entry& e = add(tag, kShort, v.size());
+        for (uint16_t x : v) put16(e.payload, x);
+    }
+    void longs(uint16_t tag, const std::vector<uint32_t>& v) {
+        Entry& e = add(tag, kLong, v.size());
+        for (uint32_t x : v) put32(e.payload, x);
+    }
+    void doubles(uint16_t tag, const std::vector<double>& v) {
+        Entry& e = add(tag, kDouble, v.size());
+        for (double x : v) {
+            uint64_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            put32(e.payload, static_cast<uint32_t>(bits));
+            put32(e.payload, static_cast<uint32_t>(bits >> 32));
+        }
+    }
+
+    // Entries plus their out-of-line values (word aligned)
+    size_t size() const {
+        size_t n = 2 + entries_.size() * 12 + 4;
+        for (const Entry& e : entries_) {
+            if (e.payload.size() > 4) n += e.payload.size() + (e.payload.size() & 1);
+        }
+        return n;
+    }
+
+    std::vector<uint8_t> serialize(uint32_t offset, uint32_t next) const {
+        std::vector<Entry> sorted = entries_;
+        std::sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b) { return a.tag < b.tag; });
+        std::vector<uint8_t> out, extra;
+        const uint32_t extraBase = offset + static_cast<uint32_t>(2 + sorted.size() * 12 + 4);
+        put16(out, static_cast<uint16_t>(sorted.size()));
+        for (const Entry& e : sorted) {
+            put16(out, e.tag);
+            put16(out, e.type);
+            put32(out, static_cast<uint32_t>(e.count));
+            if (e.payload.size() <= 4) {
+                std::vector<uint8_t> inl = e.payload;
+                inl.resize(4, 0); // Left-justified
+                out.insert(out.end(), inl.begin(), inl.end());
+            } else {
+                put32(out, extraBase + static_cast<uint32_t>(extra.size()));
+                extra.insert(extra.end(), e.payload.begin(), e.payload.end());
+                if (extra.size() & 1) extra.push_back(0);
+            }
+        }
+        put32(out, next);
+        out.insert(out.end(), extra.begin(), extra.end());
+        return out;
+    }
+
+private:
+    struct Entry {
+        uint16_t tag;
+        uint16_t type;
+        size_t count;
+        std::vector<uint8_t> payload;
+    };
+    Entry& add(uint16_t tag, uint16_t type, size_t count) {
+        entries_.push_back({tag, type, count, {}});
+        return entries_.back();
+    }
+    std::vector<Entry> entries_;
+};
+
+size_t sampleBytes(RasterSampleType type) {
+    return type == RasterSampleType::UInt8 ? 1 : 4;
+}
+
+// One resolution level; level 0 points at the caller's grid
+struct Level {
+    int width = 0;
+    int height = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    const uint8_t* data = nullptr;
+    std::vector<uint8_t> storage;
+};
+
+void downsample(const Level& fine, Level& coarse, RasterSampleType type) {
+    coarse.width = (fine.width + 1) / 2;
+    coarse.height = (fine.height + 1) / 2;
+    const size_t sb = sampleBytes(type);
+    coarse.storage.resize(static_cast<size_t>(coarse.width) * static_cast<size_t>(coarse.height) * sb);
+    coarse.data = coarse.storage.data();
+    const size_t fw = static_cast<size_t>(fine.width);
+    const size_t fh = static_cast<size_t>(fine.height);
+    const size_t cw = static_cast<size_t>(coarse.width);
+
+    core::JobSystem::instance().parallelFor(0, coarse.height, 0, [&](int rowBegin, int rowEnd) {
+        for (int row = rowBegin; row < rowEnd; ++row) {
+            const size_t y = static_cast<size_t>(row);
+            for (size_t x = 0; x < cw; ++x) {
+                const size_t dst = (y * cw + x) * sb;
+                if (type != RasterSampleType::Float32) {
+                    // Classes cannot be averaged: nearest sample
+                    const size_t src = (2 * y * fw + 2 * x) * sb;
+                    std::memcpy(coarse.storage.data() + dst, fine.data + src, sb);
+                    continue;
+                }
+                float sum = 0.0f;
+                int n = 0;
+                for (size_t j = 0; j < 2; ++j) {
+                    for (size_t i = 0; i < 2; ++i) {
+                        const size_t fx = std::min(2 * x + i, fw - 1);
+                        const size_t fy = std::min(2 * y + j, fh - 1);
+                        float v;
+                        std::memcpy(&v, fine.data + (fy * fw + fx) * sb, sizeof(v));
+                        if (std::isnan(v)) continue;
+                        sum += v;
+                        ++n;
+                    }
+                }
+                const float mean = n > 0 ? sum / static_cast<float>(n) : std::numeric_limits<float>::quiet_NaN();
+                std::memcpy(coarse.storage.data() + dst, &mean, sizeof(mean));
+            }
+        }
+    });
+}
+
+// Predictor 2 (integer differences) / 3 (float byte planes, then byte differences), in place per row
+void applyPredictor(uint8_t* tile, int tileSize, RasterSampleType type, std::vector<uint8_t>& scratch) {
+    const size_t n = static_cast<size_t>(tileSize);
+    for (size_t r = 0; r < n; ++r) {
+        if (type == RasterSampleType::UInt8) {
+            uint8_t* row = tile + r * n;
+            for (size_t i = n - 1; i > 0; --i) row[i] = static_cast<uint8_t>(row[i] - row[i - 1]);
+        } else if (type == RasterSampleType::Int32) {
+            uint8_t* row = tile + r * n * 4;
+            uint32_t prev;
+            std::memcpy(&prev, row, 4);
+            for (size_t i = 1; i < n; ++i) {
+                uint32_t cur;
+                std::memcpy(&cur, row + i * 4, 4);
+                const uint32_t diff = cur - prev;
+                std::memcpy(row + i * 4, &diff, 4);
+                prev = cur;
+            }
+        } else {
+            // Most significant byte plane first (file is little-endian like the host)
+            uint8_t* row = tile + r * n * 4;
+            scratch.resize(n * 4);
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t b = 0; b < 4; ++b) scratch[(3 - b) * n + i] = row[i * 4 + b];
+            }
+            std::memcpy(row, scratch.data(), n * 4);
+            for (size_t i = n * 4 - 1; i > 0; --i) row[i] = static_cast<uint8_t>(row[i] - row[i - 1]);
+        }
+    }
+}
+
+// tileSize x tileSize samples; edge tiles repeat the last row/column
+void extractTile(const Level& level, int tx, int ty, int tileSize, size_t sb, uint8_t* out) {
+    const size_t n = static_cast<size_t>(tileSize);
+    const size_t w = static_cast<size_t>(level.width);
+    const size_t lastRow = static_cast<size_t>(level.height - 1);
+    const size_t x0 = static_cast<size_t>(tx) * n;
+    const size_t cols = std::min(n, w - x0);
+    for (size_t r = 0; r < n; ++r) {
+        const size_t y = std::min(static_cast<size_t>(ty) * n + r, lastRow);
+        const uint8_t* src = level.data + (y * w + x0) * sb;
+        uint8_t* dst = out + r * n * sb;
+        std::memcpy(dst, src, cols * sb);
+        for (size_t c = cols; c < n; ++c) std::memcpy(dst + c * sb, src + (cols - 1) * sb, sb);
+    }
+}
+
+void setError(std::string* error, const std::string& message) {
+    if (error) *error = message;
+}
+
+} // namespace
+
+void RasterExporter::lzwEncode(const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+    out.clear();
+    BitWriter bits(out);
+    int width = 9;
+    bits.put(kLzwClear, width);
+    if (size == 0) {
+        bits.put(kLzwEoi, width);
+        bits.flush();
+        return;
+    }
+
+    // (prefix << 8 | byte) + 1 -> code; 0 = empty slot
+    std::vector<uint32_t> keys(size_t(1) << kLzwHashLog, 0u);
+    std::vector<uint16_t> codes(keys.size());
+    const uint32_t mask = static_cast<uint32_t>(keys.size() - 1);
+    uint32_t next = kLzwFirst;
+    uint32_t maxCode = 511;
+    uint32_t prefix = src[0];
+
+    for (size_t i = 1; i < size; ++i) {
+        const uint32_t key = ((prefix << 8) | src[i]) + 1u;
+        uint32_t h = (key * 2654435761u) >> (32 - kLzwHashLog);
+        while (keys[h] != 0 && keys[h] != key) h = (h + 1) & mask;
+        if (keys[h] == key) {
+            prefix = codes[h];
+            continue;
+        }
+        bits.put(prefix, width);
+        keys[h] = key;
+        codes[h] = static_cast<uint16_t>(next++);
+        if (next == kLzwMaxCode - 1) {
+            // Table full: start over (same rule as libtiff)
+            bits.put(kLzwClear, width);
+            std::fill(keys.begin(), keys.end(), 0u);
+            next = kLzwFirst;
+            width = 9;
+            maxCode = 511;
+        } else if (next > maxCode) {
+            ++width;
+            maxCode = (1u << width) - 1u;
+        }
+        prefix = src[i];
+    }
+
+    // The decoder adds one more entry after the last code, which may widen the EOI
+    bits.put(prefix, width);
+    if (++next == kLzwMaxCode - 1) {
+        bits.put(kLzwClear, width);
+        width = 9;
+    } else if (next > maxCode) {
+        ++width;
+    }
+    bits.put(kLzwEoi, width);
+    bits.flush();
+}
+
+bool RasterExporter::lzwDecode(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize) {
+    std::vector<uint16_t> prefix(kLzwMaxCode + 1);
+    std::vector<uint8_t> suffix(kLzwMaxCode + 1), first(kLzwMaxCode + 1);
+    std::vector<uint16_t> length(kLzwMaxCode + 1);
+    for (uint32_t c = 0; c < 256; ++c) {
+        suffix[c] = first[c] = static_cast<uint8_t>(c);
+        length[c] = 1;
+    }
+
+    size_t bitPos = 0;
+    const size_t totalBits = size * 8;
+    int width = 9;
+    uint32_t next = kLzwFirst;
+    uint32_t old = 0;
+    bool haveOld = false; // No string since the last clear code
+    size_t op = 0;
+
+    // Writes the string of `code` at dst[op]
+    auto emit = [&](uint32_t code) -> bool {
+        const size_t len = length[code];
+        if (rawSize - op < len) return false;
+        for (size_t k = len; k-- > 0;) {
+            dst[op + k] = suffix[code];
+            code = prefix[code];
+        }
+        op += len;
+        return true;
+    };
+
+    while (bitPos + static_cast<size_t>(width) <= totalBits) {
+        uint32_t code = 0;
+        for (int b = 0; b < width; ++b, ++bitPos) {
+            code = (code << 1) | ((src[bitPos >> 3] >> (7 - (bitPos & 7))) & 1u);
+        }
+        if (code == kLzwEoi) break;
+        if (code == kLzwClear) {
+            next = kLzwFirst;
+            width = 9;
+            haveOld = false;
+            continue;
+        }
+        if (!haveOld) {
+            if (code > 255 || !emit(code)) return false;
+            old = code;
+            haveOld = true;
+            continue;
+        }
+        uint8_t head;
+        if (code < next) {
+            head = first[code];
+        } else if (code == next) {
+            head = first[old];
+        } else {
+            return false;
+        }
+        if (next <= kLzwMaxCode) {
+            prefix[next] = static_cast<uint16_t>(old);
+            suffix[next] = head;
+            first[next] = first[old];
+            length[next] = static_cast<uint16_t>(length[old] + 1);
+            ++next;
+        }
+        if (!emit(code)) return false;
+        if (next >= (1u << width) - 1u && width < 12) ++width;
+        old = code;
+    }
+    return op == rawSize;
+}
+
+bool RasterExporter::writeGeoTiff(const std::string& path, const void* data, RasterSampleType type, int width, int height,
+                                  const RasterExportOptions& options, std::string* error) {
+    const int tileSize = options.tileSize;
+    if (width < 1 || height < 1 || tileSize < 16 || tileSize % 16 != 0) {
+        setError(error, "invalid raster or tile size");
+        return false;
+    }
+    const size_t sb = sampleBytes(type);
+
+    // Overviews until one tile covers the level
+    std::vector<Level> levels(1);
+    levels[0].width = width;
+    levels[0].height = height;
+    levels[0].data = static_cast<const uint8_t*>(data);
+    while (std::max(levels.back().width, levels.back().height) > tileSize) {
+        Level coarse;
+        downsample(levels.back(), coarse, type);
+        levels.push_back(std::move(coarse));
+    }
+
+    std::vector<size_t> firstTile(levels.size() + 1, 0);
+    for (size_t l = 0; l < levels.size(); ++l) {
+        levels[l].tilesX = (levels[l].width + tileSize - 1) / tileSize;
+        levels[l].tilesY = (levels[l].height + tileSize - 1) / tileSize;
+        firstTile[l + 1] = firstTile[l] + static_cast<size_t>(levels[l].tilesX) * static_cast<size_t>(levels[l].tilesY);
+    }
+    const size_t tileCount = firstTile.back();
+    std::vector<uint32_t> offsets(tileCount, 0), byteCounts(tileCount, 0);
+
+    const uint16_t sampleFormat = type == RasterSampleType::Float32 ? 3 : (type == RasterSampleType::Int32 ? 2 : 1);
+    const uint16_t predictor = type == RasterSampleType::Float32 ? 3 : 2;
+    auto buildIfd = [&](size_t l) {
+        const Level& level = levels[l];
+        Ifd ifd;
+        ifd.longs(254, {l == 0 ? 0u : 1u}); // NewSubfileType: reduced-resolution image
+        ifd.longs(256, {static_cast<uint32_t>(level.width)});
+        ifd.longs(257, {static_cast<uint32_t>(level.height)});
+        ifd.shorts(258, {static_cast<uint16_t>(sb * 8)});
+        ifd.shorts(259, {static_cast<uint16_t>(options.compress ? 5 : 1)});
+        ifd.shorts(262, {1}); // BlackIsZero
+        ifd.shorts(277, {1});
+        ifd.shorts(284, {1});
+        if (options.compress) ifd.shorts(317, {predictor});
+        ifd.longs(322, {static_cast<uint32_t>(tileSize)});
+        ifd.longs(323, {static_cast<uint32_t>(tileSize)});
+        ifd.longs(324, std::vector<uint32_t>(offsets.begin() + static_cast<std::ptrdiff_t>(firstTile[l]), offsets.begin() + static_cast<std::ptrdiff_t>(firstTile[l + 1])));
+        ifd.longs(325, std::vector<uint32_t>(byteCounts.begin() + static_cast<std::ptrdiff_t>(firstTile[l]), byteCounts.begin() + static_cast<std::ptrdiff_t>(firstTile[l + 1])));
+        ifd.shorts(339, {sampleFormat});
+        if (l == 0) {
+            // GeoTIFF: pixel size, north-west corner, projected model with area pixels
+            const double res = options.resolution;
+            ifd.doubles(33550, {res, res, 0.0});
+            ifd.doubles(33922, {0.0, 0.0, 0.0, options.originX, options.originY + static_cast<double>(height) * res, 0.0});
+            std::vector<uint16_t> keys = {1, 1, 0, 0, 1024, 0, 1, 1, 1025, 0, 1, 1};
+            if (options.epsg > 0) {
+                keys.insert(keys.end(), {3072, 0, 1, static_cast<uint16_t>(options.epsg)});
+            } else {
+                keys.insert(keys.end(), {3072, 0, 1, 32767, 3076, 0, 1, 9001}); // User-defined, metres
+            }
+            keys[3] = static_cast<uint16_t>((keys.size() - 4) / 4);
+            ifd.shorts(34735, keys);
+        }
+        return ifd;
+    };
+
+    // Directories first; their size does not depend on the tile offsets
+    std::vector<uint32_t> ifdOffsets(levels.size());
+    uint64_t cursor = 8;
+    for (size_t l = 0; l < levels.size(); ++l) {
+        ifdOffsets[l] = static_cast<uint32_t>(cursor);
+        cursor += buildIfd(l).size();
+    }
+    cursor = (cursor + 15) & ~uint64_t(15);
+
+    OutputFile out;
+    if (!out.open(path)) {
+        setError(error, "cannot create " + path);
+        return false;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::atomic<uint64_t> fileEnd{cursor};
+    std::atomic<bool> failed{false};
+    const int tiles = static_cast<int>(tileCount);
+    core::JobSystem::instance().parallelFor(0, tiles, 1, [&](int tileBegin, int tileEnd) {
+        std::vector<uint8_t> tile(static_cast<size_t>(tileSize) * static_cast<size_t>(tileSize) * sb);
+        std::vector<uint8_t> scratch, encoded;
+        for (int t = tileBegin; t < tileEnd; ++t) {
+            if (failed.load(std::memory_order_relaxed)) continue;
+            const size_t index = static_cast<size_t>(t);
+            const size_t l = static_cast<size_t>(std::upper_bound(firstTile.begin(), firstTile.end(), index) - firstTile.begin()) - 1;
+            const Level& level = levels[l];
+            const int local = static_cast<int>(index - firstTile[l]);
+            extractTile(level, local % level.tilesX, local / level.tilesX, tileSize, sb, tile.data());
+
+            const std::vector<uint8_t>* payload = &tile;
+            if (options.compress) {
+                applyPredictor(tile.data(), tileSize, type, scratch);
+                lzwEncode(tile.data(), tile.size(), encoded);
+                payload = &encoded;
+            }
+            const uint64_t at = fileEnd.fetch_add(payload->size());
+            if (at + payload->size() > 0xFFFFFFFFull || !out.writeAt(at, payload->data(), payload->size())) {
+                failed = true;
+                continue;
+            }
+            offsets[index] = static_cast<uint32_t>(at);
+            byteCounts[index] = static_cast<uint32_t>(payload->size());
+        }
+    });
+
+    bool ok = !failed.load();
+    if (ok) {
+        std::vector<uint8_t> header = {'I', 'I', 42, 0};
+        put32(header, ifdOffsets[0]);
+        ok = out.writeAt(0, header.data(), header.size());
+        for (size_t l = 0; ok && l < levels.size(); ++l) {
+            const uint32_t next = l + 1 < levels.size() ? ifdOffsets[l + 1] : 0u;
+            const std::vector<uint8_t> ifd = buildIfd(l).serialize(ifdOffsets[l], next);
+            ok = out.writeAt(ifdOffsets[l], ifd.data(), ifd.size());
+        }
+    }
+    ok = out.close() && ok;
+    if (!ok) {
+        setError(error, "write failed for " + path + " (classic TIFF is limited to 4 GiB)");
+        std::filesystem::remove(path);
+        return false;
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[RasterExport] " << path << ": " << width << "x" << height << ", " << levels.size() - 1
+              << " overviews, " << static_cast<double>(fileEnd.load()) / (1024.0 * 1024.0) << " MB in " << ms << " ms" << std::endl;
+    return true;
+}
+
+const char* RasterExporter::layerName(RasterLayer layer) {
+    switch (layer) {
+        case RasterLayer::Height: return "height";
+        case RasterLayer::Flux: return "flux";
+        case RasterLayer::TWI: return "twi";
+        case RasterLayer::SoilType: return "soil_type";
+        case RasterLayer::SiBCSSuborder: return "sibcs_suborder";
+        case RasterLayer::SiBCSGreatGroup: return "sibcs_great_group";
+        case RasterLayer::SiBCSSubGroup: return "sibcs_subgroup";
+        case RasterLayer::SiBCSFamily: return "sibcs_family";
+        case RasterLayer::SiBCSSeries: return "sibcs_series";
+        case RasterLayer::VegetationEI: return "vegetation_ei";
+        case RasterLayer::VegetationES: return "vegetation_es";
+        case RasterLayer::ErosionRisk: return "erosion_risk";
+        case RasterLayer::BasinId: return "basin_id";
+        default: return "unknown";
+    }
+}
+
+bool RasterExporter::hasLayer(const TerrainMap& map, RasterLayer layer) {
+    const size_t cells = static_cast<size_t>(map.getWidth()) * static_cast<size_t>(map.getHeight());
+    const landscape::SoilGrid* soil = map.getLandscapeSoil();
+    const bool hasSoil = soil && soil->soil_type.size() == cells;
+    switch (layer) {
+        case RasterLayer::Height: return map.heightMap().size() == cells;
+        case RasterLayer::Flux:
+        case RasterLayer::TWI: return map.fluxMap().size() == cells && map.heightMap().size() == cells;
+        case RasterLayer::SoilType:
+        case RasterLayer::SiBCSSuborder:
+        case RasterLayer::SiBCSGreatGroup:
+        case RasterLayer::SiBCSSubGroup:
+        case RasterLayer::SiBCSFamily:
+        case RasterLayer::SiBCSSeries: return hasSoil;
+        case RasterLayer::VegetationEI:
+        case RasterLayer::VegetationES: return map.getVegetation() && map.getVegetation()->ei_coverage.size() == cells &&
+                                               map.getVegetation()->es_coverage.size() == cells;
+        case RasterLayer::ErosionRisk: return map.getLandscapeHydro() && map.getLandscapeHydro()->erosion_risk.size() == cells;
+        case RasterLayer::BasinId: return map.watershedMap().size() == cells;
+        default: return false;
+    }
+}
+
+int RasterExporter::exportLayers(const std::string& directory, const TerrainMap& map, const std::vector<RasterLayer>& layers,
+                                 const RasterExportOptions& options, std::string* error) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        setError(error, "cannot create " + directory + ": " + ec.message());
+        return 0;
+    }
+
+    int written = 0;
+    std::vector<float> twi;
+    std::vector<float> decoded; // Packed vegetation channels
+    std::vector<uint8_t> levels; // SiBCS levels 2-6, expanded from the taxon index
+    for (RasterLayer layer : layers) {
+        if (!hasLayer(map, layer)) {
+            std::cout << "[RasterExport] Skipping " << layerName(layer) << " (not available)." << std::endl;
+            continue;
+        }
+        const void* data = nullptr;
+        RasterSampleType type = RasterSampleType::UInt8;
+        const landscape::SoilGrid* soil = map.getLandscapeSoil();
+        switch (layer) {
+            case RasterLayer::Height: data = map.heightMap().data(); type = RasterSampleType::Float32; break;
+            case RasterLayer::Flux: data = map.fluxMap().data(); type = RasterSampleType::Float32; break;
+            case RasterLayer::TWI:
+                HydrologyReport::computeTWI(map, options.resolution, twi);
+                data = twi.data();
+                type = RasterSampleType::Float32;
+                break;
+            case RasterLayer::SoilType: data = soil->soil_type.data(); break;
+            case RasterLayer::SiBCSSuborder:
+            case RasterLayer::SiBCSGreatGroup:
+            case RasterLayer::SiBCSSubGroup:
+            case RasterLayer::SiBCSFamily:
+            case RasterLayer::SiBCSSeries: {
+                const std::vector<uint8_t> byTaxon = soil->taxa.tabulate([layer](const landscape::SoilTaxon& t) {
+                    switch (layer) {
+                        case RasterLayer::SiBCSSuborder: return static_cast<uint8_t>(t.suborder);
+                        case RasterLayer::SiBCSGreatGroup: return static_cast<uint8_t>(t.greatGroup);
+                        case RasterLayer::SiBCSSubGroup: return static_cast<uint8_t>(t.subGroup);
+                        case RasterLayer::SiBCSFamily: return static_cast<uint8_t>(t.family);
+                        default: return static_cast<uint8_t>(t.series);
+                    }
+                });
+                levels.resize(soil->taxon.size());
+                for (size_t i = 0; i < levels.size(); ++i) levels[i] = byTaxon[soil->taxon[i]];
+                data = levels.data();
+                break;
+            }
+            case RasterLayer::VegetationEI:
+            case RasterLayer::VegetationES: {
+                const auto* veg = map.getVegetation();
+                const core::PackedChannel& channel = layer == RasterLayer::VegetationEI ? veg->ei_coverage : veg->es_coverage;
+                decoded.resize(channel.size());
+                channel.load(0, channel.size(), decoded.data());
+                data = decoded.data();
+                type = RasterSampleType::Float32;
+                break;
+            }
+            case RasterLayer::ErosionRisk: data = map.getLandscapeHydro()->erosion_risk.data(); type = RasterSampleType::Float32; break;
+            case RasterLayer::BasinId: data = map.watershedMap().data(); type = RasterSampleType::Int32; break;
+            default: continue;
+        }
+        const std::string path = (std::filesystem::path(directory) / (std::string(layerName(layer)) + ".tif")).string();
+        if (!writeGeoTiff(path, data, type, map.getWidth(), map.getHeight(), options, error)) return written;
+        ++written;
+    }
+    return written;
+}
+
+} // namespace terrain
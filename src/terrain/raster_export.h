@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace terrain {
+
+class TerrainMap;
+
+// v4.7.0: Per-cell layers that can leave the app as GIS rasters
+enum class RasterLayer {
+    Height,          // float, metres
+    Flux,            // float, D8 accumulation (cells)
+    TWI,             // float, ln(a / tanB), computed on export
+    SoilType,        // uint8, SiBCS order (landscape::SoilType)
+    SiBCSSuborder,   // uint8, levels 2..6 (landscape::SiBCS* enums)
+    SiBCSGreatGroup,
+    SiBCSSubGroup,
+    SiBCSFamily,
+    SiBCSSeries,
+    VegetationEI,    // float, lower stratum coverage [0, 1]
+    VegetationES,    // float, upper stratum coverage [0, 1]
+    ErosionRisk,     // float, [0, 1]
+    BasinId,         // int32, watershed segmentation (run it first)
+    Count
+};
+
+enum class RasterSampleType { UInt8, Int32, Float32 };
+
+struct RasterExportOptions {
+    float resolution = 1.0f; // Metres per cell
+    double originX = 0.0;    // West edge of the raster (map units)
+    double originY = 0.0;    // South edge
+    int epsg = 0;            // Projected CRS code; 0 = unspecified (local metres)
+    int tileSize = 256;      // Multiple of 16
+    bool compress = true;    // LZW with predictor; false = uncompressed tiles
+};
+
+/**
+ * @brief v4.7.0: Tiled GeoTIFF writer (one band per file, overviews included).
+ *
+ * Layout: header, then every IFD (full resolution first, then each 2x overview
+ * flagged as reduced-resolution), then tile data. Overviews average float
+ * layers (NaN-aware) and take the nearest sample for class layers. Tiles of
+ * all levels are encoded in parallel (LZW; predictor 2 for integers, 3 for
+ * floats) and written with positional writes as soon as each one claims its
+ * range; the IFDs go in last at their precomputed place. Row 0 is the north edge.
+ */
+class RasterExporter {
+public:
+    static const char* layerName(RasterLayer layer); // File stem, e.g. "height"
+    static bool hasLayer(const TerrainMap& map, RasterLayer layer);
+
+    // Row-major width x height samples of `type`
+    static bool writeGeoTiff(const std::string& path, const void* data, RasterSampleType type, int width, int height,
+                             const RasterExportOptions& options, std::string* error = nullptr);
+
+    // <directory>/<layerName>.tif for each available layer; returns how many were written
+    static int exportLayers(const std::string& directory, const TerrainMap& map, const std::vector<RasterLayer>& layers,
+                            const RasterExportOptions& options, std::string* error = nullptr);
+
+    // TIFF LZW (MSB-first codes, early width change); public for tests
+    static void lzwEncode(const uint8_t* src, size_t size, std::vector<uint8_t>& out);
+    static bool lzwDecode(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize);
+};
+
+} // namespace terrain
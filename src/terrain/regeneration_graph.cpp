@@ -0,0 +1,171 @@
+#include "regeneration_graph.h"
+#include "terrain_map.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace terrain {
+
+ContentHash& ContentHash::bytes(const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h_ ^= p[i];
+        h_ *= 1099511628211ull;
+    }
+    return *this;
+}
+
+void RegenerationControl::beginStages(int count) {
+    stagesTotal_ += count;
+}
+
+void RegenerationControl::finishStage() {
+    ++stagesDone_;
+    tilePermille_ = 0;
+}
+
+void RegenerationControl::tileProgress(int done, int total) {
+    if (total > 0) tilePermille_ = std::min(1000, done * 1000 / total);
+}
+
+float RegenerationControl::progress() const {
+    const int total = stagesTotal_.load();
+    if (total <= 0) return 0.0f;
+    int permille = std::min(1000, (stagesDone_.load() * 1000 + tilePermille_.load()) / total);
+    // Concurrent stages reset the tile fraction; never report going backwards
+    int prev = reportedPermille_.load();
+    while (permille > prev && !reportedPermille_.compare_exchange_weak(prev, permille)) {}
+    return static_cast<float>(std::max(permille, prev)) / 1000.0f;
+}
+
+void RegenerationGraph::addStage(Stage stage) {
+    Node node;
+    for (const std::string& dep : stage.dependsOn) {
+        auto it = std::find_if(nodes_.begin(), nodes_.end(), [&](const Node& n) { return n.stage.name == dep; });
+        if (it == nodes_.end()) {
+            throw std::runtime_error("RegenerationGraph: stage '" + stage.name + "' depends on unknown stage '" + dep + "'");
+        }
+        node.upstream.push_back(static_cast<size_t>(it - nodes_.begin()));
+    }
+    node.stage = std::move(stage);
+    nodes_.push_back(std::move(node));
+}
+
+void RegenerationGraph::invalidate() {
+    for (Node& node : nodes_) node.output.reset();
+}
+
+RegenerationGraph::Hash RegenerationGraph::computeKey(const Node& node, const std::vector<Hash>& upstreamKeys) const {
+    ContentHash hash;
+    hash.add(node.stage.name);
+    for (Hash k : upstreamKeys) hash.add(k);
+    if (node.stage.hashInputs) node.stage.hashInputs(hash);
+    return hash.value();
+}
+
+bool RegenerationGraph::wouldReuse(size_t index, Hash& key) const {
+    const Node& node = nodes_[index];
+    std::vector<Hash> upstreamKeys;
+    for (size_t up : node.upstream) {
+        Hash k = 0;
+        if (!wouldReuse(up, k)) return false;
+        upstreamKeys.push_back(k);
+    }
+    key = computeKey(node, upstreamKeys);
+    return node.output && node.key == key;
+}
+
+bool RegenerationGraph::wouldReuse(const std::string& name) const {
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        Hash key = 0;
+        if (nodes_[i].stage.name == name) return wouldReuse(i, key);
+    }
+    return false;
+}
+
+RegenerationGraph::Hash RegenerationGraph::keyOf(size_t index) const {
+    const Node& node = nodes_[index];
+    std::vector<Hash> upstreamKeys;
+    for (size_t up : node.upstream) upstreamKeys.push_back(keyOf(up));
+    return computeKey(node, upstreamKeys);
+}
+
+RegenerationGraph::Hash RegenerationGraph::keyOf(const std::string& name) const {
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i].stage.name == name) return keyOf(i);
+    }
+    throw std::runtime_error("RegenerationGraph: unknown stage '" + name + "'");
+}
+
+void RegenerationGraph::adopt(const TerrainMap& map) {
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        Node& node = nodes_[i];
+        if (!node.stage.capture) continue;
+        node.key = keyOf(i);
+        node.output = node.stage.capture(map);
+        node.adopted = true;
+    }
+}
+
+RegenerationGraph::StageReport RegenerationGraph::runNode(Node& node, TerrainMap& map) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    // Upstream keys are final: their jobs completed before this one started
+    std::vector<Hash> upstreamKeys;
+    for (size_t up : node.upstream) upstreamKeys.push_back(nodes_[up].key);
+    const Hash key = computeKey(node, upstreamKeys);
+
+    StageReport report;
+    report.name = node.stage.name;
+    if (node.output && node.key == key) {
+        if (!node.adopted) node.output->restore(map);
+        report.reused = true;
+    } else {
+        node.output.reset(); // A failing run must not leave a stale hit behind
+        node.stage.run(map);
+        if (node.stage.capture) node.output = node.stage.capture(map);
+    }
+    node.key = key;
+    report.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return report;
+}
+
+std::vector<RegenerationGraph::StageReport> RegenerationGraph::run(TerrainMap& map, RegenerationControl* control) {
+    std::vector<StageReport> reports(nodes_.size());
+    if (control) control->beginStages(static_cast<int>(nodes_.size()));
+
+    // adopt() only vouches for the map of this run, even if it is cancelled
+    struct AdoptedReset {
+        std::vector<Node>& nodes;
+        ~AdoptedReset() {
+            for (Node& node : nodes) node.adopted = false;
+        }
+    } adoptedReset{nodes_};
+
+    // v4.7.0: One job per stage, released as soon as its upstream stages finished.
+    // A failed or cancelled stage fails everything downstream without running it.
+    // Stages are long jobs: only idle workers (or this waiting thread) pick them up.
+    core::JobSystem& jobs = core::JobSystem::instance();
+    std::vector<core::JobSystem::Handle> handles(nodes_.size());
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        std::vector<core::JobSystem::Handle> upstream;
+        for (size_t up : nodes_[i].upstream) upstream.push_back(handles[up]);
+        handles[i] = jobs.submit([this, i, &map, &reports, control]() {
+            if (control) control->checkpoint();
+            reports[i] = runNode(nodes_[i], map);
+            if (control) control->finishStage();
+        }, upstream, core::JobOptions::longRunning());
+    }
+    // Every job must be done before the map and reports go out of scope
+    for (const auto& h : handles) h.wait();
+    for (const auto& h : handles) h.get(); // First failure in graph order
+
+    for (const StageReport& r : reports) {
+        std::cout << "[RegenerationGraph] " << r.name << (r.reused ? ": reused (" : ": ran (") << r.milliseconds << " ms)" << std::endl;
+    }
+    return reports;
+}
+
+} // namespace terrain
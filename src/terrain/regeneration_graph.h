@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace terrain {
+
+class TerrainMap;
+
+// v4.7.0: Incremental 64-bit content hash (FNV-1a) for stage inputs
+class ContentHash {
+public:
+    ContentHash& bytes(const void* data, size_t size);
+
+    template <typename T>
+    ContentHash& add(const T& value) { return bytes(&value, sizeof(T)); }
+
+    template <typename T>
+    ContentHash& add(const std::vector<T>& values) {
+        add(values.size());
+        return bytes(values.data(), values.size() * sizeof(T));
+    }
+
+    ContentHash& add(const std::string& s) {
+        add(s.size());
+        return bytes(s.data(), s.size());
+    }
+
+    uint64_t value() const { return h_; }
+
+private:
+    uint64_t h_ = 1469598103934665603ull;
+};
+
+// v4.7.0: Thrown from RegenerationControl::checkpoint() once the run was cancelled
+class RegenerationCancelled : public std::runtime_error {
+public:
+    RegenerationCancelled() : std::runtime_error("regeneration cancelled") {}
+};
+
+/**
+ * @brief v4.7.0: Cancellation token and progress counters of one regeneration.
+ *
+ * Shared between the UI thread (cancel, progress) and the worker. Long stages
+ * call checkpoint() between tiles of work, so a cancelled run stops within
+ * one tile; the graph also checks between stages.
+ */
+class RegenerationControl {
+public:
+    void cancel() { cancelled_.store(true); }
+    bool isCancelled() const { return cancelled_.load(); }
+    void checkpoint() const {
+        if (isCancelled()) throw RegenerationCancelled();
+    }
+
+    // Graph side: whole stages
+    void beginStages(int count);
+    void finishStage();
+    // Tiled stages: fraction of the current stage
+    void tileProgress(int done, int total);
+
+    // [0, 1], never decreasing
+    float progress() const;
+
+private:
+    std::atomic<bool> cancelled_{false};
+    std::atomic<int> stagesTotal_{0};
+    std::atomic<int> stagesDone_{0};
+    std::atomic<int> tilePermille_{0};
+    mutable std::atomic<int> reportedPermille_{0};
+};
+
+/**
+ * @brief v4.7.0: Regeneration as an explicit stage graph with memoized outputs.
+ *
+ * Each stage declares its upstream stages and hashes the inputs it reads
+ * besides them (config fields, user domain, ...). A stage's key is the hash
+ * of its name, its inputs and the keys of its upstream stages, so a change
+ * invalidates exactly the stages downstream of it. When a key matches the
+ * previous run, the captured output is restored into the map instead of
+ * running the stage again.
+ *
+ * Stages run as jobs on the shared JobSystem, each as soon as its upstream
+ * stages finished; stages not ordered by dependsOn may run concurrently and
+ * must therefore write disjoint parts of the map.
+ */
+class RegenerationGraph {
+public:
+    using Hash = uint64_t;
+
+    // Snapshot of the channels a stage wrote, copied back on a cache hit
+    class Output {
+    public:
+        virtual ~Output() = default;
+        virtual void restore(TerrainMap& map) const = 0;
+    };
+
+    struct Stage {
+        std::string name;
+        std::vector<std::string> dependsOn;                 // Must be added before this stage
+        std::function<void(ContentHash&)> hashInputs;       // Optional: inputs read besides upstream outputs
+        std::function<void(TerrainMap&)> run;
+        std::function<std::unique_ptr<Output>(const TerrainMap&)> capture; // Null: never memoized (always runs)
+    };
+
+    struct StageReport {
+        std::string name;
+        bool reused = false;
+        double milliseconds = 0.0;
+    };
+
+    void addStage(Stage stage);
+
+    // Brings `map` (freshly sized for the run) up to date; one report per stage in graph order.
+    // With a control, throws RegenerationCancelled between stages once cancelled.
+    std::vector<StageReport> run(TerrainMap& map, RegenerationControl* control = nullptr);
+
+    // True if `name` and everything upstream of it would be restored by the next run
+    bool wouldReuse(const std::string& name) const;
+
+    // Key the next run would give `name` (a pure function of the current inputs)
+    Hash keyOf(const std::string& name) const;
+
+    // The map already holds what every memoized stage would produce from the current
+    // inputs (e.g. loaded from disk): memoize it, so the next run only executes the
+    // stages without capture and leaves the map's channels as they are.
+    void adopt(const TerrainMap& map);
+
+    // Forget every memoized output (next run executes all stages)
+    void invalidate();
+
+    size_t stageCount() const { return nodes_.size(); }
+
+private:
+    struct Node {
+        Stage stage;
+        std::vector<size_t> upstream;
+        Hash key = 0;
+        std::shared_ptr<const Output> output;
+        bool adopted = false; // Output already in the map: skip the restore once
+    };
+
+    Hash computeKey(const Node& node, const std::vector<Hash>& upstreamKeys) const;
+    bool wouldReuse(size_t index, Hash& key) const;
+    Hash keyOf(size_t index) const;
+    StageReport runNode(Node& node, TerrainMap& map);
+
+    std::vector<Node> nodes_;
+};
+
+} // namespace terrain
@@ -0,0 +1,340 @@
+#include "simulation_thread.h"
+#include "../landscape/hydro_system.h"
+#include "../landscape/soil_system.h"
+#include "../vegetation/vegetation_system.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <iostream>
+
+namespace terrain {
+
+namespace {
+
+// Wake-up bound of every wait: pause/suspend/rate changes never sit behind a long sleep
+constexpr std::chrono::milliseconds kMaxSleep(50);
+
+bool sameRegime(const vegetation::DisturbanceRegime& a, const vegetation::DisturbanceRegime& b) {
+    return a.type == b.type && a.magnitude == b.magnitude && a.frequency == b.frequency &&
+           a.spatialExtent == b.spatialExtent && a.fireFrequency == b.fireFrequency &&
+           a.grazingIntensity == b.grazingIntensity && a.averageRecoveryTime == b.averageRecoveryTime &&
+           a.alpha == b.alpha && a.beta == b.beta;
+}
+
+// Brings dst (a frame buffer) up to src for the channels the texture streaming
+// reads. Only tiles whose version moved since dst was last filled are copied.
+void copyVisibleVegetation(const vegetation::VegetationGrid& src, vegetation::VegetationGrid& dst) {
+    if (!src.isValid() || src.ei_vigor.size() != src.ei_coverage.size() || src.es_vigor.size() != src.ei_coverage.size()) {
+        dst = vegetation::VegetationGrid();
+        return;
+    }
+    if (dst.generation != src.generation || dst.width != src.width || dst.height != src.height ||
+        dst.tile_version.size() != src.tile_version.size()) {
+        dst.width = src.width;
+        dst.height = src.height;
+        dst.tiles_x = src.tiles_x;
+        dst.tiles_y = src.tiles_y;
+        dst.ei_coverage = src.ei_coverage;
+        dst.es_coverage = src.es_coverage;
+        dst.ei_vigor = src.ei_vigor;
+        dst.es_vigor = src.es_vigor;
+        dst.tile_version = src.tile_version;
+        dst.generation = src.generation;
+        return;
+    }
+
+    const int kTile = vegetation::VegetationGrid::kTileSize;
+    const int tiles = src.tileCount();
+    core::JobSystem::instance().parallelFor(0, tiles, 4, [&](int tileBegin, int tileEnd) {
+        for (int t = tileBegin; t < tileEnd; ++t) {
+            const size_t ti = static_cast<size_t>(t);
+            if (dst.tile_version[ti] == src.tile_version[ti]) continue;
+            const int x0 = (t % src.tiles_x) * kTile;
+            const int y0 = (t / src.tiles_x) * kTile;
+            const size_t n = static_cast<size_t>(std::min(kTile, src.width - x0));
+            for (int y = y0; y < std::min(y0 + kTile, src.height); ++y) {
+                const size_t i = static_cast<size_t>(y) * static_cast<size_t>(src.width) + static_cast<size_t>(x0);
+                dst.ei_coverage.copyFrom(src.ei_coverage, i, n);
+                dst.es_coverage.copyFrom(src.es_coverage, i, n);
+                dst.ei_vigor.copyFrom(src.ei_vigor, i, n);
+                dst.es_vigor.copyFrom(src.es_vigor, i, n);
+            }
+            dst.tile_version[ti] = src.tile_version[ti];
+        }
+    });
+}
+
+} // namespace
+
+bool SimulationParameters::operator==(const SimulationParameters& other) const {
+    return rainIntensity == other.rainIntensity && sameRegime(disturbance, other.disturbance) &&
+           climate.rain_intensity == other.climate.rain_intensity && climate.seasonality == other.climate.seasonality &&
+           organism.max_cover == other.organism.max_cover && organism.disturbance == other.organism.disturbance &&
+           parent.weathering_rate == other.parent.weathering_rate && parent.base_fertility == other.parent.base_fertility &&
+           parent.sand_bias == other.parent.sand_bias && parent.clay_bias == other.parent.clay_bias &&
+           soilLevel == other.soilLevel && soilSimulation == other.soilSimulation;
+}
+
+// --- SimulationCommandQueue ---
+
+SimulationCommandQueue::SimulationCommandQueue(size_t capacity) {
+    size_t size = 1;
+    while (size < std::max<size_t>(capacity, 2)) size <<= 1;
+    slots_.resize(size);
+    mask_ = size - 1;
+}
+
+bool SimulationCommandQueue::push(SimulationCommand&& command) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == slots_.size()) return false;
+    slots_[tail & mask_] = std::move(command);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool SimulationCommandQueue::pop(SimulationCommand& out) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+    SimulationCommand& slot = slots_[head & mask_];
+    out = std::move(slot);
+    slot.action = nullptr; // Captures are released here, not when the slot is reused
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+// --- SimulationThread ---
+
+SimulationThread::FrameRef::FrameRef(FrameRef&& other) noexcept
+    : frame_(other.frame_), readers_(other.readers_) {
+    other.frame_ = nullptr;
+    other.readers_ = nullptr;
+}
+
+SimulationThread::FrameRef& SimulationThread::FrameRef::operator=(FrameRef&& other) noexcept {
+    if (this != &other) {
+        release();
+        frame_ = other.frame_;
+        readers_ = other.readers_;
+        other.frame_ = nullptr;
+        other.readers_ = nullptr;
+    }
+    return *this;
+}
+
+void SimulationThread::FrameRef::release() {
+    if (readers_) readers_->fetch_sub(1);
+    frame_ = nullptr;
+    readers_ = nullptr;
+}
+
+SimulationThread::Pause::Pause(SimulationThread* simulation) : simulation_(simulation) {
+    if (!simulation_) return;
+    simulation_->pauseRequests_.fetch_add(1);
+    lock_ = std::unique_lock<std::mutex>(simulation_->mutex_); // Waits for the tick in progress
+}
+
+SimulationThread::Pause::~Pause() {
+    if (!simulation_) return;
+    simulation_->pauseRequests_.fetch_sub(1);
+    lock_.unlock();
+    simulation_->wake_.notify_all();
+}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::attach(TerrainMap& map, const SimulationParameters& parameters, const SimulationSettings& settings) {
+    stop();
+    map_ = &map;
+    parameters_ = parameters;
+    settings_ = settings;
+    settings_.soilSliceRows = std::max(settings_.soilSliceRows, 1);
+    rng_.seed(settings.seed);
+    rate_.store(settings.ticksPerSecond);
+
+    tick_ = 0;
+    time_ = 0.0;
+    achievedRate_ = 0.0;
+    lastTick_ = {};
+    soilRow_ = 0;
+    soilRowsSwept_ = 0;
+    published_.store(-1);
+    for (Buffer& buffer : buffers_) buffer.frame = SimulationFrame();
+    suspended_.store(false);
+    stopping_.store(false);
+}
+
+void SimulationThread::start(TerrainMap& map, const SimulationParameters& parameters, const SimulationSettings& settings) {
+    attach(map, parameters, settings);
+    std::cout << "[Simulation] Thread started (" << map.getWidth() << "x" << map.getHeight() << ", "
+              << settings.ticksPerSecond << " ticks/s)" << std::endl;
+    worker_ = std::thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop() {
+    if (!worker_.joinable()) return;
+    stopping_.store(true);
+    wake_.notify_all();
+    worker_.join();
+    std::cout << "[Simulation] Thread stopped at tick " << tick_ << " (" << time_ << " s simulated)" << std::endl;
+}
+
+bool SimulationThread::setParameters(const SimulationParameters& parameters) {
+    SimulationCommand command;
+    command.type = SimulationCommand::Type::SetParameters;
+    command.parameters = parameters;
+    return commands_.push(std::move(command));
+}
+
+bool SimulationThread::post(std::function<void(TerrainMap&)> action) {
+    SimulationCommand command;
+    command.type = SimulationCommand::Type::Action;
+    command.action = std::move(action);
+    return commands_.push(std::move(command));
+}
+
+void SimulationThread::setRate(double ticksPerSecond) {
+    rate_.store(ticksPerSecond);
+    wake_.notify_all();
+}
+
+void SimulationThread::setSuspended(bool suspended) {
+    suspended_.store(suspended);
+    wake_.notify_all();
+}
+
+SimulationThread::FrameRef SimulationThread::acquire() const {
+    for (;;) {
+        const int index = published_.load();
+        if (index < 0) return {};
+        const Buffer& buffer = buffers_[index];
+        buffer.readers.fetch_add(1);
+        // The simulation checks readers only after moving published_ away from a
+        // buffer, so seeing the same index again means this one is safe to read
+        if (published_.load() == index) return FrameRef(&buffer.frame, &buffer.readers);
+        buffer.readers.fetch_sub(1);
+    }
+}
+
+void SimulationThread::step() {
+    if (map_ && !worker_.joinable()) tick();
+}
+
+void SimulationThread::run() {
+    using clock = std::chrono::steady_clock;
+    std::unique_lock<std::mutex> lock(mutex_);
+    clock::time_point due = clock::now();
+    while (!stopping_.load()) {
+        const double rate = rate_.load();
+        const clock::time_point now = clock::now();
+        const bool idle = suspended_.load() || pauseRequests_.load() > 0;
+        if (idle || (rate > 0.0 && now < due)) {
+            // Sleeping releases the grids: Pause guards take them here
+            wake_.wait_until(lock, idle ? now + kMaxSleep : std::min(due, now + kMaxSleep));
+            continue;
+        }
+
+        tick();
+
+        // Keep the cadence, but never burst to catch up after slow ticks
+        if (rate > 0.0) {
+            const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / rate));
+            due = std::max(due + period, clock::now() - period);
+        }
+    }
+}
+
+void SimulationThread::drainCommands() {
+    SimulationCommand command;
+    while (commands_.pop(command)) {
+        if (command.type == SimulationCommand::Type::SetParameters) {
+            parameters_ = command.parameters;
+        } else if (command.action) {
+            command.action(*map_);
+            command.action = nullptr;
+        }
+    }
+}
+
+void SimulationThread::tick() {
+    const auto t0 = std::chrono::steady_clock::now();
+    drainCommands();
+
+    const float dt = static_cast<float>(settings_.stepSeconds);
+    auto* veg = map_->getVegetation();
+    auto* soil = map_->getLandscapeSoil();
+    auto* hydro = map_->getLandscapeHydro();
+
+    // 1. Soil: a slice of rows per tick (rolling sweep)
+    if (soil) {
+        const int height = map_->getHeight();
+        const int rowBegin = soilRow_;
+        const int rowEnd = std::min(rowBegin + settings_.soilSliceRows, height);
+        if (parameters_.soilSimulation) {
+            landscape::SoilSystem::update(*soil, dt, parameters_.climate, parameters_.organism, parameters_.parent,
+                                          *map_, rowBegin, rowEnd, parameters_.soilLevel);
+        }
+        soilRowsSwept_ += static_cast<uint64_t>(std::max(rowEnd - rowBegin, 0));
+        soilRow_ = rowEnd >= height ? 0 : rowEnd;
+    }
+
+    // 2. Hydro (global flow)
+    if (soil && hydro && veg) {
+        landscape::HydroSystem::update(*hydro, *soil, *veg, parameters_.rainIntensity, dt);
+    }
+
+    // 3. Vegetation: disturbance + growth
+    if (veg && veg->isValid()) {
+        if (parameters_.disturbance.fireFrequency > 0.0f) {
+            const float probability = parameters_.disturbance.fireFrequency * dt;
+            if (std::uniform_real_distribution<float>(0.0f, 1.0f)(rng_) < probability) {
+                parameters_.disturbance.type = vegetation::DisturbanceType::Fire;
+                vegetation::VegetationSystem::applyDisturbance(*veg, parameters_.disturbance);
+                std::cout << "[Vegetation] Fire Event Triggered!" << std::endl;
+            }
+        }
+        vegetation::VegetationSystem::update(*veg, dt, parameters_.disturbance, soil, hydro);
+    }
+
+    ++tick_;
+    time_ += settings_.stepSeconds;
+    if (observer_) observer_(tick_, time_);
+
+    const auto t1 = std::chrono::steady_clock::now();
+    stepMs_ = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    if (lastTick_.time_since_epoch().count() != 0) {
+        const double interval = std::chrono::duration<double>(t0 - lastTick_).count();
+        if (interval > 0.0) {
+            const double rate = 1.0 / interval;
+            achievedRate_ = achievedRate_ > 0.0 ? 0.9 * achievedRate_ + 0.1 * rate : rate;
+        }
+    }
+    lastTick_ = t0;
+    publish();
+}
+
+void SimulationThread::publish() {
+    // Only this thread stores published_, so the back buffer is the other one
+    const int back = published_.load() == 0 ? 1 : 0;
+    Buffer& buffer = buffers_[back];
+    if (buffer.readers.load() != 0) {
+        skippedPublishes_.fetch_add(1);
+        return;
+    }
+
+    SimulationFrame& frame = buffer.frame;
+    frame.tick = tick_;
+    frame.time = time_;
+    frame.stepMs = stepMs_;
+    frame.ticksPerSecond = achievedRate_;
+    frame.soilRowsSwept = soilRowsSwept_;
+    frame.soilSimulation = parameters_.soilSimulation;
+    if (const auto* veg = map_->getVegetation()) {
+        copyVisibleVegetation(*veg, frame.vegetation);
+    } else {
+        frame.vegetation = vegetation::VegetationGrid();
+    }
+    published_.store(back);
+}
+
+} // namespace terrain
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "terrain_map.h"
+#include "../landscape/landscape_types.h"
+#include "../landscape/soil_services.h"
+#include "../vegetation/vegetation_types.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace terrain {
+
+// v4.7.0: Everything the UI edits that a simulation tick reads
+struct SimulationParameters {
+    float rainIntensity = 50.0f;             // mm/h
+    vegetation::DisturbanceRegime disturbance;
+    landscape::Climate climate;
+    landscape::OrganismPressure organism;
+    landscape::ParentMaterial parent;
+    landscape::SiBCSLevel soilLevel = landscape::SiBCSLevel::Suborder;
+    bool soilSimulation = true;              // False while the user edits the SiBCS domain
+
+    bool operator==(const SimulationParameters& other) const;
+    bool operator!=(const SimulationParameters& other) const { return !(*this == other); }
+};
+
+// Work handed to the simulation thread; runs between two ticks
+struct SimulationCommand {
+    enum class Type { SetParameters, Action };
+    Type type = Type::Action;
+    SimulationParameters parameters;
+    std::function<void(TerrainMap&)> action;
+};
+
+/**
+ * @brief v4.7.0: Bounded single-producer / single-consumer ring (UI thread ->
+ * simulation thread). Neither side blocks or locks; push() fails when full.
+ */
+class SimulationCommandQueue {
+public:
+    explicit SimulationCommandQueue(size_t capacity = 256); // Rounded up to a power of two
+
+    bool push(SimulationCommand&& command); // Producer
+    bool pop(SimulationCommand& out);       // Consumer
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<SimulationCommand> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{0}; // Next slot to pop
+    alignas(64) std::atomic<size_t> tail_{0}; // Next slot to push
+};
+
+// Read-only state published after a tick
+struct SimulationFrame {
+    uint64_t tick = 0;
+    double time = 0.0;               // Simulated seconds
+    double stepMs = 0.0;             // Wall time of the tick
+    double ticksPerSecond = 0.0;     // Achieved rate (smoothed)
+
+    // Visible channels only (coverage, vigor, tile versions, generation): the
+    // texture streaming input. Tiles are copied when their version moved.
+    vegetation::VegetationGrid vegetation;
+
+    // Rows are evolved in a rolling sweep; the count never wraps, so a consumer
+    // that skipped frames still knows which rows changed since it last looked
+    uint64_t soilRowsSwept = 0;
+    bool soilSimulation = true;
+};
+
+struct SimulationSettings {
+    double stepSeconds = 0.1;        // Simulated time per tick
+    double ticksPerSecond = 10.0;    // Wall-clock pacing; 0 = as fast as possible
+    int soilSliceRows = 32;          // Soil rows evolved per tick
+    uint32_t seed = 0;               // Fire events
+};
+
+/**
+ * @brief v4.7.0: Steps hydro, soil and vegetation on a dedicated thread.
+ *
+ * While running, the thread owns the simulated grids of the map (vegetation,
+ * landscape soil and hydro); the heights, soil taxonomy and TerrainMap::soilMap
+ * stay with the caller. Results reach the render thread as SimulationFrames in
+ * two ping-pong buffers: a tick fills the one not published and swaps the
+ * published index atomically. A buffer still held by a reader is never
+ * overwritten (the publish is skipped; the next tick catches up).
+ *
+ * Edits travel over the command queue and apply before the next tick. Code
+ * that must read or write the live grids on another thread (probe, snapshot,
+ * export, replay) holds a Pause, which waits for the tick in progress.
+ */
+class SimulationThread {
+public:
+    // Held reference to a published frame; the simulation does not touch it meanwhile
+    class FrameRef {
+    public:
+        FrameRef() = default;
+        FrameRef(FrameRef&& other) noexcept;
+        FrameRef& operator=(FrameRef&& other) noexcept;
+        FrameRef(const FrameRef&) = delete;
+        FrameRef& operator=(const FrameRef&) = delete;
+        ~FrameRef() { release(); }
+
+        explicit operator bool() const { return frame_ != nullptr; }
+        const SimulationFrame* operator->() const { return frame_; }
+        const SimulationFrame& operator*() const { return *frame_; }
+
+    private:
+        friend class SimulationThread;
+        FrameRef(const SimulationFrame* frame, std::atomic<int>* readers) : frame_(frame), readers_(readers) {}
+        void release();
+
+        const SimulationFrame* frame_ = nullptr;
+        std::atomic<int>* readers_ = nullptr;
+    };
+
+    // Exclusive access to the live grids for the guard's lifetime (no-op for nullptr)
+    class Pause {
+    public:
+        explicit Pause(SimulationThread* simulation);
+        ~Pause();
+        Pause(const Pause&) = delete;
+        Pause& operator=(const Pause&) = delete;
+
+    private:
+        SimulationThread* simulation_;
+        std::unique_lock<std::mutex> lock_;
+    };
+
+    SimulationThread() = default;
+    ~SimulationThread();
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Binds `map` and resets the clock without starting the thread (step() drives it)
+    void attach(TerrainMap& map, const SimulationParameters& parameters, const SimulationSettings& settings = {});
+
+    // attach() + the thread; `map` must outlive it (stop() before replacing it)
+    void start(TerrainMap& map, const SimulationParameters& parameters, const SimulationSettings& settings = {});
+    void stop();
+    bool isRunning() const { return worker_.joinable(); }
+
+    // UI thread (single producer); false if the queue is full
+    bool setParameters(const SimulationParameters& parameters);
+    bool post(std::function<void(TerrainMap&)> action);
+
+    void setRate(double ticksPerSecond); // 0 = unthrottled
+    void setSuspended(bool suspended);   // Ticks stop; commands wait
+
+    // Runs on the simulation thread after every tick, with the grids settled
+    // (e.g. timeline capture). Set it under a Pause.
+    void setTickObserver(std::function<void(uint64_t tick, double time)> observer) { observer_ = std::move(observer); }
+
+    // Latest published frame (empty before the first tick)
+    FrameRef acquire() const;
+
+    // One synchronous tick on the caller's thread (thread not running)
+    void step();
+
+    uint64_t skippedPublishes() const { return skippedPublishes_.load(); }
+
+private:
+    struct Buffer {
+        SimulationFrame frame;
+        mutable std::atomic<int> readers{0};
+    };
+
+    void run();
+    void drainCommands();
+    void tick();
+    void publish();
+
+    TerrainMap* map_ = nullptr;
+    SimulationSettings settings_;
+    SimulationParameters parameters_;
+    SimulationCommandQueue commands_;
+    std::function<void(uint64_t, double)> observer_;
+    std::mt19937 rng_;
+
+    // Simulation thread only
+    uint64_t tick_ = 0;
+    double time_ = 0.0;
+    double stepMs_ = 0.0;
+    double achievedRate_ = 0.0;
+    std::chrono::steady_clock::time_point lastTick_;
+    int soilRow_ = 0;
+    uint64_t soilRowsSwept_ = 0;
+
+    Buffer buffers_[2];
+    std::atomic<int> published_{-1};
+    std::atomic<uint64_t> skippedPublishes_{0};
+
+    std::mutex mutex_;                  // Held by the thread while it ticks
+    std::condition_variable wake_;
+    std::atomic<int> pauseRequests_{0};
+    std::atomic<double> rate_{10.0};
+    std::atomic<bool> suspended_{false};
+    std::atomic<bool> stopping_{false};
+    std::thread worker_;
+};
+
+} // namespace terrain
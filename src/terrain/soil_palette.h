@@ -2,6 +2,7 @@
 
 #include "terrain_map.h"
 #include <cstdint>
+#include <vector>
 
 namespace terrain {
 
@@ -288,4 +289,34 @@ private:
     }
 };
 
+/**
+ * @brief v4.7.0: getCumulativeColor() of every (order, taxon) pair of one world.
+ * Built once per mesh build, so a cell costs a lookup instead of five switches
+ * and an HSV round trip. Valid until the dictionary gains entries.
+ */
+class SoilColorTable {
+public:
+    static constexpr size_t kTypes = static_cast<size_t>(SoilType::Organossolo) + 1;
+
+    SoilColorTable(landscape::SiBCSLevel viewLevel, const landscape::TaxonDictionary& taxa)
+        : taxonCount_(taxa.size()), rgb_(kTypes * taxonCount_ * 3) {
+        for (size_t type = 0; type < kTypes; ++type) {
+            for (size_t t = 0; t < taxonCount_; ++t) {
+                const landscape::SoilTaxon& taxon = taxa[static_cast<landscape::TaxonID>(t)];
+                SoilPalette::getCumulativeColor(viewLevel, static_cast<SoilType>(type), taxon.suborder, taxon.greatGroup,
+                                                taxon.subGroup, taxon.family, taxon.series, &rgb_[(type * taxonCount_ + t) * 3]);
+            }
+        }
+    }
+
+    // storedType as in the soil grid (IDs past Organossolo read as None)
+    const float* color(uint8_t storedType, landscape::TaxonID taxon) const {
+        return &rgb_[(static_cast<size_t>(soilTypeOf(storedType)) * taxonCount_ + taxon) * 3];
+    }
+
+private:
+    size_t taxonCount_;
+    std::vector<float> rgb_;
+};
+
 } // namespace terrain
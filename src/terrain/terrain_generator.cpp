@@ -1,8 +1,14 @@
 #include "terrain_generator.h"
+#include "dem_importer.h"
+#include "../math/fft.h"
+#include "../core/job_system.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <complex>
+#include <cstdint>
+#include <limits>
 #include <iostream>
-#include <map>
 #include <vector>
 #include "../landscape/soil_system.h"
 #include "../landscape/hydro_system.h"
@@ -12,6 +18,19 @@ namespace terrain {
 TerrainGenerator::TerrainGenerator(int seed) : noise_(seed), seed_(seed) {
 }
 
+template <typename Body>
+void TerrainGenerator::forEachRowTile(int h, Body&& body) const {
+    const int tiles = (h + kTileRows - 1) / kTileRows;
+    for (int t = 0; t < tiles; ++t) {
+        if (control_) {
+            control_->checkpoint();
+            control_->tileProgress(t, tiles);
+        }
+        body(t * kTileRows, std::min(h, (t + 1) * kTileRows));
+    }
+    if (control_) control_->tileProgress(tiles, tiles);
+}
+
 // 1. SEED FIX: Use config.seed
 void TerrainGenerator::generateBaseTerrain(TerrainMap& map, const TerrainConfig& config) {
     if (config.seed != 0) {
@@ -28,73 +47,194 @@ void TerrainGenerator::generateBaseTerrain(TerrainMap& map, const TerrainConfig&
     int w = map.getWidth();
     int h = map.getHeight();
 
+    if (config.model == TerrainConfig::FiniteTerrainModel::SpectralSynthesis) {
+        generateSpectralTerrain(map, config);
+        return;
+    }
+
+    // v4.7.0: Real elevations are kept absolute (metres above the DEM datum)
+    if (config.model == TerrainConfig::FiniteTerrainModel::ImportedDem) {
+        DemImporter::importHeights(config.demPath, w, h, config.resolution, map.heightMap(), control_);
+        map.markAllDirty();
+        return;
+    }
+
     // Noise parameters
     float scale = config.noiseScale;
     
-    #pragma omp parallel for collapse(2)
-    for (int z = 0; z < h; ++z) {
-        for (int x = 0; x < w; ++x) {
-            // v3.6.6: Use Physical Coordinates (x * resolution) for Noise Sampling
-            float nx = (static_cast<float>(x) * config.resolution) * scale;
-            float nz = (static_cast<float>(z) * config.resolution) * scale;
-            
-            float val = 0.0f;
-
-            if (config.model == TerrainConfig::FiniteTerrainModel::ExperimentalBlend) {
-                // Experimental Blend Logic
-                // Low Freq (Base)
-                float low = noise_.octaveNoise(nx * 0.5f, nz * 0.5f, 3, 0.5f);
-                
-                // Mid Freq (Rolling)
-                float mid = noise_.octaveNoise(nx * 2.0f, nz * 2.0f, 3, 0.5f);
-                
-                // High Freq (Micro)
-                float high = noise_.octaveNoise(nx * 8.0f, nz * 8.0f, 2, 0.6f);
-                
-                // Weighted Sum
-                val = low * config.blendConfig.lowFreqWeight + mid * config.blendConfig.midFreqWeight + high * config.blendConfig.highFreqWeight;
-                
-                // Normalize by total weight to keep range roughly [-1, 1]
-                float totalWeight = config.blendConfig.lowFreqWeight + config.blendConfig.midFreqWeight + config.blendConfig.highFreqWeight;
-                if (totalWeight > 0.001f) {
-                    val /= totalWeight;
+    // v4.7.0: Row-batched noise (bit-identical to per-cell noise2D/octaveNoise),
+    // in bands so a regeneration can be cancelled between them
+    forEachRowTile(h, [&](int z0, int z1) {
+        core::JobSystem::instance().parallelFor(z0, z1, 0, [&](int rowBegin, int rowEnd) {
+            const size_t n = static_cast<size_t>(w);
+            std::vector<float> nxRow(n), nzRow(n), val(n), sx(n), sz(n), layer(n);
+
+            for (int z = rowBegin; z < rowEnd; ++z) {
+                for (size_t x = 0; x < n; ++x) {
+                    // v3.6.6: Use Physical Coordinates (x * resolution) for Noise Sampling
+                    nxRow[x] = (static_cast<float>(x) * config.resolution) * scale;
+                    nzRow[x] = (static_cast<float>(z) * config.resolution) * scale;
+                }
+
+                if (config.model == TerrainConfig::FiniteTerrainModel::ExperimentalBlend) {
+                    // Experimental Blend Logic
+                    // Low Freq (Base), Mid Freq (Rolling), High Freq (Micro)
+                    auto band = [&](float f, int octaves, float persistence, float weight, bool first) {
+                        for (size_t x = 0; x < n; ++x) {
+                            sx[x] = nxRow[x] * f;
+                            sz[x] = nzRow[x] * f;
+                        }
+                        noise_.octaveNoiseBatch(sx.data(), sz.data(), layer.data(), n, octaves, persistence);
+                        for (size_t x = 0; x < n; ++x) {
+                            val[x] = first ? layer[x] * weight : val[x] + layer[x] * weight;
+                        }
+                    };
+                    band(0.5f, 3, 0.5f, config.blendConfig.lowFreqWeight, true);
+                    band(2.0f, 3, 0.5f, config.blendConfig.midFreqWeight, false);
+                    band(8.0f, 2, 0.6f, config.blendConfig.highFreqWeight, false);
+
+                    // Normalize by total weight to keep range roughly [-1, 1]
+                    float totalWeight = config.blendConfig.lowFreqWeight + config.blendConfig.midFreqWeight + config.blendConfig.highFreqWeight;
+                    for (int x = 0; x < w; ++x) {
+                        float v = val[static_cast<size_t>(x)];
+                        if (totalWeight > 0.001f) {
+                            v /= totalWeight;
+                        }
+
+                        // Map -1..1 to 0..1
+                        v = (v + 1.0f) * 0.5f;
+                        v = std::clamp(v, 0.0f, 1.0f);
+
+                        // Exponent
+                        if (config.blendConfig.exponent != 1.0f) {
+                            v = std::pow(v, config.blendConfig.exponent);
+                        }
+                        map.setHeight(x, z, v * config.maxHeight);
+                    }
+                } else {
+                    // Existing Logic: fBm with config.persistence (v3.7.1), normalized by total amplitude
+                    noise_.octaveNoiseBatch(nxRow.data(), nzRow.data(), val.data(), n, config.octaves, config.persistence);
+                    for (int x = 0; x < w; ++x) {
+                        // Map -1..1 to 0..1
+                        float v = (val[static_cast<size_t>(x)] + 1.0f) * 0.5f;
+
+                        // Apply curve
+                        v = std::pow(v, 2.0f);
+                        map.setHeight(x, z, v * config.maxHeight);
+                    }
+                }
+            }
+        });
+    });
+}
+
+namespace {
+
+// Counter-based hash (splitmix64): random value for a spectral bin, independent of
+// evaluation order, so synthesis is deterministic for any thread count
+uint64_t binHash(uint64_t seed, uint64_t row, uint64_t col) {
+    uint64_t z = seed * 0x9E3779B97F4A7C15ull + row * 0xBF58476D1CE4E5B9ull + col * 0x94D049BB133111EBull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+} // namespace
+
+// v4.7.0: Spectral synthesis. A random Gaussian spectrum with power-law amplitude is
+// built directly on the half plane and brought back with one inverse real FFT, so
+// cost is O(N log N) whatever the octave/detail content. The synthesis grid is the
+// next power of two in each direction; the map is a crop of it (periodic only when
+// the map size is itself a power of two).
+void TerrainGenerator::generateSpectralTerrain(TerrainMap& map, const TerrainConfig& config) {
+    const int w = map.getWidth();
+    const int h = map.getHeight();
+    if (w < 1 || h < 1) return;
+
+    const size_t P = math::FFT::nextPowerOfTwo(static_cast<size_t>(std::max(w, 2)));
+    const size_t Q = math::FFT::nextPowerOfTwo(static_cast<size_t>(h));
+    const size_t bins = P / 2 + 1;
+
+    const double beta = config.spectralConfig.beta > 0.0f
+        ? static_cast<double>(config.spectralConfig.beta)
+        : -2.0 * std::log2(std::clamp(static_cast<double>(config.persistence), 0.05, 0.95));
+    const float expo = static_cast<float>(-beta / 4.0); // amp = (f^2 + f0^2)^(-beta/4)
+    const float f0sq = config.noiseScale * config.noiseScale;
+    const double dfx = 1.0 / (static_cast<double>(P) * config.resolution); // Cycles per metre
+    const double dfz = 1.0 / (static_cast<double>(Q) * config.resolution);
+    const uint64_t seed = static_cast<uint64_t>(static_cast<uint32_t>(seed_));
+
+    std::vector<std::complex<float>> spectrum(bins * Q);
+
+    core::JobSystem::instance().parallelFor(0, static_cast<int>(Q), 0, [&](int rowBegin, int rowEnd) {
+        for (int q = rowBegin; q < rowEnd; ++q) {
+            for (size_t k = 0; k < bins; ++k) {
+                // Columns 0 and P/2 are their own mirror: take the lower half and
+                // conjugate it so the synthesized field is real
+                size_t row = static_cast<size_t>(q);
+                bool mirrored = false;
+                const bool selfConjugateColumn = (k == 0 || k == P / 2);
+                if (selfConjugateColumn && row > Q / 2) {
+                    row = Q - row;
+                    mirrored = true;
                 }
-                
-                // Map -1..1 to 0..1
-                val = (val + 1.0f) * 0.5f;
-                val = std::clamp(val, 0.0f, 1.0f);
-                
-                // Exponent
-                if (config.blendConfig.exponent != 1.0f) {
-                    val = std::pow(val, config.blendConfig.exponent);
+                if (k == 0 && row == 0) {
+                    spectrum[static_cast<size_t>(q) * bins] = 0.0f; // No DC (normalized below)
+                    continue;
                 }
-                
-            } else {
-                // Existing Logic
-                float freq = 1.0f;
-                float amp = 1.0f;
-                float maxAmp = 0.0f;
-                
-                for(int i=0; i<config.octaves; ++i) {
-                    val += noise_.noise2D(nx * freq, nz * freq) * amp;
-                    maxAmp += amp;
-                    amp *= config.persistence; // v3.7.1
-                    freq *= 2.0f;
+
+                const float fz = static_cast<float>((row <= Q / 2 ? static_cast<double>(row) : static_cast<double>(row) - static_cast<double>(Q)) * dfz);
+                const float fx = static_cast<float>(static_cast<double>(k) * dfx);
+                const float amp = std::exp(expo * std::log(fx * fx + fz * fz + f0sq));
+
+                // Box-Muller from two 24-bit uniforms in (0, 1]
+                const uint64_t bits = binHash(seed, row, k);
+                const float u1 = (static_cast<float>(bits >> 40) + 1.0f) * (1.0f / 16777216.0f);
+                const float u2 = static_cast<float>((bits >> 8) & 0xFFFFFFull) * (1.0f / 16777216.0f);
+                const float r = std::sqrt(-2.0f * std::log(u1)) * amp;
+                const float angle = 6.28318530717958647692f * u2;
+                float re = r * std::cos(angle);
+                float im = r * std::sin(angle);
+                if (selfConjugateColumn && (row == 0 || row == Q / 2)) im = 0.0f;
+                if (mirrored) im = -im;
+
+                spectrum[static_cast<size_t>(q) * bins + k] = std::complex<float>(re, im);
+            }
+        }
+    });
+
+    std::vector<float> field(P * Q);
+    if (control_) control_->checkpoint();
+    math::fft2DRealInverse(spectrum.data(), P, Q, field.data());
+
+    // Normalize the cropped region to [0, 1], then the same curve as the Perlin model
+    using Range = std::pair<float, float>;
+    const Range bounds = core::JobSystem::instance().parallelReduce(0, h, 0,
+        Range(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()),
+        [&](int rowBegin, int rowEnd) {
+            Range r(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+            for (int z = rowBegin; z < rowEnd; ++z) {
+                for (int x = 0; x < w; ++x) {
+                    float v = field[static_cast<size_t>(z) * P + static_cast<size_t>(x)];
+                    r.first = std::min(r.first, v);
+                    r.second = std::max(r.second, v);
                 }
-                
-                val /= maxAmp; 
-                
-                // Map -1..1 to 0..1
-                val = (val + 1.0f) * 0.5f;
-                
-                // Apply curve
-                val = std::pow(val, 2.0f); 
             }
-            
-            // Set Height
-            map.setHeight(x, z, val * config.maxHeight);
+            return r;
+        },
+        [](const Range& a, const Range& b) { return Range(std::min(a.first, b.first), std::max(a.second, b.second)); });
+    const float lo = bounds.first;
+    const float hi = bounds.second;
+    const float range = hi > lo ? hi - lo : 1.0f;
+
+    core::JobSystem::instance().parallelFor(0, h, 0, [&](int rowBegin, int rowEnd) {
+        for (int z = rowBegin; z < rowEnd; ++z) {
+            for (int x = 0; x < w; ++x) {
+                float v = (field[static_cast<size_t>(z) * P + static_cast<size_t>(x)] - lo) / range;
+                map.setHeight(x, z, v * v * config.maxHeight);
+            }
         }
-    }
+    });
 }
 
 // 2. D8 FIX: Use Slope (Drop/Distance)
@@ -172,95 +312,286 @@ void TerrainGenerator::calculateDrainage(TerrainMap& map) {
     std::cout << "[TerrainGenerator] Drainage Calculation Complete." << std::endl;
 }
 
-void TerrainGenerator::classifySoil(TerrainMap& map, const TerrainConfig& config) {
-    int w = map.getWidth();
-    int h = map.getHeight();
+namespace {
+
+// --- Landscape Ecology Patch Configuration ---
+// Mapping LSI/CF/RCC to Noise Parameters: {frequency, warping, roughness, stretchY}
+// Indexed by SoilType (None unused)
+constexpr int kPatternTypes = static_cast<int>(SoilType::Rocha) + 1;
+
+// Candidate Soils based on Slope Class (Catena)
+struct CandidateSet {
+    int count;
+    SoilType types[3];
+};
+
+const CandidateSet kSlopeClasses[] = {
+    {3, {SoilType::Hidromorfico, SoilType::BTextural, SoilType::Argila}}, // < 3%
+    {3, {SoilType::BTextural, SoilType::BemDes, SoilType::Argila}},       // < 8%
+    {2, {SoilType::BTextural, SoilType::Argila}},                         // < 20%
+    {2, {SoilType::BTextural, SoilType::Raso}},                           // < 45%
+    {1, {SoilType::Raso}},                                                // < 75%
+    {1, {SoilType::Rocha}}
+};
+
+inline int slopeClass(float localSlope) {
+    if (localSlope < 3.0f) return 0;
+    if (localSlope < 8.0f) return 1;
+    if (localSlope < 20.0f) return 2;
+    if (localSlope < 45.0f) return 3;
+    if (localSlope < 75.0f) return 4;
+    return 5;
+}
 
-    // --- Landscape Ecology Patch Configuration ---
-    // Mapping LSI/CF/RCC to Noise Parameters
-    struct SoilPatchConfig {
-        float frequency;    // Patch Size (Inverse)
-        float warping;      // LSI (Distortion)
-        float roughness;    // CF (Complexity/Octaves)
-        float stretchY;     // RCC (Anisotropy)
-    };
+// Lattice samples per period of the finest octave. Upsampled strengths are only
+// trusted where the winning margin exceeds the local interpolation error bound;
+// the remaining (boundary) cells are evaluated exactly. Fields whose lattice would
+// be no coarser than the grid are evaluated exactly per row instead.
+constexpr float kSamplesPerPeriod = 3.0f;
 
-    // Constant configs for soil types
-    static const std::map<SoilType, SoilPatchConfig> soilConfigs = {
-        // Solo Raso: LSI High (5434), CF Mod (2.49), RCC 0.66
-        {SoilType::Raso,          {1.5f, 25.0f, 0.8f, 1.2f}}, 
-        
-        // Bem Desenvolvido: LSI Low (2508), CF Low (2.36), RCC High (0.68 - Most Circular)
-        {SoilType::BemDes,        {0.8f, 2.0f,  0.2f, 1.0f}}, 
-        
+} // namespace
+
+const TerrainGenerator::SoilPatchConfig& TerrainGenerator::soilPatchConfig(SoilType type) {
+    static const SoilPatchConfig configs[kPatternTypes] = {
+        {1.0f, 0.0f,  0.5f, 1.0f}, // None (unused)
         // Hidromorfico: LSI Mod (3272), CF Low (2.27), RCC 0.65
-        {SoilType::Hidromorfico,  {1.2f, 8.0f,  0.3f, 1.5f}}, 
-        
-        // Argila Expansiva: LSI Low (1827), CF High (2.84), RCC 0.64 (Alongado/Irregular)
-        {SoilType::Argila,        {2.0f, 5.0f,  0.9f, 0.6f}}, 
-        
+        {1.2f, 8.0f,  0.3f, 1.5f},
         // B-Textural: Avg values
-        {SoilType::BTextural,     {1.0f, 10.0f, 0.5f, 1.0f}},
-        
-        {SoilType::Rocha,         {1.0f, 0.0f,  0.5f, 1.0f}} // Fallback
+        {1.0f, 10.0f, 0.5f, 1.0f},
+        // Argila Expansiva: LSI Low (1827), CF High (2.84), RCC 0.64 (Alongado/Irregular)
+        {2.0f, 5.0f,  0.9f, 0.6f},
+        // Bem Desenvolvido: LSI Low (2508), CF Low (2.36), RCC High (0.68 - Most Circular)
+        {0.8f, 2.0f,  0.2f, 1.0f},
+        // Solo Raso: LSI High (5434), CF Mod (2.49), RCC 0.66
+        {1.5f, 25.0f, 0.8f, 1.2f},
+        {1.0f, 0.0f,  0.5f, 1.0f}  // Rocha: Fallback
     };
+    return configs[static_cast<int>(type)];
+}
 
-    // Helper Lambda for Pattern Strength
-    // calculateSoilPattern is thread-safe (const method using const noise_)
-    
-    #pragma omp parallel for collapse(2)
-    for (int z = 0; z < h; ++z) {
-        for (int x = 0; x < w; ++x) {
-            float hL = map.getHeight(std::max(0, x-1), z);
-            float hR = map.getHeight(std::min(w-1, x+1), z);
-            float hD = map.getHeight(x, std::max(0, z-1));
-            float hU = map.getHeight(x, std::min(h-1, z+1));
-            
-            float dz_dx = (hR - hL) / (2.0f * config.resolution);
-            float dz_dz = (hU - hD) / (2.0f * config.resolution);
-            
-            float localSlope = std::sqrt(dz_dx*dz_dx + dz_dz*dz_dz) * 100.0f;
-
-            // Physical Coordinates for Scale Invariance
-            // This ensures patterns have the same physical size in meters regardless of grid resolution
-            float worldX = x * config.resolution;
-            float worldZ = z * config.resolution;
-
-            // Candidate Soils based on Slope Class (Catena)
-            std::vector<SoilType> candidates;
-
-            if (localSlope < 3.0f) {
-                candidates = {SoilType::Hidromorfico, SoilType::BTextural, SoilType::Argila};
-            } else if (localSlope < 8.0f) {
-                candidates = {SoilType::BTextural, SoilType::BemDes, SoilType::Argila};
-            } else if (localSlope < 20.0f) {
-                candidates = {SoilType::BTextural, SoilType::Argila};
-            } else if (localSlope < 45.0f) {
-                candidates = {SoilType::BTextural, SoilType::Raso};
-            } else if (localSlope < 75.0f) {
-                candidates = {SoilType::Raso};
-            } else {
-                candidates = {SoilType::Rocha};
+// v4.7.0: Pattern fields only depend on seed, grid size and resolution, never on
+// heights, so they are sampled once on a coarse lattice per soil type (spacing from
+// the finest octave's wavelength) and reused until one of those changes.
+void TerrainGenerator::updateSoilPatternCache(int w, int h, float resolution) {
+    SoilPatternCache& cache = soilPatterns_;
+    if (cache.valid && cache.seed == seed_ && cache.width == w && cache.height == h && cache.resolution == resolution) return;
+
+    cache.fields.assign(kPatternTypes, {});
+    for (int t = 1; t < kPatternTypes; ++t) {
+        // Only soils that ever compete need a field (Rocha is uncontested)
+        bool contested = false;
+        for (const CandidateSet& set : kSlopeClasses) {
+            for (int c = 0; c < set.count; ++c) contested |= set.count > 1 && static_cast<int>(set.types[c]) == t;
+        }
+        if (!contested) continue;
+
+        const SoilPatchConfig& cfg = soilPatchConfig(static_cast<SoilType>(t));
+        SoilPatternCache::Field& field = cache.fields[static_cast<size_t>(t)];
+
+        // Finest octave period in metres: 100 / (frequency * 2^(octaves-1)); z is stretched
+        const int octaves = 1 + static_cast<int>(cfg.roughness * 4.0f);
+        const float periodX = 100.0f / (cfg.frequency * static_cast<float>(1 << (octaves - 1)));
+        const float periodZ = periodX / cfg.stretchY;
+        field.stepX = std::max(1, static_cast<int>(periodX / (kSamplesPerPeriod * resolution)));
+        field.stepZ = std::max(1, static_cast<int>(periodZ / (kSamplesPerPeriod * resolution)));
+        if (field.stepX == 1 && field.stepZ == 1) {
+            field.perRow = true;
+            continue;
+        }
+        field.width = (w - 1 + field.stepX - 1) / field.stepX + 1;
+        field.height = (h - 1 + field.stepZ - 1) / field.stepZ + 1;
+        field.values.resize(static_cast<size_t>(field.width) * static_cast<size_t>(field.height));
+
+        core::JobSystem::instance().parallelFor(0, field.height, 0, [&](int rowBegin, int rowEnd) {
+            std::vector<float> px(static_cast<size_t>(field.width)), pz(static_cast<size_t>(field.width));
+
+            for (int j = rowBegin; j < rowEnd; ++j) {
+                for (int i = 0; i < field.width; ++i) {
+                    // Physical Coordinates for Scale Invariance
+                    px[static_cast<size_t>(i)] = static_cast<float>(i * field.stepX) * resolution;
+                    pz[static_cast<size_t>(i)] = static_cast<float>(j * field.stepZ) * resolution;
+                }
+                calculateSoilPatternBatch(px.data(), pz.data(), px.size(), cfg,
+                                          field.values.data() + static_cast<size_t>(j) * static_cast<size_t>(field.width));
             }
-
-            // Competition: Select candidate with highest pattern strength
-            SoilType bestSoil = SoilType::Rocha; // Default
-            float maxStrength = -1e9f;
-
-            for (auto type : candidates) {
-                const auto& cfg = soilConfigs.at(type);
-                // PASS WORLD COORDINATES HERE
-                float strength = calculateSoilPattern(worldX, worldZ, {cfg.frequency, cfg.warping, cfg.roughness, cfg.stretchY});
-                
-                if (strength > maxStrength) {
-                    maxStrength = strength;
-                    bestSoil = type;
+        });
+
+        // Bilinear error per lattice cell: |f - If| <= (u(1-u) |f_xx| hx^2 + v(1-v) |f_zz| hz^2) / 2,
+        // with the curvature terms taken from node second differences (max over the
+        // cell's four corners). Stored as the x and z coefficients of u(1-u), v(1-v).
+        const int fw = field.width, fh = field.height;
+        std::vector<float> nodeXX(field.values.size(), 0.0f), nodeZZ(field.values.size(), 0.0f);
+        auto val = [&](int i, int j) { return field.values[static_cast<size_t>(j) * static_cast<size_t>(fw) + static_cast<size_t>(i)]; };
+        core::JobSystem::instance().parallelFor(0, fh, 0, [&](int rowBegin, int rowEnd) {
+            for (int j = rowBegin; j < rowEnd; ++j) {
+                for (int i = 0; i < fw; ++i) {
+                    const size_t idx = static_cast<size_t>(j) * static_cast<size_t>(fw) + static_cast<size_t>(i);
+                    nodeXX[idx] = (i > 0 && i + 1 < fw) ? std::abs(val(i - 1, j) - 2.0f * val(i, j) + val(i + 1, j)) : 0.0f;
+                    nodeZZ[idx] = (j > 0 && j + 1 < fh) ? std::abs(val(i, j - 1) - 2.0f * val(i, j) + val(i, j + 1)) : 0.0f;
                 }
             }
-
-            map.setSoil(x, z, bestSoil);
-        }
+        });
+        field.error.resize(field.values.size() * 2);
+        core::JobSystem::instance().parallelFor(0, fh, 0, [&](int rowBegin, int rowEnd) {
+            for (int j = rowBegin; j < rowEnd; ++j) {
+                const int j1 = std::min(j + 1, fh - 1);
+                for (int i = 0; i < fw; ++i) {
+                    const int i1 = std::min(i + 1, fw - 1);
+                    auto cellMax = [&](const std::vector<float>& d) {
+                        auto at = [&](int a, int b) { return d[static_cast<size_t>(b) * static_cast<size_t>(fw) + static_cast<size_t>(a)]; };
+                        return std::max(std::max(at(i, j), at(i1, j)), std::max(at(i, j1), at(i1, j1)));
+                    };
+                    const size_t idx = static_cast<size_t>(j) * static_cast<size_t>(fw) + static_cast<size_t>(i);
+                    field.error[2 * idx] = 0.5f * cellMax(nodeXX);
+                    field.error[2 * idx + 1] = 0.5f * cellMax(nodeZZ);
+                }
+            }
+        });
     }
+
+    cache.seed = seed_;
+    cache.width = w;
+    cache.height = h;
+    cache.resolution = resolution;
+    cache.valid = true;
+}
+
+void TerrainGenerator::classifySoil(TerrainMap& map, const TerrainConfig& config) {
+    int w = map.getWidth();
+    int h = map.getHeight();
+    if (w < 1 || h < 1) return;
+
+    updateSoilPatternCache(w, h, config.resolution);
+    const SoilPatternCache& cache = soilPatterns_;
+
+    const float* heights = map.heightMap().data();
+    map.shareSoilTypes(false); // v4.7.0: Patterns need the map's own buffer
+    uint8_t* soil = map.soilMap().data();
+
+    // Bands of rows: a regeneration can be cancelled between them
+    forEachRowTile(h, [&](int z0, int z1) {
+        core::JobSystem::instance().parallelFor(z0, z1, 0, [&](int rowBegin, int rowEnd) {
+            // Upsampled strength and error bound of every contested soil type for one row
+            std::vector<float> rowValue(static_cast<size_t>(kPatternTypes) * static_cast<size_t>(w));
+            std::vector<float> rowError(rowValue.size());
+            std::vector<float> colValue, colError;
+            // Cells too close to call from the lattice (patch boundaries), evaluated
+            // exactly in one batch per soil type
+            std::vector<int> ambCell, ambClass;
+            std::vector<float> ambX, ambZ, exact, strength;
+            std::vector<size_t> slot;
+
+            for (int z = rowBegin; z < rowEnd; ++z) {
+                for (int t = 1; t < kPatternTypes; ++t) {
+                    const SoilPatternCache::Field& f = cache.fields[static_cast<size_t>(t)];
+                    float* value = rowValue.data() + static_cast<size_t>(t) * static_cast<size_t>(w);
+                    float* error = rowError.data() + static_cast<size_t>(t) * static_cast<size_t>(w);
+                    if (f.perRow) {
+                        ambX.resize(static_cast<size_t>(w));
+                        ambZ.assign(static_cast<size_t>(w), static_cast<float>(z) * config.resolution);
+                        for (int x = 0; x < w; ++x) ambX[static_cast<size_t>(x)] = static_cast<float>(x) * config.resolution;
+                        calculateSoilPatternBatch(ambX.data(), ambZ.data(), ambX.size(), soilPatchConfig(static_cast<SoilType>(t)), value);
+                        std::fill(error, error + w, 0.0f);
+                        continue;
+                    }
+                    if (f.values.empty()) continue;
+                    const int j = z / f.stepZ, j1 = std::min(j + 1, f.height - 1);
+                    const float v = static_cast<float>(z - j * f.stepZ) / static_cast<float>(f.stepZ);
+                    const size_t row0 = static_cast<size_t>(j) * static_cast<size_t>(f.width);
+                    const size_t row1 = static_cast<size_t>(j1) * static_cast<size_t>(f.width);
+                    // Interpolate the two lattice rows along z first, then along x per cell
+                    colValue.resize(static_cast<size_t>(f.width));
+                    colError.resize(static_cast<size_t>(f.width));
+                    const float wu = v * (1.0f - v);
+                    for (int i = 0; i < f.width; ++i) {
+                        const size_t n0 = row0 + static_cast<size_t>(i);
+                        const float a = f.values[n0];
+                        colValue[static_cast<size_t>(i)] = a + (f.values[row1 + static_cast<size_t>(i)] - a) * v;
+                        colError[static_cast<size_t>(i)] = f.error[2 * n0 + 1] * wu;
+                    }
+                    const float invStep = 1.0f / static_cast<float>(f.stepX);
+                    for (int i = 0, x = 0; x < w; ++i) {
+                        const int i1 = std::min(i + 1, f.width - 1);
+                        const float a = colValue[static_cast<size_t>(i)], d = colValue[static_cast<size_t>(i1)] - a;
+                        const float ex = f.error[2 * (row0 + static_cast<size_t>(i))], ez = colError[static_cast<size_t>(i)];
+                        for (int k = 0; k < f.stepX && x < w; ++k, ++x) {
+                            const float u = static_cast<float>(k) * invStep;
+                            value[x] = a + d * u;
+                            error[x] = ex * u * (1.0f - u) + ez;
+                        }
+                    }
+                }
+
+                const float* row = heights + static_cast<size_t>(z) * static_cast<size_t>(w);
+                const float* rowD = heights + static_cast<size_t>(std::max(0, z - 1)) * static_cast<size_t>(w);
+                const float* rowU = heights + static_cast<size_t>(std::min(h - 1, z + 1)) * static_cast<size_t>(w);
+                uint8_t* soilRow = soil + static_cast<size_t>(z) * static_cast<size_t>(w);
+                ambCell.clear();
+                ambClass.clear();
+                for (int x = 0; x < w; ++x) {
+                    float dz_dx = (row[std::min(w - 1, x + 1)] - row[std::max(0, x - 1)]) / (2.0f * config.resolution);
+                    float dz_dz = (rowU[x] - rowD[x]) / (2.0f * config.resolution);
+
+                    float localSlope = std::sqrt(dz_dx*dz_dx + dz_dz*dz_dz) * 100.0f;
+
+                    // Competition: Select candidate with highest pattern strength
+                    const int cls = slopeClass(localSlope);
+                    const CandidateSet& set = kSlopeClasses[cls];
+                    int best = 0;
+                    if (set.count > 1) {
+                        float value[3], error[3];
+                        for (int c = 0; c < set.count; ++c) {
+                            const size_t idx = static_cast<size_t>(set.types[c]) * static_cast<size_t>(w) + static_cast<size_t>(x);
+                            value[c] = rowValue[idx];
+                            error[c] = rowError[idx];
+                            if (value[c] > value[best]) best = c;
+                        }
+                        for (int c = 0; c < set.count; ++c) {
+                            if (c != best && value[best] - value[c] <= error[best] + error[c]) {
+                                ambCell.push_back(x);
+                                ambClass.push_back(cls);
+                                break;
+                            }
+                        }
+                    }
+                    soilRow[x] = static_cast<uint8_t>(set.types[best]);
+                }
+                if (ambCell.empty()) continue;
+
+                // Exact strengths, 3 slots per ambiguous cell in candidate order
+                const size_t n = ambCell.size();
+                strength.assign(n * 3, 0.0f);
+                for (int t = 1; t < kPatternTypes; ++t) {
+                    ambX.clear();
+                    ambZ.clear();
+                    slot.clear();
+                    for (size_t k = 0; k < n; ++k) {
+                        const CandidateSet& set = kSlopeClasses[ambClass[k]];
+                        for (int c = 0; c < set.count; ++c) {
+                            if (static_cast<int>(set.types[c]) != t) continue;
+                            // Physical Coordinates for Scale Invariance
+                            ambX.push_back(static_cast<float>(ambCell[k]) * config.resolution);
+                            ambZ.push_back(static_cast<float>(z) * config.resolution);
+                            slot.push_back(k * 3 + static_cast<size_t>(c));
+                        }
+                    }
+                    if (slot.empty()) continue;
+                    exact.resize(slot.size());
+                    calculateSoilPatternBatch(ambX.data(), ambZ.data(), slot.size(), soilPatchConfig(static_cast<SoilType>(t)), exact.data());
+                    for (size_t s = 0; s < slot.size(); ++s) strength[slot[s]] = exact[s];
+                }
+
+                for (size_t k = 0; k < n; ++k) {
+                    const CandidateSet& set = kSlopeClasses[ambClass[k]];
+                    int best = 0;
+                    for (int c = 1; c < set.count; ++c) {
+                        if (strength[k * 3 + static_cast<size_t>(c)] > strength[k * 3 + static_cast<size_t>(best)]) best = c;
+                    }
+                    soilRow[ambCell[k]] = static_cast<uint8_t>(set.types[best]);
+                }
+            }
+        });
+    });
 }
 
 void TerrainGenerator::classifySoilFromSCORPAN(TerrainMap& map, const landscape::SiBCSUserConfig* domain) {
@@ -310,29 +641,37 @@ void TerrainGenerator::classifySoilFromSCORPAN(TerrainMap& map, const landscape:
         }
     };
 
+    // v4.7.0: The map views soil_type instead of receiving a copy. Orders outside
+    // the domain are hidden from that view; the SiBCS grid keeps them, so a
+    // wider domain shows them again without a new classification.
+    auto inDomain = [&](uint8_t stored) {
+        const auto order = orderFromSoilType(stored);
+        return order != landscape::SiBCSOrder::kNone &&
+               std::find(allowedOrders.begin(), allowedOrders.end(), order) != allowedOrders.end();
+    };
+    SoilMask shown = soilMaskOf(SoilType::None);
+    for (int stored = 0; stored <= static_cast<int>(SoilType::Organossolo); ++stored) {
+        if (inDomain(static_cast<uint8_t>(stored))) shown |= soilMaskOf(static_cast<SoilType>(stored));
+    }
+
     int w = map.getWidth();
     int h = map.getHeight();
-    long long applied = 0;
-    long long cleared = 0;
-
-    #pragma omp parallel for reduction(+:applied, cleared) collapse(2)
-    for (int z = 0; z < h; ++z) {
-        for (int x = 0; x < w; ++x) {
-            size_t idx = static_cast<size_t>(z * w + x);
-            auto order = orderFromSoilType(grid->soil_type[idx]);
-            bool inDomain = (order != landscape::SiBCSOrder::kNone) && 
-                            (std::find(allowedOrders.begin(), allowedOrders.end(), order) != allowedOrders.end());
-
-            if (!inDomain) {
-                map.setSoil(x, z, SoilType::None);
-                cleared += 1;
-                continue;
+    std::atomic<long long> applied{0};
+    std::atomic<long long> cleared{0};
+    core::JobSystem::instance().parallelFor(0, h, 0, [&](int rowBegin, int rowEnd) {
+        long long chunkApplied = 0, chunkCleared = 0;
+        for (int z = rowBegin; z < rowEnd; ++z) {
+            for (int x = 0; x < w; ++x) {
+                size_t idx = static_cast<size_t>(z * w + x);
+                if (inDomain(grid->soil_type[idx])) chunkApplied += 1;
+                else chunkCleared += 1;
             }
-
-            map.setSoil(x, z, static_cast<SoilType>(grid->soil_type[idx]));
-            applied += 1;
         }
-    }
+        applied += chunkApplied;
+        cleared += chunkCleared;
+    });
+    map.setSoilDomain(shown);
+    map.shareSoilTypes(true);
     
     std::cout << "[TerrainGenerator] SCORPAN classifications synced to map (" << applied 
               << " in-domain cells, " << cleared << " cleared outside domain)." << std::endl;
@@ -362,6 +701,31 @@ float TerrainGenerator::calculateSoilPattern(float x, float z, const SoilPatchCo
     return noise_.octaveNoise(nx, nz, octaves, persistence);
 }
 
+// v4.7.0: Batch form of calculateSoilPattern (same operation order, SIMD noise)
+void TerrainGenerator::calculateSoilPatternBatch(const float* x, const float* z, size_t n, const SoilPatchConfig& cfg, float* out) const {
+    std::vector<float> nx(n), nz(n);
+    for (size_t i = 0; i < n; ++i) {
+        nx[i] = x[i] * 0.01f * cfg.frequency;
+        nz[i] = z[i] * 0.01f * cfg.frequency * cfg.stretchY;
+    }
+
+    if (cfg.warping > 0.0f) {
+        std::vector<float> sx(n), sz(n), qx(n), qz(n);
+        for (size_t i = 0; i < n; ++i) { sx[i] = nx[i] + 5.2f; sz[i] = nz[i] + 1.3f; }
+        noise_.noise2DBatch(sx.data(), sz.data(), qx.data(), n);
+        for (size_t i = 0; i < n; ++i) { sx[i] = nx[i] + 1.3f; sz[i] = nz[i] + 5.2f; }
+        noise_.noise2DBatch(sx.data(), sz.data(), qz.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            nx[i] += qx[i] * cfg.warping * 0.01f;
+            nz[i] += qz[i] * cfg.warping * 0.01f;
+        }
+    }
+
+    int octaves = 1 + static_cast<int>(cfg.roughness * 4.0f); // 1 to 5
+    float persistence = 0.3f + (cfg.roughness * 0.4f);        // 0.3 to 0.7
+    noise_.octaveNoiseBatch(nx.data(), nz.data(), out, n, octaves, persistence);
+}
+
 // Keeping empty implementation for now to satisfy link, or basic one.
 void TerrainGenerator::applyErosion(TerrainMap& map, int /*iterations*/) {
     // Optional: Can add simple erosion based on the calculated flux later.
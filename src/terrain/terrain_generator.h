@@ -2,7 +2,9 @@
 #include "terrain_map.h"
 #include "../math/noise.h"
 #include "../landscape/landscape_types.h"
+#include "regeneration_graph.h"
 #include <memory>
+#include <vector>
 
 namespace terrain {
 
@@ -24,9 +26,22 @@ public:
     void applyErosion(TerrainMap& map, int iterations); // Kept for legacy/optional
     void generateRivers(TerrainMap& map);
 
+    // v4.7.0: Optional cancellation/progress for the tiled passes (base terrain,
+    // soil classification), checked between bands of kTileRows rows. Not owned.
+    static constexpr int kTileRows = 128;
+    void setControl(RegenerationControl* control) { control_ = control; }
+
 private:
+    // Runs body(z0, z1) over row bands, with a checkpoint before each band
+    template <typename Body>
+    void forEachRowTile(int h, Body&& body) const;
+
+    // v4.7.0: FiniteTerrainModel::SpectralSynthesis path of generateBaseTerrain
+    void generateSpectralTerrain(TerrainMap& map, const TerrainConfig& config);
+
     math::PerlinNoise noise_;
     int seed_;
+    RegenerationControl* control_ = nullptr;
     
     struct SoilPatchConfig {
         float frequency = 1.0f;    // Controls patch size (Inverse Scale)
@@ -37,6 +52,32 @@ private:
     
     // Helper to calculate pattern strength for a specific soil config
     float calculateSoilPattern(float x, float z, const SoilPatchConfig& config) const;
+    // v4.7.0: Same for n points (one lattice row); bit-identical to the scalar helper
+    void calculateSoilPatternBatch(const float* x, const float* z, size_t n, const SoilPatchConfig& config, float* out) const;
+
+    // v4.7.0: Per-soil pattern parameters (static table indexed by SoilType)
+    static const SoilPatchConfig& soilPatchConfig(SoilType type);
+
+    // v4.7.0: Coarse pattern-strength lattices for classifySoil (bilinear upsampled)
+    struct SoilPatternCache {
+        struct Field {
+            int stepX = 1;   // Lattice spacing in cells
+            int stepZ = 1;
+            int width = 0;   // Lattice nodes
+            int height = 0;
+            bool perRow = false; // Lattice no coarser than the grid: evaluated exactly per row instead
+            std::vector<float> values; // Empty for soils that never compete
+            std::vector<float> error;  // Per lattice cell: x/z coefficients of the bilinear error bound
+        };
+        std::vector<Field> fields; // Indexed by SoilType
+        int seed = 0;
+        int width = 0;
+        int height = 0;
+        float resolution = 0.0f;
+        bool valid = false;
+    };
+    SoilPatternCache soilPatterns_;
+    void updateSoilPatternCache(int w, int h, float resolution);
 };
 
 } // namespace terrain
@@ -10,39 +10,104 @@ TerrainMap::TerrainMap(int width, int height) : width_(width), height_(height) {
 void TerrainMap::resize(int width, int height) {
     width_ = width;
     height_ = height;
-    size_t size = static_cast<size_t>(width * height);
+    if (!arena_) arena_ = std::make_shared<core::GridArena>();
+    layout_ = std::make_unique<core::GridLayout>(width, height, arena_);
+    core::GridLayout& layout = *layout_;
+    soilShared_ = false;
+    soilDomain_ = kAllSoilTypes;
     
-    heightMap_.assign(size, 0.0f);
-    moistureMap_.assign(size, 0.0f);
-    sedimentMap_.assign(size, 0.0f);
-    fluxMap_.assign(size, 0.0f); // v3.6.1
-    biomeMap_.assign(size, 0);
-    flowDirMap_.assign(size, -1);   // v3.6.3: -1 means no receiver (sink or undefined)
-    watershedMap_.assign(size, 0);  // v3.6.3: 0 means no basin assigned
-    soilMap_.assign(size, static_cast<uint8_t>(SoilType::None)); // v3.7.3
+    layout.add("height", heightMap_, 0.0f);
+    layout.addLazy("moisture", moistureMap_, 0.0f); // v4.7.0: Nothing writes these yet
+    layout.addLazy("sediment", sedimentMap_, 0.0f);
+    layout.add("flux", fluxMap_, 0.0f); // v3.6.1
+    layout.addLazy("biome", biomeMap_, 0);
+    layout.add("flow_dir", flowDirMap_, -1);   // v3.6.3: -1 means no receiver (sink or undefined)
+    layout.addLazy("watershed", watershedMap_, 0);  // v3.6.3: 0 means no basin assigned (v4.7.0: allocated by segmentation)
+    layout.add("soil", soilMap_, static_cast<uint8_t>(SoilType::None)); // v3.7.3
+    pyramid_.reset(width, height); // v4.7.0
 
     // v3.9.0: Vegetation
     if (!vegGrid_) vegGrid_ = std::make_unique<vegetation::VegetationGrid>();
-    vegGrid_->resize(width, height);
+    vegGrid_->describe(layout);
 
     // v4.0: Landscape Soil
     if (!landscapeSoil_) landscapeSoil_ = std::make_unique<landscape::SoilGrid>();
-    landscapeSoil_->resize(width, height);
+    landscapeSoil_->describe(layout);
 
     // v4.0: Landscape Hydro
     if (!landscapeHydro_) landscapeHydro_ = std::make_unique<landscape::HydroGrid>();
-    landscapeHydro_->resize(width, height);
+    landscapeHydro_->describe(layout);
+
+    // v4.7.0: One region for all of them, filled in row bands
+    layout.apply();
 }
 
 void TerrainMap::clear() {
     std::fill(heightMap_.begin(), heightMap_.end(), 0.0f);
-    std::fill(moistureMap_.begin(), moistureMap_.end(), 0.0f);
-    std::fill(sedimentMap_.begin(), sedimentMap_.end(), 0.0f);
     std::fill(fluxMap_.begin(), fluxMap_.end(), 0.0f); // v3.6.1
-    std::fill(biomeMap_.begin(), biomeMap_.end(), 0);
     std::fill(flowDirMap_.begin(), flowDirMap_.end(), -1);
-    std::fill(watershedMap_.begin(), watershedMap_.end(), 0);
+    shareSoilTypes(false);
     std::fill(soilMap_.begin(), soilMap_.end(), static_cast<uint8_t>(SoilType::None));
+    // v4.7.0: Lazy channels go back to unallocated (reads as their default)
+    for (const core::ChannelUsage& u : layout_->usage()) {
+        if (layout_->isLazy(u.name)) layout_->release(u.name);
+    }
+    pyramid_.markAllDirty();
+}
+
+bool TerrainMap::hasChannel(const std::string& name) const {
+    if (name == "soil" && soilShared_) return true;
+    return layout_->isAllocated(name);
+}
+
+bool TerrainMap::isLazyChannel(const std::string& name) const {
+    return layout_->isLazy(name);
+}
+
+bool TerrainMap::allocateChannel(const std::string& name) {
+    return layout_->isLazy(name) && layout_->materialize(name);
+}
+
+bool TerrainMap::releaseChannel(const std::string& name) {
+    return layout_->isLazy(name) && layout_->release(name);
+}
+
+std::vector<core::ChannelUsage> TerrainMap::memoryReport() const {
+    std::vector<core::ChannelUsage> report = layout_->usage();
+    for (core::ChannelUsage& u : report) {
+        if (u.name == "soil" && soilShared_) u.state = core::ChannelState::Shared;
+    }
+    return report;
+}
+
+size_t TerrainMap::allocatedBytes() const {
+    size_t total = 0;
+    for (const core::ChannelUsage& u : layout_->usage()) total += u.bytes;
+    return total;
+}
+
+void TerrainMap::shareSoilTypes(bool shared) {
+    if (shared == soilShared_ || (shared && !landscapeSoil_)) return;
+    soilShared_ = shared;
+    if (shared) {
+        layout_->release(soilMap_);
+    } else {
+        layout_->materialize(soilMap_);
+    }
+    pyramid_.markAllDirty();
+}
+
+void TerrainMap::setSoilDomain(SoilMask domain) {
+    if (domain == soilDomain_) return;
+    soilDomain_ = domain;
+    if (soilShared_) pyramid_.markAllDirty();
+}
+
+const TerrainPyramid& TerrainMap::pyramid() const {
+    if (pyramid_.isDirty()) {
+        pyramid_.update(heightMap_, soilMap(), soilView());
+    }
+    return pyramid_;
 }
 
 float TerrainMap::getHeight(int x, int z) const {
@@ -70,24 +135,24 @@ void TerrainMap::setFlux(int x, int y, float f) {
 }
 
 float TerrainMap::getMoisture(int x, int z) const {
-    if (!isValid(x, z)) return 0.0f;
+    if (!isValid(x, z) || moistureMap_.empty()) return 0.0f;
     return moistureMap_[z * width_ + x];
 }
 
 void TerrainMap::setMoisture(int x, int z, float m) {
     if (isValid(x, z)) {
-        moistureMap_[z * width_ + x] = m;
+        moistureMap()[z * width_ + x] = m;
     }
 }
 
 SoilType TerrainMap::getSoil(int x, int z) const {
     if (!isValid(x, z)) return SoilType::None;
-    return static_cast<SoilType>(soilMap_[z * width_ + x]);
+    return soilTypeOf(soilMap()[z * width_ + x], soilView());
 }
 
 void TerrainMap::setSoil(int x, int z, SoilType s) {
     if (isValid(x, z)) {
-        soilMap_[z * width_ + x] = static_cast<uint8_t>(s);
+        soilMap()[z * width_ + x] = static_cast<uint8_t>(s);
     }
 }
 
@@ -5,6 +5,7 @@
 #include <memory>
 #include "../vegetation/vegetation_types.h"
 #include "../landscape/landscape_types.h"
+#include "terrain_pyramid.h"
 
 namespace terrain {
 
@@ -26,6 +27,25 @@ enum class SoilType : uint8_t {
     Organossolo = 16
 };
 
+// v4.7.0: Stored soil IDs above Organossolo (e.g. landscape::SoilType::Undefined
+// in the shared SCORPAN view) read as None
+inline SoilType soilTypeOf(uint8_t stored) {
+    return stored > static_cast<uint8_t>(SoilType::Organossolo) ? SoilType::None : static_cast<SoilType>(stored);
+}
+
+// v4.7.0: Soil types a view shows, one bit per SoilType; the others read as None
+using SoilMask = uint32_t;
+constexpr SoilMask kAllSoilTypes = ~SoilMask(0);
+
+inline SoilMask soilMaskOf(SoilType type) {
+    return SoilMask(1) << static_cast<unsigned>(type);
+}
+
+inline SoilType soilTypeOf(uint8_t stored, SoilMask shown) {
+    const SoilType type = soilTypeOf(stored);
+    return (shown & soilMaskOf(type)) ? type : SoilType::None;
+}
+
 struct TerrainConfig {
     int width = 1024;
     int height = 1024;
@@ -43,7 +63,9 @@ struct TerrainConfig {
     // v3.8.3: Terrain Models (Refactored)
     enum class FiniteTerrainModel {
         Default,            // Standard perlin noise
-        ExperimentalBlend   // Weighted frequency blend
+        ExperimentalBlend,  // Weighted frequency blend
+        SpectralSynthesis,  // v4.7.0: Power-law spectrum + inverse FFT, O(N log N) for any detail level
+        ImportedDem         // v4.7.0: Real elevation raster (demPath), resampled to resolution
     };
 
     struct BlendConfig {
@@ -53,18 +75,44 @@ struct TerrainConfig {
         float exponent = 1.0f;
     };
 
+    // v4.7.0: SpectralSynthesis shapes white noise by P(f) ~ (f^2 + f0^2)^(-beta/2),
+    // with f0 = noiseScale (cycles per metre, the Perlin base frequency).
+    // beta <= 0 derives it from persistence as fBm would: beta = -2 log2(persistence).
+    struct SpectralConfig {
+        float beta = 0.0f;
+    };
+
     FiniteTerrainModel model = FiniteTerrainModel::Default;
     BlendConfig blendConfig;
+    SpectralConfig spectralConfig;
+    std::string demPath; // v4.7.0: ESRI .asc or raw raster + .hdr (ImportedDem only)
 };
 
 class TerrainMap {
 public:
     TerrainMap(int width, int height);
     ~TerrainMap() = default;
+    TerrainMap(const TerrainMap&) = delete; // The channel registry refers to the members
+    TerrainMap& operator=(const TerrainMap&) = delete;
 
+    // v4.7.0: Lays every channel (including the vegetation, soil and hydro
+    // grids) out in this map's GridArena, first-touched in parallel. Lazy
+    // channels (moisture, sediment, biome, watershed) stay unallocated.
     void resize(int width, int height);
     void clear();
 
+    const core::GridArena& arena() const { return *arena_; }
+
+    // v4.7.0: Channel registry, by world snapshot name ("height", "soil.depth", ...).
+    // A lazy channel is empty until its non-const accessor (or allocateChannel)
+    // is first used; const readers must check for empty().
+    bool hasChannel(const std::string& name) const;     // Allocated, or the shared soil view
+    bool isLazyChannel(const std::string& name) const;
+    bool allocateChannel(const std::string& name);      // Lazy channels only
+    bool releaseChannel(const std::string& name);       // Lazy channels only
+    std::vector<core::ChannelUsage> memoryReport() const;
+    size_t allocatedBytes() const;
+
     // Data Access
     int getWidth() const { return width_; }
     int getHeight() const { return height_; } // Keep existing getHeight() for consistency with other accessors
@@ -83,34 +131,56 @@ public:
     void setSediment(int x, int y, float s);
     
     // Direct buffer access for generators/renderer (reordered and consolidated)
-    std::vector<float>& heightMap() { return heightMap_; }
-    const std::vector<float>& heightMap() const { return heightMap_; }
+    core::GridVector<float>& heightMap() { return heightMap_; }
+    const core::GridVector<float>& heightMap() const { return heightMap_; }
 
-    std::vector<float>& moistureMap() { return moistureMap_; }
-    const std::vector<float>& moistureMap() const { return moistureMap_; }
+    // v4.7.0: Lazy
+    core::GridVector<float>& moistureMap() { return lazy(moistureMap_); }
+    const core::GridVector<float>& moistureMap() const { return moistureMap_; }
 
-    std::vector<float>& sedimentMap() { return sedimentMap_; }
-    const std::vector<float>& sedimentMap() const { return sedimentMap_; }
+    core::GridVector<float>& sedimentMap() { return lazy(sedimentMap_); }
+    const core::GridVector<float>& sedimentMap() const { return sedimentMap_; }
 
-    std::vector<float>& fluxMap() { return fluxMap_; }
-    const std::vector<float>& fluxMap() const { return fluxMap_; }
+    core::GridVector<float>& fluxMap() { return fluxMap_; }
+    const core::GridVector<float>& fluxMap() const { return fluxMap_; }
 
-    std::vector<uint8_t>& biomeMap() { return biomeMap_; }
-    const std::vector<uint8_t>& biomeMap() const { return biomeMap_; }
+    core::GridVector<uint8_t>& biomeMap() { return lazy(biomeMap_); }
+    const core::GridVector<uint8_t>& biomeMap() const { return biomeMap_; }
 
     // v3.6.3: Watershed Support
-    std::vector<int>& flowDirMap() { return flowDirMap_; }
-    const std::vector<int>& flowDirMap() const { return flowDirMap_; }
+    core::GridVector<int>& flowDirMap() { return flowDirMap_; }
+    const core::GridVector<int>& flowDirMap() const { return flowDirMap_; }
 
-    std::vector<int>& watershedMap() { return watershedMap_; }
-    const std::vector<int>& watershedMap() const { return watershedMap_; }
+    core::GridVector<int>& watershedMap() { return lazy(watershedMap_); }
+    const core::GridVector<int>& watershedMap() const { return watershedMap_; }
 
     // v3.7.3: Semantic Soil Map
-    std::vector<uint8_t>& soilMap() { return soilMap_; }
-    const std::vector<uint8_t>& soilMap() const { return soilMap_; }
+    // v4.7.0: While shared, this is the landscape soil_type grid itself (read
+    // values through soilTypeOf(value, soilView())); the map's own buffer is released.
+    core::GridVector<uint8_t>& soilMap() { return soilShared_ ? landscapeSoil_->soil_type : soilMap_; }
+    const core::GridVector<uint8_t>& soilMap() const { return soilShared_ ? landscapeSoil_->soil_type : soilMap_; }
     SoilType getSoil(int x, int y) const;
     void setSoil(int x, int y, SoilType s);
 
+    // v4.7.0: SCORPAN mode views the SiBCS classification instead of copying it.
+    // Unsharing allocates the own buffer again, filled with None.
+    void shareSoilTypes(bool shared);
+    bool soilShared() const { return soilShared_; }
+
+    // v4.7.0: Types the shared view shows (the SCORPAN domain), so the SiBCS grid
+    // keeps orders outside it. The own buffer always shows every type.
+    SoilMask soilDomain() const { return soilDomain_; }
+    void setSoilDomain(SoilMask domain);
+    SoilMask soilView() const { return soilShared_ ? soilDomain_ : kAllSoilTypes; }
+
+    // v4.7.0: Min/max/mean height + majority soil pyramid (see TerrainPyramid).
+    // Rebuilt lazily on read from the tiles marked dirty. Writers that change
+    // heightMap()/soilMap() of a live map must report the region; a freshly
+    // resized map is entirely dirty.
+    const TerrainPyramid& pyramid() const;
+    void markDirty(int x0, int y0, int x1, int y1) { pyramid_.markDirty(x0, y0, x1, y1); }
+    void markAllDirty() { pyramid_.markAllDirty(); }
+
     // Helpers
     // (x,z variants removed to avoid ambiguity with x,y)
     
@@ -131,20 +201,29 @@ public:
     const landscape::HydroGrid* getLandscapeHydro() const { return landscapeHydro_.get(); }
 
 private:
+    template <typename T>
+    core::GridVector<T>& lazy(core::GridVector<T>& channel) {
+        if (channel.empty()) layout_->materialize(channel);
+        return channel;
+    }
+
     int width_;
     int height_;
     
     // Normalized Data [0.0 - 1.0] generally, but height can be real meters if preferred
-    std::vector<float> heightMap_;
-    std::vector<float> moistureMap_;
-    std::vector<float> sedimentMap_; // Accumulated sediment
-    std::vector<float> fluxMap_;     // Accumulated water flow (v3.6.1)
-    std::vector<uint8_t> biomeMap_;  // ID of the biome
+    core::GridVector<float> heightMap_;
+    core::GridVector<float> moistureMap_;
+    core::GridVector<float> sedimentMap_; // Accumulated sediment
+    core::GridVector<float> fluxMap_;     // Accumulated water flow (v3.6.1)
+    core::GridVector<uint8_t> biomeMap_;  // ID of the biome
     
     // v3.6.3
-    std::vector<int> flowDirMap_;    // Index of receiver cell (-1 if sink)
-    std::vector<int> watershedMap_;  // ID of the drainage basin
-    std::vector<uint8_t> soilMap_;   // v3.7.3: Semantic Soil ID
+    core::GridVector<int> flowDirMap_;    // Index of receiver cell (-1 if sink)
+    core::GridVector<int> watershedMap_;  // ID of the drainage basin
+    core::GridVector<uint8_t> soilMap_;   // v3.7.3: Semantic Soil ID
+
+    // v4.7.0: Derived from heightMap_/soilMap_; updated on read
+    mutable TerrainPyramid pyramid_;
 
     // v3.9.0
     std::unique_ptr<vegetation::VegetationGrid> vegGrid_;
@@ -152,6 +231,12 @@ private:
     // v4.0: Integrated Landscape (Soil Foundation)
     std::unique_ptr<landscape::SoilGrid> landscapeSoil_; // The physical soil state
     std::unique_ptr<landscape::HydroGrid> landscapeHydro_; // The hydrological state
+
+    // v4.7.0: Holds every channel above; kept (and rewound) across resizes
+    std::shared_ptr<core::GridArena> arena_;
+    std::unique_ptr<core::GridLayout> layout_; // Registry of the current size
+    bool soilShared_ = false;
+    SoilMask soilDomain_ = kAllSoilTypes;
 };
 
 } // namespace terrain
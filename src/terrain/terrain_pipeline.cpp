@@ -0,0 +1,259 @@
+#include "terrain_pipeline.h"
+#include "world_snapshot.h"
+#include "../vegetation/vegetation_system.h"
+#include <algorithm>
+#include <filesystem>
+#include <utility>
+
+namespace terrain {
+
+namespace {
+
+// Copy of the channels a stage wrote, plus how to put them back
+template <typename T>
+class Snapshot : public RegenerationGraph::Output {
+public:
+    using RestoreFn = void (*)(TerrainMap&, const T&);
+    Snapshot(T value, RestoreFn restore) : value_(std::move(value)), restore_(restore) {}
+    void restore(TerrainMap& map) const override { restore_(map, value_); }
+
+private:
+    T value_;
+    RestoreFn restore_;
+};
+
+template <typename T>
+std::unique_ptr<RegenerationGraph::Output> snapshot(T value, typename Snapshot<T>::RestoreFn restore) {
+    return std::make_unique<Snapshot<T>>(std::move(value), restore);
+}
+
+struct DrainageChannels {
+    core::GridVector<float> flux;
+    core::GridVector<int> flowDir;
+};
+
+struct LandscapeGrids {
+    landscape::SoilGrid soil;
+    landscape::HydroGrid hydro;
+};
+
+// v4.7.0: The SCORPAN sync edits soil_type in place and shares it as the soil map
+struct ScorpanOutput {
+    SoilMask domain = kAllSoilTypes; // The SiBCS grid itself is the landscape stage's output
+    bool shared = false;
+};
+
+void hashDomain(ContentHash& h, const landscape::SiBCSUserConfig& d) {
+    h.add(d.allowedOrders).add(d.allowedSubOrders).add(d.allowedGreatGroups).add(d.allowedSubGroups);
+    h.add(d.selections.size());
+    for (const auto& s : d.selections) {
+        h.add(s.order).add(s.suborder).add(s.greatGroup).add(s.subGroup).add(s.family).add(s.series);
+    }
+    h.add(d.applyConstraints).add(d.domainConfirmed).add(d.pendingChanges);
+}
+
+} // namespace
+
+TerrainPipeline::TerrainPipeline() {
+    addTerrainStages();
+}
+
+void TerrainPipeline::addTerrainStages() {
+    graph_.addStage({
+        kBase, {},
+        [this](ContentHash& h) {
+            const TerrainConfig& c = inputs_.config;
+            h.add(c.width).add(c.height).add(c.resolution).add(c.maxHeight).add(c.seed);
+            h.add(c.noiseScale).add(c.persistence).add(c.octaves).add(c.model);
+            h.add(c.blendConfig.lowFreqWeight).add(c.blendConfig.midFreqWeight)
+             .add(c.blendConfig.highFreqWeight).add(c.blendConfig.exponent);
+            h.add(c.spectralConfig.beta);
+            if (c.model == TerrainConfig::FiniteTerrainModel::ImportedDem) {
+                // Re-import when the file changes on disk
+                std::error_code ec;
+                h.add(c.demPath).add(std::filesystem::file_size(c.demPath, ec));
+                h.add(std::filesystem::last_write_time(c.demPath, ec).time_since_epoch().count());
+            }
+        },
+        [this](TerrainMap& map) { generator_->generateBaseTerrain(map, inputs_.config); },
+        [](const TerrainMap& map) {
+            return snapshot(map.heightMap(), [](TerrainMap& m, const core::GridVector<float>& v) {
+                m.heightMap() = v;
+                m.markAllDirty();
+            });
+        }
+    });
+
+    graph_.addStage({
+        kDrainage, {kBase}, nullptr,
+        [this](TerrainMap& map) { generator_->calculateDrainage(map); },
+        [](const TerrainMap& map) {
+            return snapshot(DrainageChannels{map.fluxMap(), map.flowDirMap()}, [](TerrainMap& m, const DrainageChannels& v) {
+                m.fluxMap() = v.flux;
+                m.flowDirMap() = v.flowDir;
+            });
+        }
+    });
+
+    graph_.addStage({
+        kSoilPatterns, {kBase},
+        [this](ContentHash& h) { h.add(inputs_.config.seed).add(inputs_.config.resolution); },
+        [this](TerrainMap& map) { generator_->classifySoil(map, inputs_.config); },
+        [](const TerrainMap& map) {
+            return snapshot(map.soilMap(), [](TerrainMap& m, const core::GridVector<uint8_t>& v) {
+                m.shareSoilTypes(false);
+                m.soilMap() = v;
+                m.markAllDirty();
+            });
+        }
+    });
+
+    // Soil + hydro grids (SoilSystem/HydroSystem::initialize read heights only)
+    graph_.addStage({
+        kLandscape, {kBase},
+        [this](ContentHash& h) { h.add(inputs_.config.seed); },
+        [this](TerrainMap& map) { generator_->generateLandscape(map); },
+        [](const TerrainMap& map) {
+            LandscapeGrids grids;
+            if (map.getLandscapeSoil()) grids.soil = *map.getLandscapeSoil();
+            if (map.getLandscapeHydro()) grids.hydro = *map.getLandscapeHydro();
+            return snapshot(std::move(grids), [](TerrainMap& m, const LandscapeGrids& v) {
+                if (m.getLandscapeSoil()) *m.getLandscapeSoil() = v.soil;
+                if (m.getLandscapeHydro()) *m.getLandscapeHydro() = v.hydro;
+            });
+        }
+    });
+
+    // v4.5.11: Transform Vectors to Soil Types if in SCORPAN mode (v4.7.0: the soil map becomes a view of soil_type)
+    graph_.addStage({
+        kScorpan, {kSoilPatterns, kLandscape},
+        [this](ContentHash& h) {
+            h.add(inputs_.soilMode);
+            if (inputs_.soilMode == 1) hashDomain(h, inputs_.domain);
+        },
+        [this](TerrainMap& map) {
+            if (inputs_.soilMode == 1) generator_->classifySoilFromSCORPAN(map, &inputs_.domain);
+        },
+        [](const TerrainMap& map) {
+            ScorpanOutput out;
+            out.domain = map.soilDomain();
+            out.shared = map.soilShared();
+            return snapshot(std::move(out), [](TerrainMap& m, const ScorpanOutput& v) {
+                m.setSoilDomain(v.domain);
+                m.shareSoilTypes(v.shared);
+                m.markAllDirty();
+            });
+        }
+    });
+
+    // v3.9.0: Vegetation only depends on the seed and grid size
+    graph_.addStage({
+        kVegetation, {},
+        [this](ContentHash& h) { h.add(inputs_.config.seed).add(inputs_.config.width).add(inputs_.config.height); },
+        [this](TerrainMap& map) {
+            if (map.getVegetation()) vegetation::VegetationSystem::initialize(*map.getVegetation(), inputs_.config.seed);
+        },
+        [](const TerrainMap& map) {
+            vegetation::VegetationGrid grid;
+            if (map.getVegetation()) grid = *map.getVegetation();
+            return snapshot(std::move(grid), [](TerrainMap& m, const vegetation::VegetationGrid& v) {
+                if (!m.getVegetation()) return;
+                *m.getVegetation() = v;
+                // A restored grid is a new grid for incremental consumers (texture tiles)
+                m.getVegetation()->generation = vegetation::VegetationGrid::nextGeneration();
+            });
+        }
+    });
+
+    // v4.7.0: Runs beside the caller's consumers (mesh); both only read the map
+    graph_.addStage({
+        kDiskCache, {kDrainage, kScorpan, kVegetation}, nullptr,
+        [this](TerrainMap& map) {
+            if (!diskCache_) return;
+            const uint64_t key = currentWorldKey();
+            if (!diskCache_->contains(key)) diskCache_->store(key, map);
+        },
+        nullptr
+    });
+}
+
+void TerrainPipeline::ensureGenerator() {
+    // Also needed when the base stage is restored or loaded from disk: downstream stages may still run
+    if (!generator_ || generatorSeed_ != inputs_.config.seed) {
+        generator_ = std::make_unique<TerrainGenerator>(inputs_.config.seed);
+        generatorSeed_ = inputs_.config.seed;
+    }
+}
+
+bool TerrainPipeline::reusesTerrain() const {
+    return graph_.wouldReuse(kDrainage) && graph_.wouldReuse(kScorpan) && graph_.wouldReuse(kVegetation);
+}
+
+uint64_t TerrainPipeline::currentWorldKey() const {
+    ContentHash h;
+    h.add(kGeneratorRevision).add(WorldSnapshot::kFormatVersion);
+    h.add(graph_.keyOf(kDrainage)).add(graph_.keyOf(kScorpan)).add(graph_.keyOf(kVegetation));
+    return h.value();
+}
+
+uint64_t TerrainPipeline::worldKey(const RegenerationInputs& inputs) {
+    inputs_ = inputs;
+    return currentWorldKey();
+}
+
+std::vector<RegenerationGraph::StageReport> TerrainPipeline::regenerate(TerrainMap& map, const RegenerationInputs& inputs,
+                                                                        RegenerationControl* control) {
+    inputs_ = inputs;
+    control_ = control;
+    ensureGenerator();
+    generator_->setControl(control);
+
+    struct ControlReset {
+        TerrainPipeline* self;
+        ~ControlReset() {
+            self->control_ = nullptr;
+            if (self->generator_) self->generator_->setControl(nullptr);
+        }
+    } reset{this};
+
+    // v4.7.0: Warm start: an earlier session or configuration generated this world
+    if (diskCache_ && !reusesTerrain() && diskCache_->load(currentWorldKey(), map, control)) {
+        graph_.adopt(map);
+    }
+    return graph_.run(map, control);
+}
+
+bool TerrainPipeline::reusesBaseTerrain(const RegenerationInputs& inputs) {
+    inputs_ = inputs;
+    return graph_.wouldReuse(kBase) || (diskCache_ && diskCache_->contains(currentWorldKey()));
+}
+
+std::unique_ptr<TerrainMap> TerrainPipeline::generatePreview(const RegenerationInputs& inputs, int factor,
+                                                             RegenerationControl* control) {
+    TerrainConfig config = inputs.config;
+    config.width = (inputs.config.width - 1) / factor + 1;
+    config.height = (inputs.config.height - 1) / factor + 1;
+    config.resolution = inputs.config.resolution * static_cast<float>(factor);
+
+    auto map = std::make_unique<TerrainMap>(config.width, config.height);
+    TerrainGenerator gen(config.seed);
+    gen.setControl(control);
+    gen.generateBaseTerrain(*map, config);
+    gen.classifySoil(*map, config);
+    if (control) control->checkpoint();
+    if (map->getVegetation()) vegetation::VegetationSystem::initialize(*map->getVegetation(), config.seed);
+    return map;
+}
+
+std::vector<int> TerrainPipeline::previewFactors(const TerrainConfig& config) {
+    const int extent = std::max(config.width, config.height);
+    std::vector<int> factors;
+    for (int budget : {512, 1024}) {
+        int factor = 1;
+        while ((extent - 1) / factor + 1 > budget) factor *= 2;
+        if (factor >= 2 && (factors.empty() || factor < factors.back())) factors.push_back(factor);
+    }
+    return factors;
+}
+
+} // namespace terrain
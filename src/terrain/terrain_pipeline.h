@@ -0,0 +1,102 @@
+#pragma once
+
+#include "regeneration_graph.h"
+#include "terrain_generator.h"
+#include "terrain_map.h"
+#include "world_cache.h"
+#include "../landscape/landscape_types.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace terrain {
+
+// v4.7.0: Everything a regeneration reads from the UI, captured when it starts
+struct RegenerationInputs {
+    TerrainConfig config;
+    int soilMode = 1;                   // 1 = SCORPAN (SiBCS) map sync
+    landscape::SiBCSUserConfig domain;
+};
+
+/**
+ * @brief v4.7.0: The world generation chain as a memoized stage graph.
+ *
+ *   base ─┬─ drainage ──────────────┐
+ *         ├─ soil_patterns ─┐       │
+ *         └─ landscape ─────┴─ scorpan
+ *   vegetation (independent of the terrain)
+ *   disk_cache (after all of the above; no-op without a WorldCache)
+ *
+ * Only the stages whose inputs changed since the previous regenerate() run;
+ * e.g. a new SiBCS domain re-runs scorpan alone, heights, drainage and the
+ * landscape grids are restored from the cache. Callers append their own
+ * consumers (mesh building) through graph().
+ */
+class TerrainPipeline {
+public:
+    TerrainPipeline();
+
+    // Stage names, for dependsOn of appended stages
+    static constexpr const char* kBase = "base";
+    static constexpr const char* kDrainage = "drainage";
+    static constexpr const char* kSoilPatterns = "soil_patterns";
+    static constexpr const char* kLandscape = "landscape";
+    static constexpr const char* kScorpan = "scorpan";
+    static constexpr const char* kVegetation = "vegetation";
+    static constexpr const char* kDiskCache = "disk_cache"; // Stores the terrain if it is not cached yet
+
+    // Bump whenever a generator changes what it writes for the same inputs:
+    // part of worldKey(), so older on-disk entries stop matching
+    static constexpr uint32_t kGeneratorRevision = 1;
+
+    RegenerationGraph& graph() { return graph_; }
+
+    // Optional warm start: terrain stages are loaded from / stored to this cache
+    void setDiskCache(std::shared_ptr<WorldCache> cache) { diskCache_ = std::move(cache); }
+
+    // Content hash of everything the terrain stages read for `inputs` (disk cache key)
+    uint64_t worldKey(const RegenerationInputs& inputs);
+
+    // Inputs of the run in progress (valid inside stage callbacks)
+    const RegenerationInputs& inputs() const { return inputs_; }
+
+    // `map` must be sized to inputs.config; not re-entrant (one regeneration at a time).
+    // With a disk cache, a miss in memory for the terrain stages tries the cache first.
+    // With a control, throws RegenerationCancelled once it is cancelled (stages that
+    // completed keep their memoized outputs; the interrupted one re-runs next time).
+    std::vector<RegenerationGraph::StageReport> regenerate(TerrainMap& map, const RegenerationInputs& inputs,
+                                                           RegenerationControl* control = nullptr);
+
+    // True if the next regenerate(inputs) would restore the heights (from memory or disk)
+    // instead of computing them
+    bool reusesBaseTerrain(const RegenerationInputs& inputs);
+
+    /**
+     * @brief Coarse stand-in for the final map: every `factor`-th sample of the same
+     * world extent (resolution * factor), with heights, soil patterns and vegetation.
+     * Independent of the memoized graph; Default/ExperimentalBlend previews sample the
+     * final heights exactly, SpectralSynthesis ones are statistically similar only.
+     */
+    static std::unique_ptr<TerrainMap> generatePreview(const RegenerationInputs& inputs, int factor,
+                                                       RegenerationControl* control = nullptr);
+
+    // Decimation factors worth previewing, coarsest first (<= 512 then <= 1024 samples
+    // across); empty for maps small enough to generate at once
+    static std::vector<int> previewFactors(const TerrainConfig& config);
+
+private:
+    void addTerrainStages();
+    void ensureGenerator();
+    bool reusesTerrain() const;
+    uint64_t currentWorldKey() const;
+
+    RegenerationGraph graph_;
+    RegenerationInputs inputs_;
+    RegenerationControl* control_ = nullptr;
+    // Kept across runs so per-seed caches (soil pattern lattices) survive
+    std::unique_ptr<TerrainGenerator> generator_;
+    int generatorSeed_ = 0;
+    std::shared_ptr<WorldCache> diskCache_;
+};
+
+} // namespace terrain
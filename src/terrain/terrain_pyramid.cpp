@@ -0,0 +1,220 @@
+#include "terrain_pyramid.h"
+#include "terrain_map.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace terrain {
+
+void TerrainPyramid::reset(int baseWidth, int baseHeight) {
+    baseWidth_ = std::max(0, baseWidth);
+    baseHeight_ = std::max(0, baseHeight);
+    levels_.clear();
+
+    int w = baseWidth_;
+    int h = baseHeight_;
+    int l = 0;
+    while (w > 1 || h > 1) {
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+        ++l;
+
+        Level level;
+        level.width = w;
+        level.height = h;
+        level.cellSize = 1 << l;
+        const size_t size = static_cast<size_t>(w) * static_cast<size_t>(h);
+        level.minHeight.assign(size, 0.0f);
+        level.maxHeight.assign(size, 0.0f);
+        level.meanHeight.assign(size, 0.0f);
+        level.soil.assign(size, 0);
+        levels_.push_back(std::move(level));
+    }
+
+    // Tile grids for the base (index 0) and every level
+    const size_t count = levels_.size() + 1;
+    dirtyTiles_.assign(count, {});
+    tilesX_.assign(count, 0);
+    tilesY_.assign(count, 0);
+    for (size_t k = 0; k < count; ++k) {
+        int lw = k == 0 ? baseWidth_ : levels_[k - 1].width;
+        int lh = k == 0 ? baseHeight_ : levels_[k - 1].height;
+        tilesX_[k] = (lw + kTileSize - 1) / kTileSize;
+        tilesY_[k] = (lh + kTileSize - 1) / kTileSize;
+        dirtyTiles_[k].assign(static_cast<size_t>(tilesX_[k] * tilesY_[k]), 0);
+    }
+    markAllDirty();
+}
+
+void TerrainPyramid::markDirty(int x0, int y0, int x1, int y1) {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, baseWidth_);
+    y1 = std::min(y1, baseHeight_);
+    if (x0 >= x1 || y0 >= y1 || dirtyTiles_.empty()) return;
+
+    for (int ty = y0 / kTileSize; ty <= (y1 - 1) / kTileSize; ++ty) {
+        for (int tx = x0 / kTileSize; tx <= (x1 - 1) / kTileSize; ++tx) {
+            dirtyTiles_[0][static_cast<size_t>(ty * tilesX_[0] + tx)] = 1;
+        }
+    }
+    anyDirty_ = true;
+}
+
+void TerrainPyramid::markAllDirty() {
+    if (dirtyTiles_.empty()) return;
+    std::fill(dirtyTiles_[0].begin(), dirtyTiles_[0].end(), static_cast<uint8_t>(1));
+    anyDirty_ = !dirtyTiles_[0].empty();
+}
+
+void TerrainPyramid::update(const core::GridVector<float>& heights, const core::GridVector<uint8_t>& soil,
+                            uint32_t shownSoils) {
+    if (!anyDirty_) return;
+    const size_t baseSize = static_cast<size_t>(baseWidth_) * static_cast<size_t>(baseHeight_);
+    if (heights.size() < baseSize || soil.size() < baseSize) return;
+
+    std::vector<int> work;
+    for (int l = 1; l <= levelCount(); ++l) {
+        const size_t k = static_cast<size_t>(l);
+
+        // A tile at level l covers 2x2 tiles of level l-1
+        std::vector<uint8_t>& below = dirtyTiles_[k - 1];
+        std::vector<uint8_t>& here = dirtyTiles_[k];
+        for (int ty = 0; ty < tilesY_[k - 1]; ++ty) {
+            for (int tx = 0; tx < tilesX_[k - 1]; ++tx) {
+                uint8_t& flag = below[static_cast<size_t>(ty * tilesX_[k - 1] + tx)];
+                if (!flag) continue;
+                here[static_cast<size_t>((ty / 2) * tilesX_[k] + tx / 2)] = 1;
+                flag = 0;
+            }
+        }
+
+        work.clear();
+        for (int t = 0; t < static_cast<int>(here.size()); ++t) {
+            if (here[static_cast<size_t>(t)]) work.push_back(t);
+        }
+
+        core::JobSystem::instance().parallelFor(0, static_cast<int>(work.size()), 1, [&](int workBegin, int workEnd) {
+            for (int i = workBegin; i < workEnd; ++i) {
+                const int t = work[static_cast<size_t>(i)];
+                reduceTile(l, t % tilesX_[k], t / tilesX_[k], heights, soil, shownSoils);
+            }
+        });
+    }
+
+    // Top level flags are not consumed by anything above
+    if (!dirtyTiles_.empty()) {
+        std::fill(dirtyTiles_.back().begin(), dirtyTiles_.back().end(), static_cast<uint8_t>(0));
+    }
+    anyDirty_ = false;
+}
+
+void TerrainPyramid::reduceTile(int l, int tx, int ty, const core::GridVector<float>& heights, const core::GridVector<uint8_t>& soil,
+                                uint32_t shownSoils) {
+    Level& dst = levels_[static_cast<size_t>(l - 1)];
+    const Level* src = l > 1 ? &levels_[static_cast<size_t>(l - 2)] : nullptr;
+    const int srcW = src ? src->width : baseWidth_;
+    const int srcH = src ? src->height : baseHeight_;
+    const int childSize = 1 << (l - 1);
+
+    const int x0 = tx * kTileSize;
+    const int y0 = ty * kTileSize;
+    const int x1 = std::min(x0 + kTileSize, dst.width);
+    const int y1 = std::min(y0 + kTileSize, dst.height);
+
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            float mn = std::numeric_limits<float>::max();
+            float mx = std::numeric_limits<float>::lowest();
+            float sum = 0.0f;
+            float area = 0.0f;
+
+            // Majority vote over up to 4 children, weighted by their base-cell area
+            uint8_t classes[4];
+            float weights[4];
+            int nClasses = 0;
+
+            for (int cy = 2 * y; cy < std::min(2 * y + 2, srcH); ++cy) {
+                for (int cx = 2 * x; cx < std::min(2 * x + 2, srcW); ++cx) {
+                    const size_t ci = static_cast<size_t>(cy) * static_cast<size_t>(srcW) + static_cast<size_t>(cx);
+                    float cMin, cMax, cMean;
+                    uint8_t cSoil;
+                    float cArea;
+                    if (src) {
+                        cMin = src->minHeight[ci];
+                        cMax = src->maxHeight[ci];
+                        cMean = src->meanHeight[ci];
+                        cSoil = src->soil[ci];
+                        // Edge blocks are clipped to the base map
+                        int ax = std::min(childSize, baseWidth_ - cx * childSize);
+                        int ay = std::min(childSize, baseHeight_ - cy * childSize);
+                        cArea = static_cast<float>(ax * ay);
+                    } else {
+                        cMin = cMax = cMean = heights[ci];
+                        cSoil = static_cast<uint8_t>(soilTypeOf(soil[ci], shownSoils)); // Shared SCORPAN view: Undefined -> None
+                        cArea = 1.0f;
+                    }
+
+                    mn = std::min(mn, cMin);
+                    mx = std::max(mx, cMax);
+                    sum += cMean * cArea;
+                    area += cArea;
+
+                    int c = 0;
+                    while (c < nClasses && classes[c] != cSoil) ++c;
+                    if (c == nClasses) {
+                        classes[nClasses] = cSoil;
+                        weights[nClasses] = 0.0f;
+                        ++nClasses;
+                    }
+                    weights[c] += cArea;
+                }
+            }
+
+            int best = 0;
+            for (int c = 1; c < nClasses; ++c) {
+                if (weights[c] > weights[best]) best = c;
+            }
+
+            const size_t di = dst.index(x, y);
+            dst.minHeight[di] = mn;
+            dst.maxHeight[di] = mx;
+            dst.meanHeight[di] = area > 0.0f ? sum / area : 0.0f;
+            dst.soil[di] = nClasses > 0 ? classes[best] : 0;
+        }
+    }
+}
+
+int TerrainPyramid::levelForFootprint(float baseCellsPerSample) const {
+    if (baseCellsPerSample < 2.0f) return 0;
+    int l = static_cast<int>(std::floor(std::log2(baseCellsPerSample)));
+    return std::clamp(l, 0, levelCount());
+}
+
+void TerrainPyramid::locateMax(int l, int x, int y, const core::GridVector<float>& heights, int& outX, int& outY) const {
+    for (int k = l; k >= 1; --k) {
+        const float target = level(k).maxHeight[level(k).index(x, y)];
+        const int srcW = k > 1 ? level(k - 1).width : baseWidth_;
+        const int srcH = k > 1 ? level(k - 1).height : baseHeight_;
+
+        int bx = 2 * x;
+        int by = 2 * y;
+        for (int cy = 2 * y; cy < std::min(2 * y + 2, srcH); ++cy) {
+            for (int cx = 2 * x; cx < std::min(2 * x + 2, srcW); ++cx) {
+                const size_t ci = static_cast<size_t>(cy) * static_cast<size_t>(srcW) + static_cast<size_t>(cx);
+                const float v = k > 1 ? level(k - 1).maxHeight[ci] : heights[ci];
+                if (v == target) {
+                    bx = cx;
+                    by = cy;
+                }
+            }
+        }
+        x = bx;
+        y = by;
+    }
+    outX = x;
+    outY = y;
+}
+
+} // namespace terrain
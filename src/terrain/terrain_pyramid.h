@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../core/grid_arena.h"
+
+namespace terrain {
+
+// v4.7.0: Multi-resolution summary of the heightmap and semantic soil map.
+// Level l (1..levelCount()) has one cell per 2^l x 2^l block of base cells
+// (edge blocks are clipped for non power-of-two maps). Each cell stores the
+// min / max / mean height and the majority soil class of its block.
+//
+// Updates are incremental: writers mark base regions dirty, and update()
+// recomputes only the affected 64x64 tiles of each level from the level below.
+// Majority soil is exact at level 1 and area-weighted majority-of-majorities above.
+class TerrainPyramid {
+public:
+    static constexpr int kTileSize = 64; // Dirty-tile granularity, in cells of each level
+
+    struct Level {
+        int width = 0;
+        int height = 0;
+        int cellSize = 1; // Base cells per side (2^l)
+        std::vector<float> minHeight;
+        std::vector<float> maxHeight;
+        std::vector<float> meanHeight;
+        std::vector<uint8_t> soil; // Majority terrain::SoilType
+
+        size_t index(int x, int y) const { return static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(x); }
+    };
+
+    // Allocates levels for a base map and marks everything dirty
+    void reset(int baseWidth, int baseHeight);
+
+    // Marks the base rectangle [x0, x1) x [y0, y1) for recomputation
+    void markDirty(int x0, int y0, int x1, int y1);
+    void markAllDirty();
+    bool isDirty() const { return anyDirty_; }
+
+    // Recomputes dirty tiles, bottom-up (parallel per tile). Soil types outside
+    // `shownSoils` (a SoilMask) count as None.
+    void update(const core::GridVector<float>& heights, const core::GridVector<uint8_t>& soil,
+                uint32_t shownSoils = ~uint32_t(0));
+
+    int baseWidth() const { return baseWidth_; }
+    int baseHeight() const { return baseHeight_; }
+    int levelCount() const { return static_cast<int>(levels_.size()); }
+    // l in [1, levelCount()]
+    const Level& level(int l) const { return levels_[static_cast<size_t>(l - 1)]; }
+
+    // Finest level whose cells are at least `baseCellsPerSample` base cells wide
+    // (0 = base map). Used to read ~one cell per output pixel.
+    int levelForFootprint(float baseCellsPerSample) const;
+
+    // Follows the max chain down to the base cell holding the maximum of
+    // cell (x, y) of level l.
+    void locateMax(int l, int x, int y, const core::GridVector<float>& heights, int& outX, int& outY) const;
+
+private:
+    void reduceTile(int l, int tx, int ty, const core::GridVector<float>& heights, const core::GridVector<uint8_t>& soil,
+                    uint32_t shownSoils);
+
+    int baseWidth_ = 0;
+    int baseHeight_ = 0;
+    std::vector<Level> levels_;
+
+    // Per level: dirty flags for its 64x64 tiles (index 0 = base map tiles)
+    std::vector<std::vector<uint8_t>> dirtyTiles_;
+    std::vector<int> tilesX_;
+    std::vector<int> tilesY_;
+    bool anyDirty_ = false;
+};
+
+} // namespace terrain
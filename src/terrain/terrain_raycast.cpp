@@ -0,0 +1,181 @@
+#include "terrain_raycast.h"
+#include "terrain_map.h"
+#include "terrain_pyramid.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace terrain {
+
+namespace {
+
+struct GridRay {
+    // Ray in grid space: x/z in samples, y in world units, same parameter t
+    double ox, oy, oz;
+    double dx, dy, dz;
+};
+
+// Slab test against [x0,x1] x [z0,z1], clipped to [tmin,tmax]
+inline bool clipBox(const GridRay& r, double x0, double x1, double z0, double z1,
+                    double tmin, double tmax, double& t0, double& t1) {
+    t0 = tmin;
+    t1 = tmax;
+    auto slab = [&](double o, double d, double lo, double hi) {
+        if (std::abs(d) < 1e-12) return o >= lo && o <= hi;
+        double a = (lo - o) / d;
+        double b = (hi - o) / d;
+        if (a > b) std::swap(a, b);
+        t0 = std::max(t0, a);
+        t1 = std::min(t1, b);
+        return t0 <= t1;
+    };
+    return slab(r.ox, r.dx, x0, x1) && slab(r.oz, r.dz, z0, z1);
+}
+
+// First s in [t0,t1] where the ray meets the bilinear patch (i,j); false if none
+bool intersectPatch(const core::GridVector<float>& heights, int w, int i, int j,
+                    const GridRay& r, double t0, double t1, double& tHit) {
+    auto hAt = [&](int x, int z) { return static_cast<double>(heights[static_cast<size_t>(z) * static_cast<size_t>(w) + static_cast<size_t>(x)]); };
+    const double h00 = hAt(i, j), h10 = hAt(i + 1, j), h01 = hAt(i, j + 1), h11 = hAt(i + 1, j + 1);
+
+    // h(u,v) = a + b u + c v + e u v, with u,v local to the patch at the entry point
+    const double b = h10 - h00, c = h01 - h00, e = h00 - h10 - h01 + h11;
+    const double u0 = r.ox + r.dx * t0 - i;
+    const double v0 = r.oz + r.dz * t0 - j;
+    const double y0 = r.oy + r.dy * t0;
+
+    // f(s) = ray.y - h = C + B s + A s^2, s = t - t0
+    const double C = y0 - (h00 + b * u0 + c * v0 + e * u0 * v0);
+    const double B = r.dy - (b * r.dx + c * r.dz + e * (u0 * r.dz + v0 * r.dx));
+    const double A = -e * r.dx * r.dz;
+    const double len = t1 - t0;
+
+    if (C <= 0.0) { tHit = t0; return true; } // Entered the patch at or below the surface
+
+    double s = std::numeric_limits<double>::max();
+    if (std::abs(A) < 1e-12) {
+        if (B < 0.0) s = -C / B;
+    } else {
+        double disc = B * B - 4.0 * A * C;
+        if (disc >= 0.0) {
+            double sq = std::sqrt(disc);
+            // Numerically stable roots
+            double q = -0.5 * (B + (B >= 0.0 ? sq : -sq));
+            double r0 = q / A;
+            double r1 = q != 0.0 ? C / q : r0;
+            if (r0 > r1) std::swap(r0, r1);
+            if (r0 >= 0.0) s = r0;
+            else if (r1 >= 0.0) s = r1;
+        }
+    }
+    if (s > len) return false;
+    tHit = t0 + s;
+    return true;
+}
+
+struct Node {
+    int level, x, y;
+    double t0, t1;
+};
+
+} // namespace
+
+RayHit raycast(const TerrainMap& map, const math::Ray& ray, float maxDist, float gridScale) {
+    RayHit result;
+    const int w = map.getWidth();
+    const int h = map.getHeight();
+    if (w < 2 || h < 2 || gridScale <= 0.0f) return result;
+
+    const TerrainPyramid& pyramid = map.pyramid();
+    const core::GridVector<float>& heights = map.heightMap();
+
+    GridRay r{ray.origin.x / gridScale, ray.origin.y, ray.origin.z / gridScale,
+              ray.direction.x / gridScale, ray.direction.y, ray.direction.z / gridScale};
+
+    // Conservative bound for all patches of node (l, x, y): patches in a block also
+    // use the first sample row/column of the next block, so include the +1 neighbours.
+    auto nodeMax = [&](int l, int x, int y) -> double {
+        if (l == 0) {
+            return std::max(std::max(heights[static_cast<size_t>(y) * static_cast<size_t>(w) + static_cast<size_t>(x)],
+                                      heights[static_cast<size_t>(y) * static_cast<size_t>(w) + static_cast<size_t>(x + 1)]),
+                            std::max(heights[static_cast<size_t>(y + 1) * static_cast<size_t>(w) + static_cast<size_t>(x)],
+                                     heights[static_cast<size_t>(y + 1) * static_cast<size_t>(w) + static_cast<size_t>(x + 1)]));
+        }
+        const TerrainPyramid::Level& lv = pyramid.level(l);
+        float m = lv.maxHeight[lv.index(x, y)];
+        if (x + 1 < lv.width) m = std::max(m, lv.maxHeight[lv.index(x + 1, y)]);
+        if (y + 1 < lv.height) m = std::max(m, lv.maxHeight[lv.index(x, y + 1)]);
+        if (x + 1 < lv.width && y + 1 < lv.height) m = std::max(m, lv.maxHeight[lv.index(x + 1, y + 1)]);
+        return m;
+    };
+
+    // Push a node if the ray crosses its footprint at or below its max height
+    Node stack[128];
+    int top = 0;
+    auto visit = [&](int l, int x, int y, double tmin, double tmax, Node& out) {
+        const int cs = 1 << l;
+        const double x0 = static_cast<double>(x) * cs;
+        const double z0 = static_cast<double>(y) * cs;
+        if (x0 >= w - 1 || z0 >= h - 1) return false; // Beyond the last patch
+        const double x1 = std::min(x0 + cs, static_cast<double>(w - 1));
+        const double z1 = std::min(z0 + cs, static_cast<double>(h - 1));
+
+        double t0, t1;
+        if (!clipBox(r, x0, x1, z0, z1, tmin, tmax, t0, t1)) return false;
+        if (std::min(r.oy + r.dy * t0, r.oy + r.dy * t1) > nodeMax(l, x, y)) return false;
+        out = {l, x, y, t0, t1};
+        return true;
+    };
+
+    const int topLevel = pyramid.levelCount();
+    Node root;
+    if (!visit(topLevel, 0, 0, 0.0, static_cast<double>(maxDist), root)) return result;
+    stack[top++] = root;
+
+    while (top > 0) {
+        Node n = stack[--top];
+
+        if (n.level == 0) {
+            double tHit;
+            if (intersectPatch(heights, w, n.x, n.y, r, n.t0, n.t1, tHit)) {
+                result.hit = true;
+                result.t = static_cast<float>(tHit);
+                result.position = ray.origin + ray.direction * result.t;
+                result.cellX = n.x;
+                result.cellZ = n.y;
+                result.x = std::clamp(static_cast<int>(std::lround(r.ox + r.dx * tHit)), 0, w - 1);
+                result.z = std::clamp(static_cast<int>(std::lround(r.oz + r.dz * tHit)), 0, h - 1);
+                return result;
+            }
+            continue;
+        }
+
+        // Children front-to-back: push in reverse entry order (insertion sort, at most 4)
+        Node children[4];
+        int count = 0;
+        for (int cy = 0; cy < 2; ++cy) {
+            for (int cx = 0; cx < 2; ++cx) {
+                Node c;
+                if (!visit(n.level - 1, 2 * n.x + cx, 2 * n.y + cy, n.t0, n.t1, c)) continue;
+                int i = count++;
+                for (; i > 0 && children[i - 1].t0 < c.t0; --i) children[i] = children[i - 1];
+                children[i] = c;
+            }
+        }
+        for (int i = 0; i < count; ++i) stack[top++] = children[i];
+    }
+    return result;
+}
+
+void raycastBatch(const TerrainMap& map, const math::Ray* rays, size_t count, float maxDist, float gridScale, RayHit* out) {
+    map.pyramid(); // Lazy update must not race inside the parallel loop
+
+    core::JobSystem::instance().parallelFor(0, static_cast<int>(count), 64, [&](int rayBegin, int rayEnd) {
+        for (int i = rayBegin; i < rayEnd; ++i) {
+            out[i] = raycast(map, rays[i], maxDist, gridScale);
+        }
+    });
+}
+
+} // namespace terrain
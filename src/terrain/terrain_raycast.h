@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../math/math_types.h"
+#include <cstddef>
+
+namespace terrain {
+
+class TerrainMap;
+
+// v4.7.0: Result of a ray / heightfield query
+struct RayHit {
+    bool hit = false;
+    float t = 0.0f;          // Ray parameter at the hit (world units if direction is normalized)
+    math::Vec3 position{0.0f, 0.0f, 0.0f};
+    int cellX = 0;           // Patch (quad between samples x..x+1, z..z+1) containing the hit
+    int cellZ = 0;
+    int x = 0;               // Nearest height sample (map index, as used by probes)
+    int z = 0;
+};
+
+// v4.7.0: Exact ray intersection against the rendered heightfield.
+// Sample (x, z) sits at world (x * gridScale, h, z * gridScale); each quad is
+// treated as a bilinear patch. Traversal is front-to-back over the max-height
+// quadtree (TerrainMap::pyramid()), so empty space is skipped in large steps
+// and every patch the ray actually crosses is tested (no tunnelling through
+// thin ridges, unlike fixed-step marching).
+RayHit raycast(const TerrainMap& map, const math::Ray& ray, float maxDist, float gridScale);
+
+// Batch variant for many rays (e.g. sampling a whole view for analysis).
+// Parallel over rays; brings the pyramid up to date once before starting.
+void raycastBatch(const TerrainMap& map, const math::Ray* rays, size_t count, float maxDist, float gridScale, RayHit* out);
+
+} // namespace terrain
@@ -1,175 +1,402 @@
 #include "terrain_renderer.h"
 #include "../ml/ml_service.h"
 #include "soil_palette.h"
+#include "terrain_rtin.h"
 #include "../graphics/geometry_utils.h"
+#include "../core/job_system.h"
 #include <iostream>
 #include <cstring>
 #include <algorithm> // v3.9.0 for std::clamp
 #include <cmath>
+#include <mutex>
+#include <optional>
+#include <cstddef>
 
 namespace shape {
 
 TerrainRenderer::TerrainRenderer(const core::GraphicsContext& ctx, VkRenderPass renderPass, VkCommandPool commandPool) : ctx_(ctx), commandPool_(commandPool) {
     // Reuse existing basic shader for v1 (Vertex Color)
-    auto vs = std::make_shared<graphics::Shader>(ctx_, "shaders/basic.vert.spv");
+    // v4.7.0: terrain.vert decodes the compact split streams
+    auto vs = std::make_shared<graphics::Shader>(ctx_, "shaders/terrain.vert.spv");
     auto fs = std::make_shared<graphics::Shader>(ctx_, "shaders/terrain.frag.spv");
     
     // v3.9.0: Create Vegetation Layout FIRST so Material knows it
     createVegetationResources(1, 1); // Dummy size, will resize in updateVegetation or assumes fixed
 
     // Create Material with VALID RenderPass!
-    material_ = std::make_unique<graphics::Material>(ctx_, renderPass, VkExtent2D{1280,720}, vs, fs, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_POLYGON_MODE_FILL, true, true, vegDescLayout_); 
+    graphics::VertexInputLayout vertexInput = vertexInputLayout();
+    material_ = std::make_unique<graphics::Material>(ctx_, renderPass, VkExtent2D{1280,720}, vs, fs, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_POLYGON_MODE_FILL, true, true, vegDescLayout_, &vertexInput);
 }
     // Material initialized.
 
-// 1. Refactored buildMesh to use helper
-void TerrainRenderer::buildMesh(const terrain::TerrainMap& map, float gridScale, const ml::MLService* mlService, int soilMode, bool useMLColor) {
-    MeshData data = generateMeshData(map, gridScale, mlService, soilMode, useMLColor);
-    uploadMesh(data);
-}
+namespace {
 
-void TerrainRenderer::uploadMesh(const MeshData& data) {
-    // This MUST run on Main Thread (GPU Access)
-    mesh_ = std::make_unique<graphics::Mesh>(ctx_, data.vertices, data.indices);
+// Central-difference normal (shared by the geometry pass and the slope colouring)
+inline void computeNormal(const terrain::TerrainMap& map, int x, int z, int w, int h, float gridScale, float n[3]) {
+    float hL = map.getHeight(x > 0 ? x-1 : x, z);
+    float hR = map.getHeight(x < w-1 ? x+1 : x, z);
+    float hD = map.getHeight(x, z > 0 ? z-1 : z);
+    float hU = map.getHeight(x, z < h-1 ? z+1 : z);
+    
+    // Central differences
+    float dx = (hR - hL); // run=2
+    float dz = (hU - hD);
+    // Normal = cross( (2, dx, 0), (0, dz, 2) ) -> normalized
+    // Roughly (-dx, 2, -dz)
+    
+    float nx = -dx;
+    float ny = 2.0f * gridScale; // Correctly scale run by gridScale
+    float nz = -dz;
+    float len = std::sqrt(nx*nx + ny*ny + nz*nz);
+    n[0] = nx / len;
+    n[1] = ny / len;
+    n[2] = nz / len;
 }
 
-TerrainRenderer::MeshData TerrainRenderer::generateMeshData(const terrain::TerrainMap& map, float gridScale, const ml::MLService* mlService, int soilMode, bool useMLColor) {
-    int w = map.getWidth();
-    int h = map.getHeight();
-    
-    MeshData data;
-    data.vertices.reserve(w * h);
-    data.indices.reserve((w - 1) * (h - 1) * 6);
+// Colour + per-cell attributes for rows [rowBegin, rowEnd), written densely to out.
+void encodeAttributes(const terrain::TerrainMap& map, float gridScale, const ml::MLService* mlService,
+                      int soilMode, bool useMLColor, int rowBegin, int rowEnd, graphics::TerrainAttributes* out) {
+    const int w = map.getWidth();
+    const int h = map.getHeight();
+    const auto* soil = map.getLandscapeSoil();
+    const auto& fluxMap = map.fluxMap();
+    const auto& sedimentMap = map.sedimentMap();
+    const auto& watershedMap = map.watershedMap();
+    const auto& soilMap = map.soilMap();
+    const terrain::SoilMask shownSoils = map.soilView();
+    const bool hasSediment = !sedimentMap.empty(); // v4.7.0: Lazy channels
+    const bool hasBasins = !watershedMap.empty();
+    const landscape::SiBCSLevel viewLevel = static_cast<landscape::SiBCSLevel>(soilMode);
+    // v4.7.0: SiBCS colours per (order, taxon) of this world, one lookup per cell
+    std::optional<terrain::SoilColorTable> soilColors;
+    if (soilMode >= 1 && soil) soilColors.emplace(viewLevel, soil->taxa);
+
+    // v4.7.0: ML colour is evaluated per row through the batched path (model resolved once)
+    const bool mlActive = mlService && useMLColor && soil;
+    const ml::ModelHandle soilColorModel = mlActive ? mlService->getModel("soil_color") : nullptr;
+
+    core::JobSystem::instance().parallelFor(rowBegin, rowEnd, 0, [&](int zBegin, int zEnd) {
+        for (int z = zBegin; z < zEnd; ++z) {
+            graphics::TerrainAttributes* row = out + static_cast<size_t>(z - rowBegin) * static_cast<size_t>(w);
+            const size_t rowStart = static_cast<size_t>(z) * static_cast<size_t>(w);
+
+            std::vector<float> mlOut;
+            if (mlActive) {
+                // Inputs: depth, organic matter, infiltration / 100, compaction (SoA, straight from the soil grid;
+                // compaction is packed, unpacked per row)
+                std::vector<float> infNorm(static_cast<size_t>(w));
+                std::vector<float> compaction(static_cast<size_t>(w));
+                for (int x = 0; x < w; ++x) {
+                    infNorm[static_cast<size_t>(x)] = soil->infiltration[rowStart + static_cast<size_t>(x)] / 100.0f;
+                }
+                soil->compaction.load(rowStart, static_cast<size_t>(w), compaction.data());
+                const float* cols[4] = {
+                    soil->depth.data() + rowStart,
+                    soil->organic_matter.data() + rowStart,
+                    infNorm.data(),
+                    compaction.data()
+                };
+                mlOut.resize(static_cast<size_t>(w));
+                mlService->predictBatch(soilColorModel, cols, static_cast<size_t>(w), mlOut.data());
+            }
 
-    std::vector<graphics::Vertex>& vertices = data.vertices;
-    std::vector<uint32_t>& indices = data.indices;
+            for (int x = 0; x < w; ++x) {
+                const size_t idx = static_cast<size_t>(z) * static_cast<size_t>(w) + static_cast<size_t>(x);
+                float color[4] = {0.0f, 0.0f, 0.0f, 1.0f};
 
-    // 1. Generate Vertices
-    for (int z = 0; z < h; ++z) {
-        for (int x = 0; x < w; ++x) {
-            float height = map.getHeight(x, z);
-            
-            // Calculate Smooth Normal
-            float hL = map.getHeight(x > 0 ? x-1 : x, z);
-            float hR = map.getHeight(x < w-1 ? x+1 : x, z);
-            float hD = map.getHeight(x, z > 0 ? z-1 : z);
-            float hU = map.getHeight(x, z < h-1 ? z+1 : z);
-            
-            // Central differences
-            float dx = (hR - hL); // run=2
-            float dz = (hU - hD);
-            // Normal = cross( (2, dx, 0), (0, dz, 2) ) -> normalized
-            // Roughly (-dx, 2, -dz)
+                // Visualization Colors
+                // Slope-based coloring (Default / Base)
+                float normal[3];
+                computeNormal(map, x, z, w, h, gridScale, normal);
+                float slope = 1.0f - normal[1]; // 0 = flat, 1 = vertical
             
-            float nx = -dx;
-            float ny = 2.0f * gridScale; // Correctly scale run by gridScale
-            float nz = -dz;
-            float len = std::sqrt(nx*nx + ny*ny + nz*nz);
-            
-            graphics::Vertex v{};
-            v.pos[0] = static_cast<float>(x) * gridScale;
-            v.pos[1] = height;
-            v.pos[2] = static_cast<float>(z) * gridScale;
-            
-            v.normal[0] = nx / len;
-            v.normal[1] = ny / len;
-            v.normal[2] = nz / len;
-
-            // Visualization Colors
-            // Slope-based coloring (Default / Base)
-            float slope = 1.0f - v.normal[1]; // 0 = flat, 1 = vertical
+                if (slope < 0.15f) { // Flat (Soil/Dirt)
+                    color[0] = 0.55f; color[1] = 0.47f; color[2] = 0.36f; // Light Brown
+                } else if (slope < 0.4f) { // Hill (Darker Soil/Rock mix)
+                    color[0] = 0.45f; color[1] = 0.38f; color[2] = 0.31f; // Darker Brown
+                } else { // Cliff (Rock)
+                    color[0] = 0.4f; color[1] = 0.4f; color[2] = 0.45f; // Blue-Grey Rock
+                }
             
-            if (slope < 0.15f) { // Flat (Soil/Dirt)
-                v.color[0] = 0.55f; v.color[1] = 0.47f; v.color[2] = 0.36f; // Light Brown
-            } else if (slope < 0.4f) { // Hill (Darker Soil/Rock mix)
-                v.color[0] = 0.45f; v.color[1] = 0.38f; v.color[2] = 0.31f; // Darker Brown
-            } else { // Cliff (Rock)
-                v.color[0] = 0.4f; v.color[1] = 0.4f; v.color[2] = 0.45f; // Blue-Grey Rock
-            }
+                // v4.6.6: Cumulative SiBCS Visualization (Hierarchical)
+                if (soilColors) {
+                    const float* rgb = soilColors->color(soil->soil_type[idx], soil->taxon[idx]);
+                    color[0] = rgb[0];
+                    color[1] = rgb[1];
+                    color[2] = rgb[2];
+                }
             
-            // v4.6.6: Cumulative SiBCS Visualization (Hierarchical)
-            if (soilMode >= 1 && map.getLandscapeSoil()) {
-                int idx = z * w + x;
-                auto* soil = map.getLandscapeSoil();
-                float rgb[3] = {0.5f, 0.5f, 0.5f};
-
-                landscape::SiBCSLevel viewLevel = static_cast<landscape::SiBCSLevel>(soilMode);
-
-                // Fetch full taxonomic context
-                uint8_t storedType = soil->soil_type[idx];
-                auto type = terrain::SoilType::None;
-                if (storedType <= static_cast<uint8_t>(terrain::SoilType::Organossolo)) {
-                    type = static_cast<terrain::SoilType>(storedType);
+                // v4.0.0 ML Override (Optional - takes precedence if active)
+                if (mlActive) {
+                    Eigen::Vector3f mlColor = ml::MLService::soilColorRamp(mlOut[static_cast<size_t>(x)]);
+                    color[0] = mlColor.x();
+                    color[1] = mlColor.y();
+                    color[2] = mlColor.z();
                 }
-                auto sub = static_cast<landscape::SiBCSSubOrder>(soil->suborder[idx]);
-                auto group = static_cast<landscape::SiBCSGreatGroup>(soil->great_group[idx]);
-                auto subGroup = static_cast<landscape::SiBCSSubGroup>(soil->sub_group[idx]);
-                auto family = static_cast<landscape::SiBCSFamily>(soil->family[idx]);
-                auto series = static_cast<landscape::SiBCSSeries>(soil->series[idx]);
-                
-                // Unified Call
-                terrain::SoilPalette::getCumulativeColor(viewLevel, type, sub, group, subGroup, family, series, rgb);
-                
-                v.color[0] = rgb[0];
-                v.color[1] = rgb[1];
-                v.color[2] = rgb[2];
-            }
             
-            // v4.0.0 ML Override (Optional - takes precedence if active)
-            if (mlService && useMLColor && map.getLandscapeSoil()) {
-                int idx = z * w + x;
-                auto* soil = map.getLandscapeSoil();
-                float d = soil->depth[idx];
-                float om = soil->organic_matter[idx];
-                float inf = soil->infiltration[idx] / 100.0f;
-                float comp = soil->compaction[idx];
-                
-                // Predict
-                Eigen::Vector3f mlColor = mlService->predictSoilColor(d, om, inf, comp);
-                v.color[0] = mlColor.x();
-                v.color[1] = mlColor.y();
-                v.color[2] = mlColor.z();
+                // v3.6.1 Flux (Drainage) / v3.6.2 Sediment -> decoded to fragUV in terrain.vert
+                // v3.6.3 Basin ID + v3.7.3 Semantic Soil ID -> packed ids word
+                row[x] = graphics::terrain_vertex::packAttributes(
+                    color, fluxMap[idx], hasSediment ? sedimentMap[idx] : 0.0f, hasBasins ? watershedMap[idx] : 0,
+                    static_cast<uint8_t>(terrain::soilTypeOf(soilMap[idx], shownSoils)));
             }
-            
-            // v3.6.1 Flux (Drainage) Visualization
-            // Store flux in UV.x for shader-based visualization toggling.
-            float flux = map.fluxMap()[z * w + x];
-            v.uv[0] = flux;
-            
-            // v3.6.2 Erosion (Sediment) Visualization
-            // Store sediment in UV.y
-            float sed = map.sedimentMap()[z * w + x];
-            v.uv[1] = sed;
-
-            // v3.6.3 Watershed Visualization
-            // Store Basin ID in auxiliary
-            v.auxiliary = static_cast<float>(map.watershedMap()[z * w + x]);
-            
-            // v3.7.3 Semantic Soil ID
-            v.soilId = static_cast<float>(map.soilMap()[z * w + x]);
-            
-            vertices.push_back(v);
         }
+    });
+}
+
+} // namespace
+
+// 1. Refactored buildMesh to use helper
+void TerrainRenderer::buildMesh(const terrain::TerrainMap& map, float gridScale, const ml::MLService* mlService, int soilMode, bool useMLColor) {
+    uploadMesh(generateMeshData(map, gridScale, mlService, soilMode, useMLColor));
+}
+
+void TerrainRenderer::uploadMesh(MeshData data) {
+    // This MUST run on Main Thread (GPU Access)
+    if (!data.indices) {
+        data.indices = gridIndices(data.width, data.height);
     }
 
-    // Indices (same as before)
-    for (int z = 0; z < h - 1; ++z) {
-        for (int x = 0; x < w - 1; ++x) {
-            int topLeft = z * w + x;
-            int topRight = topLeft + 1;
-            int bottomLeft = (z + 1) * w + x;
-            int bottomRight = bottomLeft + 1;
-
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
+    // v4.7.0: Index lists are shared (gridIndices() per size, or an adaptive
+    // triangulation); upload only when the list itself changes
+    if (!gridIndexBuffer_ || uploadedIndices_ != data.indices) {
+        gridIndexBuffer_ = graphics::Mesh::createIndexBuffer(ctx_, *data.indices);
+        gridIndexCount_ = static_cast<uint32_t>(data.indices->size());
+        uploadedIndices_ = data.indices;
+    }
+
+    std::vector<std::unique_ptr<resources::Buffer>> streams;
+    streams.push_back(graphics::Mesh::createVertexBuffer(ctx_, data.geometry.data(),
+        sizeof(graphics::TerrainGeometry) * data.geometry.size()));
+    streams.push_back(graphics::Mesh::createVertexBuffer(ctx_, data.attributes.data(),
+        sizeof(graphics::TerrainAttributes) * data.attributes.size()));
+
+    mesh_ = std::make_unique<graphics::Mesh>(std::move(streams), static_cast<uint32_t>(data.geometry.size()),
+                                             gridIndexBuffer_, gridIndexCount_);
+    meshWidth_ = data.width;
+    meshHeight_ = data.height;
+    gridScale_ = data.gridScale;
+
+    int tiles = (meshHeight_ + kAttributeTileRows - 1) / kAttributeTileRows;
+    dirtyTiles_.assign(static_cast<size_t>(std::max(tiles, 0)), 0);
+    anyDirty_ = false;
+}
+
+void TerrainRenderer::markAttributesDirty(int rowBegin, int rowEnd) {
+    if (dirtyTiles_.empty()) return;
+    rowBegin = std::max(rowBegin, 0);
+    rowEnd = std::min(rowEnd, meshHeight_);
+    if (rowBegin >= rowEnd) return;
+    int t0 = rowBegin / kAttributeTileRows;
+    int t1 = (rowEnd - 1) / kAttributeTileRows;
+    for (int t = t0; t <= t1; ++t) {
+        dirtyTiles_[static_cast<size_t>(t)] = 1;
+    }
+    anyDirty_ = true;
+}
+
+void TerrainRenderer::markAllAttributesDirty() {
+    std::fill(dirtyTiles_.begin(), dirtyTiles_.end(), static_cast<uint8_t>(1));
+    anyDirty_ = !dirtyTiles_.empty();
+}
+
+void TerrainRenderer::flushDirtyAttributes(const terrain::TerrainMap& map, const ml::MLService* mlService, int soilMode, bool useMLColor) {
+    if (!anyDirty_ || !mesh_) return;
+    if (map.getWidth() != meshWidth_ || map.getHeight() != meshHeight_) return;
+
+    const VkDeviceSize rowBytes = sizeof(graphics::TerrainAttributes) * static_cast<VkDeviceSize>(meshWidth_);
+    ensureStagingRing(rowBytes * kAttributeTileRows); // At least one tile per slot
+    resources::Buffer& attributeStream = mesh_->vertexStream(1);
+
+    resources::StagingRing::Slot* slot = nullptr;
+    VkDeviceSize used = 0;
+    std::vector<VkBufferCopy> regions;
+
+    auto beginSlot = [&]() {
+        slot = &stagingRing_->acquire();
+        used = 0;
+        regions.clear();
+        // WAR: earlier frames on this queue may still read the attribute stream
+        vkCmdPipelineBarrier(slot->cmd, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 0, nullptr);
+    };
+    auto endSlot = [&]() {
+        vkCmdCopyBuffer(slot->cmd, slot->buffer, attributeStream.handle(),
+                        static_cast<uint32_t>(regions.size()), regions.data());
+
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = attributeStream.handle();
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(slot->cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        stagingRing_->submit(*slot);
+        slot = nullptr;
+    };
+
+    const int tiles = static_cast<int>(dirtyTiles_.size());
+    for (int t = 0; t < tiles; ) {
+        if (!dirtyTiles_[static_cast<size_t>(t)]) { ++t; continue; }
+
+        // Coalesce consecutive dirty tiles into one contiguous row range
+        int t1 = t;
+        while (t1 < tiles && dirtyTiles_[static_cast<size_t>(t1)]) ++t1;
+        int row = t * kAttributeTileRows;
+        int rowEnd = std::min(t1 * kAttributeTileRows, meshHeight_);
+        t = t1;
+
+        while (row < rowEnd) {
+            if (!slot) beginSlot();
+            VkDeviceSize freeRows = (stagingRing_->slotSize() - used) / rowBytes;
+            if (freeRows == 0) { endSlot(); continue; }
+
+            int n = static_cast<int>(std::min<VkDeviceSize>(freeRows, static_cast<VkDeviceSize>(rowEnd - row)));
+            encodeAttributes(map, gridScale_, mlService, soilMode, useMLColor, row, row + n,
+                             reinterpret_cast<graphics::TerrainAttributes*>(slot->data + used));
+
+            VkBufferCopy region{};
+            region.srcOffset = used;
+            region.dstOffset = static_cast<VkDeviceSize>(row) * rowBytes;
+            region.size = static_cast<VkDeviceSize>(n) * rowBytes;
+            regions.push_back(region);
+
+            used += region.size;
+            row += n;
         }
     }
+    if (slot) endSlot();
+
+    std::fill(dirtyTiles_.begin(), dirtyTiles_.end(), static_cast<uint8_t>(0));
+    anyDirty_ = false;
+}
+
+void TerrainRenderer::refreshAttributes(const terrain::TerrainMap& map, float gridScale, const ml::MLService* mlService, int soilMode, bool useMLColor) {
+    if (!mesh_ || meshWidth_ != map.getWidth() || meshHeight_ != map.getHeight()) {
+        // Topology changed: full rebuild replaces buffers that may still be in use
+        vkDeviceWaitIdle(ctx_.device());
+        buildMesh(map, gridScale, mlService, soilMode, useMLColor);
+        return;
+    }
+
+    markAllAttributesDirty();
+    flushDirtyAttributes(map, mlService, soilMode, useMLColor);
+}
 
+graphics::VertexInputLayout TerrainRenderer::vertexInputLayout() {
+    graphics::VertexInputLayout layout;
+    layout.bindings.resize(2);
+    layout.bindings[0].binding = 0;
+    layout.bindings[0].stride = sizeof(graphics::TerrainGeometry);
+    layout.bindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    layout.bindings[1].binding = 1;
+    layout.bindings[1].stride = sizeof(graphics::TerrainAttributes);
+    layout.bindings[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    auto attr = [](uint32_t location, uint32_t binding, VkFormat format, uint32_t offset) {
+        VkVertexInputAttributeDescription d{};
+        d.location = location;
+        d.binding = binding;
+        d.format = format;
+        d.offset = offset;
+        return d;
+    };
+    layout.attributes = {
+        attr(0, 0, VK_FORMAT_R32_SFLOAT,     offsetof(graphics::TerrainGeometry, height)),
+        attr(1, 0, VK_FORMAT_R16G16_SNORM,   offsetof(graphics::TerrainGeometry, normal)),
+        attr(2, 1, VK_FORMAT_R8G8B8A8_UNORM, offsetof(graphics::TerrainAttributes, color)),
+        attr(3, 1, VK_FORMAT_R16G16_UNORM,   offsetof(graphics::TerrainAttributes, flux)),
+        attr(4, 1, VK_FORMAT_R32_UINT,       offsetof(graphics::TerrainAttributes, ids)),
+    };
+    return layout;
+}
+
+std::shared_ptr<const std::vector<uint32_t>> TerrainRenderer::gridIndices(int width, int height) {
+    static std::mutex cacheMutex;
+    static std::shared_ptr<const std::vector<uint32_t>> cached;
+    static int cachedW = 0;
+    static int cachedH = 0;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cached && cachedW == width && cachedH == height) {
+        return cached;
+    }
+
+    auto indices = std::make_shared<std::vector<uint32_t>>();
+    if (width > 1 && height > 1) {
+        const uint32_t w = static_cast<uint32_t>(width);
+        indices->resize(static_cast<size_t>(width - 1) * static_cast<size_t>(height - 1) * 6);
+        uint32_t* out = indices->data();
+
+        core::JobSystem::instance().parallelFor(0, height - 1, 0, [&](int rowBegin, int rowEnd) {
+            for (int z = rowBegin; z < rowEnd; ++z) {
+                uint32_t* row = out + static_cast<size_t>(z) * (w - 1) * 6;
+                for (uint32_t x = 0; x < w - 1; ++x) {
+                    uint32_t topLeft = static_cast<uint32_t>(z) * w + x;
+                    uint32_t topRight = topLeft + 1;
+                    uint32_t bottomLeft = topLeft + w;
+                    uint32_t bottomRight = bottomLeft + 1;
+
+                    row[0] = topLeft;
+                    row[1] = bottomLeft;
+                    row[2] = topRight;
+
+                    row[3] = topRight;
+                    row[4] = bottomLeft;
+                    row[5] = bottomRight;
+                    row += 6;
+                }
+            }
+        });
+    }
+
+    cached = std::move(indices);
+    cachedW = width;
+    cachedH = height;
+    return cached;
+}
+
+TerrainRenderer::MeshData TerrainRenderer::generateMeshData(const terrain::TerrainMap& map, float gridScale, const ml::MLService* mlService, int soilMode, bool useMLColor) {
+    int w = map.getWidth();
+    int h = map.getHeight();
+    
+    MeshData data;
+    data.width = w;
+    data.height = h;
+    data.gridScale = gridScale;
+    const size_t count = static_cast<size_t>(w) * static_cast<size_t>(h);
+    data.geometry.resize(count);
+    data.attributes.resize(count);
+
+    // 1. Generate Geometry (rows are independent; buffer is pre-sized)
+    core::JobSystem::instance().parallelFor(0, h, 0, [&](int rowBegin, int rowEnd) {
+        for (int z = rowBegin; z < rowEnd; ++z) {
+            for (int x = 0; x < w; ++x) {
+                float normal[3];
+                computeNormal(map, x, z, w, h, gridScale, normal);
+                data.geometry[static_cast<size_t>(z) * static_cast<size_t>(w) + static_cast<size_t>(x)] =
+                    graphics::terrain_vertex::packGeometry(map.getHeight(x, z), normal);
+            }
+        }
+    });
+
+    // 2. Colours and per-cell attributes
+    encodeAttributes(map, gridScale, mlService, soilMode, useMLColor, 0, h, data.attributes.data());
+
+    // 3. Indices (memoized per grid size)
+    data.indices = gridIndices(w, h);
+
+    return data;
+}
+
+TerrainRenderer::MeshData TerrainRenderer::generateAdaptiveMeshData(const terrain::TerrainMap& map, float maxErrorMeters, float gridScale, const ml::MLService* mlService, int soilMode, bool useMLColor) {
+    MeshData data = generateMeshData(map, gridScale, mlService, soilMode, useMLColor);
+    data.indices = terrain::TerrainRtin(map).triangulate(maxErrorMeters);
     return data;
 }
 
@@ -197,7 +424,9 @@ void TerrainRenderer::render(VkCommandBuffer cmd, const std::array<float, 16>& m
         float fixedColor[4];
         float params[4]; // x=opacity, y=drainageIntensity, z=fogDensity, w=pointSize
         uint32_t flags;  // Bitmask: 1=Lit, 2=FixCol, 4=Slope, 8=Drain, 16=Eros, 32=Water, 64=Soil, 128=Basin
-        float pad[3];
+        float gridScale;    // v4.7.0: terrain.vert rebuilds x/z from gl_VertexIndex
+        uint32_t gridWidth;
+        float pad;
     } pc;
     static_assert(sizeof(pc) == 128, "PC size mismatch");
 
@@ -247,6 +476,9 @@ void TerrainRenderer::render(VkCommandBuffer cmd, const std::array<float, 16>& m
     }
     
     pc.flags = static_cast<uint32_t>(mask);
+    pc.gridScale = gridScale_;
+    pc.gridWidth = static_cast<uint32_t>(std::max(meshWidth_, 1));
+    pc.pad = 0.0f;
 
     vkCmdPushConstants(cmd, material_->layout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pc), &pc);
 
@@ -402,77 +634,25 @@ void TerrainRenderer::updateVegetation(const vegetation::VegetationGrid& grid) {
             destroyVegetationResources();
         }
         createVegetationResources(grid.width, grid.height);
-        
-        // Ensure Fence and Command Buffer exist
-        if (uploadFence_ == VK_NULL_HANDLE) {
-            VkFenceCreateInfo fenceInfo{};
-            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            fenceInfo.flags = 0; // Starts unsignaled
-            vkCreateFence(ctx_.device(), &fenceInfo, nullptr, &uploadFence_);
-            
-            // Allocate Command Buffer once
-            VkCommandBufferAllocateInfo allocInfo{};
-            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-            allocInfo.commandPool = commandPool_;
-            allocInfo.commandBufferCount = 1;
-            vkAllocateCommandBuffers(ctx_.device(), &allocInfo, &uploadCmd_);
-        }
-    }
-
-    VkDeviceSize imageSize = grid.width * grid.height * 4;
-
-    // 2. Wait for previous upload to complete (Back-pressure)
-    if (hasPendingUpload_) {
-        vkWaitForFences(ctx_.device(), 1, &uploadFence_, VK_TRUE, UINT64_MAX);
-        vkResetFences(ctx_.device(), 1, &uploadFence_);
+        vegTexture_.invalidate();
+        vegImageInitialized_ = false;
     }
 
-    // 3. Staging Buffer Management
-    if (imageSize > stagingSize_ || stagingBuffer_ == VK_NULL_HANDLE) {
-        // Free old
-        if (stagingBuffer_ != VK_NULL_HANDLE) {
-            vkDestroyBuffer(ctx_.device(), stagingBuffer_, nullptr);
-            vkFreeMemory(ctx_.device(), stagingMemory_, nullptr);
-        }
-        // Allocate new (Host Visible)
-        createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                     stagingBuffer_, stagingMemory_);
-        stagingSize_ = imageSize;
-    }
+    // 2. v4.7.0: CPU tile diff + pack; only tiles whose texels changed are uploaded
+    const std::vector<vegetation::TextureTile>& tiles = vegTexture_.update(grid);
+    if (tiles.empty()) return;
 
-    // 4. Map and Fill (Parallel)
-    void* data;
-    vkMapMemory(ctx_.device(), stagingMemory_, 0, imageSize, 0, &data);
-    
-    uint8_t* pixels = static_cast<uint8_t*>(data);
-    size_t count = grid.getSize();
-
-    // PARALLEL CONVERSION (Critical for 4K)
-    #pragma omp parallel for
-    for (size_t i = 0; i < count; ++i) {
-        pixels[i * 4 + 0] = static_cast<uint8_t>(std::clamp(grid.ei_coverage[i], 0.0f, 1.0f) * 255.0f);
-        pixels[i * 4 + 1] = static_cast<uint8_t>(std::clamp(grid.es_coverage[i], 0.0f, 1.0f) * 255.0f);
-        pixels[i * 4 + 2] = static_cast<uint8_t>(std::clamp(grid.ei_vigor[i], 0.0f, 1.0f) * 255.0f);
-        pixels[i * 4 + 3] = static_cast<uint8_t>(std::clamp(grid.es_vigor[i], 0.0f, 1.0f) * 255.0f);
-    }
-    
-    vkUnmapMemory(ctx_.device(), stagingMemory_);
+    const VkDeviceSize tileBytes = static_cast<VkDeviceSize>(vegetation::VegetationGrid::kTileSize) *
+                                   vegetation::VegetationGrid::kTileSize * 4;
+    ensureStagingRing(tileBytes);
 
-    // 5. Submit Upload Command
-    vkResetCommandBuffer(uploadCmd_, 0);
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    // 3. Stream through the staging ring, one VkBufferImageCopy per tile
+    resources::StagingRing::Slot* slot = nullptr;
+    VkDeviceSize used = 0;
+    std::vector<VkBufferImageCopy> regions;
 
-    vkBeginCommandBuffer(uploadCmd_, &beginInfo);
-    
-    // Transition Undefined/Read -> Transfer Dst
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED; // Or SHADER_READ_ONLY if preserving? We overwrite all, so UNDEFINED is fine/faster.
-    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
     barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.image = vegImage_;
@@ -481,40 +661,69 @@ void TerrainRenderer::updateVegetation(const vegetation::VegetationGrid& grid) {
     barrier.subresourceRange.levelCount = 1;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-    vkCmdPipelineBarrier(uploadCmd_, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
-    VkBufferImageCopy region{};
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.layerCount = 1;
-    region.imageExtent = { (uint32_t)grid.width, (uint32_t)grid.height, 1 };
-
-    vkCmdCopyBufferToImage(uploadCmd_, stagingBuffer_, vegImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-    // Transition Transfer Dst -> Shader Read Only
-    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-    vkCmdPipelineBarrier(uploadCmd_, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-    vkEndCommandBuffer(uploadCmd_);
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &uploadCmd_;
+    auto beginSlot = [&]() {
+        slot = &stagingRing_->acquire();
+        used = 0;
+        regions.clear();
+
+        // Partial updates must preserve the rest of the image: only the very first
+        // upload (which covers every tile) may discard from UNDEFINED.
+        barrier.oldLayout = vegImageInitialized_ ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(slot->cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        vegImageInitialized_ = true;
+    };
+    auto endSlot = [&]() {
+        vkCmdCopyBufferToImage(slot->cmd, slot->buffer, vegImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(regions.size()), regions.data());
+
+        // Transition Transfer Dst -> Shader Read Only
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(slot->cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        stagingRing_->submit(*slot);
+        slot = nullptr;
+    };
+
+    for (const auto& tile : tiles) {
+        const VkDeviceSize bytes = tile.byteSize();
+        if (slot && used + bytes > stagingRing_->slotSize()) endSlot();
+        if (!slot) beginSlot();
+
+        vegTexture_.copyTile(tile, slot->data + used);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = used;
+        region.bufferRowLength = 0; // Tightly packed tile rows
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { tile.x, tile.y, 0 };
+        region.imageExtent = { static_cast<uint32_t>(tile.width), static_cast<uint32_t>(tile.height), 1 };
+        regions.push_back(region);
+
+        used += bytes;
+    }
+    if (slot) endSlot();
+}
 
-    // Submit with Fence
-    vkQueueSubmit(ctx_.graphicsQueue(), 1, &submitInfo, uploadFence_);
-    hasPendingUpload_ = true;
+void TerrainRenderer::ensureStagingRing(VkDeviceSize minSlotSize) {
+    // Shared by attribute and vegetation streaming (4 MB minimum per slot)
+    if (stagingRing_ && stagingRing_->slotSize() >= minSlotSize) return;
+    if (stagingRing_) stagingRing_->waitAll();
+    VkDeviceSize slotSize = std::max<VkDeviceSize>(4ull << 20, minSlotSize);
+    stagingRing_ = std::make_unique<resources::StagingRing>(ctx_, slotSize, 3);
 }
 
 void TerrainRenderer::destroyVegetationResources() {
     VkDevice device = ctx_.device();
+    if (stagingRing_) stagingRing_->waitAll(); // Tile copies may still target the image
     if (vegSampler_) vkDestroySampler(device, vegSampler_, nullptr);
     if (vegView_) vkDestroyImageView(device, vegView_, nullptr);
     if (vegImage_) vkDestroyImage(device, vegImage_, nullptr);
@@ -522,25 +731,13 @@ void TerrainRenderer::destroyVegetationResources() {
     if (vegDescPool_) vkDestroyDescriptorPool(device, vegDescPool_, nullptr);
     if (vegDescLayout_) vkDestroyDescriptorSetLayout(device, vegDescLayout_, nullptr);
     
-    // Clean up Async Resources
-    if (stagingBuffer_) vkDestroyBuffer(device, stagingBuffer_, nullptr);
-    if (stagingMemory_) vkFreeMemory(device, stagingMemory_, nullptr);
-    if (uploadFence_) vkDestroyFence(device, uploadFence_, nullptr);
-    // Command Buffer is freed with pool usually, but to be clean:
-    if (uploadCmd_) vkFreeCommandBuffers(device, commandPool_, 1, &uploadCmd_);
-    
     vegSampler_ = VK_NULL_HANDLE;
     vegView_ = VK_NULL_HANDLE;
     vegImage_ = VK_NULL_HANDLE;
     vegMemory_ = VK_NULL_HANDLE;
     vegDescPool_ = VK_NULL_HANDLE;
     vegDescLayout_ = VK_NULL_HANDLE;
-    stagingBuffer_ = VK_NULL_HANDLE;
-    stagingMemory_ = VK_NULL_HANDLE;
-    uploadFence_ = VK_NULL_HANDLE;
-    uploadCmd_ = VK_NULL_HANDLE;
-    stagingSize_ = 0;
-    hasPendingUpload_ = false;
+    vegImageInitialized_ = false;
 }
 
 uint32_t TerrainRenderer::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
@@ -554,23 +751,4 @@ uint32_t TerrainRenderer::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFl
     throw std::runtime_error("failed to find suitable memory type!");
 }
 
-void TerrainRenderer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = size;
-    bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    if (vkCreateBuffer(ctx_.device(), &bufferInfo, nullptr, &buffer) != VK_SUCCESS) throw std::runtime_error("failed to create buffer!");
-
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(ctx_.device(), buffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-    if (vkAllocateMemory(ctx_.device(), &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) throw std::runtime_error("failed to allocate buffer memory!");
-    vkBindBufferMemory(ctx_.device(), buffer, bufferMemory, 0);
-}
-
 } // namespace shape
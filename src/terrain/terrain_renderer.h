@@ -4,9 +4,12 @@
 #include "../core/graphics_context.h"
 #include "../graphics/material.h"
 #include "../graphics/mesh.h"
+#include "../graphics/terrain_vertex.h"
+#include "../resources/staging_ring.h"
 #include <memory>
 #include <vector>
 #include "../vegetation/vegetation_types.h"
+#include "../vegetation/vegetation_texture.h"
 
 namespace ml { class MLService; }
 
@@ -18,8 +21,15 @@ public:
     ~TerrainRenderer() = default;
 
     struct MeshData {
-        std::vector<graphics::Vertex> vertices;
-        std::vector<uint32_t> indices;
+        // v4.7.0: Compact split streams (x/z implicit in the vertex index)
+        std::vector<graphics::TerrainGeometry> geometry;
+        std::vector<graphics::TerrainAttributes> attributes;
+        // v4.7.0: Grid topology depends only on (width, height); shared via gridIndices().
+        // Adaptive meshes carry their own triangle list over the same vertex grid.
+        std::shared_ptr<const std::vector<uint32_t>> indices;
+        int width = 0;
+        int height = 0;
+        float gridScale = 1.0f;
     };
 
     /**
@@ -30,7 +40,46 @@ public:
 
     // Async Support
     static MeshData generateMeshData(const terrain::TerrainMap& map, float gridScale = 1.0f, const ml::MLService* mlService = nullptr, int soilMode = 0, bool useMLColor = false);
-    void uploadMesh(const MeshData& data);
+    void uploadMesh(MeshData data);
+
+    /**
+     * @brief Error-bounded adaptive mesh (RTIN, see terrain::TerrainRtin).
+     * Same vertex streams as generateMeshData; only the triangle list is reduced,
+     * with the surface within maxErrorMeters of every height sample and no cracks.
+     */
+    static MeshData generateAdaptiveMeshData(const terrain::TerrainMap& map, float maxErrorMeters, float gridScale = 1.0f, const ml::MLService* mlService = nullptr, int soilMode = 0, bool useMLColor = false);
+
+    /**
+     * @brief Memoized triangle-list indices for a w x h vertex grid.
+     * Thread-safe; repeated calls with the same size return the same buffer.
+     */
+    static std::shared_ptr<const std::vector<uint32_t>> gridIndices(int width, int height);
+
+    /**
+     * @brief Bindings/attributes for the split geometry + attribute streams (terrain.vert).
+     */
+    static graphics::VertexInputLayout vertexInputLayout();
+
+    // v4.7.0: Attribute streaming. Rows are grouped into tiles of kAttributeTileRows;
+    // only dirty tiles are re-encoded and copied through the staging ring.
+    static constexpr int kAttributeTileRows = 32;
+
+    /** @brief Flag rows [rowBegin, rowEnd) as needing new colours/attributes. */
+    void markAttributesDirty(int rowBegin, int rowEnd);
+    void markAllAttributesDirty();
+
+    /**
+     * @brief Re-encode dirty attribute tiles and upload them without stalling the device.
+     * Geometry and indices are never touched.
+     */
+    void flushDirtyAttributes(const terrain::TerrainMap& map, const ml::MLService* mlService = nullptr, int soilMode = 0, bool useMLColor = false);
+    bool hasDirtyAttributes() const { return anyDirty_; }
+
+    /**
+     * @brief Recompute colours and attributes for the whole map (markAll + flush).
+     * Falls back to buildMesh if the map size no longer matches the uploaded mesh.
+     */
+    void refreshAttributes(const terrain::TerrainMap& map, float gridScale = 1.0f, const ml::MLService* mlService = nullptr, int soilMode = 0, bool useMLColor = false);
 
     /**
      * @brief Record draw commands
@@ -54,6 +103,18 @@ private:
     VkCommandPool commandPool_; // v3.9.0: Needed for texture uploads
     std::unique_ptr<graphics::Mesh> mesh_;
     std::unique_ptr<graphics::Material> material_;
+
+    // v4.7.0: Mesh streams, GPU index buffer memoized per index list,
+    // and dirty-tile state for attribute uploads.
+    int meshWidth_ = 0;
+    int meshHeight_ = 0;
+    float gridScale_ = 1.0f;
+    std::shared_ptr<resources::Buffer> gridIndexBuffer_;
+    uint32_t gridIndexCount_ = 0;
+    std::shared_ptr<const std::vector<uint32_t>> uploadedIndices_;
+    std::vector<uint8_t> dirtyTiles_;
+    bool anyDirty_ = false;
+    std::unique_ptr<resources::StagingRing> stagingRing_;
     
     // Vegetation Texture Resources
     VkImage vegImage_ = VK_NULL_HANDLE;
@@ -61,15 +122,9 @@ private:
     VkImageView vegView_ = VK_NULL_HANDLE;
     VkSampler vegSampler_ = VK_NULL_HANDLE;
     
-    // v3.9.2: Async Upload Synchronization
-    VkFence uploadFence_ = VK_NULL_HANDLE;
-    VkCommandBuffer uploadCmd_ = VK_NULL_HANDLE;
-    bool hasPendingUpload_ = false;
-
-    // Persistent Staging Buffer
-    VkBuffer stagingBuffer_ = VK_NULL_HANDLE;
-    VkDeviceMemory stagingMemory_ = VK_NULL_HANDLE;
-    VkDeviceSize stagingSize_ = 0;
+    // v4.7.0: Dirty-tile streaming (CPU diff/pack, uploads go through stagingRing_)
+    vegetation::VegetationTextureCache vegTexture_;
+    bool vegImageInitialized_ = false; // false -> next upload may start from UNDEFINED
     
     // Vegetation Descriptors
     VkDescriptorSetLayout vegDescLayout_ = VK_NULL_HANDLE;
@@ -82,7 +137,7 @@ private:
 
     // Helpers
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
-    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+    void ensureStagingRing(VkDeviceSize minSlotSize);
 };
 
 } // namespace shape
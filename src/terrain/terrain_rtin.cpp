@@ -0,0 +1,220 @@
+#include "terrain_rtin.h"
+#include "terrain_map.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace terrain {
+
+namespace {
+
+// Errors of triangles that cross the far map edge: always refined
+constexpr float kForceSplit = FLT_MAX;
+
+// Subtree depth at which extraction is handed out as parallel tasks (tiles)
+constexpr int kTaskDepth = 10;
+
+struct Tri {
+    int ax, az; // Hypotenuse
+    int bx, bz;
+    int cx, cz; // Right-angle apex
+};
+
+} // namespace
+
+TerrainRtin::TerrainRtin(const TerrainMap& map)
+    : width_(map.getWidth()), height_(map.getHeight()) {
+    if (width_ < 2 || height_ < 2) return;
+
+    int tile = 1;
+    while (tile + 1 < std::max(width_, height_)) tile <<= 1;
+    gridSize_ = tile + 1;
+    const int size = gridSize_;
+    errors_.assign(static_cast<size_t>(size) * static_cast<size_t>(size), 0.0f);
+
+    const core::GridVector<float>& heights = map.heightMap();
+    const int w = width_;
+    const int h = height_;
+    // Virtual grid beyond the map replicates the edge samples
+    auto hAt = [&](int x, int z) {
+        return heights[static_cast<size_t>(std::min(z, h - 1)) * static_cast<size_t>(w) + static_cast<size_t>(std::min(x, w - 1))];
+    };
+    auto err = [&](int x, int z) -> float& { return errors_[static_cast<size_t>(z) * static_cast<size_t>(size) + static_cast<size_t>(x)]; };
+    auto outside = [&](int x, int z) { return x > w - 1 || z > h - 1; };
+    // Triangle has a corner outside the map but covers some of it
+    auto straddles = [&](int ax, int az, int bx, int bz, int cx, int cz) {
+        if (!outside(ax, az) && !outside(bx, bz) && !outside(cx, cz)) return false;
+        return std::min({ax, bx, cx}) < w - 1 && std::min({az, bz, cz}) < h - 1;
+    };
+
+    // Max deviation of the triangle's plane from the samples it covers. Exact
+    // (not just the hypotenuse midpoint), so the tolerance is a hard bound.
+    auto triangleError = [&](int ax, int az, int bx, int bz, int cx, int cz) -> float {
+        if (straddles(ax, az, bx, bz, cx, cz)) return kForceSplit;
+        const int x0 = std::min({ax, bx, cx}), x1 = std::max({ax, bx, cx});
+        const int z0 = std::min({az, bz, cz}), z1 = std::max({az, bz, cz});
+        if (x0 >= w - 1 || z0 >= h - 1) return 0.0f; // Entirely outside; never emitted
+
+        // Edge functions: e_k(x, z) >= 0 inside, sum = twice the signed area
+        const int area2 = (bx - ax) * (cz - az) - (bz - az) * (cx - ax);
+        const float inv = 1.0f / static_cast<float>(area2);
+        const float ha = hAt(ax, az), hb = hAt(bx, bz), hc = hAt(cx, cz);
+        float worst = 0.0f;
+        for (int z = z0; z <= z1; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                const int ea = (cx - bx) * (z - bz) - (cz - bz) * (x - bx); // Weight of a
+                const int eb = (ax - cx) * (z - cz) - (az - cz) * (x - cx); // Weight of b
+                const int ec = area2 - ea - eb;
+                if (area2 > 0 ? (ea < 0 || eb < 0 || ec < 0) : (ea > 0 || eb > 0 || ec > 0)) continue;
+                const float plane = (static_cast<float>(ea) * ha + static_cast<float>(eb) * hb + static_cast<float>(ec) * hc) * inv;
+                worst = std::max(worst, std::abs(plane - hAt(x, z)));
+            }
+        }
+        return worst;
+    };
+
+    // Bottom-up over triangle sizes. Each vertex is the hypotenuse midpoint of
+    // at most two triangles of one level, so a level is computed per vertex with
+    // no write conflicts; children (finer level) are always complete beforehand.
+    for (int s = 2; s <= tile; s <<= 1) {
+        const int half = s / 2;
+        const int n = tile / s;
+
+        // a) Hypotenuse = side of an s-square, apex = centre of the adjacent squares.
+        //    Children are the centres of the (s/2)-squares on either side.
+        core::JobSystem::instance().parallelFor(0, n + 1, 0, [&](int rowBegin, int rowEnd) {
+            for (int j = rowBegin; j < rowEnd; ++j) {
+                for (int i = 0; i < n; ++i) {
+                    for (int axis = 0; axis < 2; ++axis) {
+                        // axis 0: horizontal edge (i, j); axis 1: vertical edge (j, i)
+                        const int ax = axis == 0 ? i * s : j * s;
+                        const int az = axis == 0 ? j * s : i * s;
+                        const int bx = axis == 0 ? ax + s : ax;
+                        const int bz = axis == 0 ? az : az + s;
+                        const int mx = (ax + bx) / 2;
+                        const int mz = (az + bz) / 2;
+                        const int px = axis == 0 ? 0 : half; // Towards the apexes
+                        const int pz = axis == 0 ? half : 0;
+
+                        float e = 0.0f;
+                        for (int side = -1; side <= 1; side += 2) {
+                            const int cx = mx + side * px;
+                            const int cz = mz + side * pz;
+                            if (cx < 0 || cz < 0 || cx > tile || cz > tile) continue;
+                            e = std::max(e, triangleError(ax, az, bx, bz, cx, cz));
+                            if (s > 2) {
+                                e = std::max(e, err((cx + ax) / 2, (cz + az) / 2));
+                                e = std::max(e, err((cx + bx) / 2, (cz + bz) / 2));
+                            }
+                        }
+                        err(mx, mz) = e;
+                    }
+                }
+            }
+        });
+
+        // b) Hypotenuse = diagonal of an s-square (checkerboard orientation, so
+        //    every diagonal passes through its parent's centre). Children are the
+        //    four side midpoints from a).
+        core::JobSystem::instance().parallelFor(0, n, 0, [&](int rowBegin, int rowEnd) {
+            for (int j = rowBegin; j < rowEnd; ++j) {
+                for (int i = 0; i < n; ++i) {
+                    const int x0 = i * s, z0 = j * s;
+                    const int mx = x0 + half, mz = z0 + half;
+                    const bool mainDiagonal = ((i + j) & 1) == 0;
+                    const int ax = mainDiagonal ? x0 : x0 + s;
+                    const int bx = mainDiagonal ? x0 + s : x0;
+                    const int az = z0, bz = z0 + s;
+
+                    float e = std::max(triangleError(ax, az, bx, bz, bx, az), triangleError(ax, az, bx, bz, ax, bz));
+                    e = std::max({e, err(mx, z0), err(mx, z0 + s), err(x0, mz), err(x0 + s, mz)});
+                    err(mx, mz) = e;
+                }
+            }
+        });
+    }
+}
+
+std::shared_ptr<const std::vector<uint32_t>> TerrainRtin::triangulate(float maxError) const {
+    auto result = std::make_shared<std::vector<uint32_t>>();
+    if (gridSize_ == 0) return result;
+
+    const int size = gridSize_;
+    const int tile = size - 1;
+    const uint32_t w = static_cast<uint32_t>(width_);
+    const float threshold = std::min(std::max(maxError, 0.0f), FLT_MAX * 0.5f);
+
+    auto shouldSplit = [&](const Tri& t) {
+        if (std::abs(t.ax - t.cx) + std::abs(t.az - t.cz) <= 1) return false;
+        const int mx = (t.ax + t.bx) / 2, mz = (t.az + t.bz) / 2;
+        return errors_[static_cast<size_t>(mz) * static_cast<size_t>(size) + static_cast<size_t>(mx)] > threshold;
+    };
+    auto children = [](const Tri& t, Tri& left, Tri& right) {
+        const int mx = (t.ax + t.bx) / 2, mz = (t.az + t.bz) / 2;
+        left = {t.cx, t.cz, t.ax, t.az, mx, mz};
+        right = {t.bx, t.bz, t.cx, t.cz, mx, mz};
+    };
+    auto emit = [&](const Tri& t, std::vector<uint32_t>& out) {
+        if (t.ax >= width_ || t.bx >= width_ || t.cx >= width_ ||
+            t.az >= height_ || t.bz >= height_ || t.cz >= height_) {
+            return; // Outside the map (anything crossing the edge was refined)
+        }
+        uint32_t a = static_cast<uint32_t>(t.az) * w + static_cast<uint32_t>(t.ax);
+        uint32_t b = static_cast<uint32_t>(t.bz) * w + static_cast<uint32_t>(t.bx);
+        uint32_t c = static_cast<uint32_t>(t.cz) * w + static_cast<uint32_t>(t.cx);
+        // Match gridIndices() winding (topLeft, bottomLeft, topRight)
+        if ((t.bx - t.ax) * (t.cz - t.az) - (t.bz - t.az) * (t.cx - t.ax) > 0) std::swap(b, c);
+        out.push_back(a);
+        out.push_back(b);
+        out.push_back(c);
+    };
+
+    // 1. Descend the top of the tree serially to collect subtrees (spatial tiles)
+    std::vector<Tri> tasks;
+    struct Pending { Tri tri; int depth; };
+    std::vector<Pending> stack;
+    stack.push_back({{tile, tile, 0, 0, 0, tile}, 0});
+    stack.push_back({{0, 0, tile, tile, tile, 0}, 0});
+    while (!stack.empty()) {
+        Pending p = stack.back();
+        stack.pop_back();
+        if (p.depth == kTaskDepth || !shouldSplit(p.tri)) {
+            tasks.push_back(p.tri);
+            continue;
+        }
+        Tri left, right;
+        children(p.tri, left, right);
+        stack.push_back({right, p.depth + 1});
+        stack.push_back({left, p.depth + 1});
+    }
+
+    // 2. Refine each subtree independently; concatenate in task order (deterministic)
+    std::vector<std::vector<uint32_t>> parts(tasks.size());
+    core::JobSystem::instance().parallelFor(0, static_cast<int>(tasks.size()), 4, [&](int taskBegin, int taskEnd) {
+        for (int k = taskBegin; k < taskEnd; ++k) {
+            std::vector<uint32_t>& out = parts[static_cast<size_t>(k)];
+            std::vector<Tri> local{tasks[static_cast<size_t>(k)]};
+            while (!local.empty()) {
+                Tri t = local.back();
+                local.pop_back();
+                if (!shouldSplit(t)) {
+                    emit(t, out);
+                    continue;
+                }
+                Tri left, right;
+                children(t, left, right);
+                local.push_back(right);
+                local.push_back(left);
+            }
+        }
+    });
+
+    size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    result->reserve(total);
+    for (const auto& part : parts) result->insert(result->end(), part.begin(), part.end());
+    return result;
+}
+
+} // namespace terrain
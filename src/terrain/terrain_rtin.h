@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace terrain {
+
+class TerrainMap;
+
+// v4.7.0: Error-bounded adaptive triangulation (Right-Triangulated Irregular
+// Network) over the heightmap.
+//
+// The map is embedded in a (2^k + 1)^2 RTIN grid; the per-vertex error map (max
+// deviation of each triangle's plane from the samples it covers) is
+// computed once (parallel per level) and can then be triangulated at any
+// vertical tolerance. Errors are propagated to ancestors, so neighbouring
+// triangles always split consistently and the result is crack-free. Triangles
+// that would cross the far map edges (non 2^k + 1 sizes) are always refined,
+// so every emitted triangle lies inside the map.
+//
+// Output indices address the full-resolution vertex grid (x + z * width), i.e.
+// they can be used directly with TerrainRenderer::MeshData's vertex streams.
+class TerrainRtin {
+public:
+    explicit TerrainRtin(const TerrainMap& map);
+
+    // Triangle list (3 indices per triangle, same winding as the full grid)
+    // such that the linear interpolation error is <= maxError metres at every
+    // sample. Parallel by tiles of the RTIN tree; output order is deterministic.
+    std::shared_ptr<const std::vector<uint32_t>> triangulate(float maxError) const;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int gridSize() const { return gridSize_; }
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    int gridSize_ = 0;           // 2^k + 1
+    std::vector<float> errors_;  // gridSize_^2, propagated vertex errors
+};
+
+} // namespace terrain
@@ -0,0 +1,450 @@
+#include "timeline_recorder.h"
+#include "../math/lz_codec.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace terrain {
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x4C545053u;   // "SPTL"
+constexpr uint32_t kFrameMagic = 0x454D5246u;  // "FRME"
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kRawTile = 0x80000000u;     // Size flag: payload stored shuffled, not compressed
+constexpr uint32_t kKeyFlag = 1u;
+
+#pragma pack(push, 1)
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    int32_t tileSize;
+    int32_t channelCount;
+    int32_t keyframeInterval;
+    uint32_t reserved;
+};
+
+struct FrameHeader {
+    uint32_t magic;
+    uint32_t flags;
+    uint64_t tick;
+    double time;
+    uint64_t payloadBytes; // Size table + tile payloads
+};
+#pragma pack(pop)
+
+// Tiles of one channel, row-major; all channels share the layout
+struct TileGrid {
+    int width, height, size, across, down;
+    TileGrid(int w, int h, int s) : width(w), height(h), size(s), across((w + s - 1) / s), down((h + s - 1) / s) {}
+    int count() const { return across * down; }
+    void rect(int t, int& x0, int& y0, int& tw, int& th) const {
+        x0 = (t % across) * size;
+        y0 = (t / across) * size;
+        tw = std::min(size, width - x0);
+        th = std::min(size, height - y0);
+    }
+};
+
+// Parallel copy for the simulation thread (channels are large and contiguous)
+void copyChannel(const TimelineChannel& src, std::vector<float>& dst) {
+    const size_t size = src.size();
+    dst.resize(size);
+    constexpr size_t kChunk = size_t(1) << 18;
+    // Chunks grow rather than the count overflowing parallelFor's int range
+    const size_t chunk = std::max(kChunk, size / static_cast<size_t>(std::numeric_limits<int>::max()) + 1);
+    const int chunks = static_cast<int>((size + chunk - 1) / chunk);
+    core::JobSystem::instance().parallelFor(0, chunks, 1, [&](int chunkBegin, int chunkEnd) {
+        for (int c = chunkBegin; c < chunkEnd; ++c) {
+            const size_t begin = static_cast<size_t>(c) * chunk;
+            const size_t end = std::min(size, begin + chunk);
+            if (src.source) std::memcpy(dst.data() + begin, src.source->data() + begin, (end - begin) * sizeof(float));
+            else src.packed->load(begin, end - begin, dst.data() + begin);
+        }
+    });
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+// --- TimelineRecorder ---
+
+TimelineRecorder::~TimelineRecorder() {
+    stop();
+}
+
+bool TimelineRecorder::start(const std::string& path, int width, int height, const std::vector<TimelineChannel>& channels,
+                             const TimelineOptions& options, std::string* error) {
+    stop();
+    const size_t cells = static_cast<size_t>(width) * static_cast<size_t>(height);
+    for (const TimelineChannel& c : channels) {
+        if (c.size() != cells) {
+            if (error) *error = "channel '" + c.name + "' does not match the grid";
+            return false;
+        }
+    }
+    if (channels.empty() || options.tileSize < 8 || options.keyframeInterval < 1 || options.maxPendingFrames < 1) {
+        if (error) *error = "invalid recorder options";
+        return false;
+    }
+
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        if (error) *error = "cannot create " + path;
+        return false;
+    }
+    FileHeader header{kFileMagic, kVersion, width, height, options.tileSize, static_cast<int32_t>(channels.size()),
+                      options.keyframeInterval, 0};
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const TimelineChannel& c : channels) {
+        const uint32_t len = static_cast<uint32_t>(c.name.size());
+        file_.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        file_.write(c.name.data(), len);
+    }
+
+    path_ = path;
+    width_ = width;
+    height_ = height;
+    channels_ = channels;
+    options_ = options;
+    previous_.reset();
+    frameNumber_ = 0;
+    queue_.clear();
+    pool_.clear();
+    // Every buffer is allocated and touched here, so capture() is a plain copy
+    for (int i = 0; i <= options.maxPendingFrames; ++i) {
+        auto frame = std::make_unique<Frame>();
+        frame->channels.assign(channels.size(), std::vector<float>(cells, 0.0f));
+        pool_.push_back(std::move(frame));
+    }
+    stopping_ = false;
+    failed_ = !file_;
+    stats_ = TimelineStats{};
+    stats_.bytes = static_cast<uint64_t>(file_.tellp());
+    running_ = true;
+    worker_ = std::thread([this]() { encoderLoop(); });
+    std::cout << "[Timeline] Recording " << channels.size() << " channels (" << width << "x" << height << ") to " << path << std::endl;
+    return true;
+}
+
+bool TimelineRecorder::capture(uint64_t tick, double time) {
+    if (!running_) return false;
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::unique_ptr<Frame> frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.captured;
+        if (pool_.empty()) {
+            ++stats_.dropped;
+            return false;
+        }
+        frame = std::move(pool_.back());
+        pool_.pop_back();
+    }
+
+    const size_t cells = static_cast<size_t>(width_) * static_cast<size_t>(height_);
+    frame->tick = tick;
+    frame->time = time;
+    frame->channels.resize(channels_.size());
+    bool valid = true;
+    for (size_t c = 0; c < channels_.size(); ++c) {
+        valid = valid && channels_[c].size() == cells;
+        if (valid) copyChannel(channels_[c], frame->channels[c]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!valid) {
+            // Grid resized under the recorder (regeneration): nothing sensible to record
+            ++stats_.dropped;
+            pool_.push_back(std::move(frame));
+            return false;
+        }
+        queue_.push_back(std::move(frame));
+        stats_.captureMs += elapsedMs(t0);
+    }
+    wake_.notify_one();
+    return true;
+}
+
+bool TimelineRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return !failed_;
+        running_ = false;
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (worker_.joinable()) worker_.join();
+    file_.close();
+
+    // Buffers are only useful while recording
+    previous_.reset();
+    pool_.clear();
+    tileOut_.clear();
+    std::cout << "[Timeline] Stopped: " << stats_.written << " frames (" << stats_.keyframes << " keyframes, "
+              << stats_.dropped << " dropped), " << static_cast<double>(stats_.bytes) / (1024.0 * 1024.0) << " MB" << std::endl;
+    return !failed_;
+}
+
+TimelineStats TimelineRecorder::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void TimelineRecorder::encoderLoop() {
+    for (;;) {
+        std::unique_ptr<Frame> frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return; // Stopping and drained
+            frame = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        encode(*frame);
+
+        // The encoded frame becomes the reference for the next delta
+        std::swap(previous_, frame);
+        if (frame) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pool_.push_back(std::move(frame));
+        }
+    }
+}
+
+void TimelineRecorder::encode(Frame& frame) {
+    auto t0 = std::chrono::steady_clock::now();
+    const TileGrid grid(width_, height_, options_.tileSize);
+    const int tiles = grid.count();
+    const int channelCount = static_cast<int>(channels_.size());
+    const bool key = !previous_ || frameNumber_ % static_cast<uint64_t>(options_.keyframeInterval) == 0;
+    const int jobs = tiles * channelCount;
+    tileOut_.resize(static_cast<size_t>(jobs));
+    std::vector<uint32_t> sizes(static_cast<size_t>(jobs), 0u);
+
+    // Half the cores at most: this runs next to the simulation
+    core::JobSystem& pool = core::JobSystem::instance();
+    core::JobSystem::ThreadLimit limit(std::max(1, pool.threadCount() / 2));
+    pool.parallelFor(0, jobs, 4, [&](int jobBegin, int jobEnd) {
+        std::vector<uint32_t> values;
+        std::vector<uint8_t> shuffled;
+        for (int j = jobBegin; j < jobEnd; ++j) {
+            const int c = j / tiles;
+            int x0, y0, tw, th;
+            grid.rect(j % tiles, x0, y0, tw, th);
+            const size_t n = static_cast<size_t>(tw) * static_cast<size_t>(th);
+            values.resize(n);
+            const float* cur = frame.channels[static_cast<size_t>(c)].data();
+            const float* prev = key ? nullptr : previous_->channels[static_cast<size_t>(c)].data();
+
+            uint32_t changed = 0;
+            for (int y = 0; y < th; ++y) {
+                const size_t row = static_cast<size_t>(y0 + y) * static_cast<size_t>(width_) + static_cast<size_t>(x0);
+                uint32_t* dst = values.data() + static_cast<size_t>(y) * static_cast<size_t>(tw);
+                std::memcpy(dst, cur + row, static_cast<size_t>(tw) * sizeof(float));
+                if (prev) {
+                    for (int x = 0; x < tw; ++x) {
+                        uint32_t p;
+                        std::memcpy(&p, prev + row + static_cast<size_t>(x), sizeof(p));
+                        dst[x] ^= p;
+                        changed |= dst[x];
+                    }
+                }
+            }
+            std::vector<uint8_t>& out = tileOut_[static_cast<size_t>(j)];
+            if (prev && changed == 0) {
+                out.clear(); // Unchanged since the previous frame
+                continue;
+            }
+
+            const size_t bytes = n * sizeof(uint32_t);
+            shuffled.resize(bytes);
+            math::byteShuffle(reinterpret_cast<const uint8_t*>(values.data()), n, sizeof(uint32_t), shuffled.data());
+            out.resize(bytes);
+            const size_t packed = math::lzCompress(shuffled.data(), bytes, out.data(), bytes);
+            if (packed == 0) {
+                std::memcpy(out.data(), shuffled.data(), bytes);
+                sizes[static_cast<size_t>(j)] = static_cast<uint32_t>(bytes) | kRawTile;
+            } else {
+                out.resize(packed);
+                sizes[static_cast<size_t>(j)] = static_cast<uint32_t>(packed);
+            }
+        }
+    });
+
+    FrameHeader header{kFrameMagic, key ? kKeyFlag : 0u, frame.tick, frame.time, 0};
+    header.payloadBytes = sizes.size() * sizeof(uint32_t);
+    for (const auto& out : tileOut_) header.payloadBytes += out.size();
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file_.write(reinterpret_cast<const char*>(sizes.data()), static_cast<std::streamsize>(sizes.size() * sizeof(uint32_t)));
+    for (const auto& out : tileOut_) file_.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+    file_.flush();
+    ++frameNumber_;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) failed_ = true;
+    ++stats_.written;
+    stats_.keyframes += key ? 1 : 0;
+    stats_.bytes += sizeof(header) + header.payloadBytes;
+    stats_.encodeMs += elapsedMs(t0);
+}
+
+// --- TimelineReader ---
+
+bool TimelineReader::open(const std::string& path, std::string* error) {
+    frames_.clear();
+    names_.clear();
+    state_.clear();
+    stateFrame_ = -1;
+    if (!file_.open(path) || file_.size() < sizeof(FileHeader)) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    FileHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (header.magic != kFileMagic || header.version != kVersion || header.width < 1 || header.height < 1 ||
+        header.tileSize < 1 || header.channelCount < 1) {
+        if (error) *error = "not a timeline recording";
+        return false;
+    }
+    width_ = header.width;
+    height_ = header.height;
+    tileSize_ = header.tileSize;
+
+    size_t offset = sizeof(header);
+    for (int c = 0; c < header.channelCount; ++c) {
+        uint32_t len = 0;
+        if (offset + sizeof(len) > file_.size()) return false;
+        std::memcpy(&len, file_.data() + offset, sizeof(len));
+        offset += sizeof(len);
+        if (offset + len > file_.size()) return false;
+        names_.emplace_back(reinterpret_cast<const char*>(file_.data() + offset), len);
+        offset += len;
+    }
+
+    // Index the records; stop at the first incomplete one
+    const size_t tableBytes = static_cast<size_t>(TileGrid(width_, height_, tileSize_).count()) * names_.size() * sizeof(uint32_t);
+    while (offset + sizeof(FrameHeader) <= file_.size()) {
+        FrameHeader fh;
+        std::memcpy(&fh, file_.data() + offset, sizeof(fh));
+        if (fh.magic != kFrameMagic || fh.payloadBytes < tableBytes || fh.payloadBytes > file_.size() - offset - sizeof(fh)) break;
+        // The first frame must be a keyframe (deltas need a base)
+        if (frames_.empty() && !(fh.flags & kKeyFlag)) break;
+        frames_.push_back({fh.tick, fh.time, offset, (fh.flags & kKeyFlag) != 0});
+        offset += sizeof(fh) + fh.payloadBytes;
+    }
+    if (frames_.empty()) {
+        if (error) *error = "recording has no complete frame";
+        return false;
+    }
+    return true;
+}
+
+int TimelineReader::channelIndex(const std::string& name) const {
+    auto it = std::find(names_.begin(), names_.end(), name);
+    return it == names_.end() ? -1 : static_cast<int>(it - names_.begin());
+}
+
+size_t TimelineReader::frameAtTick(uint64_t tick) const {
+    auto it = std::upper_bound(frames_.begin(), frames_.end(), tick,
+                               [](uint64_t t, const FrameInfo& f) { return t < f.tick; });
+    return it == frames_.begin() ? 0 : static_cast<size_t>(it - frames_.begin()) - 1;
+}
+
+const std::vector<std::vector<float>>* TimelineReader::read(size_t frame) {
+    if (frame >= frames_.size()) return nullptr;
+    size_t key = frame;
+    while (!frames_[key].key) --key; // Frame 0 is always a keyframe
+
+    // Continue from the current state when it lies between the keyframe and the target
+    size_t first = key;
+    if (stateFrame_ >= static_cast<long long>(key) && stateFrame_ <= static_cast<long long>(frame)) {
+        first = static_cast<size_t>(stateFrame_) + 1;
+    }
+    for (size_t f = first; f <= frame; ++f) {
+        if (!applyFrame(f)) {
+            stateFrame_ = -1;
+            return nullptr;
+        }
+        stateFrame_ = static_cast<long long>(f);
+    }
+    return &state_;
+}
+
+bool TimelineReader::applyFrame(size_t frame) {
+    const FrameInfo& info = frames_[frame];
+    const TileGrid grid(width_, height_, tileSize_);
+    const int tiles = grid.count();
+    const int jobs = tiles * channelCount();
+    const size_t cells = static_cast<size_t>(width_) * static_cast<size_t>(height_);
+    state_.resize(names_.size());
+    for (auto& channel : state_) channel.resize(cells);
+
+    const uint8_t* base = file_.data() + info.offset + sizeof(FrameHeader);
+    std::vector<uint32_t> sizes(static_cast<size_t>(jobs));
+    std::memcpy(sizes.data(), base, sizes.size() * sizeof(uint32_t));
+    std::vector<size_t> offsets(static_cast<size_t>(jobs) + 1, sizes.size() * sizeof(uint32_t));
+    for (size_t j = 0; j < sizes.size(); ++j) offsets[j + 1] = offsets[j] + (sizes[j] & ~kRawTile);
+    FrameHeader fh;
+    std::memcpy(&fh, file_.data() + info.offset, sizeof(fh));
+    if (offsets.back() != fh.payloadBytes) return false;
+
+    std::atomic<bool> ok{true};
+    core::JobSystem::instance().parallelFor(0, jobs, 4, [&](int jobBegin, int jobEnd) {
+        std::vector<uint8_t> shuffled;
+        std::vector<uint32_t> values;
+        for (int j = jobBegin; j < jobEnd; ++j) {
+            const uint32_t size = sizes[static_cast<size_t>(j)];
+            if (size == 0) {
+                if (info.key) ok = false; // Keyframes store every tile
+                continue;
+            }
+            int x0, y0, tw, th;
+            grid.rect(j % tiles, x0, y0, tw, th);
+            const size_t n = static_cast<size_t>(tw) * static_cast<size_t>(th);
+            const size_t bytes = n * sizeof(uint32_t);
+            const uint8_t* payload = base + offsets[static_cast<size_t>(j)];
+            shuffled.resize(bytes);
+            if (size & kRawTile) {
+                if ((size & ~kRawTile) != bytes) {
+                    ok = false;
+                    continue;
+                }
+                std::memcpy(shuffled.data(), payload, bytes);
+            } else if (!math::lzDecompress(payload, size, shuffled.data(), bytes)) {
+                ok = false;
+                continue;
+            }
+            values.resize(n);
+            math::byteUnshuffle(shuffled.data(), n, sizeof(uint32_t), reinterpret_cast<uint8_t*>(values.data()));
+
+            float* dst = state_[static_cast<size_t>(j / tiles)].data();
+            for (int y = 0; y < th; ++y) {
+                float* row = dst + static_cast<size_t>(y0 + y) * static_cast<size_t>(width_) + static_cast<size_t>(x0);
+                uint32_t* src = values.data() + static_cast<size_t>(y) * static_cast<size_t>(tw);
+                if (!info.key) {
+                    for (int x = 0; x < tw; ++x) {
+                        uint32_t v;
+                        std::memcpy(&v, row + x, sizeof(v));
+                        src[x] ^= v;
+                    }
+                }
+                std::memcpy(row, src, static_cast<size_t>(tw) * sizeof(float));
+            }
+        }
+    });
+    return ok;
+}
+
+} // namespace terrain
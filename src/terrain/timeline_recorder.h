@@ -0,0 +1,156 @@
+#pragma once
+
+#include "world_snapshot.h"
+#include "../core/grid_arena.h"
+#include "../core/packed_channel.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace terrain {
+
+// v4.7.0: One recorded grid (width * height floats owned by the simulation);
+// either a float grid or a packed one (recorded as floats)
+struct TimelineChannel {
+    std::string name;
+    const core::GridVector<float>* source = nullptr;
+    const core::PackedChannel* packed = nullptr;
+
+    size_t size() const { return source ? source->size() : (packed ? packed->size() : 0); }
+};
+
+struct TimelineOptions {
+    int keyframeInterval = 50; // Frames between keyframes (5 s at 10 Hz)
+    int tileSize = 64;
+    int maxPendingFrames = 3;  // Frame buffers in flight; captures beyond this are dropped
+};
+
+struct TimelineStats {
+    uint64_t captured = 0;
+    uint64_t dropped = 0;      // Encoder behind and no free buffer
+    uint64_t written = 0;
+    uint64_t keyframes = 0;
+    uint64_t bytes = 0;        // File size so far
+    double captureMs = 0.0;    // Total time spent in capture() (simulation thread)
+    double encodeMs = 0.0;     // Total time spent encoding (background thread)
+};
+
+/**
+ * @brief v4.7.0: Records chosen simulation channels over time.
+ *
+ * capture() only copies the channels into a pooled frame buffer and hands it to
+ * a background thread; when every buffer is still queued the frame is dropped
+ * instead of blocking the simulation, so memory stays at (maxPendingFrames + 1)
+ * frames. The encoder splits each channel into tiles. Keyframe tiles store the
+ * values, other frames store them XORed with the previous recorded frame
+ * (unchanged tiles cost 4 bytes). Payloads are byte-shuffled and LZ-compressed.
+ *
+ * File: header and channel names, then self-delimiting frame records (tick,
+ * time, key flag, tile sizes, tile payloads) appended as they are encoded. The
+ * reader indexes the record headers, so a recording cut short is readable up
+ * to its last complete frame.
+ */
+class TimelineRecorder {
+public:
+    TimelineRecorder() = default;
+    ~TimelineRecorder();
+    TimelineRecorder(const TimelineRecorder&) = delete;
+    TimelineRecorder& operator=(const TimelineRecorder&) = delete;
+
+    bool start(const std::string& path, int width, int height, const std::vector<TimelineChannel>& channels,
+               const TimelineOptions& options = {}, std::string* error = nullptr);
+
+    // Simulation thread; false if the frame was dropped
+    bool capture(uint64_t tick, double time);
+
+    // Encodes what is queued and closes the file
+    bool stop();
+
+    bool isRecording() const { return running_; }
+    const std::string& path() const { return path_; }
+    TimelineStats stats() const;
+
+private:
+    struct Frame {
+        uint64_t tick = 0;
+        double time = 0.0;
+        std::vector<std::vector<float>> channels;
+    };
+
+    void encoderLoop();
+    void encode(Frame& frame);
+
+    std::string path_;
+    int width_ = 0;
+    int height_ = 0;
+    TimelineOptions options_;
+    std::vector<TimelineChannel> channels_;
+
+    // Encoder thread only
+    std::ofstream file_;
+    std::unique_ptr<Frame> previous_;
+    uint64_t frameNumber_ = 0;
+    std::vector<std::vector<uint8_t>> tileOut_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::unique_ptr<Frame>> queue_;
+    std::vector<std::unique_ptr<Frame>> pool_;
+    bool stopping_ = false;
+    bool failed_ = false;
+    std::atomic<bool> running_{false};
+    TimelineStats stats_;
+    std::thread worker_;
+};
+
+/**
+ * @brief v4.7.0: Random access to a recording: any frame is rebuilt from the
+ * keyframe at or before it plus the deltas up to it. Moving forward from the
+ * last frame read only applies the deltas in between (timeline scrubbing).
+ */
+class TimelineReader {
+public:
+    bool open(const std::string& path, std::string* error = nullptr);
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int channelCount() const { return static_cast<int>(names_.size()); }
+    const std::string& channelName(int c) const { return names_[static_cast<size_t>(c)]; }
+    int channelIndex(const std::string& name) const; // -1 if not recorded
+
+    size_t frameCount() const { return frames_.size(); }
+    uint64_t tickOf(size_t frame) const { return frames_[frame].tick; }
+    double timeOf(size_t frame) const { return frames_[frame].time; }
+    bool isKeyframe(size_t frame) const { return frames_[frame].key; }
+    size_t frameAtTick(uint64_t tick) const; // Last frame recorded at or before tick
+
+    // All channels at `frame`; valid until the next read
+    const std::vector<std::vector<float>>* read(size_t frame);
+
+private:
+    struct FrameInfo {
+        uint64_t tick;
+        double time;
+        uint64_t offset;
+        bool key;
+    };
+    bool applyFrame(size_t frame);
+
+    MappedFile file_;
+    int width_ = 0;
+    int height_ = 0;
+    int tileSize_ = 0;
+    std::vector<std::string> names_;
+    std::vector<FrameInfo> frames_;
+    std::vector<std::vector<float>> state_;
+    long long stateFrame_ = -1;
+};
+
+} // namespace terrain
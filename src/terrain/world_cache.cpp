@@ -0,0 +1,90 @@
+#include "world_cache.h"
+#include "world_snapshot.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace terrain {
+
+WorldCache::WorldCache(std::string directory, size_t maxEntries)
+    : directory_(std::move(directory)), maxEntries_(std::max<size_t>(1, maxEntries)) {}
+
+std::string WorldCache::pathFor(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.world", static_cast<unsigned long long>(key));
+    return (fs::path(directory_) / name).string();
+}
+
+bool WorldCache::contains(uint64_t key) const {
+    std::error_code ec;
+    return fs::is_regular_file(pathFor(key), ec);
+}
+
+bool WorldCache::load(uint64_t key, TerrainMap& map, RegenerationControl* control) const {
+    const std::string path = pathFor(key);
+    if (!contains(key)) return false;
+
+    auto t0 = std::chrono::steady_clock::now();
+    SnapshotReader reader;
+    if (!reader.open(path) || reader.info().key != key || !WorldSnapshot::load(reader, map, control)) {
+        std::cerr << "[WorldCache] Ignoring unusable entry " << path << std::endl;
+        return false;
+    }
+    // Recency for eviction
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[WorldCache] Warm start from " << path << " (" << ms << " ms)" << std::endl;
+    return true;
+}
+
+bool WorldCache::store(uint64_t key, const TerrainMap& map) const {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    if (ec) {
+        std::cerr << "[WorldCache] Cannot create " << directory_ << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    const std::string path = pathFor(key);
+    SnapshotInfo info;
+    info.key = key;
+    if (!WorldSnapshot::save(path, map, info)) return false;
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[WorldCache] Stored " << path << " (" << ms << " ms)" << std::endl;
+    evict();
+    return true;
+}
+
+void WorldCache::evict() const {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type time;
+    };
+    std::vector<Entry> entries;
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(directory_, ec)) {
+        if (item.path().extension() != ".world") continue;
+        std::error_code timeEc;
+        auto time = item.last_write_time(timeEc);
+        if (!timeEc) entries.push_back({item.path(), time});
+    }
+    if (entries.size() <= maxEntries_) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time > b.time; });
+    for (size_t i = maxEntries_; i < entries.size(); ++i) {
+        fs::remove(entries[i].path, ec);
+        std::cout << "[WorldCache] Evicted " << entries[i].path.string() << std::endl;
+    }
+}
+
+} // namespace terrain
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace terrain {
+
+class TerrainMap;
+class RegenerationControl;
+
+/**
+ * @brief v4.7.0: Content-addressed on-disk cache of generated worlds.
+ *
+ * One WorldSnapshot file per key (`<directory>/<key as hex>.world`); the key
+ * is a hash of everything generation reads (see TerrainPipeline::worldKey),
+ * so a hit is a bit-exact replacement for running the generators. Least
+ * recently used entries beyond maxEntries are deleted on store. All failures
+ * are logged and reported as a miss: the cache is never required.
+ */
+class WorldCache {
+public:
+    explicit WorldCache(std::string directory, size_t maxEntries = 4);
+
+    const std::string& directory() const { return directory_; }
+    std::string pathFor(uint64_t key) const;
+
+    bool contains(uint64_t key) const;
+    bool load(uint64_t key, TerrainMap& map, RegenerationControl* control = nullptr) const;
+    bool store(uint64_t key, const TerrainMap& map) const;
+
+private:
+    void evict() const;
+
+    std::string directory_;
+    size_t maxEntries_;
+};
+
+} // namespace terrain
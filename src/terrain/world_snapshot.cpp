@@ -0,0 +1,535 @@
+#include "world_snapshot.h"
+#include "regeneration_graph.h"
+#include "terrain_map.h"
+#include "../math/lz_codec.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace terrain {
+
+// --- MappedFile ---
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = static_cast<const unsigned char*>(view);
+    size_ = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file referenced
+    if (view == MAP_FAILED) return false;
+    data_ = static_cast<const unsigned char*>(view);
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+    if (!data_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+    CloseHandle(file_);
+    mapping_ = nullptr;
+    file_ = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+// --- OutputFile ---
+
+OutputFile::~OutputFile() {
+    close();
+}
+
+bool OutputFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    handle_ = handle;
+    return true;
+#else
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    return fd_ >= 0;
+#endif
+}
+
+bool OutputFile::writeAt(uint64_t offset, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const size_t chunk = std::min<size_t>(size, size_t(1) << 30);
+#ifdef _WIN32
+        OVERLAPPED ov{};
+        ov.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFu);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD written = 0;
+        if (!WriteFile(static_cast<HANDLE>(handle_), p, static_cast<DWORD>(chunk), &written, &ov) || written == 0) return false;
+#else
+        const ssize_t written = ::pwrite(fd_, p, chunk, static_cast<off_t>(offset));
+        if (written <= 0) return false;
+#endif
+        p += written;
+        offset += static_cast<uint64_t>(written);
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool OutputFile::resize(uint64_t size) {
+#ifdef _WIN32
+    LARGE_INTEGER li;
+    li.QuadPart = static_cast<LONGLONG>(size);
+    return SetFilePointerEx(static_cast<HANDLE>(handle_), li, nullptr, FILE_BEGIN) && SetEndOfFile(static_cast<HANDLE>(handle_));
+#else
+    return ::ftruncate(fd_, static_cast<off_t>(size)) == 0;
+#endif
+}
+
+bool OutputFile::close() {
+#ifdef _WIN32
+    if (!handle_) return true;
+    bool ok = CloseHandle(static_cast<HANDLE>(handle_)) != 0;
+    handle_ = nullptr;
+#else
+    if (fd_ < 0) return true;
+    bool ok = ::close(fd_) == 0;
+    fd_ = -1;
+#endif
+    return ok;
+}
+
+// --- WorldSnapshot ---
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'A', 'P', 'W', 'O', 'R', 'L', 'D'};
+constexpr uint32_t kByteOrderMark = 0x01020304u;
+constexpr uint32_t kCodecRaw = 0;
+constexpr uint32_t kCodecShuffleLZ = 1;
+constexpr size_t kMinCompressBytes = 4096;
+constexpr const char* kTaxaEntry = "soil.taxa";
+
+using Header = SnapshotReader::Header;
+using Entry = SnapshotReader::Entry;
+static_assert(sizeof(Header) == 64 && sizeof(Entry) == 80, "WorldSnapshot: unexpected padding");
+
+uint64_t alignUp(uint64_t v) {
+    return (v + WorldSnapshot::kAlignment - 1) / WorldSnapshot::kAlignment * WorldSnapshot::kAlignment;
+}
+
+// One grid of the map, untyped (all channels are width * height elements)
+template <typename Ptr>
+struct ChannelRef {
+    const char* name;
+    SnapshotDType dtype;
+    size_t elemSize;
+    size_t count;
+    Ptr data;
+    bool packed;
+};
+
+SnapshotDType dtypeOf(core::ChannelPrecision precision) {
+    switch (precision) {
+        case core::ChannelPrecision::Float16: return SnapshotDType::F16;
+        case core::ChannelPrecision::Unorm16: return SnapshotDType::UNORM16;
+        default: return SnapshotDType::F32;
+    }
+}
+
+bool precisionOf(uint32_t dtype, core::ChannelPrecision& precision) {
+    switch (static_cast<SnapshotDType>(dtype)) {
+        case SnapshotDType::F32: precision = core::ChannelPrecision::Float32; return true;
+        case SnapshotDType::F16: precision = core::ChannelPrecision::Float16; return true;
+        case SnapshotDType::UNORM16: precision = core::ChannelPrecision::Unorm16; return true;
+        default: return false;
+    }
+}
+
+template <typename Ptr, typename T>
+ChannelRef<Ptr> channelRef(const char* name, T& values) {
+    using V = typename std::remove_const<T>::type::value_type;
+    return {name, snapshotDTypeOf<V>(), sizeof(V), values.size(), values.data(), false};
+}
+
+template <typename Ptr>
+ChannelRef<Ptr> channelRef(const char* name, core::PackedChannel& values) {
+    return {name, dtypeOf(values.precision()), values.elementSize(), values.size(), values.data(), true};
+}
+
+template <typename Ptr>
+ChannelRef<Ptr> channelRef(const char* name, const core::PackedChannel& values) {
+    return {name, dtypeOf(values.precision()), values.elementSize(), values.size(), values.data(), true};
+}
+
+// Every persistent grid of the map, by name. MapT is TerrainMap or const TerrainMap.
+// v4.7.0: Lazy channels only once allocated, "soil" only while not a view of soil.soil_type
+template <typename MapT, typename Fn>
+void forEachChannel(MapT& map, Fn&& fn) {
+    fn("height", map.heightMap());
+    if (map.hasChannel("moisture")) fn("moisture", map.moistureMap());
+    if (map.hasChannel("sediment")) fn("sediment", map.sedimentMap());
+    fn("flux", map.fluxMap());
+    if (map.hasChannel("biome")) fn("biome", map.biomeMap());
+    fn("flow_dir", map.flowDirMap());
+    if (map.hasChannel("watershed")) fn("watershed", map.watershedMap());
+    if (!map.soilShared()) fn("soil", map.soilMap());
+
+    if (auto* s = map.getLandscapeSoil()) {
+        fn("soil.depth", s->depth);
+        fn("soil.infiltration", s->infiltration);
+        fn("soil.compaction", s->compaction);
+        fn("soil.organic_matter", s->organic_matter);
+        fn("soil.propagule_bank", s->propagule_bank);
+        fn("soil.soil_type", s->soil_type);
+        fn("soil.taxon", s->taxon);
+        fn("soil.lithology_id", s->lithology_id);
+        fn("soil.sand_fraction", s->sand_fraction);
+        fn("soil.clay_fraction", s->clay_fraction);
+        fn("soil.labile_carbon", s->labile_carbon);
+        fn("soil.recalcitrant_carbon", s->recalcitrant_carbon);
+        fn("soil.dead_biomass", s->dead_biomass);
+        fn("soil.water_content_soil", s->water_content_soil);
+        fn("soil.field_capacity", s->field_capacity);
+        fn("soil.conductivity", s->conductivity);
+    }
+    if (auto* h = map.getLandscapeHydro()) {
+        fn("hydro.water_depth", h->water_depth);
+        fn("hydro.flow_flux", h->flow_flux);
+        fn("hydro.erosion_risk", h->erosion_risk);
+        fn("hydro.receiver_index", h->receiver_index);
+        fn("hydro.sort_order", h->sort_order);
+        fn("hydro.slope", h->slope);
+    }
+    if (auto* v = map.getVegetation()) {
+        fn("veg.ei_coverage", v->ei_coverage);
+        fn("veg.ei_vigor", v->ei_vigor);
+        fn("veg.ei_capacity", v->ei_capacity);
+        fn("veg.es_coverage", v->es_coverage);
+        fn("veg.es_vigor", v->es_vigor);
+        fn("veg.es_capacity", v->es_capacity);
+        fn("veg.recovery_timer", v->recovery_timer);
+    }
+}
+
+template <typename MapT, typename Ptr>
+std::vector<ChannelRef<Ptr>> channelRefs(MapT& map) {
+    std::vector<ChannelRef<Ptr>> refs;
+    forEachChannel(map, [&](const char* name, auto& values) { refs.push_back(channelRef<Ptr>(name, values)); });
+    return refs;
+}
+
+} // namespace
+
+bool WorldSnapshot::save(const std::string& path, const TerrainMap& map, const SnapshotInfo& info,
+                         const SnapshotOptions& options) {
+    const auto refs = channelRefs<const TerrainMap, const void*>(map);
+    const int channelCount = static_cast<int>(refs.size());
+    // v4.7.0: The taxon dictionary is the last entry
+    const landscape::SoilGrid* soil = map.getLandscapeSoil();
+    std::vector<Entry> table(refs.size() + (soil ? 1 : 0));
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.byteOrder = kByteOrderMark;
+    header.channelCount = static_cast<uint32_t>(table.size());
+    header.soilDomain = map.soilDomain();
+    header.key = info.key;
+    header.width = map.getWidth();
+    header.height = map.getHeight();
+    header.resolution = info.resolution;
+    header.seed = info.seed;
+    header.maxHeight = info.maxHeight;
+    header.waterLevel = info.waterLevel;
+
+    const std::string tmpPath = path + ".tmp";
+    OutputFile out;
+    if (!out.open(tmpPath)) {
+        std::cerr << "[WorldSnapshot] Failed to open " << tmpPath << " for writing." << std::endl;
+        return false;
+    }
+
+    // Raw snapshots have a fixed layout (table order); compressed blocks claim space as they finish
+    const uint64_t dataStart = alignUp(sizeof(Header) + table.size() * sizeof(Entry));
+    std::vector<uint64_t> rawOffsets(refs.size());
+    uint64_t rawEnd = dataStart;
+    for (size_t i = 0; i < refs.size(); ++i) {
+        rawOffsets[i] = rawEnd;
+        rawEnd = alignUp(rawEnd + refs[i].count * refs[i].elemSize);
+    }
+    std::atomic<uint64_t> nextOffset{dataStart};
+    std::atomic<bool> failed{false};
+
+    core::JobSystem::instance().parallelFor(0, channelCount, 1, [&](int channelBegin, int channelEnd) {
+        for (int c = channelBegin; c < channelEnd; ++c) {
+            if (failed.load()) continue;
+            const auto& ref = refs[static_cast<size_t>(c)];
+            Entry& e = table[static_cast<size_t>(c)];
+            std::strncpy(e.name, ref.name, sizeof(e.name) - 1);
+            e.dtype = static_cast<uint32_t>(ref.dtype);
+            e.elemSize = static_cast<uint32_t>(ref.elemSize);
+            e.dims[0] = static_cast<uint32_t>(map.getWidth());
+            e.dims[1] = static_cast<uint32_t>(map.getHeight());
+            e.rawBytes = ref.count * ref.elemSize;
+
+            const uint8_t* block = static_cast<const uint8_t*>(ref.data);
+            size_t stored = static_cast<size_t>(e.rawBytes);
+            e.codec = kCodecRaw;
+            std::vector<uint8_t> packed;
+            if (options.compress && stored >= kMinCompressBytes) {
+                std::vector<uint8_t> shuffled(stored);
+                math::byteShuffle(block, ref.count, ref.elemSize, shuffled.data());
+                packed.resize(math::lzCompressBound(stored));
+                const size_t n = math::lzCompress(shuffled.data(), stored, packed.data(), packed.size());
+                if (n > 0 && n < stored - stored / 8) {
+                    block = packed.data();
+                    stored = n;
+                    e.codec = kCodecShuffleLZ;
+                }
+            }
+            e.storedBytes = stored;
+            e.offset = options.compress ? nextOffset.fetch_add(alignUp(stored)) : rawOffsets[static_cast<size_t>(c)];
+            if (!out.writeAt(e.offset, block, stored)) failed = true;
+        }
+    });
+
+    uint64_t fileEnd = options.compress ? nextOffset.load() : rawEnd;
+    if (soil) {
+        const std::vector<landscape::SoilTaxon>& taxa = soil->taxa.entries();
+        Entry& e = table.back();
+        std::strncpy(e.name, kTaxaEntry, sizeof(e.name) - 1);
+        e.dtype = static_cast<uint32_t>(SnapshotDType::U8);
+        e.elemSize = sizeof(landscape::SoilTaxon);
+        e.dims[0] = static_cast<uint32_t>(taxa.size());
+        e.dims[1] = 1;
+        e.codec = kCodecRaw;
+        e.rawBytes = e.storedBytes = taxa.size() * sizeof(landscape::SoilTaxon);
+        e.offset = fileEnd;
+        fileEnd = alignUp(fileEnd + e.rawBytes);
+        if (!out.writeAt(e.offset, taxa.data(), static_cast<size_t>(e.rawBytes))) failed = true;
+    }
+    bool ok = !failed.load() && out.resize(fileEnd) && out.writeAt(0, &header, sizeof(header)) &&
+              out.writeAt(sizeof(header), table.data(), table.size() * sizeof(Entry));
+    ok = out.close() && ok;
+    if (!ok) {
+        std::cerr << "[WorldSnapshot] Write to " << tmpPath << " failed." << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::cerr << "[WorldSnapshot] Failed to move " << tmpPath << " into place: " << ec.message() << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool WorldSnapshot::load(const std::string& path, TerrainMap& map, SnapshotInfo* info, RegenerationControl* control) {
+    SnapshotReader reader;
+    if (!reader.open(path)) return false;
+    if (info) *info = reader.info();
+    return load(reader, map, control);
+}
+
+bool WorldSnapshot::load(const SnapshotReader& reader, TerrainMap& map, RegenerationControl* control) {
+    const SnapshotInfo& info = reader.info();
+    if (map.getWidth() != info.width || map.getHeight() != info.height) {
+        map.resize(info.width, info.height);
+    }
+
+    // v4.7.0: Lazy channels the file lacks were never written; no "soil" means
+    // it was saved as a view of the SiBCS soil types
+    for (const core::ChannelUsage& u : map.memoryReport()) {
+        if (!map.isLazyChannel(u.name)) continue;
+        if (reader.has(u.name)) map.allocateChannel(u.name);
+        else map.releaseChannel(u.name);
+    }
+    map.setSoilDomain(reader.soilDomain_);
+    map.shareSoilTypes(!reader.has("soil"));
+
+    // Resolve every channel first: a missing one fails before anything is decoded
+    const auto refs = channelRefs<TerrainMap, void*>(map);
+    std::vector<const Entry*> entries(refs.size());
+    for (size_t i = 0; i < refs.size(); ++i) {
+        const Entry* e = reader.find(refs[i].name);
+        bool usable = e && reader.matches(*e, refs[i].dtype, refs[i].elemSize);
+        // v4.7.0: A packed channel saved in another precision is converted
+        core::ChannelPrecision stored = core::ChannelPrecision::Float32;
+        if (!usable && e && refs[i].packed && precisionOf(e->dtype, stored)) {
+            usable = reader.matches(*e, static_cast<SnapshotDType>(e->dtype), core::precisionBytes(stored));
+        }
+        if (!usable) {
+            std::cerr << "[WorldSnapshot] Channel '" << refs[i].name << "' missing or mismatched." << std::endl;
+            return false;
+        }
+        entries[i] = e;
+    }
+
+    // v4.7.0: The dictionary the taxon channel indexes
+    if (landscape::SoilGrid* soil = map.getLandscapeSoil()) {
+        const Entry* e = reader.find(kTaxaEntry);
+        const size_t fileSize = reader.file_.size();
+        const bool usable = e && e->dtype == static_cast<uint32_t>(SnapshotDType::U8) &&
+                            e->elemSize == sizeof(landscape::SoilTaxon) && e->dims[1] == 1 && e->codec == kCodecRaw &&
+                            e->rawBytes == static_cast<uint64_t>(e->dims[0]) * sizeof(landscape::SoilTaxon) &&
+                            e->storedBytes == e->rawBytes && e->offset <= fileSize && e->rawBytes <= fileSize - e->offset;
+        std::vector<landscape::SoilTaxon> taxa(usable ? e->dims[0] : 0);
+        if (usable) std::memcpy(taxa.data(), reader.file_.data() + e->offset, static_cast<size_t>(e->rawBytes));
+        if (!usable || !soil->taxa.assign(taxa)) {
+            std::cerr << "[WorldSnapshot] Taxon dictionary missing or invalid." << std::endl;
+            return false;
+        }
+    }
+
+    std::atomic<bool> ok{true};
+    const int channelCount = static_cast<int>(refs.size());
+    core::JobSystem::instance().parallelFor(0, channelCount, 1, [&](int channelBegin, int channelEnd) {
+        for (int c = channelBegin; c < channelEnd; ++c) {
+            if (!ok.load() || (control && control->isCancelled())) continue;
+            const Entry& e = *entries[static_cast<size_t>(c)];
+            const auto& ref = refs[static_cast<size_t>(c)];
+            if (e.dtype == static_cast<uint32_t>(ref.dtype)) {
+                if (!reader.readInto(e, ref.data)) ok = false;
+                continue;
+            }
+            core::ChannelPrecision from = core::ChannelPrecision::Float32, to = from;
+            precisionOf(e.dtype, from);
+            precisionOf(static_cast<uint32_t>(ref.dtype), to);
+            std::vector<uint8_t> raw(static_cast<size_t>(e.rawBytes));
+            std::vector<float> values(ref.count);
+            if (!reader.readInto(e, raw.data())) {
+                ok = false;
+                continue;
+            }
+            core::PackedChannel::decode(from, raw.data(), ref.count, values.data());
+            core::PackedChannel::encode(to, values.data(), ref.count, ref.data);
+        }
+    });
+    if (control) control->checkpoint();
+    if (const landscape::SoilGrid* soil = map.getLandscapeSoil()) {
+        const auto& ids = soil->taxon;
+        if (!ids.empty() && *std::max_element(ids.begin(), ids.end()) >= soil->taxa.size()) ok = false;
+    }
+    if (!ok.load()) {
+        std::cerr << "[WorldSnapshot] Corrupt channel data." << std::endl;
+        return false;
+    }
+
+    map.markAllDirty();
+    // Loaded grid is a new grid for incremental consumers (texture tiles)
+    if (map.getVegetation()) map.getVegetation()->generation = vegetation::VegetationGrid::nextGeneration();
+    return true;
+}
+
+// --- SnapshotReader ---
+
+bool SnapshotReader::open(const std::string& path) {
+    table_ = nullptr;
+    channelCount_ = 0;
+    if (!file_.open(path)) return false;
+
+    Header header;
+    if (file_.size() < sizeof(header)) return false;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != WorldSnapshot::kFormatVersion ||
+        header.byteOrder != kByteOrderMark || header.width <= 0 || header.height <= 0) {
+        return false;
+    }
+    if (sizeof(header) + static_cast<size_t>(header.channelCount) * sizeof(Entry) > file_.size()) return false;
+
+    info_.key = header.key;
+    info_.width = header.width;
+    info_.height = header.height;
+    info_.resolution = header.resolution;
+    info_.seed = header.seed;
+    info_.maxHeight = header.maxHeight;
+    info_.waterLevel = header.waterLevel;
+    soilDomain_ = header.soilDomain;
+    // The mapping is page aligned and the table follows the 64-byte header
+    table_ = reinterpret_cast<const Entry*>(file_.data() + sizeof(header));
+    channelCount_ = header.channelCount;
+    return true;
+}
+
+const SnapshotReader::Entry* SnapshotReader::find(const std::string& name) const {
+    for (uint32_t c = 0; c < channelCount_; ++c) {
+        if (std::strncmp(table_[c].name, name.c_str(), sizeof(table_[c].name)) == 0) return &table_[c];
+    }
+    return nullptr;
+}
+
+bool SnapshotReader::matches(const Entry& e, SnapshotDType dtype, size_t elemSize) const {
+    const uint64_t count = static_cast<uint64_t>(e.dims[0]) * e.dims[1];
+    return e.dtype == static_cast<uint32_t>(dtype) && e.elemSize == elemSize &&
+           e.dims[0] == static_cast<uint32_t>(info_.width) && e.dims[1] == static_cast<uint32_t>(info_.height) &&
+           e.rawBytes == count * elemSize && e.offset % WorldSnapshot::kAlignment == 0 &&
+           e.offset <= file_.size() && e.storedBytes <= file_.size() - e.offset &&
+           (e.codec == kCodecShuffleLZ || (e.codec == kCodecRaw && e.storedBytes == e.rawBytes));
+}
+
+bool SnapshotReader::readInto(const Entry& e, void* dst) const {
+    const uint8_t* src = file_.data() + e.offset;
+    if (e.codec == kCodecRaw) {
+        std::memcpy(dst, src, static_cast<size_t>(e.rawBytes));
+        return true;
+    }
+    std::vector<uint8_t> shuffled(static_cast<size_t>(e.rawBytes));
+    if (!math::lzDecompress(src, static_cast<size_t>(e.storedBytes), shuffled.data(), shuffled.size())) return false;
+    const size_t count = static_cast<size_t>(e.rawBytes / e.elemSize);
+    math::byteUnshuffle(shuffled.data(), count, e.elemSize, static_cast<uint8_t*>(dst));
+    return true;
+}
+
+} // namespace terrain
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace terrain {
+
+class TerrainMap;
+class RegenerationControl;
+
+/**
+ * @brief v4.7.0: Read-only memory mapping of a whole file (POSIX mmap / Win32 view).
+ * Pages are faulted in on first access, so opening is O(1) regardless of size.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+/**
+ * @brief v4.7.0: Positional writes (pwrite / overlapped WriteFile) into one file.
+ * Safe to call writeAt from several threads on disjoint ranges.
+ */
+class OutputFile {
+public:
+    OutputFile() = default;
+    ~OutputFile();
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    bool open(const std::string& path); // Creates or truncates
+    bool writeAt(uint64_t offset, const void* data, size_t size);
+    bool resize(uint64_t size);         // Trailing padding (gaps read as zeros)
+    bool close();
+
+private:
+#ifdef _WIN32
+    void* handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+// Element type of a snapshot channel (stored in the file; values are stable).
+// v4.7.0: F16 / UNORM16 hold packed channels (core::PackedChannel) as stored.
+enum class SnapshotDType : uint32_t { U8 = 1, I32 = 2, U32 = 3, F32 = 4, F16 = 5, UNORM16 = 6, U16 = 7 };
+
+template <typename T>
+constexpr SnapshotDType snapshotDTypeOf() {
+    static_assert(std::is_same<T, uint8_t>::value || std::is_same<T, uint16_t>::value ||
+                  std::is_same<T, int32_t>::value || std::is_same<T, uint32_t>::value ||
+                  std::is_same<T, float>::value,
+                  "WorldSnapshot: unsupported channel element type");
+    return std::is_same<T, uint8_t>::value   ? SnapshotDType::U8
+         : std::is_same<T, uint16_t>::value ? SnapshotDType::U16
+         : std::is_same<T, int32_t>::value  ? SnapshotDType::I32
+         : std::is_same<T, uint32_t>::value ? SnapshotDType::U32
+                                            : SnapshotDType::F32;
+}
+
+// World-level metadata carried in the snapshot header
+struct SnapshotInfo {
+    uint64_t key = 0;          // Opaque to the format (warm-start cache: content hash)
+    int width = 0;             // Filled from the map on save
+    int height = 0;
+    float resolution = 1.0f;   // Metres per cell
+    int seed = 0;
+    float maxHeight = 0.0f;
+    float waterLevel = 0.0f;
+};
+
+struct SnapshotOptions {
+    // Byte-shuffle + LZ per channel; channels that do not shrink by 1/8 stay raw
+    bool compress = false;
+};
+
+/**
+ * @brief v4.7.0: Reader over a mapped snapshot. Uncompressed channels are served
+ * straight from the mapping (view()); read() copies or decompresses.
+ * Valid while the reader lives; views are read-only.
+ */
+class SnapshotReader {
+public:
+    // False if missing, truncated, of another format version or byte order
+    bool open(const std::string& path);
+
+    const SnapshotInfo& info() const { return info_; }
+    bool has(const std::string& name) const { return find(name) != nullptr; }
+
+    // Zero-copy: nullptr unless `name` exists with type T, width*height elements, uncompressed
+    template <typename T>
+    const T* view(const std::string& name) const {
+        const Entry* e = find(name);
+        if (!e || !matches(*e, snapshotDTypeOf<T>(), sizeof(T)) || e->codec != 0) return nullptr;
+        return reinterpret_cast<const T*>(file_.data() + e->offset);
+    }
+
+    // Fills `out` (resized to width*height); false if missing, mistyped or corrupt
+    template <typename T>
+    bool read(const std::string& name, std::vector<T>& out) const {
+        const Entry* e = find(name);
+        if (!e || !matches(*e, snapshotDTypeOf<T>(), sizeof(T))) return false;
+        out.resize(static_cast<size_t>(e->dims[0]) * e->dims[1]);
+        return readInto(*e, out.data());
+    }
+
+    // File layout (public for the writer)
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;    // 0x01020304 as written by the producing machine
+        uint32_t channelCount;
+        uint32_t soilDomain;   // v4.7.0: TerrainMap::soilDomain(), the types the shared soil view shows
+        uint64_t key;
+        int32_t width;
+        int32_t height;
+        float resolution;
+        int32_t seed;
+        float maxHeight;
+        float waterLevel;
+        uint8_t pad[8];
+    };
+    struct Entry {
+        char name[32];
+        uint32_t dtype;
+        uint32_t elemSize;
+        uint32_t dims[2];      // width, height
+        uint32_t codec;        // 0 = raw, 1 = byte shuffle + LZ
+        uint32_t reserved;
+        uint64_t offset;       // From the start of the file, multiple of WorldSnapshot::kAlignment
+        uint64_t storedBytes;
+        uint64_t rawBytes;
+    };
+
+private:
+    friend class WorldSnapshot;
+
+    const Entry* find(const std::string& name) const;
+    bool matches(const Entry& e, SnapshotDType dtype, size_t elemSize) const;
+    bool readInto(const Entry& e, void* dst) const;
+
+    MappedFile file_;
+    SnapshotInfo info_;
+    uint32_t soilDomain_ = 0;
+    const Entry* table_ = nullptr;
+    uint32_t channelCount_ = 0;
+};
+
+/**
+ * @brief v4.7.0: Versioned binary image of every grid of a TerrainMap
+ * (heights, drainage, soil patterns, SoilGrid, HydroGrid, VegetationGrid).
+ *
+ * Layout (little endian):
+ *   header   magic "SAPWORLD", format version, byte-order mark, world metadata
+ *   table    one Entry per channel: name, dtype, dimensions, codec, offset, sizes
+ *   data     one block per channel, each starting on a 64-byte boundary
+ *
+ * Channels are addressed by name ("height", "soil.depth", "veg.ei_coverage", ...),
+ * so a reader only depends on the names it knows and extra channels are ignored.
+ * Packed channels are written in their storage precision and converted on load
+ * when the map stores them differently. The soil taxon dictionary is one more
+ * entry ("soil.taxa", one SoilTaxon per element, dims = {taxa, 1}) that the
+ * "soil.taxon" channel indexes.
+ * Channels are encoded and written in parallel (positional writes), so blocks
+ * of compressed snapshots appear in completion order; the table is authoritative.
+ */
+class WorldSnapshot {
+public:
+    static constexpr uint32_t kFormatVersion = 5;
+    static constexpr size_t kAlignment = 64;
+
+    // Writes to `path`.tmp and renames, so readers never see a partial file
+    static bool save(const std::string& path, const TerrainMap& map, const SnapshotInfo& info,
+                     const SnapshotOptions& options = {});
+
+    // `map` is resized to the snapshot. False (map unspecified) if the file is unusable
+    // or lacks a channel (v4.7.0: lazy channels and "soil" are optional). With a
+    // control, throws RegenerationCancelled once cancelled.
+    static bool load(const std::string& path, TerrainMap& map, SnapshotInfo* info = nullptr,
+                     RegenerationControl* control = nullptr);
+    static bool load(const SnapshotReader& reader, TerrainMap& map, RegenerationControl* control = nullptr);
+};
+
+} // namespace terrain
@@ -9,6 +9,7 @@
 
 #include "imgui.h"
 #include "backends/imgui_impl_vulkan.h"
+#include "../core/job_system.h"
 
 #include <iostream>
 #include <cstring>
@@ -139,24 +140,54 @@ void Minimap::destroyResources() {
 void Minimap::update(const terrain::TerrainMap& map, const terrain::TerrainConfig& config) {
     if (image_ == VK_NULL_HANDLE) return;
 
+    map_ = &map;
+    config_ = config;
+
+    // Store world dims for render
+    worldWidth_ = map.getWidth() * config.resolution;
+    worldHeight_ = map.getHeight() * config.resolution;
+
+    // Keep the current zoom window; render() re-bakes it if it changes
+    renderView(texU0_, texV0_, texU1_, texV1_);
+    findPeaks();
+}
+
+void Minimap::renderView(float u0, float v0, float u1, float v1) {
+    if (!map_ || image_ == VK_NULL_HANDLE) return;
+    const terrain::TerrainMap& map = *map_;
+    const terrain::TerrainConfig& config = config_;
+
     // Generate CPU Pixel Data
-    // Downsample from Map (Width x Height) to Texture (512 x 512)
+    // v4.7.0: Each texel reads one cell of the pyramid level whose footprint matches
+    // the texel size (area-filtered, no aliasing), instead of point-sampling the base map.
     std::vector<uint32_t> pixels(textureWidth_ * textureHeight_);
 
     int mapW = map.getWidth();
     int mapH = map.getHeight();
-    worldWidth_ = mapW * config.resolution;
-    worldHeight_ = mapH * config.resolution;
+    if (mapW <= 0 || mapH <= 0) return;
+
+    const terrain::TerrainPyramid& pyramid = map.pyramid();
+    float footprint = std::max((u1 - u0) * static_cast<float>(mapW) / static_cast<float>(textureWidth_),
+                               (v1 - v0) * static_cast<float>(mapH) / static_cast<float>(textureHeight_));
+    const int level = pyramid.levelForFootprint(footprint);
+
+    const int lw = level > 0 ? pyramid.level(level).width : mapW;
+    const int lh = level > 0 ? pyramid.level(level).height : mapH;
+    const int cellSize = level > 0 ? pyramid.level(level).cellSize : 1;
+    const float* heights = level > 0 ? pyramid.level(level).meanHeight.data() : map.heightMap().data();
+    const uint8_t* soils = level > 0 ? pyramid.level(level).soil.data() : map.soilMap().data();
+    const terrain::SoilMask shownSoils = map.soilView(); // Pyramid levels are already masked
+    auto heightAt = [&](int x, int z) { return heights[static_cast<size_t>(z) * static_cast<size_t>(lw) + static_cast<size_t>(x)]; };
 
     // Helper to get color
     auto getColor = [&](int x, int z) -> uint32_t {
-        terrain::SoilType type = map.getSoil(x, z);
-        float h = map.getHeight(x, z);
-        // Simple Hillshade
-        float hL = map.getHeight(std::max(0, x-1), z);
-        float hU = map.getHeight(x, std::min(mapH-1, z+1));
-        float slopeX = h - hL;
-        float slopeZ = hU - h;
+        terrain::SoilType type = terrain::soilTypeOf(soils[static_cast<size_t>(z) * static_cast<size_t>(lw) + static_cast<size_t>(x)], shownSoils);
+        float h = heightAt(x, z);
+        // Simple Hillshade (per base cell, so relief reads the same at every level)
+        float hL = heightAt(std::max(0, x-1), z);
+        float hU = heightAt(x, std::min(lh-1, z+1));
+        float slopeX = (h - hL) / cellSize;
+        float slopeZ = (hU - h) / cellSize;
         // v3.8.1: Boost contrast for Hills (was 0.3f)
         // With 1024 resolution, slopes are small per pixel. Multiply by larger factor.
         float light = 0.5f + 1.5f * (slopeX - slopeZ); 
@@ -184,28 +215,24 @@ void Minimap::update(const terrain::TerrainMap& map, const terrain::TerrainConfi
         // uint32: 0xAABBGGRR (Little Endian) -> R at lowest. 
     };
 
-    #pragma omp parallel for collapse(2)
-    for (uint32_t y = 0; y < textureHeight_; ++y) {
-        for (uint32_t x = 0; x < textureWidth_; ++x) {
-            // Map to Terrain Coords
-            float u = static_cast<float>(x) / textureWidth_;
-            float v = static_cast<float>(y) / textureHeight_;
+    core::JobSystem::instance().parallelFor(0, static_cast<int>(textureHeight_), 0, [&](int rowBegin, int rowEnd) {
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            for (uint32_t x = 0; x < textureWidth_; ++x) {
+                // Texel centre -> normalized map coords inside the window
+                float u = u0 + (static_cast<float>(x) + 0.5f) / textureWidth_ * (u1 - u0);
+                float v = v0 + (static_cast<float>(y) + 0.5f) / textureHeight_ * (v1 - v0);
             
-            // Flip V if needed? Terrain 0,0 is usually bottom-left. 
-            // Image 0,0 is Top-Left. 
-            // So v should map to (1-v) for correct orientation if Z is Up.
-            // Let's assume Z grows up. Map (0,0) is bottom-left.
-            // Image (0,0) top-left.
-            // So Image Y=0 -> World Z = Max. Image Y=Max -> World Z = 0.
-            int mapX = static_cast<int>(u * mapW);
-            int mapZ = static_cast<int>(v * mapH); // v3.8.0 Fix: V=0 is North (Z=0). No inversion.
+                // Image (0,0) is top-left; V=0 is North (Z=0). No inversion (v3.8.0).
+                int cellX = static_cast<int>(u * mapW) / cellSize;
+                int cellZ = static_cast<int>(v * mapH) / cellSize;
             
-            mapX = std::max(0, std::min(mapW - 1, mapX));
-            mapZ = std::max(0, std::min(mapH - 1, mapZ));
+                cellX = std::max(0, std::min(lw - 1, cellX));
+                cellZ = std::max(0, std::min(lh - 1, cellZ));
             
-            pixels[y * textureWidth_ + x] = getColor(mapX, mapZ);
+                pixels[static_cast<uint32_t>(y) * textureWidth_ + x] = getColor(cellX, cellZ);
+            }
         }
-    }
+    });
 
     // Upload
     // 1. Staging Buffer
@@ -222,47 +249,51 @@ void Minimap::update(const terrain::TerrainMap& map, const terrain::TerrainConfi
     
     // 4. Transition back
     transitionImageLayout(image_, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    
-    // Store world dims for render
-    int w = map.getWidth();
-    int h = map.getHeight();
-    worldWidth_ = w * config.resolution;
-    worldHeight_ = h * config.resolution;
-    
+
+    texU0_ = u0;
+    texV0_ = v0;
+    texU1_ = u1;
+    texV1_ = v1;
+}
+
+void Minimap::findPeaks() {
     // v3.8.0: Identify Symbols (Peaks)
     symbols_.clear();
-    // Simple Local Maxima (Kernel 3x3 or larger step)
-    // Simple Local Maxima (Kernel 3x3 or larger step)
-    int step = 15; // v3.8.1: Finer step for Hills
-    float peakThresh = std::max(config.waterLevel + 2.0f, config.maxHeight * 0.35f); // v3.8.1: Lower threshold (35%) to catch Hills
+    if (!map_) return;
+    const terrain::TerrainMap& map = *map_;
+    const terrain::TerrainPyramid& pyramid = map.pyramid();
+    if (pyramid.levelCount() == 0) return;
+
+    // v4.7.0: Local maxima of the max-height pyramid at ~16-cell blocks (was: every
+    // 15th base cell vs 4 neighbours 15 cells away). A block is a peak if its max
+    // beats all 8 neighbouring blocks; the symbol sits on the actual summit cell.
+    const int l = std::min(4, pyramid.levelCount());
+    const terrain::TerrainPyramid::Level& level = pyramid.level(l);
+    float peakThresh = std::max(config_.waterLevel + 2.0f, config_.maxHeight * 0.35f); // v3.8.1: Lower threshold (35%) to catch Hills
     
-    for (int z = step; z < h - step; z += step) {
-        for (int x = step; x < w - step; x += step) {
-            float val = map.getHeight(x, z);
-            if (val > peakThresh) {
-                // Check neighbors
-                bool isPeak = true;
-                if (map.getHeight(x-step, z) >= val) isPeak = false;
-                if (map.getHeight(x+step, z) >= val) isPeak = false;
-                if (map.getHeight(x, z-step) >= val) isPeak = false;
-                if (map.getHeight(x, z+step) >= val) isPeak = false;
-                
-                if (isPeak) {
-                    float globalU = static_cast<float>(x) / w;
-                    float globalV = static_cast<float>(z) / h; // v3.8.0 Fix: V aligned with Z
-                    
-                    // Actually, texture gen uses: v = static_cast<float>(y) / h;
-                    // pixel y=0 is Top of texture. 
-                    // map z=0 is usually Top or Bottom depending on coord sys.
-                    // In texture gen: int mapZ = (1.0 - v) * mapH. So v=0 -> mapZ=mapH. v=1 -> mapZ=0.
-                    // So Top of Texture (v=0) is Z=Max. Bottom (v=1) is Z=0.
-                    // Wait, let's check generate loop: 
-                    // for (uint32_t y = 0; y < textureHeight_; ++y) ... mapZ = (1.0f - v) * mapH;
-                    // So Visual V matches 1.0 - Z_norm.
-                    
-                    symbols_.push_back({ globalU, globalV, 0 });
+    for (int z = 1; z < level.height - 1; ++z) {
+        for (int x = 1; x < level.width - 1; ++x) {
+            float val = level.maxHeight[level.index(x, z)];
+            if (val <= peakThresh) continue;
+
+            // Check neighbors
+            bool isPeak = true;
+            for (int dz = -1; dz <= 1 && isPeak; ++dz) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if ((dx || dz) && level.maxHeight[level.index(x + dx, z + dz)] >= val) {
+                        isPeak = false;
+                        break;
+                    }
                 }
             }
+            
+            if (isPeak) {
+                int px, pz;
+                pyramid.locateMax(l, x, z, map.heightMap(), px, pz);
+                float globalU = (static_cast<float>(px) + 0.5f) / static_cast<float>(map.getWidth());
+                float globalV = (static_cast<float>(pz) + 0.5f) / static_cast<float>(map.getHeight()); // v3.8.0 Fix: V aligned with Z
+                symbols_.push_back({ globalU, globalV, 0 });
+            }
         }
     }
 }
@@ -292,11 +323,19 @@ void Minimap::render(graphics::Camera& camera) {
         ImVec2 uv0(centerX_ - halfVP, centerY_ - halfVP);
         ImVec2 uv1(centerX_ + halfVP, centerY_ + halfVP);
 
+        // v4.7.0: Re-bake the texture for the visible window from the matching
+        // pyramid level (zoomed views get real detail instead of magnified texels)
+        if (map_ && (uv0.x != texU0_ || uv0.y != texV0_ || uv1.x != texU1_ || uv1.y != texV1_)) {
+            renderView(uv0.x, uv0.y, uv1.x, uv1.y);
+        }
+        ImVec2 texUv0((uv0.x - texU0_) / (texU1_ - texU0_), (uv0.y - texV0_) / (texV1_ - texV0_));
+        ImVec2 texUv1((uv1.x - texU0_) / (texU1_ - texU0_), (uv1.y - texV0_) / (texV1_ - texV0_));
+
         // Display Size
         ImVec2 size(256, 256);
         ImVec2 pMin = ImGui::GetCursorScreenPos();
         
-        ImGui::Image((ImTextureID)textureID_, size, uv0, uv1);
+        ImGui::Image((ImTextureID)textureID_, size, texUv0, texUv1);
 
         // Interact: Click to Move Camera
         if (ImGui::IsItemHovered()) {
@@ -47,6 +47,13 @@ private:
     VkSampler sampler_ = VK_NULL_HANDLE;
     VkDescriptorSet textureID_ = VK_NULL_HANDLE;
 
+    // v4.7.0: Source map for re-rendering zoomed views from the height pyramid.
+    // Refreshed by update(); the owner calls update() whenever the map is replaced.
+    const terrain::TerrainMap* map_ = nullptr;
+    terrain::TerrainConfig config_;
+    // Normalized map window currently baked into the texture
+    float texU0_ = 0.0f, texV0_ = 0.0f, texU1_ = 1.0f, texV1_ = 1.0f;
+
     // State for Zoom/Pan
     float zoomLevel_ = 1.0f; // 1.0 = Full Map
     // Offset center normalized [0,1]
@@ -61,6 +68,8 @@ private:
     std::vector<Symbol> symbols_;
 
     // Helpers
+    void renderView(float u0, float v0, float u1, float v1); // v4.7.0: Rasterize a map window from the pyramid
+    void findPeaks();
     void createResources();
     void destroyResources();
     void createSampler();
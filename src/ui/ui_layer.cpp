@@ -52,13 +52,17 @@ void UiLayer::render(UiFrameContext& ctx, VkCommandBuffer cmd) {
     }
 
     // v3.8.3 Loading Overlay
+    // v4.7.0: Progress + cancel; a coarse preview is shown while the full map is built,
+    // so the overlay sits at the top instead of covering the view
     if (ctx.isRegenerating) {
-        ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x * 0.5f, ImGui::GetIO().DisplaySize.y * 0.5f), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
-        ImGui::SetNextWindowSize(ImVec2(300, 100));
+        ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x * 0.5f, 40.0f), ImGuiCond_Always, ImVec2(0.5f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(320, 0));
         if (ImGui::Begin("Loading", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings)) {
             ImGui::Text("Generating Terrain...");
-            ImGui::Separator();
-            ImGui::TextWrapped("Please wait. Large maps (4096) can take several seconds to process 16 million cells.");
+            ImGui::ProgressBar(ctx.regenProgress, ImVec2(-1, 0));
+            if (ImGui::Button("Cancel", ImVec2(-1, 0)) && callbacks_.cancelRegeneration) {
+                callbacks_.cancelRegeneration();
+            }
         }
         ImGui::End();
     }
@@ -201,6 +205,19 @@ void UiLayer::drawMenuBar(UiFrameContext& ctx) {
                 }
             }
             ImGui::Separator();
+            // v4.7.0: World snapshots (all grids; resumable)
+            if (ImGui::MenuItem("Save World Snapshot", nullptr, false, !ctx.isRegenerating) && callbacks_.saveWorldSnapshot) {
+                callbacks_.saveWorldSnapshot(snapshotCompress_);
+            }
+            ImGui::MenuItem("Compress Snapshots", nullptr, &snapshotCompress_);
+            if (ImGui::MenuItem("Load World Snapshot", nullptr, false, !ctx.isRegenerating) && callbacks_.loadWorldSnapshot) {
+                callbacks_.loadWorldSnapshot();
+            }
+            // v4.7.0: Tiled GeoTIFFs with overviews, one per layer, in raster_export/
+            if (ImGui::MenuItem("Export GIS Rasters (GeoTIFF)", nullptr, false, !ctx.isRegenerating) && callbacks_.exportRasters) {
+                callbacks_.exportRasters();
+            }
+            ImGui::Separator();
             if (ImGui::BeginMenu("Watershed Analysis (v3.6.3)")) {
                 if (ImGui::MenuItem("Global Segmentation")) {
                     if (ctx.finiteMap) {
@@ -517,7 +534,9 @@ void UiLayer::drawToolbar(UiFrameContext& ctx) {
                  config.seed = genSeedInput_;
                  config.waterLevel = genWaterLvl_;
                  
-                 if (genUseBlend_) {
+                 if (genUseSpectral_) {
+                     config.model = terrain::TerrainConfig::FiniteTerrainModel::SpectralSynthesis;
+                 } else if (genUseBlend_) {
                      config.model = terrain::TerrainConfig::FiniteTerrainModel::ExperimentalBlend;
                      config.blendConfig.lowFreqWeight = genBlendLow_;
                      config.blendConfig.midFreqWeight = genBlendMid_;
@@ -670,8 +689,12 @@ void UiLayer::drawTerrainInspector(UiFrameContext& ctx) {
 
     ImGui::SliderFloat("Resolution", &genResolution_, 0.1f, 4.0f, "%.1f m");
     
+    // v4.7.0: Spectral synthesis ignores octaves/blend (cost independent of detail)
+    ImGui::Checkbox("Spectral Synthesis (FFT)", &genUseSpectral_);
+    if (genUseSpectral_) ImGui::BeginDisabled();
     ImGui::Checkbox("Use Experimental Blend", &genUseBlend_);
-    if (genUseBlend_) {
+    if (genUseSpectral_) ImGui::EndDisabled();
+    if (genUseBlend_ && !genUseSpectral_) {
         ImGui::Indent();
         ImGui::SliderFloat("Low Freq", &genBlendLow_, 0.0f, 2.0f);
         ImGui::SliderFloat("Mid Freq", &genBlendMid_, 0.0f, 2.0f);
@@ -702,7 +725,9 @@ void UiLayer::drawTerrainInspector(UiFrameContext& ctx) {
             config.persistence = genPersistence_;
             config.seed = genSeedInput_;
             config.waterLevel = genWaterLvl_;
-            if (genUseBlend_) {
+            if (genUseSpectral_) {
+                config.model = terrain::TerrainConfig::FiniteTerrainModel::SpectralSynthesis;
+            } else if (genUseBlend_) {
                 config.model = terrain::TerrainConfig::FiniteTerrainModel::ExperimentalBlend;
                 config.blendConfig.lowFreqWeight = genBlendLow_;
                 config.blendConfig.midFreqWeight = genBlendMid_;
@@ -719,6 +744,15 @@ void UiLayer::drawTerrainInspector(UiFrameContext& ctx) {
     }
     if (ctx.isRegenerating) ImGui::EndDisabled();
 
+    // v4.7.0: Real terrain from an elevation raster (uses Resolution above)
+    ImGui::InputText("DEM File", demPath_, IM_ARRAYSIZE(demPath_));
+    if (ctx.isRegenerating || demPath_[0] == '\0') ImGui::BeginDisabled();
+    if (ImGui::Button("Import DEM", ImVec2(-1, 0)) && callbacks_.importDem) {
+        lastMetrics_.clear();
+        callbacks_.importDem(demPath_, genResolution_);
+    }
+    if (ctx.isRegenerating || demPath_[0] == '\0') ImGui::EndDisabled();
+
     // --- Navigation ---
     ImGui::Separator();
     ImGui::Text("Viewer Controls:");
@@ -797,6 +831,35 @@ void UiLayer::drawHydrologyInspector(UiFrameContext& ctx) {
             if (ctx.showSlopeAnalysis) ctx.showSlopeAnalysis = false;
             if (ctx.showDrainage) ctx.showDrainage = false;
     }
+
+    // v4.7.0: Runs on its own thread; the rate no longer follows the frame rate
+    ImGui::Separator();
+    ImGui::Text("Simulation");
+    ImGui::SliderFloat("Tick Rate", &ctx.simulationRate, 0.0f, 60.0f, ctx.simulationRate <= 0.0f ? "Unlimited" : "%.0f /s");
+    ImGui::Text("%.1f ticks/s, %.1f ms/tick", ctx.simTicksPerSecond, ctx.simStepMs);
+
+    // v4.7.0: Record vegetation / soil depth / erosion over time and scrub back through it
+    ImGui::Separator();
+    ImGui::Text("Simulation Timeline");
+    if (ctx.replayActive) {
+        int frame = ctx.replayFrame;
+        if (ImGui::SliderInt("Frame", &frame, 0, std::max(0, ctx.replayFrameCount - 1)) && callbacks_.seekReplay) {
+            callbacks_.seekReplay(frame);
+        }
+        ImGui::Text("t = %.1f s", ctx.replayTime);
+        if (ImGui::Button("Resume Simulation") && callbacks_.setReplay) callbacks_.setReplay(false);
+    } else if (ctx.isRecording) {
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "REC  %zu frames (%zu dropped)", ctx.recordedFrames, ctx.droppedFrames);
+        if (ImGui::Button("Stop Recording") && callbacks_.stopRecording) callbacks_.stopRecording();
+        ImGui::SameLine();
+        if (ImGui::Button("Replay") && callbacks_.setReplay) callbacks_.setReplay(true);
+    } else {
+        if (ImGui::Button("Record") && callbacks_.startRecording && !ctx.isRegenerating) callbacks_.startRecording();
+        if (ctx.recordedFrames > 0) {
+            ImGui::SameLine();
+            if (ImGui::Button("Replay") && callbacks_.setReplay) callbacks_.setReplay(true);
+        }
+    }
 }
 
 // drawGeologyInspector removed - merged into Soil Inspector v4.5.1
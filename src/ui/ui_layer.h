@@ -67,6 +67,21 @@ struct UiFrameContext {
     float& lightIntensity;
     // v3.8.3 Async Status
     bool isRegenerating;
+    float regenProgress; // v4.7.0: [0, 1]
+
+    // v4.7.0 Simulation Timeline
+    bool isRecording;
+    size_t recordedFrames;
+    size_t droppedFrames;
+    bool replayActive;
+    int replayFrame;
+    int replayFrameCount;
+    double replayTime; // Simulated seconds of the shown frame
+
+    // v4.7.0 Simulation thread
+    float& simulationRate; // Ticks per second; 0 = unlimited
+    double simTicksPerSecond;
+    double simStepMs;
     
     // v3.9.0 Vegetation
     int& vegetationMode;
@@ -129,6 +144,17 @@ struct Callbacks {
     std::function<void(int, float)> mlTrainFireModel;
     std::function<void(int)> mlCollectGrowthData;
     std::function<void(int, float)> mlTrainGrowthModel;
+
+    // v4.7.0: Abort the regeneration in progress (keeps the current world)
+    std::function<void()> cancelRegeneration;
+    std::function<void(bool)> saveWorldSnapshot; // v4.7.0: compress
+    std::function<void()> loadWorldSnapshot;     // v4.7.0
+    std::function<void(const std::string&, float)> importDem; // v4.7.0: path, resolution (m)
+    std::function<void()> exportRasters;         // v4.7.0: GeoTIFF per layer
+    std::function<void()> startRecording;        // v4.7.0: Simulation timeline
+    std::function<void()> stopRecording;
+    std::function<void(bool)> setReplay;
+    std::function<void(int)> seekReplay;
 };
 
 // ... (Moved include to top)
@@ -187,11 +213,14 @@ private:
     float genWaterLvl_ = 64.0f;
     int genSeedInput_ = 12345;
     bool genUseBlend_ = false;
+    bool genUseSpectral_ = false; // v4.7.0: FFT spectral synthesis model
+    bool snapshotCompress_ = true; // v4.7.0: Shuffle + LZ for saved world snapshots
     float genBlendLow_ = 1.0f;
     float genBlendMid_ = 0.5f;
     float genBlendHigh_ = 0.25f;
     float genBlendExp_ = 1.0f;
     float genResolution_ = 1.0f;
+    char demPath_[256] = "";       // v4.7.0: DEM raster for Import DEM
 
     // v4.3.5: Metrics Cache
     std::map<terrain::SoilType, terrain::ClassMetrics> lastMetrics_;
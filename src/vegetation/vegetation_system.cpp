@@ -1,9 +1,16 @@
 #include "vegetation_system.h"
 #include "../landscape/landscape_types.h"
+#include "../core/job_system.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <random>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VEG_NOISE_SSE2 1
+#endif
 
 namespace vegetation {
 
@@ -39,6 +46,125 @@ float smoothNoise(float x, float y, int seed) {
     return lerp(i1, i2, fy);
 }
 
+#ifdef VEG_NOISE_SSE2
+// 32-bit wrapping multiply (SSE2 has no pmulld)
+inline __m128i mullo32(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128 pseudoNoise4(__m128i x, __m128i y, __m128i seedTerm) {
+    __m128i n = _mm_add_epi32(_mm_add_epi32(x, mullo32(y, _mm_set1_epi32(57))), seedTerm);
+    n = _mm_xor_si128(_mm_slli_epi32(n, 13), n);
+    __m128i inner = _mm_add_epi32(mullo32(mullo32(n, n), _mm_set1_epi32(15731)), _mm_set1_epi32(789221));
+    __m128i r = _mm_add_epi32(mullo32(n, inner), _mm_set1_epi32(1376312589));
+    r = _mm_and_si128(r, _mm_set1_epi32(0x7fffffff));
+    return _mm_sub_ps(_mm_set1_ps(1.0f), _mm_div_ps(_mm_cvtepi32_ps(r), _mm_set1_ps(1073741824.0f)));
+}
+#endif
+
+// v4.7.0: smoothNoise over n points, bit-identical to the scalar version
+// (4 lanes per step with SSE2; integer hash wraps exactly like the scalar path).
+void smoothNoiseBatch(const float* x, const float* y, float* out, size_t n, int seed) {
+    size_t i = 0;
+
+#ifdef VEG_NOISE_SSE2
+    const __m128i seedTerm = _mm_set1_epi32(static_cast<int>(static_cast<unsigned>(seed) * 131u));
+    const __m128i one = _mm_set1_epi32(1);
+    auto lerp4 = [](__m128 a, __m128 b, __m128 t) { return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a))); };
+    for (; i + 4 <= n; i += 4) {
+        const __m128 px = _mm_loadu_ps(x + i);
+        const __m128 py = _mm_loadu_ps(y + i);
+        // floor: truncate, then step down where truncation rounded up
+        __m128i X = _mm_cvttps_epi32(px);
+        __m128i Y = _mm_cvttps_epi32(py);
+        X = _mm_add_epi32(X, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(X), px))); // -1 where true
+        Y = _mm_add_epi32(Y, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(Y), py)));
+        const __m128 fx = _mm_sub_ps(px, _mm_cvtepi32_ps(X));
+        const __m128 fy = _mm_sub_ps(py, _mm_cvtepi32_ps(Y));
+
+        const __m128i X1 = _mm_add_epi32(X, one);
+        const __m128i Y1 = _mm_add_epi32(Y, one);
+        __m128 i1 = lerp4(pseudoNoise4(X, Y, seedTerm), pseudoNoise4(X1, Y, seedTerm), fx);
+        __m128 i2 = lerp4(pseudoNoise4(X, Y1, seedTerm), pseudoNoise4(X1, Y1, seedTerm), fx);
+        _mm_storeu_ps(out + i, lerp4(i1, i2, fy));
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = smoothNoise(x[i], y[i], seed);
+    }
+}
+
+// v4.7.0: Coverage and vigor of one cell, unpacked from the grid's storage
+struct VegetationCell {
+    float eiCoverage;
+    float esCoverage;
+    float eiVigor;
+    float esVigor;
+};
+
+// v4.7.0: Parallel sweep in tile order. fn(i, cell) edits the unpacked cell and
+// returns true if it may have changed; each tile row is converted to floats
+// once, and stored back (batch conversion) only if a cell changed. Each tile is owned by
+// one thread, so its version bump is race-free.
+template <typename CellFn>
+void forEachTile(VegetationGrid& grid, CellFn&& fn) {
+    const int w = grid.width;
+    const int h = grid.height;
+    const int T = VegetationGrid::kTileSize;
+    const int tiles = grid.tileCount();
+
+    core::JobSystem::instance().parallelFor(0, tiles, 1, [&](int tileBegin, int tileEnd) {
+        float eiCoverage[T], esCoverage[T], eiVigor[T], esVigor[T];
+        for (int t = tileBegin; t < tileEnd; ++t) {
+            const int x0 = (t % grid.tiles_x) * T;
+            const int y0 = (t / grid.tiles_x) * T;
+            const int x1 = std::min(x0 + T, w);
+            const int y1 = std::min(y0 + T, h);
+            const size_t n = static_cast<size_t>(x1 - x0);
+
+            bool changed = false;
+            for (int y = y0; y < y1; ++y) {
+                const size_t row = static_cast<size_t>(y) * static_cast<size_t>(w) + static_cast<size_t>(x0);
+                grid.ei_coverage.load(row, n, eiCoverage);
+                grid.es_coverage.load(row, n, esCoverage);
+                grid.ei_vigor.load(row, n, eiVigor);
+                grid.es_vigor.load(row, n, esVigor);
+
+                bool rowChanged = false;
+                for (size_t k = 0; k < n; ++k) {
+                    VegetationCell cell{eiCoverage[k], esCoverage[k], eiVigor[k], esVigor[k]};
+                    if (!fn(row + k, cell)) continue;
+                    // A change below the storage step is no change (keeps settled tiles clean)
+                    cell.eiCoverage = grid.ei_coverage.round(cell.eiCoverage);
+                    cell.esCoverage = grid.es_coverage.round(cell.esCoverage);
+                    cell.eiVigor = grid.ei_vigor.round(cell.eiVigor);
+                    cell.esVigor = grid.es_vigor.round(cell.esVigor);
+                    if (cell.eiCoverage == eiCoverage[k] && cell.esCoverage == esCoverage[k] &&
+                        cell.eiVigor == eiVigor[k] && cell.esVigor == esVigor[k]) {
+                        continue;
+                    }
+                    eiCoverage[k] = cell.eiCoverage;
+                    esCoverage[k] = cell.esCoverage;
+                    eiVigor[k] = cell.eiVigor;
+                    esVigor[k] = cell.esVigor;
+                    rowChanged = true;
+                }
+                if (!rowChanged) continue;
+                grid.ei_coverage.store(row, n, eiCoverage);
+                grid.es_coverage.store(row, n, esCoverage);
+                grid.ei_vigor.store(row, n, eiVigor);
+                grid.es_vigor.store(row, n, esVigor);
+                changed = true;
+            }
+            if (changed) grid.touchTile(t);
+        }
+    });
+}
+
 void VegetationSystem::initialize(VegetationGrid& grid, int seed) {
     if (!grid.isValid()) return;
     
@@ -48,63 +174,77 @@ void VegetationSystem::initialize(VegetationGrid& grid, int seed) {
     // Use std::mt19937 for better randomness if needed, but perlin uses integer hash.
     // We keep the noise functions deterministic based on seed.
 
-    #pragma omp parallel for collapse(2)
-    for (int y = 0; y < h; ++y) {
-        for (int x = 0; x < w; ++x) {
-            int idx = y * w + x;
-            
-            // --- 1. EI (Grass) Capacity Initialization ---
+    // v4.7.0: Noise layers are evaluated a row at a time (smoothNoiseBatch)
+    core::JobSystem::instance().parallelFor(0, h, 0, [&](int rowBegin, int rowEnd) {
+        std::vector<float> lowX(w), midX(w), lowXs(w), midXs(w), lowY(w), midY(w), lowYs(w), midYs(w);
+        std::vector<float> n1(w), n2(w), esN1(w), esN2(w), vigorNoise(w);
+        std::vector<float> eiCoverage(w), esCoverage(w), vigor(w); // Packed channels, stored per row
+        const size_t n = static_cast<size_t>(w);
+
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            for (int x = 0; x < w; ++x) {
+                lowX[x] = x * 0.02f;  lowY[x] = y * 0.02f;
+                midX[x] = x * 0.1f;   midY[x] = y * 0.1f;
+                lowXs[x] = x * 0.02f + 100; lowYs[x] = y * 0.02f + 100;
+                midXs[x] = x * 0.1f + 100;  midYs[x] = y * 0.1f + 100;
+            }
             // FBM (Fractal Brownian Motion) for natural patches
-            // Octave 1: Low Freq, High Amp
-            float n1 = smoothNoise(x * 0.02f, y * 0.02f, seed);
-            // Octave 2: Mid Freq, Mid Amp
-            float n2 = smoothNoise(x * 0.1f, y * 0.1f, seed + 999);
-            
-            float capacityNoiseEI = n1 * 0.7f + n2 * 0.3f; // Mixed
-            
-            // Base Capacity for EI (Space/Soil potential)
-            // Range [0.6, 1.0] modulated by noise
-            grid.ei_capacity[idx] = 0.6f + 0.4f * (capacityNoiseEI * 0.5f + 0.5f);
-            
-            // Set initial coverage to full capacity
-            grid.ei_coverage[idx] = grid.ei_capacity[idx];
+            // Octave 1: Low Freq, High Amp / Octave 2: Mid Freq, Mid Amp
+            smoothNoiseBatch(lowX.data(), lowY.data(), n1.data(), n, seed);
+            smoothNoiseBatch(midX.data(), midY.data(), n2.data(), n, seed + 999);
+            // Independent noise layer for shrubs (patchy, clumped)
+            smoothNoiseBatch(lowXs.data(), lowYs.data(), esN1.data(), n, seed);
+            smoothNoiseBatch(midXs.data(), midYs.data(), esN2.data(), n, seed + 888);
+            smoothNoiseBatch(midX.data(), midY.data(), vigorNoise.data(), n, seed + 55);
 
+            for (int x = 0; x < w; ++x) {
+                int idx = y * w + x;
 
-            // --- 2. ES (Shrub) Capacity Initialization ---
-            // Independent noise layer for shrubs (patchy, clumped)
-            float esN1 = smoothNoise(x * 0.02f + 100, y * 0.02f + 100, seed);
-            float esN2 = smoothNoise(x * 0.1f + 100, y * 0.1f + 100, seed + 888);
-            float capacityNoiseES = esN1 * 0.7f + esN2 * 0.3f;
-            
-            // Shrubs are patchier. If noise is low, capacity is zero.
-            if (capacityNoiseES > 0.2f) { 
-                grid.es_capacity[idx] = (capacityNoiseES - 0.2f) * 1.5f; 
-                if (grid.es_capacity[idx] > 1.0f) grid.es_capacity[idx] = 1.0f;
-            } else {
-                grid.es_capacity[idx] = 0.0f;
-            }
+                // --- 1. EI (Grass) Capacity Initialization ---
+                float capacityNoiseEI = n1[x] * 0.7f + n2[x] * 0.3f; // Mixed
 
-            // Initial ES coverage (Start with some, but let it grow)
-            grid.es_coverage[idx] = grid.es_capacity[idx] * 0.5f;
+                // Base Capacity for EI (Space/Soil potential)
+                // Range [0.6, 1.0] modulated by noise
+                grid.ei_capacity[idx] = 0.6f + 0.4f * (capacityNoiseEI * 0.5f + 0.5f);
 
-            
-            // --- 3. Vigor Initialization ---
-            float vigorNoise = smoothNoise(x * 0.1f, y * 0.1f, seed + 55); 
-            grid.ei_vigor[idx] = 0.8f + 0.2f * vigorNoise; 
-            grid.es_vigor[idx] = grid.ei_vigor[idx];
-            
-            grid.recovery_timer[idx] = 0.0f;
+                // Set initial coverage to full capacity
+                eiCoverage[x] = grid.ei_capacity[idx];
+
+
+                // --- 2. ES (Shrub) Capacity Initialization ---
+                float capacityNoiseES = esN1[x] * 0.7f + esN2[x] * 0.3f;
+
+                // Shrubs are patchier. If noise is low, capacity is zero.
+                if (capacityNoiseES > 0.2f) {
+                    grid.es_capacity[idx] = (capacityNoiseES - 0.2f) * 1.5f;
+                    if (grid.es_capacity[idx] > 1.0f) grid.es_capacity[idx] = 1.0f;
+                } else {
+                    grid.es_capacity[idx] = 0.0f;
+                }
+
+                // Initial ES coverage (Start with some, but let it grow)
+                esCoverage[x] = grid.es_capacity[idx] * 0.5f;
+
+
+                // --- 3. Vigor Initialization ---
+                vigor[x] = 0.8f + 0.2f * vigorNoise[x];
+
+                grid.recovery_timer[idx] = 0.0f;
+            }
+            const size_t row = static_cast<size_t>(y) * n;
+            grid.ei_coverage.store(row, n, eiCoverage.data());
+            grid.es_coverage.store(row, n, esCoverage.data());
+            grid.ei_vigor.store(row, n, vigor.data());
+            grid.es_vigor.store(row, n, vigor.data());
         }
-    }
+    });
+    grid.touchAll();
 }
 
 void VegetationSystem::update(VegetationGrid& grid, float dt, const DisturbanceRegime& regime, 
                               const landscape::SoilGrid* soil, const landscape::HydroGrid* hydro) {
     if (!grid.isValid()) return;
     
-    // In OpenMP parallel loop for performance
-    int size = static_cast<int>(grid.getSize());
-    
     // Calculate Global Disturbance Index (Regime-based)
     float D = regime.magnitude * regime.frequency * regime.spatialExtent;
     
@@ -115,8 +255,9 @@ void VegetationSystem::update(VegetationGrid& grid, float dt, const DisturbanceR
     float R_ES = std::exp(-regime.beta * D);
     R_ES = std::max(0.0f, std::min(1.0f, R_ES)); 
 
-    #pragma omp parallel for
-    for (int i = 0; i < size; ++i) {
+    forEachTile(grid, [&](size_t i, VegetationCell& cell) {
+        const VegetationCell before = cell;
+
         // --- COUPLING: Site Index (Soil Depth + Organic Matter) ---
         float siteIndex = 1.0f; // Default good
         float recoveryPot = 1.0f; // Propagule Bank
@@ -144,13 +285,13 @@ void VegetationSystem::update(VegetationGrid& grid, float dt, const DisturbanceR
         if (grid.recovery_timer[i] <= 0.0f) {
             
             // 1. EI (Grass) Dynamics
-            if (grid.ei_coverage[i] < currentMaxEI) {
+            if (cell.eiCoverage < currentMaxEI) {
                 // Growth depends on Recovery Potential (Seeds)
-                grid.ei_coverage[i] += 0.1f * dt * recoveryPot; 
-                if (grid.ei_coverage[i] > currentMaxEI) grid.ei_coverage[i] = currentMaxEI;
-            } else if (grid.ei_coverage[i] > currentMaxEI) {
-                grid.ei_coverage[i] -= 0.05f * dt; 
-                 if (grid.ei_coverage[i] < currentMaxEI) grid.ei_coverage[i] = currentMaxEI;
+                cell.eiCoverage += 0.1f * dt * recoveryPot; 
+                if (cell.eiCoverage > currentMaxEI) cell.eiCoverage = currentMaxEI;
+            } else if (cell.eiCoverage > currentMaxEI) {
+                cell.eiCoverage -= 0.05f * dt; 
+                 if (cell.eiCoverage < currentMaxEI) cell.eiCoverage = currentMaxEI;
             }
             
             // Vigor (Simulated seasonality + Water Stress)
@@ -165,56 +306,59 @@ void VegetationSystem::update(VegetationGrid& grid, float dt, const DisturbanceR
                 if (soil && soil->depth[i] < 0.2f) targetVigor = 0.2f; 
             }
             
-            if (grid.ei_vigor[i] < targetVigor) {
-                grid.ei_vigor[i] += 0.1f * dt;
+            if (cell.eiVigor < targetVigor) {
+                cell.eiVigor += 0.1f * dt;
             } else {
-                grid.ei_vigor[i] -= 0.05f * dt; 
+                cell.eiVigor -= 0.05f * dt; 
             }
-            grid.ei_vigor[i] = std::max(0.0f, std::min(1.0f, grid.ei_vigor[i]));
-            grid.es_vigor[i] = grid.ei_vigor[i]; 
+            cell.eiVigor = std::max(0.0f, std::min(1.0f, cell.eiVigor));
+            cell.esVigor = cell.eiVigor; 
 
             // 2. ES (Shrub) Dynamics with FACILITATION
-            bool facilitationActive = grid.ei_coverage[i] > 0.7f;
+            bool facilitationActive = cell.eiCoverage > 0.7f;
             
-            if (grid.es_coverage[i] < currentMaxES) {
+            if (cell.esCoverage < currentMaxES) {
                 if (facilitationActive) {
-                    grid.es_coverage[i] += 0.02f * dt * recoveryPot; 
+                    cell.esCoverage += 0.02f * dt * recoveryPot; 
                 } 
-                if (grid.es_coverage[i] > currentMaxES) grid.es_coverage[i] = currentMaxES;
-            } else if (grid.es_coverage[i] > currentMaxES) {
-                 grid.es_coverage[i] -= 0.1f * dt; 
-                 if (grid.es_coverage[i] < currentMaxES) grid.es_coverage[i] = currentMaxES;
+                if (cell.esCoverage > currentMaxES) cell.esCoverage = currentMaxES;
+            } else if (cell.esCoverage > currentMaxES) {
+                 cell.esCoverage -= 0.1f * dt; 
+                 if (cell.esCoverage < currentMaxES) cell.esCoverage = currentMaxES;
             }
         } 
 
         // Competition Logic
-        if (grid.es_coverage[i] > 0.0f) {
-            float availableSpace = 1.0f - grid.es_coverage[i];
-            if (grid.ei_coverage[i] > availableSpace) {
-                grid.ei_coverage[i] = availableSpace;
+        if (cell.esCoverage > 0.0f) {
+            float availableSpace = 1.0f - cell.esCoverage;
+            if (cell.eiCoverage > availableSpace) {
+                cell.eiCoverage = availableSpace;
             }
         }
-    } 
+
+        return before.eiCoverage != cell.eiCoverage || before.esCoverage != cell.esCoverage ||
+               before.eiVigor != cell.eiVigor || before.esVigor != cell.esVigor;
+    });
     
     enforceInvariants(grid);
 }
 
 void VegetationSystem::enforceInvariants(VegetationGrid& grid) {
     if (!grid.isValid()) return;
-    int size = static_cast<int>(grid.getSize());
 
-    #pragma omp parallel for
-    for (int i = 0; i < size; ++i) {
+    forEachTile(grid, [&](size_t, VegetationCell& cell) {
         // Invariant 1: EI + ES <= 1.0
-        float total = grid.ei_coverage[i] + grid.es_coverage[i];
+        float total = cell.eiCoverage + cell.esCoverage;
         if (total > 1.0f) {
             // Prioritize ES (Structural) over EI (Opportunistic)
             // Shrink EI to fit
             float excess = total - 1.0f;
-            grid.ei_coverage[i] -= excess;
-            if (grid.ei_coverage[i] < 0.0f) grid.ei_coverage[i] = 0.0f;
+            cell.eiCoverage -= excess;
+            if (cell.eiCoverage < 0.0f) cell.eiCoverage = 0.0f;
+            return true;
         }
-    }
+        return false;
+    });
 }
 
 void VegetationSystem::applyDisturbance(VegetationGrid& grid, const DisturbanceRegime& regime) {
@@ -260,6 +404,7 @@ void VegetationSystem::applyDisturbance(VegetationGrid& grid, const DisturbanceR
                  grid.ei_vigor[idx] = 0.0f; // Ash/Blackened
                  grid.es_vigor[idx] = 0.0f;
                  grid.recovery_timer[idx] = regime.averageRecoveryTime; 
+                 grid.touchTile(grid.tileOfIndex(static_cast<size_t>(idx)));
              }
          } 
          else if (regime.type == DisturbanceType::Grazing) {
@@ -271,6 +416,7 @@ void VegetationSystem::applyDisturbance(VegetationGrid& grid, const DisturbanceR
              // Vigor impact
              grid.ei_vigor[idx] -= removal * 0.5f;
              if (grid.ei_vigor[idx] < 0.2f) grid.ei_vigor[idx] = 0.2f;
+             grid.touchTile(grid.tileOfIndex(static_cast<size_t>(idx)));
          }
     }
 }
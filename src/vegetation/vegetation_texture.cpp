@@ -0,0 +1,157 @@
+#include "vegetation_texture.h"
+#include "../core/job_system.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VEG_TEXTURE_SSE2 1
+#endif
+
+namespace vegetation {
+
+namespace {
+
+// Same result as static_cast<uint8_t>(std::clamp(v, 0, 1) * 255) (truncating), NaN -> 0
+inline uint32_t toUnorm8(float v) {
+    float c = v > 0.0f ? (v < 1.0f ? v : 1.0f) : 0.0f;
+    return static_cast<uint32_t>(c * 255.0f);
+}
+
+// v4.7.0: Texels of `count` cells from `begin` (coverage/vigor are packed channels,
+// converted in tile-sized runs on the stack)
+void packCells(const VegetationGrid& grid, size_t begin, size_t count, uint8_t* out) {
+    constexpr size_t kRun = VegetationGrid::kTileSize;
+    float r[kRun], g[kRun], b[kRun], a[kRun];
+    for (size_t done = 0; done < count; done += kRun) {
+        const size_t n = std::min(kRun, count - done);
+        grid.ei_coverage.load(begin + done, n, r);
+        grid.es_coverage.load(begin + done, n, g);
+        grid.ei_vigor.load(begin + done, n, b);
+        grid.es_vigor.load(begin + done, n, a);
+        packRGBA8(r, g, b, a, n, out + done * 4);
+    }
+}
+
+} // namespace
+
+void packRGBA8(const float* r, const float* g, const float* b, const float* a,
+               size_t count, uint8_t* out) {
+    size_t i = 0;
+
+#ifdef VEG_TEXTURE_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+
+    // 4 texels per iteration: clamp, scale, truncate, then shift channels into one 32-bit texel
+    auto channel = [&](const float* src) {
+        __m128 v = _mm_loadu_ps(src);
+        v = _mm_min_ps(_mm_max_ps(v, zero), one); // max(NaN, 0) -> 0
+        return _mm_cvttps_epi32(_mm_mul_ps(v, scale));
+    };
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i texel = channel(r + i);
+        texel = _mm_or_si128(texel, _mm_slli_epi32(channel(g + i), 8));
+        texel = _mm_or_si128(texel, _mm_slli_epi32(channel(b + i), 16));
+        texel = _mm_or_si128(texel, _mm_slli_epi32(channel(a + i), 24));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), texel);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out[i * 4 + 0] = static_cast<uint8_t>(toUnorm8(r[i]));
+        out[i * 4 + 1] = static_cast<uint8_t>(toUnorm8(g[i]));
+        out[i * 4 + 2] = static_cast<uint8_t>(toUnorm8(b[i]));
+        out[i * 4 + 3] = static_cast<uint8_t>(toUnorm8(a[i]));
+    }
+}
+
+TextureTile VegetationTextureCache::tileRect(const VegetationGrid& grid, int t) const {
+    const int T = VegetationGrid::kTileSize;
+    TextureTile tile;
+    tile.x = (t % grid.tiles_x) * T;
+    tile.y = (t / grid.tiles_x) * T;
+    tile.width = std::min(T, grid.width - tile.x);
+    tile.height = std::min(T, grid.height - tile.y);
+    return tile;
+}
+
+const std::vector<TextureTile>& VegetationTextureCache::update(const VegetationGrid& grid) {
+    tiles_.clear();
+    if (!grid.isValid()) return tiles_;
+
+    const int tileCount = grid.tileCount();
+    const size_t rowPitch = static_cast<size_t>(grid.width) * 4;
+
+    // New grid (or first use): repack everything and report all tiles
+    if (grid.generation != generation_ || grid.width != width_ || grid.height != height_) {
+        width_ = grid.width;
+        height_ = grid.height;
+        generation_ = grid.generation;
+        pixels_.resize(rowPitch * static_cast<size_t>(height_));
+        seenVersion_.assign(grid.tile_version.begin(), grid.tile_version.end());
+
+        core::JobSystem::instance().parallelFor(0, height_, 0, [&](int rowBegin, int rowEnd) {
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                const size_t row = static_cast<size_t>(y) * static_cast<size_t>(width_);
+                packCells(grid, row, static_cast<size_t>(width_), pixels_.data() + row * 4);
+            }
+        });
+
+        tiles_.reserve(static_cast<size_t>(tileCount));
+        for (int t = 0; t < tileCount; ++t) tiles_.push_back(tileRect(grid, t));
+        return tiles_;
+    }
+
+    // Tiles the simulation touched since last time
+    candidates_.clear();
+    for (int t = 0; t < tileCount; ++t) {
+        if (grid.tile_version[static_cast<size_t>(t)] != seenVersion_[static_cast<size_t>(t)]) {
+            candidates_.push_back(t);
+            seenVersion_[static_cast<size_t>(t)] = grid.tile_version[static_cast<size_t>(t)];
+        }
+    }
+    if (candidates_.empty()) return tiles_;
+
+    // Repack touched tiles row by row; keep only those whose RGBA8 texels differ
+    // (sub-quantum drift in the float state does not cost an upload).
+    changed_.assign(candidates_.size(), 0);
+
+    core::JobSystem::instance().parallelFor(0, static_cast<int>(candidates_.size()), 1, [&](int candidateBegin, int candidateEnd) {
+        for (int c = candidateBegin; c < candidateEnd; ++c) {
+            const TextureTile tile = tileRect(grid, candidates_[static_cast<size_t>(c)]);
+            uint8_t scratch[VegetationGrid::kTileSize * 4];
+            const size_t bytes = static_cast<size_t>(tile.width) * 4;
+            bool changed = false;
+
+            for (int y = tile.y; y < tile.y + tile.height; ++y) {
+                const size_t src = static_cast<size_t>(y) * static_cast<size_t>(width_) + static_cast<size_t>(tile.x);
+                packCells(grid, src, static_cast<size_t>(tile.width), scratch);
+
+                uint8_t* dst = pixels_.data() + src * 4;
+                if (std::memcmp(dst, scratch, bytes) != 0) {
+                    std::memcpy(dst, scratch, bytes);
+                    changed = true;
+                }
+            }
+            changed_[static_cast<size_t>(c)] = changed ? 1 : 0;
+        }
+    });
+
+    for (size_t c = 0; c < candidates_.size(); ++c) {
+        if (changed_[c]) tiles_.push_back(tileRect(grid, candidates_[c]));
+    }
+    return tiles_;
+}
+
+void VegetationTextureCache::copyTile(const TextureTile& tile, uint8_t* dst) const {
+    const size_t bytes = static_cast<size_t>(tile.width) * 4;
+    for (int y = 0; y < tile.height; ++y) {
+        const size_t src = (static_cast<size_t>(tile.y + y) * static_cast<size_t>(width_) + static_cast<size_t>(tile.x)) * 4;
+        std::memcpy(dst + static_cast<size_t>(y) * bytes, pixels_.data() + src, bytes);
+    }
+}
+
+} // namespace vegetation
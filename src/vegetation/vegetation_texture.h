@@ -0,0 +1,60 @@
+#pragma once
+
+#include "vegetation_types.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace vegetation {
+
+    // v4.7.0: Packs four float channels [0,1] into interleaved RGBA8 texels.
+    // Matches static_cast<uint8_t>(clamp(v, 0, 1) * 255) exactly (SSE2 when available).
+    void packRGBA8(const float* r, const float* g, const float* b, const float* a,
+                   size_t count, uint8_t* out);
+
+    // Region of the vegetation texture, in texels (one VegetationGrid tile, clipped to the grid)
+    struct TextureTile {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+
+        size_t byteSize() const { return static_cast<size_t>(width) * static_cast<size_t>(height) * 4; }
+    };
+
+    // v4.7.0: CPU side of the vegetation texture streaming (no GPU dependency).
+    // Keeps the last packed RGBA8 image (R = EI coverage, G = ES coverage,
+    // B = EI vigor, A = ES vigor). update() only repacks tiles whose
+    // VegetationGrid::tile_version moved and reports the ones whose texels
+    // actually differ, so the renderer uploads just those regions.
+    class VegetationTextureCache {
+    public:
+        // Returns the tiles that changed since the previous call (all tiles after a
+        // resize, a new grid generation or invalidate()).
+        const std::vector<TextureTile>& update(const VegetationGrid& grid);
+
+        // Copies a tile as tightly packed rows (tile.width * 4 bytes per row)
+        void copyTile(const TextureTile& tile, uint8_t* dst) const;
+
+        // Forces the next update() to report every tile (e.g. GPU image recreated)
+        void invalidate() { generation_ = 0; }
+
+        const std::vector<uint8_t>& pixels() const { return pixels_; }
+        int width() const { return width_; }
+        int height() const { return height_; }
+
+    private:
+        TextureTile tileRect(const VegetationGrid& grid, int t) const;
+
+        int width_ = 0;
+        int height_ = 0;
+        uint64_t generation_ = 0;
+        std::vector<uint32_t> seenVersion_;
+        std::vector<uint8_t> pixels_;   // width_ * height_ * 4
+        std::vector<int> candidates_;
+        std::vector<uint8_t> changed_;
+        std::vector<TextureTile> tiles_;
+    };
+
+} // namespace vegetation
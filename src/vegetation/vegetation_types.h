@@ -2,6 +2,10 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "../core/grid_arena.h"
+#include "../core/packed_channel.h"
 
 namespace vegetation {
 
@@ -41,37 +45,76 @@ namespace vegetation {
 
         // Data Arrays (aligned for potential SIMD usage)
         // Index = y * width + x
+        // v4.7.0: Coverage and vigor are stored as unorm16 (PackedChannel); kernels
+        // convert a row at a time
         
         // Lower Stratum (Estrato Inferior - EI) e.g., Grass
-        std::vector<float> ei_coverage; // [0.0 - 1.0]
-        std::vector<float> ei_vigor;    // [0.0 - 1.0] (Health/Greenness)
-        std::vector<float> ei_capacity; // [0.0 - 1.0] Max Capacity (Cached Noise)
+        core::PackedChannel ei_coverage{core::ChannelPrecision::Unorm16}; // [0.0 - 1.0]
+        core::PackedChannel ei_vigor{core::ChannelPrecision::Unorm16};    // [0.0 - 1.0] (Health/Greenness)
+        core::GridVector<float> ei_capacity; // [0.0 - 1.0] Max Capacity (Cached Noise)
 
         // Upper Stratum (Estrato Superior - ES) e.g., Shrubs/Trees
-        std::vector<float> es_coverage; // [0.0 - 1.0]
-        std::vector<float> es_vigor;    // [0.0 - 1.0]
-        std::vector<float> es_capacity; // [0.0 - 1.0] Max Capacity (Cached)
+        core::PackedChannel es_coverage{core::ChannelPrecision::Unorm16}; // [0.0 - 1.0]
+        core::PackedChannel es_vigor{core::ChannelPrecision::Unorm16};    // [0.0 - 1.0]
+        core::GridVector<float> es_capacity; // [0.0 - 1.0] Max Capacity (Cached)
         
         // Ecological Memory / Hysteresis
         // Usage: Counts down time until recovery begins, or accumulates stress
-        std::vector<float> recovery_timer; 
+        core::GridVector<float> recovery_timer; 
+
+        // v4.7.0: Dirty-tile tracking for incremental consumers (texture streaming).
+        // VegetationSystem bumps tile_version[t] whenever a visible channel
+        // (coverage/vigor) changes inside tile t; consumers keep the versions they
+        // last saw. generation is unique per resize so a fresh grid never aliases
+        // an older one with matching versions.
+        static constexpr int kTileSize = 64;
+        int tiles_x = 0;
+        int tiles_y = 0;
+        core::GridVector<uint32_t> tile_version;
+        uint64_t generation = 0;
 
         // Helpers
-        void resize(int w, int h) {
-            width = w;
-            height = h;
-            size_t size = static_cast<size_t>(w * h);
+        void describe(core::GridLayout& layout) {
+            width = layout.width();
+            height = layout.height();
             
             // Initialization Logic (Avoid Bias: Start with mixed state or pure EI depending on design)
             // For now, initializing with full Grass (EI) and no Shrubs (ES) as baseline.
             // Complex initialization should be done by TerrainGenerator/VegetationSystem.
-            ei_coverage.assign(size, 1.0f); 
-            es_coverage.assign(size, 0.0f); 
-            ei_vigor.assign(size, 1.0f);
-            es_vigor.assign(size, 1.0f);
-            recovery_timer.assign(size, 0.0f);
-            ei_capacity.assign(size, 1.0f); // Default full capacity
-            es_capacity.assign(size, 1.0f);
+            layout.add("veg.ei_coverage", ei_coverage, 1.0f); 
+            layout.add("veg.es_coverage", es_coverage, 0.0f); 
+            layout.add("veg.ei_vigor", ei_vigor, 1.0f);
+            layout.add("veg.es_vigor", es_vigor, 1.0f);
+            layout.add("veg.recovery_timer", recovery_timer, 0.0f);
+            layout.add("veg.ei_capacity", ei_capacity, 1.0f); // Default full capacity
+            layout.add("veg.es_capacity", es_capacity, 1.0f);
+
+            tiles_x = (width + kTileSize - 1) / kTileSize;
+            tiles_y = (height + kTileSize - 1) / kTileSize;
+            layout.add("veg.tile_version", tile_version, 0u, static_cast<size_t>(tiles_x * tiles_y));
+            generation = nextGeneration();
+        }
+
+        void resize(int w, int h) {
+            core::GridLayout layout(w, h);
+            describe(layout);
+            layout.apply();
+        }
+
+        int tileCount() const { return tiles_x * tiles_y; }
+        int tileOfIndex(size_t i) const {
+            int x = static_cast<int>(i % static_cast<size_t>(width));
+            int y = static_cast<int>(i / static_cast<size_t>(width));
+            return (y / kTileSize) * tiles_x + x / kTileSize;
+        }
+        void touchTile(int t) { ++tile_version[static_cast<size_t>(t)]; }
+        void touchAll() {
+            for (auto& v : tile_version) ++v;
+        }
+
+        static uint64_t nextGeneration() {
+            static std::atomic<uint64_t> counter{0};
+            return ++counter;
         }
 
         size_t getSize() const { return ei_coverage.size(); }
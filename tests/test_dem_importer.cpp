@@ -0,0 +1,289 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../src/terrain/dem_importer.h"
+#include "../src/terrain/terrain_pipeline.h"
+#include "test_helpers.h"
+
+using namespace terrain;
+namespace fs = std::filesystem;
+
+using test_helpers::tempFile;
+
+static float parse(const char* s, size_t* consumed = nullptr) {
+    float v = -1.0f;
+    const char* end = DemImporter::parseFloat(s, s + std::strlen(s), v);
+    if (consumed) *consumed = static_cast<size_t>(end - s);
+    return v;
+}
+
+void test_parse_float() {
+    std::cout << "Running test_parse_float..." << std::endl;
+    assert(parse("0") == 0.0f);
+    assert(parse("42") == 42.0f);
+    assert(parse("-3.25") == -3.25f);
+    assert(parse("+.5") == 0.5f);
+    assert(parse("7.") == 7.0f);
+    assert(parse("1e3") == 1000.0f);
+    assert(parse("2.5E-2") == std::strtof("2.5E-2", nullptr));
+    assert(parse("-9999") == -9999.0f);
+    assert(parse("0.000123456") == std::strtof("0.000123456", nullptr));
+    assert(parse("1234.5678") == std::strtof("1234.5678", nullptr));
+    // More digits than the mantissa holds
+    assert(std::fabs(parse("12345678901234567890123") - 1.2345679e22f) < 1e16f);
+
+    size_t n = 0;
+    parse("12.5 7", &n);
+    assert(n == 4);
+    parse("3e", &n); // Dangling exponent is not part of the number
+    assert(n == 1);
+    parse("abc", &n);
+    assert(n == 0);
+    parse("-", &n);
+    assert(n == 0);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_ascii_grid() {
+    std::cout << "Running test_ascii_grid..." << std::endl;
+    const std::string path = tempFile("sister_test_dem.asc");
+    {
+        std::ofstream f(path);
+        f << "NCOLS 4\nnrows 3\nxllcenter 1000.5\nyllcorner 2000\ncellsize 30\nNODATA_value -9999\n";
+        f << "1 2 3 4\n5 -9999 7 8\n\t9.5 10 11 1.2e1\n";
+    }
+    DemGrid header;
+    assert(DemImporter::probe(path, header));
+    assert(header.width == 4 && header.height == 3 && header.cellSize == 30.0);
+    assert(header.xllCorner == 985.5 && header.yllCorner == 2000.0);
+    assert(header.hasNodata && header.nodata == -9999.0f);
+    assert(header.heights.empty());
+
+    DemGrid grid;
+    assert(DemImporter::read(path, grid));
+    assert(grid.heights.size() == 12);
+    assert(grid.heights[0] == 1.0f && grid.heights[3] == 4.0f);
+    assert(std::isnan(grid.heights[5]));
+    assert(grid.heights[8] == 9.5f && grid.heights[11] == 12.0f);
+
+    size_t filled = 0;
+    assert(DemImporter::fillNodata(grid, &filled));
+    assert(filled == 1);
+    assert(!std::isnan(grid.heights[5]) && grid.heights[5] > 1.0f && grid.heights[5] < 12.0f);
+
+    // Too few values
+    {
+        std::ofstream f(path);
+        f << "ncols 4\nnrows 3\ncellsize 1\n1 2 3 4 5 6 7 8 9 10 11\n";
+    }
+    std::string error;
+    assert(!DemImporter::read(path, grid, &error));
+    assert(!error.empty());
+    // Garbage value
+    {
+        std::ofstream f(path);
+        f << "ncols 2\nnrows 2\ncellsize 1\n1 2 x 4\n";
+    }
+    assert(!DemImporter::read(path, grid, &error));
+    fs::remove(path);
+    std::cout << "PASSED" << std::endl;
+}
+
+template <typename T>
+static void writeRaw(const std::string& path, const std::vector<T>& values, bool bigEndian) {
+    std::ofstream f(path, std::ios::binary);
+    for (T v : values) {
+        unsigned char b[sizeof(T)];
+        std::memcpy(b, &v, sizeof(T));
+        if (bigEndian) std::reverse(b, b + sizeof(T));
+        f.write(reinterpret_cast<const char*>(b), sizeof(T));
+    }
+}
+
+void test_binary_raster() {
+    std::cout << "Running test_binary_raster..." << std::endl;
+    const std::string flt = tempFile("sister_test_dem.flt");
+    const std::string hdr = tempFile("sister_test_dem.hdr");
+    writeRaw<float>(flt, {10.5f, 11.0f, -1.0f, 12.0f, 13.25f, 14.0f}, false);
+    {
+        std::ofstream f(hdr);
+        f << "ncols 3\nnrows 2\ncellsize 5\nnodata_value -1\nbyteorder LSBFIRST\n";
+    }
+    DemGrid grid;
+    assert(DemImporter::read(flt, grid));
+    assert(grid.width == 3 && grid.height == 2 && grid.cellSize == 5.0);
+    assert(grid.heights[0] == 10.5f && grid.heights[4] == 13.25f && std::isnan(grid.heights[2]));
+
+    // Big-endian 16-bit integers (SRTM style)
+    const std::string bil = tempFile("sister_test_dem.bil");
+    writeRaw<int16_t>(bil, {100, -20, 300, 400}, true);
+    {
+        std::ofstream f(hdr);
+        f << "BYTEORDER M\nNROWS 2\nNCOLS 2\nNBITS 16\nPIXELTYPE SIGNEDINT\nXDIM 30\nYDIM 30\ndx 30\ndy 30\n";
+    }
+    assert(DemImporter::read(bil, grid));
+    assert(grid.heights == std::vector<float>({100.0f, -20.0f, 300.0f, 400.0f}));
+    assert(!grid.hasNodata);
+
+    // Truncated file
+    {
+        std::ofstream f(hdr);
+        f << "ncols 3\nnrows 3\ncellsize 1\nnbits 16\npixeltype signedint\n";
+    }
+    std::string error;
+    assert(!DemImporter::read(bil, grid, &error));
+    fs::remove(bil);
+    fs::remove(flt);
+    fs::remove(hdr);
+    assert(!DemImporter::read(flt, grid, &error));
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_fill_and_resample() {
+    std::cout << "Running test_fill_and_resample..." << std::endl;
+    DemGrid grid;
+    grid.width = 5;
+    grid.height = 5;
+    grid.cellSize = 10.0;
+    grid.heights.assign(25, std::nanf(""));
+    assert(!DemImporter::fillNodata(grid));
+    grid.heights[12] = 50.0f;
+    size_t filled = 0;
+    assert(DemImporter::fillNodata(grid, &filled));
+    assert(filled == 24);
+    for (float v : grid.heights) assert(v == 50.0f);
+
+    // A plane resamples exactly
+    for (int y = 0; y < 5; ++y)
+        for (int x = 0; x < 5; ++x) grid.heights[static_cast<size_t>(y * 5 + x)] = 2.0f * static_cast<float>(x) + 3.0f * static_cast<float>(y);
+    int w = 0, h = 0;
+    DemImporter::targetSize(grid, 4.0f, w, h);
+    assert(w == 11 && h == 11); // 40 m extent, 4 m cells
+    core::GridVector<float> out;
+    DemImporter::resample(grid, w, h, 4.0f, out);
+    for (int z = 0; z < h; ++z) {
+        for (int x = 0; x < w; ++x) {
+            const float expected = (2.0f * static_cast<float>(x) + 3.0f * static_cast<float>(z)) * 0.4f;
+            assert(std::fabs(out[static_cast<size_t>(z * w + x)] - expected) < 1e-4f);
+        }
+    }
+    DemImporter::targetSize(grid, 10.0f, w, h);
+    DemImporter::resample(grid, w, h, 10.0f, out);
+    assert(std::equal(out.begin(), out.end(), grid.heights.begin(), grid.heights.end()));
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_pipeline_import() {
+    std::cout << "Running test_pipeline_import..." << std::endl;
+    const std::string path = tempFile("sister_test_pipeline.asc");
+    {
+        std::ofstream f(path);
+        f << "ncols 64\nnrows 48\nxllcorner 0\nyllcorner 0\ncellsize 2\nnodata_value -9999\n";
+        for (int y = 0; y < 48; ++y) {
+            for (int x = 0; x < 64; ++x) {
+                const bool hole = x > 20 && x < 24 && y > 10 && y < 13;
+                f << (hole ? -9999.0f : 500.0f + 0.5f * static_cast<float>(x) + std::sin(static_cast<float>(y) * 0.3f) * 4.0f) << ' ';
+            }
+            f << '\n';
+        }
+    }
+
+    RegenerationInputs in;
+    in.config.model = TerrainConfig::FiniteTerrainModel::ImportedDem;
+    in.config.demPath = path;
+    in.config.resolution = 1.0f;
+    DemGrid header;
+    assert(DemImporter::probe(path, header));
+    DemImporter::targetSize(header, in.config.resolution, in.config.width, in.config.height);
+    assert(in.config.width == 127 && in.config.height == 95);
+
+    TerrainMap map(in.config.width, in.config.height);
+    TerrainPipeline pipeline;
+    pipeline.regenerate(map, in);
+    for (float v : map.heightMap()) assert(v >= 490.0f && v <= 540.0f); // Absolute elevations kept
+    assert(map.getHeight(0, 0) == 500.0f);
+
+    // Same file: the base stage is memoized
+    pipeline.regenerate(map, in);
+    assert(pipeline.reusesBaseTerrain(in));
+
+    // Unreadable file surfaces as an exception, not a flat world
+    in.config.demPath = tempFile("sister_missing.asc");
+    bool threw = false;
+    try {
+        TerrainMap other(in.config.width, in.config.height);
+        TerrainPipeline fresh;
+        fresh.regenerate(other, in);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    fs::remove(path);
+    std::cout << "PASSED" << std::endl;
+}
+
+void bench_ascii_parse() {
+    std::cout << "Running bench_ascii_parse..." << std::endl;
+    const int n = 4096;
+    const std::string path = tempFile("sister_bench_dem.asc");
+    {
+        std::ofstream f(path);
+        f << "ncols " << n << "\nnrows " << n << "\nxllcorner 0\nyllcorner 0\ncellsize 30\nnodata_value -9999\n";
+        std::string line;
+        char buf[32];
+        for (int y = 0; y < n; ++y) {
+            line.clear();
+            for (int x = 0; x < n; ++x) {
+                std::snprintf(buf, sizeof(buf), "%.3f ", 800.0 + 0.01 * x + 0.02 * y);
+                line += buf;
+            }
+            line += '\n';
+            f << line;
+        }
+    }
+    const double mb = static_cast<double>(fs::file_size(path)) / (1024.0 * 1024.0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    DemGrid grid;
+    assert(DemImporter::read(path, grid));
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    // Reference: strtof per value
+    t0 = std::chrono::steady_clock::now();
+    {
+        std::ifstream f(path);
+        std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        const char* p = text.c_str();
+        for (int i = 0; i < 6; ++i) p = std::strchr(p, '\n') + 1;
+        std::vector<float> ref(static_cast<size_t>(n) * n);
+        for (float& v : ref) v = std::strtof(p, const_cast<char**>(&p));
+        for (size_t i = 0; i < ref.size(); ++i) assert(std::fabs(ref[i] - grid.heights[i]) <= 1e-6f * std::fabs(ref[i]));
+    }
+    double refMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "  " << n << "x" << n << " (" << mb << " MB): importer " << ms << " ms, strtof loop " << refMs << " ms" << std::endl;
+    fs::remove(path);
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_parse_float();
+    test_ascii_grid();
+    test_binary_raster();
+    test_fill_and_resample();
+    test_pipeline_import();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_ascii_parse();
+    }
+    std::cout << "All DEM importer tests passed!" << std::endl;
+    return 0;
+}
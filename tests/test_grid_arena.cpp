@@ -0,0 +1,295 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <unistd.h>
+#include <vector>
+#include "../src/core/grid_arena.h"
+#include "../src/terrain/terrain_map.h"
+#include "test_helpers.h"
+
+using core::GridArena;
+using core::GridVector;
+
+static bool aligned(const void* p) {
+    return reinterpret_cast<uintptr_t>(p) % GridArena::kAlignment == 0;
+}
+
+void test_layout_values_and_alignment() {
+    std::cout << "Running test_layout_values_and_alignment..." << std::endl;
+    auto arena = std::make_shared<GridArena>();
+    GridVector<float> a;
+    GridVector<uint8_t> b;
+    GridVector<int> c;
+    GridVector<uint32_t> perTile;
+    core::GridLayout layout(37, 29, arena);
+    layout.add("a", a, 1.5f);
+    layout.add("b", b, static_cast<uint8_t>(255));
+    layout.add("c", c, -1);
+    layout.add("perTile", perTile, 7u, 4);
+    layout.apply();
+
+    assert(a.size() == 37 * 29 && b.size() == a.size() && c.size() == a.size() && perTile.size() == 4);
+    for (float v : a) assert(v == 1.5f);
+    for (uint8_t v : b) assert(v == 255);
+    for (int v : c) assert(v == -1);
+    for (uint32_t v : perTile) assert(v == 7u);
+    assert(aligned(a.data()) && aligned(b.data()) && aligned(c.data()) && aligned(perTile.data()));
+    assert(arena->regionCount() == 1);
+
+    // Without an arena: aligned heap blocks
+    GridVector<float> heap(1001, 2.0f);
+    assert(aligned(heap.data()) && heap.get_allocator().arena() == nullptr);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_map_channels_share_one_region() {
+    std::cout << "Running test_map_channels_share_one_region..." << std::endl;
+    terrain::TerrainMap map(300, 200);
+    const GridArena& arena = map.arena();
+    assert(arena.regionCount() == 1);
+    const auto* soil = map.getLandscapeSoil();
+    const auto* veg = map.getVegetation();
+    const auto* hydro = map.getLandscapeHydro();
+    assert(soil->depth.get_allocator().arena().get() == &arena);
+    assert(aligned(soil->soil_type.data()) && aligned(veg->ei_coverage.data()) && aligned(hydro->sort_order.data()));
+
+    // Defaults as before
+    assert(soil->depth[123] == 1.0f && soil->soil_type[5] == static_cast<uint8_t>(landscape::SoilType::Undefined));
+    assert(hydro->receiver_index[77] == -1 && map.flowDirMap()[9] == -1);
+    assert(veg->ei_coverage[0] == 1.0f && veg->es_coverage[0] == 0.0f);
+    assert(veg->tile_version.size() == static_cast<size_t>(veg->tileCount()));
+
+    // Same size again: the region and every channel address are reused
+    const void* region = map.heightMap().data();
+    const size_t capacity = arena.capacity();
+    const uint64_t generation = veg->generation;
+    map.getLandscapeSoil()->depth[123] = 0.25f;
+    map.resize(300, 200);
+    assert(map.heightMap().data() == region && arena.capacity() == capacity && arena.regionCount() == 1);
+    assert(soil->depth[123] == 1.0f && veg->generation != generation);
+
+    // Smaller fits in place; larger takes one new region
+    map.resize(100, 100);
+    assert(map.heightMap().data() == region && arena.regionCount() == 1);
+    map.resize(600, 400);
+    assert(arena.regionCount() == 1 && arena.capacity() >= arena.used());
+    assert(map.getLandscapeSoil()->getSize() == 600u * 400u);
+
+    // Copies (pipeline snapshots, simulation frames) go to the heap
+    landscape::SoilGrid copy = *map.getLandscapeSoil();
+    assert(copy.depth.get_allocator().arena() == nullptr && copy.depth == map.getLandscapeSoil()->depth);
+    // Copy-assignment into the map keeps its arena storage
+    const float* depthData = map.getLandscapeSoil()->depth.data();
+    *map.getLandscapeSoil() = copy;
+    assert(map.getLandscapeSoil()->depth.data() == depthData);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_live_blocks_and_recycling() {
+    std::cout << "Running test_live_blocks_and_recycling..." << std::endl;
+    auto arena = std::make_shared<GridArena>();
+    GridVector<float> kept(GridVector<float>::allocator_type{arena});
+    kept.assign(1000, 3.0f);
+    // A block is still live: no rewind, the next blocks go after it
+    assert(!arena->reset(4096));
+    GridVector<float> more(GridVector<float>::allocator_type{arena});
+    more.assign(1000, 4.0f);
+    for (float v : kept) assert(v == 3.0f);
+    kept = GridVector<float>();
+    more = GridVector<float>();
+    assert(arena->reset(4096) && arena->used() == 0);
+
+    // A destroyed world's region is handed to the next one of similar size
+    const void* region = nullptr;
+    {
+        terrain::TerrainMap first(512, 512);
+        region = first.heightMap().data();
+    }
+    terrain::TerrainMap second(512, 512);
+    assert(second.heightMap().data() == region);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_huge_pages() {
+    std::cout << "Running test_huge_pages..." << std::endl;
+    core::GridArenaConfig config;
+    config.hugePages = true;
+    GridArena::configure(config);
+    {
+        terrain::TerrainMap map(256, 256);
+        assert(map.arena().hugePages());
+        assert(map.getLandscapeSoil()->depth[1000] == 1.0f);
+    }
+    GridArena::configure({});
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_lazy_channels() {
+    std::cout << "Running test_lazy_channels..." << std::endl;
+    auto arena = std::make_shared<GridArena>();
+    GridVector<float> eager;
+    GridVector<int> lazy;
+    core::GridLayout layout(64, 32, arena);
+    layout.add("eager", eager, 1.0f);
+    layout.addLazy("lazy", lazy, -3);
+    layout.apply();
+    assert(eager.size() == 64 * 32 && lazy.empty());
+    assert(layout.isLazy("lazy") && !layout.isAllocated("lazy") && layout.isAllocated("eager"));
+
+    auto usage = layout.usage();
+    assert(usage.size() == 2 && usage[1].name == "lazy" && usage[1].state == core::ChannelState::Lazy);
+    assert(usage[1].bytes == 0 && usage[1].reserved == GridArena::roundUp(64 * 32 * sizeof(int)));
+
+    // First write: allocated inside the reserved space, filled with its default
+    const size_t capacity = arena->capacity();
+    assert(layout.materialize(lazy) && lazy.size() == 64 * 32 && aligned(lazy.data()));
+    for (int v : lazy) assert(v == -3);
+    assert(arena->capacity() == capacity && arena->regionCount() == 1);
+    assert(layout.usage()[1].state == core::ChannelState::Allocated);
+
+    // Released: empty again, re-materialized with the default
+    lazy[0] = 9;
+    assert(layout.release("lazy") && lazy.empty() && layout.usage()[1].state == core::ChannelState::Lazy);
+    assert(layout.materialize("lazy") && lazy[0] == -3);
+    assert(!layout.materialize("unknown"));
+
+    // A new apply() leaves it lazy
+    layout.apply();
+    assert(lazy.empty() && eager.size() == 64 * 32);
+
+    terrain::TerrainMap map(120, 80);
+    const terrain::TerrainMap& view = map;
+    assert(view.moistureMap().empty() && view.sedimentMap().empty() && view.biomeMap().empty() && view.watershedMap().empty());
+    assert(!map.hasChannel("watershed") && map.isLazyChannel("watershed") && !map.isLazyChannel("height"));
+    assert(view.getMoisture(3, 3) == 0.0f);
+    const size_t before = map.allocatedBytes();
+    map.watershedMap()[5] = 7; // Allocated on first write
+    assert(map.hasChannel("watershed") && view.watershedMap().size() == 120u * 80u && view.watershedMap()[6] == 0);
+    assert(map.allocatedBytes() == before + GridArena::roundUp(120 * 80 * sizeof(int)));
+    map.setMoisture(1, 1, 0.5f);
+    assert(view.getMoisture(1, 1) == 0.5f && view.getMoisture(2, 1) == 0.0f);
+    assert(!map.releaseChannel("height") && map.releaseChannel("moisture") && view.moistureMap().empty());
+    map.clear();
+    assert(view.watershedMap().empty());
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_shared_soil_view() {
+    std::cout << "Running test_shared_soil_view..." << std::endl;
+    terrain::TerrainMap map(90, 70);
+    auto& types = map.getLandscapeSoil()->soil_type;
+    types[0] = static_cast<uint8_t>(landscape::SoilType::Latossolo);
+    map.setSoil(1, 0, terrain::SoilType::Argila);
+
+    const size_t own = map.allocatedBytes();
+    map.shareSoilTypes(true);
+    assert(map.soilShared() && map.soilMap().data() == types.data() && map.hasChannel("soil"));
+    assert(map.allocatedBytes() == own - GridArena::roundUp(90 * 70));
+    bool reported = false;
+    for (const auto& u : map.memoryReport()) {
+        if (u.name == "soil") reported = u.state == core::ChannelState::Shared && u.bytes == 0;
+    }
+    assert(reported);
+
+    // Undefined reads as None; the classification is seen without a copy
+    assert(map.getSoil(0, 0) == terrain::SoilType::Latossolo && map.getSoil(1, 0) == terrain::SoilType::None);
+    types[2] = static_cast<uint8_t>(landscape::SoilType::Gleissolo);
+    assert(map.getSoil(2, 0) == terrain::SoilType::Gleissolo);
+    map.markAllDirty();
+    assert(map.pyramid().level(1).soil[0] != static_cast<uint8_t>(landscape::SoilType::Undefined));
+
+    // A SCORPAN domain hides other orders from the view only; widening it shows them again
+    for (size_t i : {size_t(3), size_t(92), size_t(93)}) types[i] = static_cast<uint8_t>(landscape::SoilType::Gleissolo);
+    map.markAllDirty();
+    map.setSoilDomain(terrain::soilMaskOf(terrain::SoilType::Latossolo));
+    assert(map.getSoil(0, 0) == terrain::SoilType::Latossolo && map.getSoil(2, 0) == terrain::SoilType::None);
+    assert(types[2] == static_cast<uint8_t>(landscape::SoilType::Gleissolo));
+    assert(map.pyramid().level(1).soil[1] == static_cast<uint8_t>(terrain::SoilType::None)); // Cells (2..3, 0..1)
+    map.setSoilDomain(map.soilDomain() | terrain::soilMaskOf(terrain::SoilType::Gleissolo));
+    assert(map.getSoil(2, 0) == terrain::SoilType::Gleissolo);
+    assert(map.pyramid().level(1).soil[1] == static_cast<uint8_t>(terrain::SoilType::Gleissolo));
+
+    // Unshared: an own buffer again, cleared to None
+    map.shareSoilTypes(false);
+    assert(!map.soilShared() && map.soilMap().data() != types.data());
+    assert(map.getSoil(0, 0) == terrain::SoilType::None && map.allocatedBytes() == own);
+    std::cout << "PASSED" << std::endl;
+}
+
+static size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Resident memory of a 2048^2 world, then with every lazy channel written and
+// the soil map unshared (the previous, eager layout)
+void bench_world_memory() {
+    std::cout << "Running bench_world_memory..." << std::endl;
+    const int n = 2048;
+    terrain::TerrainMap map(n, n);
+    map.shareSoilTypes(true); // SCORPAN mode
+    const size_t lazyResident = residentBytes();
+    const size_t lazyAllocated = map.allocatedBytes();
+
+    for (const auto& u : map.memoryReport()) {
+        if (map.isLazyChannel(u.name)) map.allocateChannel(u.name);
+    }
+    map.shareSoilTypes(false);
+    const size_t eagerResident = residentBytes();
+    const size_t eagerAllocated = map.allocatedBytes();
+    std::cout << "  allocated: " << lazyAllocated / (1 << 20) << " MiB lazy vs " << eagerAllocated / (1 << 20)
+              << " MiB eager, resident saving: " << (eagerResident - lazyResident) / (1 << 20) << " MiB" << std::endl;
+    assert(eagerAllocated - lazyAllocated == GridArena::roundUp(size_t(n) * n * 4) * 3 + GridArena::roundUp(size_t(n) * n) * 2);
+    assert(eagerResident > lazyResident);
+    std::cout << "PASSED" << std::endl;
+}
+
+// Back-to-back regenerations of a 2048^2 world: separate vectors, then the arena
+void bench_regeneration_allocations() {
+    std::cout << "Running bench_regeneration_allocations..." << std::endl;
+    using Clock = std::chrono::steady_clock;
+    const int n = 2048;
+    auto timeIt = [](auto&& body) {
+        const auto t0 = Clock::now();
+        body();
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    };
+
+    // Previous behaviour: ~35 std::vectors assigned serially
+    double vectorsMs = 0.0;
+    for (int round = 0; round < 3; ++round) {
+        vectorsMs += timeIt([&]() {
+            std::vector<std::vector<float>> channels(35);
+            for (auto& c : channels) c.assign(static_cast<size_t>(n) * n, 1.0f);
+        });
+    }
+    double arenaMs = 0.0;
+    {
+        terrain::TerrainMap map(n, n);
+        for (int round = 0; round < 3; ++round) {
+            arenaMs += timeIt([&]() { map.resize(n, n); });
+        }
+    }
+    std::cout << "  separate vectors: " << vectorsMs / 3.0 << " ms/world, arena: " << arenaMs / 3.0 << " ms/world" << std::endl;
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_layout_values_and_alignment();
+    test_map_channels_share_one_region();
+    test_live_blocks_and_recycling();
+    test_huge_pages();
+    test_lazy_channels();
+    test_shared_soil_view();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_regeneration_allocations();
+        bench_world_memory();
+    }
+    std::cout << "All grid arena tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// Fixtures shared by the tests/test_*.cpp programs
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include "../src/terrain/terrain_pipeline.h"
+
+namespace test_helpers {
+
+// Procedural world with SCORPAN soils; callers tweak the rest
+inline terrain::RegenerationInputs smallInputs(int w, int h, int seed) {
+    terrain::RegenerationInputs in;
+    in.config.width = w;
+    in.config.height = h;
+    in.config.seed = seed;
+    in.soilMode = 1;
+    return in;
+}
+
+// Fully regenerated world built from smallInputs()
+inline std::unique_ptr<terrain::TerrainMap> makeWorld(int w, int h, int seed) {
+    terrain::RegenerationInputs in = smallInputs(w, h, seed);
+    auto map = std::make_unique<terrain::TerrainMap>(w, h);
+    terrain::TerrainPipeline pipeline;
+    pipeline.regenerate(*map, in);
+    return map;
+}
+
+inline std::string tempFile(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Scratch directory path; anything left from a previous run is removed
+inline std::string tempDir(const char* name) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    return dir.string();
+}
+
+// Micro-benchmarks are opt-in: `test_<name> --bench`
+inline bool benchRequested(int argc, char** argv) {
+    return argc > 1 && std::string(argv[1]) == "--bench";
+}
+
+} // namespace test_helpers
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../src/core/job_system.h"
+
+using core::JobSystem;
+
+void test_dependencies() {
+    std::cout << "Running test_dependencies..." << std::endl;
+    JobSystem jobs({3, false});
+    for (int round = 0; round < 200; ++round) {
+        std::mutex m;
+        std::vector<char> order;
+        auto log = [&](char c) { std::lock_guard<std::mutex> lock(m); order.push_back(c); };
+
+        // Diamond: a -> (b, c) -> d
+        auto a = jobs.submit([&]() { log('a'); });
+        auto b = jobs.submit([&]() { log('b'); }, {a});
+        auto c = jobs.submit([&]() { log('c'); }, {a});
+        auto d = jobs.submit([&]() { log('d'); }, {b, c});
+        d.get();
+        assert(a.done() && b.done() && c.done());
+        assert(order.size() == 4 && order.front() == 'a' && order.back() == 'd');
+    }
+
+    // Dependency already finished at submission
+    auto first = jobs.submit([]() {});
+    first.wait();
+    std::atomic<bool> ran{false};
+    jobs.submit([&]() { ran = true; }, {first}).get();
+    assert(ran);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_failure_propagates() {
+    std::cout << "Running test_failure_propagates..." << std::endl;
+    JobSystem jobs({2, false});
+    std::atomic<bool> dependentRan{false};
+    auto bad = jobs.submit([]() { throw std::runtime_error("stage failed"); });
+    auto dependent = jobs.submit([&]() { dependentRan = true; }, {bad});
+    bool caught = false;
+    try {
+        dependent.get();
+    } catch (const std::runtime_error& e) {
+        caught = std::string(e.what()) == "stage failed";
+    }
+    assert(caught && !dependentRan);
+
+    caught = false;
+    try {
+        jobs.parallelFor(0, 1000, 10, [](int begin, int) {
+            if (begin == 500) throw std::runtime_error("chunk");
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    assert(caught);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_parallel_for() {
+    std::cout << "Running test_parallel_for..." << std::endl;
+    JobSystem jobs({3, false});
+    for (int grain : {0, 1, 7, 64, 5000}) {
+        std::vector<std::atomic<int>> hits(4321);
+        jobs.parallelFor(0, 4321, grain, [&](int begin, int end) {
+            assert(begin < end && (grain == 0 || end - begin <= grain));
+            for (int i = begin; i < end; ++i) hits[static_cast<size_t>(i)]++;
+        });
+        for (auto& h : hits) assert(h == 1);
+    }
+    jobs.parallelFor(5, 5, 0, [](int, int) { assert(false); });
+
+    // Chunk order, not scheduling, decides the result
+    const double sum = jobs.parallelReduce(0, 100000, 333, 0.0,
+        [](int begin, int end) {
+            double s = 0.0;
+            for (int i = begin; i < end; ++i) s += 1.0 / (1.0 + i);
+            return s;
+        },
+        [](double x, double y) { return x + y; });
+    for (int k = 0; k < 10; ++k) {
+        assert(jobs.parallelReduce(0, 100000, 333, 0.0,
+            [](int begin, int end) {
+                double s = 0.0;
+                for (int i = begin; i < end; ++i) s += 1.0 / (1.0 + i);
+                return s;
+            },
+            [](double x, double y) { return x + y; }) == sum);
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_nested_and_waiting_jobs() {
+    std::cout << "Running test_nested_and_waiting_jobs..." << std::endl;
+    JobSystem jobs({2, false});
+    // More jobs that each fan out and wait than there are workers: waiting threads must help
+    std::atomic<long long> total{0};
+    std::vector<JobSystem::Handle> outer;
+    for (int j = 0; j < 16; ++j) {
+        outer.push_back(jobs.submit([&]() {
+            jobs.parallelFor(0, 1000, 10, [&](int begin, int end) {
+                jobs.parallelFor(begin, end, 3, [&](int b, int e) { total += e - b; });
+            });
+            auto inner = jobs.submit([&]() { total += 1; });
+            inner.get();
+        }));
+    }
+    for (auto& h : outer) h.get();
+    assert(total == 16 * 1001);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_affinity_and_background() {
+    std::cout << "Running test_affinity_and_background..." << std::endl;
+    JobSystem jobs({3, true});
+    assert(jobs.currentWorker() == -1);
+    for (int w = 0; w < jobs.workerCount(); ++w) {
+        std::atomic<int> ranOn{-2};
+        core::JobOptions options;
+        options.affinity = w;
+        jobs.submit([&]() { ranOn = jobs.currentWorker(); }, {}, options).get();
+        assert(ranOn == w);
+    }
+
+    // A background job runs on a worker, and a waiter does not take it over
+    core::JobOptions background;
+    background.background = true;
+    std::atomic<bool> release{false};
+    std::atomic<int> ranOn{-2};
+    auto longJob = jobs.submit([&]() {
+        ranOn = jobs.currentWorker();
+        while (!release) std::this_thread::yield();
+    }, {}, background);
+    while (ranOn == -2) std::this_thread::yield();
+    assert(ranOn >= 0);
+    std::atomic<int> quick{0};
+    jobs.parallelFor(0, 100, 1, [&](int begin, int end) { quick += end - begin; });
+    assert(quick == 100 && !longJob.done());
+    release = true;
+    longJob.get();
+    std::cout << "PASSED" << std::endl;
+}
+
+int main() {
+    test_dependencies();
+    test_failure_propagates();
+    test_parallel_for();
+    test_nested_and_waiting_jobs();
+    test_affinity_and_background();
+    std::cout << "All job system tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "../src/math/lz_codec.h"
+
+using namespace math;
+
+static std::vector<uint8_t> roundTrip(const std::vector<uint8_t>& data, size_t* compressedSize = nullptr) {
+    std::vector<uint8_t> packed(lzCompressBound(data.size()));
+    size_t n = lzCompress(data.data(), data.size(), packed.data(), packed.size());
+    assert(n > 0 || data.empty());
+    if (compressedSize) *compressedSize = n;
+    std::vector<uint8_t> out(data.size());
+    assert(lzDecompress(packed.data(), n, out.data(), out.size()));
+    return out;
+}
+
+void test_round_trips() {
+    std::cout << "Running test_round_trips..." << std::endl;
+    std::mt19937 rng(3);
+    // Sizes around the literal/match edge cases, random and repetitive content
+    for (size_t size : {0u, 1u, 4u, 12u, 13u, 17u, 255u, 270u, 4096u, 100000u}) {
+        std::vector<uint8_t> noise(size), runs(size), text(size);
+        for (size_t i = 0; i < size; ++i) {
+            noise[i] = static_cast<uint8_t>(rng());
+            runs[i] = static_cast<uint8_t>((i / 300) & 3);
+            text[i] = static_cast<uint8_t>("the quick brown fox "[i % 20]);
+        }
+        assert(roundTrip(noise) == noise);
+        assert(roundTrip(runs) == runs);
+        assert(roundTrip(text) == text);
+    }
+
+    // Long runs compress far below the input (length continuation bytes)
+    std::vector<uint8_t> zeros(1 << 20, 0);
+    size_t n = 0;
+    assert(roundTrip(zeros, &n) == zeros);
+    assert(n < zeros.size() / 100);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_shuffle_helps_floats() {
+    std::cout << "Running test_shuffle_helps_floats..." << std::endl;
+    const size_t count = 1 << 16;
+    std::vector<float> field(count);
+    for (size_t i = 0; i < count; ++i) field[i] = 100.0f + 20.0f * std::sin(static_cast<float>(i) * 0.001f);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(field.data());
+    const size_t size = count * sizeof(float);
+
+    std::vector<uint8_t> shuffled(size), restored(size);
+    byteShuffle(bytes, count, sizeof(float), shuffled.data());
+    byteUnshuffle(shuffled.data(), count, sizeof(float), restored.data());
+    assert(std::equal(restored.begin(), restored.end(), bytes));
+
+    std::vector<uint8_t> packed(lzCompressBound(size));
+    size_t plain = lzCompress(bytes, size, packed.data(), packed.size());
+    size_t grouped = lzCompress(shuffled.data(), size, packed.data(), packed.size());
+    assert(grouped < plain);
+    std::cout << "  plain " << plain << " B, shuffled " << grouped << " B of " << size << " B" << std::endl;
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_rejects_malformed() {
+    std::cout << "Running test_rejects_malformed..." << std::endl;
+    std::vector<uint8_t> text(5000);
+    for (size_t i = 0; i < text.size(); ++i) text[i] = static_cast<uint8_t>("abcabcabd"[i % 9]);
+    std::vector<uint8_t> packed(lzCompressBound(text.size()));
+    size_t n = lzCompress(text.data(), text.size(), packed.data(), packed.size());
+    std::vector<uint8_t> out(text.size());
+
+    // Truncated block, wrong expected size, too small an output buffer
+    assert(!lzDecompress(packed.data(), n / 2, out.data(), out.size()));
+    assert(!lzDecompress(packed.data(), n, out.data(), out.size() - 1));
+    assert(lzCompress(text.data(), text.size(), packed.data(), 8) == 0);
+
+    // Random garbage never writes past the buffer (checked by the decoder's bounds)
+    std::mt19937 rng(9);
+    for (int t = 0; t < 2000; ++t) {
+        std::vector<uint8_t> junk(1 + rng() % 64);
+        for (auto& b : junk) b = static_cast<uint8_t>(rng());
+        std::vector<uint8_t> dst(256);
+        lzDecompress(junk.data(), junk.size(), dst.data(), dst.size());
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+int main() {
+    test_round_trips();
+    test_shuffle_helps_floats();
+    test_rejects_malformed();
+    std::cout << "All LZ codec tests passed!" << std::endl;
+    return 0;
+}
@@ -1,9 +1,13 @@
 #include "../src/ml/ml_service.h"
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <cmath>
+#include <vector>
 #include <Eigen/Dense>
 
-int main() {
+// Service with the JSON fixture (run from the repository root)
+static bool testServicePrediction() {
     std::cout << "[Test] MLService Integration..." << std::endl;
 
     // 1. Init
@@ -15,7 +19,7 @@ int main() {
     bool loaded = service.loadModel("soil_color", "assets/models/soil_color.json");
     if (!loaded) {
         std::cerr << "[FAIL] Could not load assets/models/soil_color.json" << std::endl;
-        return 1;
+        return false;
     }
 
     // 3. Predict
@@ -24,17 +28,64 @@ int main() {
     // Sum = 0.5 + 0.25 + 0.25 + 0.0 = 1.0
     // z = 1.0 - 1.0 = 0.0
     // sigmoid(0) = 0.5
-    
-    // Pred Color: (1-0.5, 0.5, 0.2) = (0.5, 0.5, 0.2)
-    
+
+    // Pred Color: 0.5 is the Yellow stop of the Blue -> Yellow -> Red ramp = (1, 1, 0)
+
     Eigen::Vector3f color = service.predictSoilColor(1.0f, 0.5f, 50.0f / 100.0f, 0.0f);
-    
+
     std::cout << "Predicted Color: " << color.transpose() << std::endl;
 
-    assert(std::abs(color.x() - 0.5f) < 0.001f);
-    assert(std::abs(color.y() - 0.5f) < 0.001f);
-    assert(std::abs(color.z() - 0.2f) < 0.001f);
+    assert(std::abs(color.x() - 1.0f) < 0.001f);
+    assert(std::abs(color.y() - 1.0f) < 0.001f);
+    assert(std::abs(color.z() - 0.0f) < 0.001f);
+
+    // Loaded models take the batched path too
+    const float one[4] = {1.0f, 0.5f, 0.5f, 0.0f};
+    const float* cols[4] = {&one[0], &one[1], &one[2], &one[3]};
+    float out = 0.0f;
+    service.predictBatch(service.getModel("soil_color"), cols, 1, &out);
+    assert(std::abs(out - 0.5f) < 1e-5f);
+    return true;
+}
+
+// v4.7.0: Batched path must match scalar infer (model built in code, no fixture needed)
+static void testBatchMatchesScalar() {
+    std::cout << "[Test] Batched inference..." << std::endl;
+    ml::Perceptron model(4);
+    Eigen::VectorXf weights(4);
+    weights << 0.8f, -1.2f, 0.5f, 2.0f;
+    model.setWeights(weights, -0.3f);
 
+    // 3000 samples -> spans several internal blocks plus a partial tail
+    const size_t n = 3000;
+    std::vector<float> d(n), om(n), inf(n), comp(n), out(n);
+    for (size_t i = 0; i < n; ++i) {
+        d[i] = static_cast<float>(i % 7) * 0.3f;
+        om[i] = static_cast<float>(i % 11) / 11.0f;
+        inf[i] = static_cast<float>(i % 13) / 13.0f;
+        comp[i] = static_cast<float>(i % 5) / 5.0f;
+    }
+    const float* cols[4] = {d.data(), om.data(), inf.data(), comp.data()};
+    model.inferBatch(cols, n, out.data());
+    float lo = 1.0f, hi = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        Eigen::VectorXf input(4);
+        input << d[i], om[i], inf[i], comp[i];
+        assert(std::abs(out[i] - model.infer(input)) < 1e-5f);
+        lo = std::min(lo, out[i]);
+        hi = std::max(hi, out[i]);
+    }
+    assert(hi - lo > 0.5f); // The samples cover the sigmoid, not one flat end
+
+    // Missing model -> zeros, like predict()
+    ml::MLService service;
+    service.predictBatch(service.getModel("missing"), cols, n, out.data());
+    assert(out[0] == 0.0f && out[n - 1] == 0.0f);
+}
+
+int main() {
+    testBatchMatchesScalar();
+    if (!testServicePrediction()) return 1;
     std::cout << "[PASS] MLService logic verified." << std::endl;
     return 0;
 }
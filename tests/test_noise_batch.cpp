@@ -0,0 +1,88 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "../src/math/noise.h"
+#include "test_helpers.h"
+
+using namespace math;
+
+static void makePoints(size_t n, unsigned seed, std::vector<float>& x, std::vector<float>& z) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> d(-4000.0f, 4000.0f);
+    x.resize(n);
+    z.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = d(rng);
+        z[i] = d(rng) * 0.01f;
+        if (i % 7 == 0) x[i] = std::floor(x[i]); // Exact lattice coordinates
+        if (i % 13 == 0) z[i] = -0.0f;
+    }
+}
+
+void test_noise2d_batch_identical() {
+    std::cout << "Running test_noise2d_batch_identical..." << std::endl;
+    PerlinNoise noise(1234);
+    std::vector<float> x, z;
+    makePoints(10007, 1, x, z); // Odd count exercises the scalar tail
+
+    std::vector<float> scalar(x.size()), batch(x.size());
+    for (size_t i = 0; i < x.size(); ++i) scalar[i] = noise.noise2D(x[i], z[i]);
+    noise.noise2DBatch(x.data(), z.data(), batch.data(), x.size());
+    assert(std::memcmp(scalar.data(), batch.data(), scalar.size() * sizeof(float)) == 0);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_octave_batch_identical() {
+    std::cout << "Running test_octave_batch_identical..." << std::endl;
+    PerlinNoise noise(99);
+    std::vector<float> x, z;
+    makePoints(3001, 2, x, z);
+
+    std::vector<float> scalar(x.size()), batch(x.size());
+    for (int octaves = 1; octaves <= 5; ++octaves) {
+        float persistence = 0.3f + 0.1f * octaves;
+        for (size_t i = 0; i < x.size(); ++i) scalar[i] = noise.octaveNoise(x[i], z[i], octaves, persistence);
+        noise.octaveNoiseBatch(x.data(), z.data(), batch.data(), x.size(), octaves, persistence);
+        assert(std::memcmp(scalar.data(), batch.data(), scalar.size() * sizeof(float)) == 0);
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void bench_row_fbm() {
+    std::cout << "Running bench_row_fbm..." << std::endl;
+    PerlinNoise noise(7);
+    const int w = 4096, rows = 256;
+    std::vector<float> x(w), z(w), out(w);
+    using clock = std::chrono::steady_clock;
+
+    float sink = 0.0f;
+    auto t0 = clock::now();
+    for (int r = 0; r < rows; ++r) {
+        for (int i = 0; i < w; ++i) sink += noise.octaveNoise(i * 0.004f, r * 0.004f, 4, 0.5f);
+    }
+    auto t1 = clock::now();
+    for (int r = 0; r < rows; ++r) {
+        for (int i = 0; i < w; ++i) { x[i] = i * 0.004f; z[i] = r * 0.004f; }
+        noise.octaveNoiseBatch(x.data(), z.data(), out.data(), w, 4, 0.5f);
+        sink -= out[w / 2];
+    }
+    auto t2 = clock::now();
+
+    auto ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << "  scalar " << ms(t1 - t0) << " ms, batch " << ms(t2 - t1) << " ms (" << sink * 0.0f << ")" << std::endl;
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_noise2d_batch_identical();
+    test_octave_batch_identical();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_row_fbm();
+    }
+    std::cout << "All noise batch tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,287 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/math/half.h"
+#include "../src/core/packed_channel.h"
+#include "../src/terrain/simulation_thread.h"
+#include "../src/terrain/precision_validation.h"
+#include "../src/terrain/terrain_pipeline.h"
+#include "../src/terrain/world_snapshot.h"
+#include "../src/vegetation/vegetation_system.h"
+#include "test_helpers.h"
+
+using namespace core;
+using Clock = std::chrono::steady_clock;
+
+static uint32_t bitsOf(float v) {
+    uint32_t b;
+    std::memcpy(&b, &v, sizeof(b));
+    return b;
+}
+
+static float floatOf(uint32_t b) {
+    float v;
+    std::memcpy(&v, &b, sizeof(v));
+    return v;
+}
+
+static std::unique_ptr<terrain::TerrainMap> makeWorld(int w, int h) {
+    return test_helpers::makeWorld(w, h, 33);
+}
+
+void test_half_conversions() {
+    std::cout << "Running test_half_conversions..." << std::endl;
+    // Every half survives a round trip through float; batch decode matches scalar
+    std::vector<uint16_t> codes(65536);
+    for (size_t i = 0; i < codes.size(); ++i) codes[i] = static_cast<uint16_t>(i);
+    std::vector<float> decoded(codes.size());
+    math::halfsToFloat(codes.data(), codes.size(), decoded.data());
+    for (size_t i = 0; i < codes.size(); ++i) {
+        const float v = math::halfToFloat(codes[i]);
+        if (std::isnan(v)) {
+            assert(std::isnan(decoded[i]) && std::isnan(math::halfToFloat(math::floatToHalf(v))));
+            continue;
+        }
+        assert(bitsOf(decoded[i]) == bitsOf(v));
+        assert(math::floatToHalf(v) == codes[i]);
+    }
+
+    // Round to nearest even, overflow to infinity, subnormals
+    assert(math::floatToHalf(1.0f) == 0x3c00);
+    assert(math::floatToHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3c00);      // Tie -> even
+    assert(math::floatToHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3c02);
+    assert(math::floatToHalf(65519.0f) == 0x7bff && math::floatToHalf(65520.0f) == 0x7c00);
+    assert(math::floatToHalf(-1e9f) == 0xfc00);
+    assert(math::floatToHalf(std::ldexp(1.0f, -25)) == 0x0000);              // Tie -> even (zero)
+    assert(math::floatToHalf(3.0f * std::ldexp(1.0f, -26)) == 0x0001);
+    assert(math::floatToHalf(-0.0f) == 0x8000);
+
+    // Batch encode matches scalar on random bit patterns and on values near representable ones
+    std::mt19937 rng(5);
+    std::vector<float> values(100003);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = i % 2 ? floatOf(static_cast<uint32_t>(rng()))
+                          : math::halfToFloat(static_cast<uint16_t>(rng())) * (1.0f + std::ldexp(1.0f, -12));
+    }
+    std::vector<uint16_t> encoded(values.size());
+    math::floatsToHalf(values.data(), values.size(), encoded.data());
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (std::isnan(values[i])) {
+            assert((encoded[i] & 0x7c00) == 0x7c00 && (encoded[i] & 0x3ff) != 0);
+            continue;
+        }
+        assert(encoded[i] == math::floatToHalf(values[i]));
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_unorm16_conversions() {
+    std::cout << "Running test_unorm16_conversions..." << std::endl;
+    std::vector<uint16_t> codes(65536);
+    for (size_t i = 0; i < codes.size(); ++i) codes[i] = static_cast<uint16_t>(i);
+    std::vector<float> decoded(codes.size());
+    math::unorm16sToFloat(codes.data(), codes.size(), decoded.data());
+    std::vector<uint16_t> again(codes.size());
+    math::floatsToUnorm16(decoded.data(), decoded.size(), again.data());
+    for (size_t i = 0; i < codes.size(); ++i) {
+        assert(decoded[i] == math::unorm16ToFloat(codes[i]));
+        assert(again[i] == codes[i] && math::floatToUnorm16(decoded[i]) == codes[i]);
+    }
+    assert(decoded.front() == 0.0f && decoded.back() == 1.0f);
+
+    // Clamped, NaN -> 0, error within half a step
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<float> range(-0.5f, 1.5f);
+    std::vector<float> values(10007);
+    for (float& v : values) v = range(rng);
+    values[3] = nan;
+    std::vector<uint16_t> encoded(values.size());
+    math::floatsToUnorm16(values.data(), values.size(), encoded.data());
+    for (size_t i = 0; i < values.size(); ++i) {
+        assert(encoded[i] == math::floatToUnorm16(values[i]));
+        if (i == 3) {
+            assert(encoded[i] == 0);
+            continue;
+        }
+        const float clamped = std::min(std::max(values[i], 0.0f), 1.0f);
+        assert(std::abs(math::unorm16ToFloat(encoded[i]) - clamped) <= 0.5f / 65535.0f + 1e-7f);
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_packed_channel() {
+    std::cout << "Running test_packed_channel..." << std::endl;
+    PackedChannel half(ChannelPrecision::Float16), unorm(ChannelPrecision::Unorm16), exact;
+    {
+        GridLayout layout(40, 30);
+        layout.add("test.half", half, 0.25f);
+        layout.add("test.unorm", unorm, 1.0f);
+        layout.add("test.exact", exact, 0.1f);
+        layout.apply();
+    }
+    assert(half.size() == 1200 && half.bytes() == 2400 && exact.bytes() == 4800);
+    assert(half[7] == 0.25f && unorm[1199] == 1.0f && exact[0] == 0.1f);
+
+    // Writes through operator[] are rounded to the channel's precision
+    unorm[5] = 0.3f;
+    unorm[5] += 0.1f;
+    assert(std::abs(unorm[5] - 0.4f) <= 1.0f / 65535.0f && unorm[5] == unorm.round(unorm.round(0.3f) + 0.1f));
+    half[3] = 1000.1f;
+    assert(half[3] == 1000.0f);
+    unorm[6] = unorm[5];
+    assert(unorm[6] == unorm[5]);
+
+    // Row conversion matches per-cell access
+    std::vector<float> row(40);
+    for (size_t i = 0; i < row.size(); ++i) row[i] = static_cast<float>(i) / 40.0f;
+    unorm.store(400, row.size(), row.data());
+    half.store(400, row.size(), row.data());
+    std::vector<float> back(40);
+    unorm.load(400, back.size(), back.data());
+    for (size_t i = 0; i < row.size(); ++i) {
+        assert(back[i] == unorm[400 + i] && back[i] == unorm.round(row[i]));
+        assert(half[400 + i] == half.round(row[i]));
+    }
+
+    // Configuration overrides the default by name; forceFloat32 overrides everything
+    PrecisionConfig config;
+    config.channels["test.unorm"] = ChannelPrecision::Float16;
+    PackedChannel::configure(config);
+    {
+        GridLayout layout(8, 8);
+        layout.add("test.unorm", unorm, 0.5f);
+        layout.apply();
+    }
+    assert(unorm.precision() == ChannelPrecision::Float16 && unorm[0] == 0.5f);
+    config.forceFloat32 = true;
+    PackedChannel::configure(config);
+    assert(PackedChannel::precisionFor("test.unorm", ChannelPrecision::Unorm16) == ChannelPrecision::Float32);
+    PackedChannel::configure(PrecisionConfig());
+    assert(PackedChannel::precisionFor("test.unorm", ChannelPrecision::Unorm16) == ChannelPrecision::Unorm16);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_world_storage() {
+    std::cout << "Running test_world_storage..." << std::endl;
+    const int n = 256;
+    auto packed = makeWorld(n, n);
+    PrecisionConfig exact;
+    exact.forceFloat32 = true;
+    PackedChannel::configure(exact);
+    auto reference = makeWorld(n, n);
+    PackedChannel::configure(PrecisionConfig());
+
+    // 8 channels at 2 bytes per cell instead of 4
+    const size_t cells = static_cast<size_t>(n) * n;
+    assert(packed->getVegetation()->ei_coverage.precision() == ChannelPrecision::Unorm16);
+    assert(packed->getLandscapeSoil()->sand_fraction.precision() == ChannelPrecision::Unorm16);
+    assert(reference->getVegetation()->ei_coverage.precision() == ChannelPrecision::Float32);
+    assert(reference->allocatedBytes() - packed->allocatedBytes() >= 8 * 2 * cells);
+
+    // Generation agrees within the storage step
+    const auto& a = reference->getVegetation()->ei_coverage;
+    const auto& b = packed->getVegetation()->ei_coverage;
+    for (size_t i = 0; i < cells; i += 97) assert(std::abs(a[i] - b[i]) <= 1.0f / 65535.0f);
+
+    // Snapshots keep the stored precision and convert when the map differs
+    const std::string path = "/tmp/sister_precision.world";
+    terrain::SnapshotInfo info;
+    assert(terrain::WorldSnapshot::save(path, *packed, info));
+    PackedChannel::configure(exact);
+    terrain::TerrainMap loaded(n, n);
+    PackedChannel::configure(PrecisionConfig());
+    assert(terrain::WorldSnapshot::load(path, loaded));
+    const auto& c = loaded.getVegetation()->ei_coverage;
+    assert(c.precision() == ChannelPrecision::Float32);
+    for (size_t i = 0; i < cells; i += 31) assert(c[i] == b[i]);
+    terrain::TerrainMap same(n, n);
+    assert(terrain::WorldSnapshot::load(path, same));
+    assert(same.getVegetation()->ei_coverage == b && same.getLandscapeSoil()->clay_fraction == packed->getLandscapeSoil()->clay_fraction);
+    std::remove(path.c_str());
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_validation_mode() {
+    std::cout << "Running test_validation_mode..." << std::endl;
+    terrain::SimulationParameters parameters;
+    terrain::SimulationSettings settings;
+    settings.soilSliceRows = 16;
+
+    // 600 ticks = one simulated minute: coverage and vigor settle, soil rows are swept ~75 times
+    const auto report = terrain::validatePrecision([]() { return makeWorld(128, 128); }, parameters, 600, settings);
+    assert(report.size() == 8);
+    for (const terrain::PrecisionDrift& d : report) {
+        std::cout << "  " << d.name << " (" << precisionName(d.precision) << "): max " << d.maxError
+                  << ", mean " << d.meanError << std::endl;
+        assert(d.precision == ChannelPrecision::Unorm16);
+        if (d.name == "veg.ei_vigor" || d.name == "veg.es_vigor") {
+            // Vigor steps +0.1*dt / -0.05*dt around its target: both runs stay inside that band,
+            // rounding only decides where in it a cell sits
+            assert(d.maxError < 0.15f * settings.stepSeconds + 1e-3 && d.meanError < 0.01);
+        } else {
+            // A cell sitting on a growth threshold may flip a tick apart; the field must not drift
+            assert(d.maxError < 1e-2 && d.meanError < 2e-4);
+        }
+    }
+
+    // Half on a [0, 1] field: coarser near 1 (2^-11), still reported per channel
+    PrecisionConfig config;
+    config.channels["veg.ei_vigor"] = ChannelPrecision::Float16;
+    PackedChannel::configure(config);
+    const auto mixed = terrain::validatePrecision([]() { return makeWorld(64, 64); }, parameters, 200, settings);
+    PackedChannel::configure(PrecisionConfig());
+    bool sawHalf = false;
+    for (const terrain::PrecisionDrift& d : mixed) {
+        if (d.name != "veg.ei_vigor") continue;
+        sawHalf = d.precision == ChannelPrecision::Float16;
+        std::cout << "  " << d.name << " (float16): max " << d.maxError << ", mean " << d.meanError << std::endl;
+        assert(d.maxError < 0.15f * settings.stepSeconds + 1e-3);
+    }
+    assert(sawHalf);
+    std::cout << "PASSED" << std::endl;
+}
+
+void bench_vegetation_update() {
+    std::cout << "Running bench_vegetation_update..." << std::endl;
+    const int n = 1024;
+    double ms[2] = {0.0, 0.0};
+    for (int pass = 0; pass < 2; ++pass) {
+        PrecisionConfig config;
+        config.forceFloat32 = pass == 0;
+        PackedChannel::configure(config);
+        vegetation::VegetationGrid grid;
+        grid.resize(n, n);
+        PackedChannel::configure(PrecisionConfig());
+        vegetation::VegetationSystem::initialize(grid, 7);
+        vegetation::DisturbanceRegime regime;
+        vegetation::VegetationSystem::update(grid, 0.1f, regime, nullptr, nullptr); // Warm up
+        const int ticks = 10;
+        const auto t0 = Clock::now();
+        for (int t = 0; t < ticks; ++t) vegetation::VegetationSystem::update(grid, 0.1f, regime, nullptr, nullptr);
+        ms[pass] = std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / ticks;
+    }
+    std::cout << "  " << n << "x" << n << ": float32 " << ms[0] << " ms/tick, unorm16 " << ms[1] << " ms/tick" << std::endl;
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_half_conversions();
+    test_unorm16_conversions();
+    test_packed_channel();
+    test_world_storage();
+    test_validation_mode();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_vegetation_update();
+    }
+    std::cout << "All precision tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,274 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/terrain/raster_export.h"
+#include "../src/terrain/terrain_pipeline.h"
+#include "test_helpers.h"
+
+using namespace terrain;
+namespace fs = std::filesystem;
+
+// Minimal little-endian TIFF reader: tags of every IFD in the chain
+struct TiffDir {
+    std::map<uint16_t, std::vector<double>> tags;
+    uint32_t get(uint16_t tag) const { return static_cast<uint32_t>(tags.at(tag).at(0)); }
+};
+
+static uint32_t rd(const std::vector<uint8_t>& f, size_t at, int bytes) {
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) v = (v << 8) | f[at + static_cast<size_t>(i)];
+    return v;
+}
+
+static std::vector<TiffDir> readDirs(const std::vector<uint8_t>& f) {
+    assert(f[0] == 'I' && f[1] == 'I' && rd(f, 2, 2) == 42);
+    std::vector<TiffDir> dirs;
+    for (uint32_t off = rd(f, 4, 4); off != 0;) {
+        assert(off % 2 == 0 && off + 2 <= f.size());
+        TiffDir dir;
+        const uint32_t n = rd(f, off, 2);
+        uint16_t lastTag = 0;
+        for (uint32_t e = 0; e < n; ++e) {
+            const size_t at = off + 2 + e * 12;
+            const uint16_t tag = static_cast<uint16_t>(rd(f, at, 2));
+            assert(tag > lastTag); // Sorted
+            lastTag = tag;
+            const uint32_t type = rd(f, at + 2, 2);
+            const uint32_t count = rd(f, at + 4, 4);
+            const int size = type == 3 ? 2 : type == 4 ? 4 : type == 12 ? 8 : 1;
+            const size_t data = static_cast<size_t>(count) * size <= 4 ? at + 8 : rd(f, at + 8, 4);
+            std::vector<double> values;
+            for (uint32_t i = 0; i < count; ++i) {
+                if (type == 12) {
+                    uint64_t bits = rd(f, data + i * 8, 4) | (static_cast<uint64_t>(rd(f, data + i * 8 + 4, 4)) << 32);
+                    double d;
+                    std::memcpy(&d, &bits, 8);
+                    values.push_back(d);
+                } else {
+                    values.push_back(rd(f, data + static_cast<size_t>(i) * size, size));
+                }
+            }
+            dir.tags[tag] = values;
+        }
+        dirs.push_back(dir);
+        off = rd(f, off + 2 + n * 12, 4);
+    }
+    return dirs;
+}
+
+// Decoded samples of one directory (undoes LZW and the predictor)
+template <typename T>
+static std::vector<T> readImage(const std::vector<uint8_t>& f, const TiffDir& dir) {
+    const uint32_t w = dir.get(256), h = dir.get(257), ts = dir.get(322);
+    const bool lzw = dir.get(259) == 5;
+    const uint32_t across = (w + ts - 1) / ts;
+    std::vector<T> image(static_cast<size_t>(w) * h);
+    std::vector<uint8_t> tile(static_cast<size_t>(ts) * ts * sizeof(T));
+    for (size_t t = 0; t < dir.tags.at(324).size(); ++t) {
+        const size_t off = static_cast<size_t>(dir.tags.at(324)[t]);
+        const size_t len = static_cast<size_t>(dir.tags.at(325)[t]);
+        if (lzw) {
+            assert(RasterExporter::lzwDecode(f.data() + off, len, tile.data(), tile.size()));
+            for (uint32_t r = 0; r < ts; ++r) {
+                uint8_t* row = tile.data() + static_cast<size_t>(r) * ts * sizeof(T);
+                if (dir.get(317) == 3) {
+                    for (size_t i = 1; i < ts * 4; ++i) row[i] = static_cast<uint8_t>(row[i] + row[i - 1]);
+                    std::vector<uint8_t> planes(row, row + ts * 4);
+                    for (size_t i = 0; i < ts; ++i)
+                        for (size_t b = 0; b < 4; ++b) row[i * 4 + b] = planes[(3 - b) * ts + i];
+                } else {
+                    T* v = reinterpret_cast<T*>(row);
+                    for (size_t i = 1; i < ts; ++i) v[i] = static_cast<T>(v[i] + v[i - 1]);
+                }
+            }
+        } else {
+            assert(len == tile.size());
+            std::memcpy(tile.data(), f.data() + off, len);
+        }
+        const uint32_t x0 = static_cast<uint32_t>(t % across) * ts, y0 = static_cast<uint32_t>(t / across) * ts;
+        for (uint32_t y = y0; y < std::min(h, y0 + ts); ++y)
+            for (uint32_t x = x0; x < std::min(w, x0 + ts); ++x)
+                std::memcpy(&image[static_cast<size_t>(y) * w + x], tile.data() + ((y - y0) * ts + (x - x0)) * sizeof(T), sizeof(T));
+    }
+    return image;
+}
+
+static std::vector<uint8_t> slurp(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+void test_lzw_roundtrip() {
+    std::cout << "Running test_lzw_roundtrip..." << std::endl;
+    std::mt19937 rng(7);
+    std::vector<std::vector<uint8_t>> inputs;
+    inputs.push_back({});
+    inputs.push_back({42});
+    inputs.push_back(std::vector<uint8_t>(100000, 9)); // Long run
+    std::vector<uint8_t> noise(300000);
+    for (auto& b : noise) b = static_cast<uint8_t>(rng()); // Forces many table resets
+    inputs.push_back(noise);
+    std::vector<uint8_t> text(200000);
+    for (size_t i = 0; i < text.size(); ++i) text[i] = static_cast<uint8_t>("abracadabra "[(i * 7 + i / 13) % 12]);
+    inputs.push_back(text);
+
+    std::vector<uint8_t> enc;
+    for (const auto& in : inputs) {
+        RasterExporter::lzwEncode(in.data(), in.size(), enc);
+        std::vector<uint8_t> dec(in.size());
+        assert(RasterExporter::lzwDecode(enc.data(), enc.size(), dec.data(), dec.size()));
+        assert(dec == in);
+    }
+    RasterExporter::lzwEncode(inputs[2].data(), inputs[2].size(), enc);
+    assert(enc.size() < 2000);
+    std::vector<uint8_t> shortOut(10);
+    assert(!RasterExporter::lzwDecode(enc.data(), enc.size(), shortOut.data(), shortOut.size()));
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_geotiff_layout() {
+    std::cout << "Running test_geotiff_layout..." << std::endl;
+    const int w = 300, h = 170;
+    std::vector<float> heights(static_cast<size_t>(w) * h);
+    std::vector<int32_t> basins(heights.size());
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            heights[static_cast<size_t>(y) * w + x] = 50.0f + 10.0f * std::sin(x * 0.05f) + 0.25f * static_cast<float>(y);
+            basins[static_cast<size_t>(y) * w + x] = (x / 40) + 100 * (y / 30) - 7;
+        }
+    }
+    heights[5] = std::nanf("");
+
+    RasterExportOptions options;
+    options.resolution = 2.0f;
+    options.originX = 1000.0;
+    options.originY = 5000.0;
+    options.tileSize = 64;
+    const std::string path = (fs::temp_directory_path() / "sister_test_heights.tif").string();
+    assert(RasterExporter::writeGeoTiff(path, heights.data(), RasterSampleType::Float32, w, h, options));
+
+    const auto file = slurp(path);
+    const auto dirs = readDirs(file);
+    assert(dirs.size() == 4); // 300 -> 150 -> 75 -> 38 (fits one 64 tile)
+    assert(dirs[0].get(254) == 0 && dirs[1].get(254) == 1);
+    assert(dirs[0].get(256) == 300 && dirs[0].get(257) == 170);
+    assert(dirs[3].get(256) == 38 && dirs[3].get(257) == 22 && dirs[3].tags.at(324).size() == 1);
+    assert(dirs[0].get(339) == 3 && dirs[0].get(317) == 3 && dirs[0].get(258) == 32);
+    assert(dirs[0].tags.at(33550)[0] == 2.0);
+    assert(dirs[0].tags.at(33922)[3] == 1000.0 && dirs[0].tags.at(33922)[4] == 5000.0 + 170 * 2.0);
+    assert(dirs[0].tags.count(34735) && !dirs[1].tags.count(34735));
+
+    const auto full = readImage<float>(file, dirs[0]);
+    assert(std::isnan(full[5]));
+    for (size_t i = 0; i < full.size(); ++i) assert(i == 5 || full[i] == heights[i]);
+    // Overview: NaN-aware mean of each 2x2 block
+    const auto ov = readImage<float>(file, dirs[1]);
+    const float expect = (heights[static_cast<size_t>(w) + 4] + heights[4] + heights[static_cast<size_t>(w) + 5]) / 3.0f;
+    assert(std::fabs(ov[2] - expect) < 1e-4f);
+
+    // Integer classes: predictor 2 and nearest-sample overviews, also uncompressed
+    for (bool compress : {true, false}) {
+        options.compress = compress;
+        assert(RasterExporter::writeGeoTiff(path, basins.data(), RasterSampleType::Int32, w, h, options));
+        const auto f = slurp(path);
+        const auto d = readDirs(f);
+        assert(d[0].get(259) == (compress ? 5u : 1u) && d[0].get(339) == 2);
+        assert(readImage<int32_t>(f, d[0]) == basins);
+        const auto o = readImage<int32_t>(f, d[1]);
+        assert(o[static_cast<size_t>(150) * 20 + 30] == basins[static_cast<size_t>(w) * 40 + 60]);
+    }
+
+    std::string error;
+    assert(!RasterExporter::writeGeoTiff(path, basins.data(), RasterSampleType::Int32, w, h, RasterExportOptions{1.0f, 0, 0, 0, 100, true}, &error));
+    assert(!error.empty());
+    fs::remove(path);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_export_layers() {
+    std::cout << "Running test_export_layers..." << std::endl;
+    RegenerationInputs in;
+    in.config.width = 200;
+    in.config.height = 120;
+    in.config.seed = 5;
+    in.soilMode = 1;
+    TerrainMap map(in.config.width, in.config.height);
+    TerrainPipeline pipeline;
+    pipeline.regenerate(map, in);
+    // SiBCS level layers are expanded from the per-cell taxon index
+    auto* soil = map.getLandscapeSoil();
+    landscape::SoilTaxon vermelho;
+    vermelho.suborder = landscape::SiBCSSubOrder::kVermelho;
+    vermelho.series = landscape::SiBCSSeries::kGeneric;
+    for (size_t i = 0; i < soil->taxon.size(); i += 3) soil->setTaxon(i, vermelho);
+
+    const std::string dir = (fs::temp_directory_path() / "sister_raster_export").string();
+    fs::remove_all(dir);
+    std::vector<RasterLayer> all;
+    for (int l = 0; l < static_cast<int>(RasterLayer::Count); ++l) all.push_back(static_cast<RasterLayer>(l));
+
+    // No watershed segmentation ran: basin_id is skipped
+    const int expected = static_cast<int>(RasterLayer::Count) - (RasterExporter::hasLayer(map, RasterLayer::BasinId) ? 0 : 1);
+    RasterExportOptions options;
+    assert(RasterExporter::exportLayers(dir, map, all, options) == expected);
+    assert(fs::exists(fs::path(dir) / "height.tif") && fs::exists(fs::path(dir) / "sibcs_series.tif"));
+
+    const auto f = slurp((fs::path(dir) / "soil_type.tif").string());
+    const auto d = readDirs(f);
+    assert(d[0].get(258) == 8 && d[0].get(339) == 1);
+    const auto& soilType = map.getLandscapeSoil()->soil_type;
+    assert(readImage<uint8_t>(f, d[0]) == std::vector<uint8_t>(soilType.begin(), soilType.end()));
+    const auto sub = slurp((fs::path(dir) / "sibcs_suborder.tif").string());
+    const auto suborders = readImage<uint8_t>(sub, readDirs(sub)[0]);
+    for (size_t i = 0; i < suborders.size(); ++i) {
+        assert(suborders[i] == (i % 3 == 0 ? static_cast<uint8_t>(landscape::SiBCSSubOrder::kVermelho) : 0));
+    }
+    const auto twi = slurp((fs::path(dir) / "twi.tif").string());
+    for (float v : readImage<float>(twi, readDirs(twi)[0])) assert(std::isfinite(v));
+    fs::remove_all(dir);
+    std::cout << "PASSED" << std::endl;
+}
+
+void bench_export_4096() {
+    std::cout << "Running bench_export_4096..." << std::endl;
+    const int n = 4096;
+    TerrainMap map(n, n);
+    auto& hm = map.heightMap();
+    auto& flux = map.fluxMap();
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            const size_t i = static_cast<size_t>(y) * n + x;
+            hm[i] = 200.0f + 80.0f * std::sin(x * 0.004f) * std::cos(y * 0.003f);
+            flux[i] = 1.0f + static_cast<float>((x * 13 + y * 7) % 500);
+        }
+    }
+    const std::string dir = (fs::temp_directory_path() / "sister_raster_bench").string();
+    auto t0 = std::chrono::steady_clock::now();
+    const int written = RasterExporter::exportLayers(dir, map, {RasterLayer::Height, RasterLayer::Flux, RasterLayer::TWI, RasterLayer::SoilType},
+                                                     RasterExportOptions{});
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    assert(written == 4);
+    std::cout << "  4096x4096, 4 layers: " << ms << " ms" << std::endl;
+    fs::remove_all(dir);
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_lzw_roundtrip();
+    test_geotiff_layout();
+    test_export_layers();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_export_4096();
+    }
+    std::cout << "All raster export tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/core/job_system.h"
+#include "../src/terrain/terrain_pipeline.h"
+#include "test_helpers.h"
+
+using namespace terrain;
+
+static std::map<std::string, bool> reusedByName(const std::vector<RegenerationGraph::StageReport>& reports) {
+    std::map<std::string, bool> out;
+    for (const auto& r : reports) out[r.name] = r.reused;
+    return out;
+}
+
+static RegenerationInputs latossoloInputs() {
+    RegenerationInputs in = test_helpers::smallInputs(192, 128, 77);
+    in.config.maxHeight = 120.0f;
+    in.domain.applyConstraints = true;
+    in.domain.domainConfirmed = true;
+    landscape::SiBCSUserSelection sel;
+    sel.order = landscape::SiBCSOrder::kLatossolo;
+    in.domain.selections.push_back(sel);
+    return in;
+}
+
+void test_memoized_stages() {
+    std::cout << "Running test_memoized_stages..." << std::endl;
+    TerrainPipeline pipeline;
+    RegenerationInputs in = latossoloInputs();
+
+    TerrainMap first(in.config.width, in.config.height);
+    auto r1 = reusedByName(pipeline.regenerate(first, in));
+    for (const auto& kv : r1) assert(!kv.second);
+
+    // Same inputs: everything restored, identical result
+    TerrainMap second(in.config.width, in.config.height);
+    auto r2 = reusedByName(pipeline.regenerate(second, in));
+    for (const auto& kv : r2) assert(kv.second || kv.first == TerrainPipeline::kDiskCache);
+    assert(second.heightMap() == first.heightMap());
+    assert(second.soilMap() == first.soilMap());
+    assert(second.fluxMap() == first.fluxMap());
+    assert(second.getLandscapeSoil()->soil_type == first.getLandscapeSoil()->soil_type);
+    assert(second.getVegetation()->ei_coverage == first.getVegetation()->ei_coverage);
+    assert(second.getVegetation()->generation != first.getVegetation()->generation);
+
+    // Domain change: only the SCORPAN sync re-runs
+    in.domain.selections[0].order = landscape::SiBCSOrder::kArgissolo;
+    TerrainMap third(in.config.width, in.config.height);
+    auto r3 = reusedByName(pipeline.regenerate(third, in));
+    assert(!r3[TerrainPipeline::kScorpan]);
+    assert(r3[TerrainPipeline::kBase] && r3[TerrainPipeline::kDrainage] && r3[TerrainPipeline::kSoilPatterns]);
+    assert(r3[TerrainPipeline::kLandscape] && r3[TerrainPipeline::kVegetation]);
+    assert(third.heightMap() == first.heightMap());
+
+    // Height parameter change: terrain stages re-run, vegetation does not
+    in.config.maxHeight = 60.0f;
+    TerrainMap fourth(in.config.width, in.config.height);
+    auto r4 = reusedByName(pipeline.regenerate(fourth, in));
+    assert(!r4[TerrainPipeline::kBase] && !r4[TerrainPipeline::kDrainage] && !r4[TerrainPipeline::kScorpan]);
+    assert(r4[TerrainPipeline::kVegetation]);
+    assert(fourth.heightMap() != first.heightMap());
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_matches_direct_chain() {
+    std::cout << "Running test_matches_direct_chain..." << std::endl;
+    RegenerationInputs in = latossoloInputs();
+    TerrainPipeline pipeline;
+    TerrainMap viaGraph(in.config.width, in.config.height);
+    pipeline.regenerate(viaGraph, in);
+
+    TerrainMap direct(in.config.width, in.config.height);
+    TerrainGenerator gen(in.config.seed);
+    gen.generateBaseTerrain(direct, in.config);
+    gen.calculateDrainage(direct);
+    gen.classifySoil(direct, in.config);
+    gen.generateLandscape(direct);
+    gen.classifySoilFromSCORPAN(direct, &in.domain);
+
+    assert(viaGraph.heightMap() == direct.heightMap());
+    assert(viaGraph.fluxMap() == direct.fluxMap());
+    assert(viaGraph.flowDirMap() == direct.flowDirMap());
+    assert(viaGraph.soilMap() == direct.soilMap());
+    assert(viaGraph.soilShared() && viaGraph.soilDomain() == direct.soilDomain());
+    assert(direct.soilDomain() == (soilMaskOf(SoilType::None) | soilMaskOf(SoilType::Latossolo)));
+
+    // The sync only narrows the view: a wider domain shows the other orders again
+    auto shownCells = [](const TerrainMap& m) {
+        int n = 0;
+        for (int z = 0; z < m.getHeight(); ++z) {
+            for (int x = 0; x < m.getWidth(); ++x) n += m.getSoil(x, z) != SoilType::None;
+        }
+        return n;
+    };
+    auto& types = direct.getLandscapeSoil()->soil_type;
+    for (size_t i = 0; i < types.size(); ++i) {
+        types[i] = static_cast<uint8_t>(i % 3 ? landscape::SoilType::Argissolo : landscape::SoilType::Latossolo);
+    }
+    const auto classified = types;
+    gen.classifySoilFromSCORPAN(direct, &in.domain);
+    const int narrow = shownCells(direct);
+    assert(types == classified && narrow == static_cast<int>((types.size() + 2) / 3));
+    landscape::SiBCSUserConfig wide = in.domain;
+    for (auto order : {landscape::SiBCSOrder::kArgissolo, landscape::SiBCSOrder::kCambissolo,
+                       landscape::SiBCSOrder::kGleissolo, landscape::SiBCSOrder::kNeossoloLit}) {
+        landscape::SiBCSUserSelection sel;
+        sel.order = order;
+        wide.selections.push_back(sel);
+    }
+    gen.classifySoilFromSCORPAN(direct, &wide);
+    assert(shownCells(direct) == static_cast<int>(types.size()));
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_graph_levels_and_errors() {
+    std::cout << "Running test_graph_levels_and_errors..." << std::endl;
+    RegenerationGraph graph;
+    std::atomic<int> order{0};
+    int a = -1, b = -1, c = -1;
+    graph.addStage({"a", {}, nullptr, [&](TerrainMap&) { a = order++; }, nullptr});
+    graph.addStage({"b", {}, nullptr, [&](TerrainMap&) { b = order++; }, nullptr});
+    graph.addStage({"c", {"a", "b"}, nullptr, [&](TerrainMap&) { c = order++; }, nullptr});
+
+    TerrainMap map(4, 4);
+    graph.run(map);
+    assert(c == 2 && a >= 0 && b >= 0);
+
+    bool threw = false;
+    try {
+        graph.addStage({"d", {"missing"}, nullptr, [](TerrainMap&) {}, nullptr});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_cancel_and_progress() {
+    std::cout << "Running test_cancel_and_progress..." << std::endl;
+    RegenerationInputs in = latossoloInputs();
+    TerrainPipeline pipeline;
+
+    // Cancelled before it starts: nothing runs, nothing is memoized
+    RegenerationControl cancelled;
+    cancelled.cancel();
+    TerrainMap map(in.config.width, in.config.height);
+    bool threw = false;
+    try {
+        pipeline.regenerate(map, in, &cancelled);
+    } catch (const RegenerationCancelled&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(!pipeline.reusesBaseTerrain(in));
+
+    // Cancelled from inside a stage: the graph stops at the next tile/stage boundary
+    std::atomic<int> afterCancel{0};
+    RegenerationControl control;
+    RegenerationGraph graph;
+    graph.addStage({"a", {}, nullptr, [&](TerrainMap&) { control.cancel(); }, nullptr});
+    graph.addStage({"b", {"a"}, nullptr, [&](TerrainMap&) { ++afterCancel; }, nullptr});
+    threw = false;
+    try {
+        graph.run(map, &control);
+    } catch (const RegenerationCancelled&) {
+        threw = true;
+    }
+    assert(threw && afterCancel == 0);
+
+    // A later run completes normally and reports full progress
+    RegenerationControl fresh;
+    TerrainMap full(in.config.width, in.config.height);
+    auto reports = pipeline.regenerate(full, in, &fresh);
+    for (const auto& r : reports) assert(!r.reused);
+    assert(fresh.progress() == 1.0f);
+    assert(pipeline.reusesBaseTerrain(in));
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_preview() {
+    std::cout << "Running test_preview..." << std::endl;
+    TerrainConfig big;
+    big.width = big.height = 4096;
+    std::vector<int> factors = TerrainPipeline::previewFactors(big);
+    assert(factors.size() == 2 && factors[0] == 8 && factors[1] == 4);
+    big.width = big.height = 1024;
+    assert(TerrainPipeline::previewFactors(big) == std::vector<int>{2});
+    big.width = big.height = 512;
+    assert(TerrainPipeline::previewFactors(big).empty());
+
+    // Preview samples the same world: every 4th height of the full map
+    RegenerationInputs in = latossoloInputs();
+    in.config.width = 193;
+    in.config.height = 129;
+    std::unique_ptr<TerrainMap> preview = TerrainPipeline::generatePreview(in, 4);
+    assert(preview->getWidth() == 49 && preview->getHeight() == 33);
+    TerrainMap full(in.config.width, in.config.height);
+    TerrainGenerator gen(in.config.seed);
+    gen.generateBaseTerrain(full, in.config);
+    for (int z = 0; z < preview->getHeight(); z += 8) {
+        for (int x = 0; x < preview->getWidth(); x += 8) {
+            assert(std::abs(preview->getHeight(x, z) - full.getHeight(x * 4, z * 4)) < 1e-3f);
+        }
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_stages_stay_off_foreign_threads() {
+    std::cout << "Running test_stages_stay_off_foreign_threads..." << std::endl;
+    core::JobSystem& jobs = core::JobSystem::instance();
+    const std::thread::id self = std::this_thread::get_id();
+    std::atomic<int> onSelf{0};
+    auto slowStage = [&](TerrainMap&) {
+        if (std::this_thread::get_id() == self) ++onSelf;
+        jobs.parallelFor(0, 64, 1, [&](int, int) {
+            if (std::this_thread::get_id() == self) ++onSelf;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        });
+    };
+    RegenerationGraph graph;
+    for (const char* name : {"a", "b", "c", "d"}) graph.addStage({name, {}, nullptr, slowStage, nullptr});
+
+    // Regeneration runs as a background job, like the app's; this thread stands in for the
+    // render/simulation thread and keeps waiting on its own parallelFor chunks meanwhile
+    TerrainMap map(4, 4);
+    auto regen = jobs.submit([&]() { graph.run(map); }, {}, core::JobOptions::longRunning());
+    std::atomic<int> own{0};
+    while (!regen.done()) jobs.parallelFor(0, 8, 1, [&](int begin, int end) { own += end - begin; });
+    regen.get();
+    assert(onSelf == 0 && own > 0);
+    std::cout << "PASSED" << std::endl;
+}
+
+int main() {
+    core::JobSystem::configure({3, false}); // Idle workers to steal from, whatever the machine
+    test_memoized_stages();
+    test_matches_direct_chain();
+    test_graph_levels_and_errors();
+    test_cancel_and_progress();
+    test_stages_stay_off_foreign_threads();
+    test_preview();
+    std::cout << "All regeneration graph tests passed!" << std::endl;
+    return 0;
+}
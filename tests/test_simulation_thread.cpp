@@ -0,0 +1,241 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../src/terrain/simulation_thread.h"
+#include "../src/terrain/terrain_pipeline.h"
+#include "../src/landscape/hydro_system.h"
+#include "../src/landscape/soil_system.h"
+#include "../src/vegetation/vegetation_system.h"
+#include "../src/vegetation/vegetation_texture.h"
+#include "test_helpers.h"
+
+using namespace terrain;
+using Clock = std::chrono::steady_clock;
+
+static std::unique_ptr<TerrainMap> makeWorld(int w, int h) {
+    return test_helpers::makeWorld(w, h, 21);
+}
+
+static bool sameVisible(const vegetation::VegetationGrid& a, const vegetation::VegetationGrid& b) {
+    return a.ei_coverage == b.ei_coverage && a.es_coverage == b.es_coverage && a.ei_vigor == b.ei_vigor &&
+           a.es_vigor == b.es_vigor && a.tile_version == b.tile_version;
+}
+
+void test_command_queue() {
+    std::cout << "Running test_command_queue..." << std::endl;
+    SimulationCommandQueue queue(5);
+    assert(queue.capacity() == 8);
+    for (int i = 0; i < 8; ++i) {
+        SimulationCommand c;
+        c.parameters.rainIntensity = static_cast<float>(i);
+        assert(queue.push(std::move(c)));
+    }
+    SimulationCommand full;
+    assert(!queue.push(std::move(full)));
+    SimulationCommand out;
+    for (int i = 0; i < 8; ++i) {
+        assert(queue.pop(out) && out.parameters.rainIntensity == static_cast<float>(i));
+    }
+    assert(!queue.pop(out));
+
+    // One producer, one consumer, in order, nothing lost
+    SimulationCommandQueue ring(64);
+    const int n = 200000;
+    std::vector<int> seen;
+    seen.reserve(n);
+    std::thread consumer([&]() {
+        SimulationCommand c;
+        while (static_cast<int>(seen.size()) < n) {
+            if (ring.pop(c)) seen.push_back(static_cast<int>(c.parameters.rainIntensity));
+            else std::this_thread::yield();
+        }
+    });
+    for (int i = 0; i < n; ) {
+        SimulationCommand c;
+        c.parameters.rainIntensity = static_cast<float>(i);
+        if (ring.push(std::move(c))) ++i;
+        else std::this_thread::yield();
+    }
+    consumer.join();
+    for (int i = 0; i < n; ++i) assert(seen[static_cast<size_t>(i)] == i);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_frames_commands_and_pause() {
+    std::cout << "Running test_frames_commands_and_pause..." << std::endl;
+    auto map = makeWorld(192, 160);
+    SimulationParameters params;
+    SimulationSettings settings;
+    settings.ticksPerSecond = 0.0; // Unthrottled
+    SimulationThread sim;
+    assert(!sim.acquire());
+    sim.start(*map, params, settings);
+
+    // Actions run on the simulation thread, between ticks, in posting order
+    std::atomic<int> actions{0};
+    std::thread::id actionThread;
+    assert(sim.post([&](TerrainMap& m) { assert(&m == map.get()); actionThread = std::this_thread::get_id(); ++actions; }));
+    params.rainIntensity = 0.0f;
+    assert(sim.setParameters(params));
+    assert(sim.post([&](TerrainMap&) { ++actions; }));
+
+    // Published frames only move forward
+    uint64_t lastTick = 0;
+    while (lastTick < 25) {
+        auto frame = sim.acquire();
+        if (!frame) continue;
+        assert(frame->tick >= lastTick);
+        assert(frame->vegetation.isValid());
+        lastTick = frame->tick;
+    }
+    assert(actions == 2 && actionThread != std::this_thread::get_id());
+
+    // Under a Pause the grids are settled and the latest frame matches them
+    for (int round = 0; round < 5; ++round) {
+        {
+            SimulationThread::Pause pause(&sim);
+            auto frame = sim.acquire();
+            assert(frame);
+            const uint64_t tick = frame->tick;
+            assert(sameVisible(frame->vegetation, *map->getVegetation()));
+            assert(frame->vegetation.generation == map->getVegetation()->generation);
+            assert(frame->soilRowsSwept == tick * 32);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            assert(sim.acquire()->tick == tick); // No tick while paused
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }
+
+    // A held frame is never rewritten: the other buffer takes the ticks
+    {
+        auto held = sim.acquire();
+        const vegetation::VegetationGrid copy = held->vegetation;
+        const uint64_t tick = held->tick;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        assert(held->tick == tick && sameVisible(held->vegetation, copy));
+    }
+
+    // Suspended: no ticks, commands wait
+    sim.setSuspended(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    uint64_t frozen = 0;
+    {
+        SimulationThread::Pause pause(&sim);
+        frozen = sim.acquire()->tick;
+    }
+    assert(sim.post([&](TerrainMap&) { ++actions; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    assert(sim.acquire()->tick == frozen && actions == 2);
+    sim.setSuspended(false);
+    while (sim.acquire()->tick == frozen) std::this_thread::yield();
+    sim.stop();
+    assert(actions == 3);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_thread_matches_synchronous_steps() {
+    std::cout << "Running test_thread_matches_synchronous_steps..." << std::endl;
+    auto threaded = makeWorld(160, 128);
+    auto stepped = makeWorld(160, 128);
+    SimulationParameters params;
+    SimulationSettings settings;
+    settings.ticksPerSecond = 0.0;
+
+    SimulationThread sim;
+    sim.start(*threaded, params, settings);
+    while (!sim.acquire() || sim.acquire()->tick < 12) std::this_thread::yield();
+    sim.stop();
+    const uint64_t ticks = sim.acquire()->tick;
+
+    SimulationThread sync;
+    sync.attach(*stepped, params, settings);
+    for (uint64_t t = 0; t < ticks; ++t) sync.step();
+    assert(sync.acquire()->tick == ticks);
+    assert(sameVisible(*threaded->getVegetation(), *stepped->getVegetation()));
+    assert(threaded->getLandscapeSoil()->depth == stepped->getLandscapeSoil()->depth);
+    assert(threaded->getLandscapeHydro()->erosion_risk == stepped->getLandscapeHydro()->erosion_risk);
+    std::cout << "PASSED" << std::endl;
+}
+
+// Frame loop: vegetation texture diff + ~4 ms of "rendering". Inline, every
+// 10 Hz tick lands inside a frame; threaded, frames only consume snapshots.
+void bench_frame_times() {
+    std::cout << "Running bench_frame_times..." << std::endl;
+    auto map = makeWorld(1024, 1024);
+    auto* veg = map->getVegetation();
+    auto* soil = map->getLandscapeSoil();
+    auto* hydro = map->getLandscapeHydro();
+    SimulationParameters params;
+    const auto runFor = std::chrono::seconds(3);
+
+    auto frameLoop = [&](auto&& perFrame) {
+        std::vector<double> frameMs;
+        vegetation::VegetationTextureCache cache;
+        const auto end = Clock::now() + runFor;
+        while (Clock::now() < end) {
+            const auto t0 = Clock::now();
+            perFrame(cache);
+            const auto busy = t0 + std::chrono::milliseconds(4);
+            while (Clock::now() < busy) {}
+            frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+        }
+        std::sort(frameMs.begin(), frameMs.end());
+        return frameMs;
+    };
+    auto report = [](const char* label, const std::vector<double>& ms, uint64_t ticks) {
+        std::cout << "  " << label << ": " << ms.size() << " frames, p50 " << ms[ms.size() / 2] << " ms, p99 "
+                  << ms[ms.size() * 99 / 100] << " ms, max " << ms.back() << " ms, " << ticks << " ticks" << std::endl;
+    };
+
+    // Inline (previous behaviour)
+    uint64_t inlineTicks = 0;
+    int soilRow = 0;
+    auto lastTick = Clock::now();
+    auto inlineMs = frameLoop([&](vegetation::VegetationTextureCache& cache) {
+        if (Clock::now() - lastTick >= std::chrono::milliseconds(100)) {
+            lastTick = Clock::now();
+            const int end = std::min(soilRow + 32, map->getHeight());
+            landscape::SoilSystem::update(*soil, 0.1f, params.climate, params.organism, params.parent, *map, soilRow, end);
+            soilRow = end >= map->getHeight() ? 0 : end;
+            landscape::HydroSystem::update(*hydro, *soil, *veg, params.rainIntensity, 0.1f);
+            vegetation::VegetationSystem::update(*veg, 0.1f, params.disturbance, soil, hydro);
+            ++inlineTicks;
+        }
+        cache.update(*veg);
+    });
+    report("inline  ", inlineMs, inlineTicks);
+
+    // Simulation thread at the same 10 Hz, then unthrottled
+    for (double rate : {10.0, 0.0}) {
+        SimulationSettings settings;
+        settings.ticksPerSecond = rate;
+        SimulationThread sim;
+        sim.start(*map, params, settings);
+        uint64_t ticks = 0;
+        auto threadMs = frameLoop([&](vegetation::VegetationTextureCache& cache) {
+            auto frame = sim.acquire();
+            if (frame) {
+                cache.update(frame->vegetation);
+                ticks = frame->tick;
+            }
+        });
+        sim.stop();
+        report(rate > 0.0 ? "thread10" : "threadMax", threadMs, ticks);
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_command_queue();
+    test_frames_commands_and_pause();
+    test_thread_matches_synchronous_steps();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_frame_times();
+    }
+    std::cout << "All simulation thread tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "../src/landscape/soil_system.h"
+#include "../src/terrain/terrain_map.h"
+#include "test_helpers.h"
+
+using namespace landscape;
+using Clock = std::chrono::steady_clock;
+
+static SiBCSUserSelection makeSelection(SiBCSOrder order, SiBCSSubOrder sub = SiBCSSubOrder::kNone,
+                                        SiBCSSeries series = SiBCSSeries::kNone) {
+    SiBCSUserSelection s;
+    s.order = order;
+    s.suborder = sub;
+    s.series = series;
+    return s;
+}
+
+static SiBCSUserConfig confirmed(std::vector<SiBCSUserSelection> selections) {
+    SiBCSUserConfig config;
+    config.selections = std::move(selections);
+    config.applyConstraints = true;
+    config.domainConfirmed = true;
+    return config;
+}
+
+// Orders and taxa painted in stripes; every 5th cell left unclassified
+static void paint(SoilGrid& grid) {
+    const SoilType types[4] = {SoilType::Latossolo, SoilType::Argissolo, SoilType::Gleissolo, SoilType::Cambissolo};
+    SoilTaxon taxa[3];
+    taxa[1].suborder = SiBCSSubOrder::kVermelho;
+    taxa[2].suborder = SiBCSSubOrder::kHaplic;
+    taxa[2].series = SiBCSSeries::kVarzea;
+    for (size_t i = 0; i < grid.taxon.size(); ++i) {
+        grid.soil_type[i] = i % 5 == 0 ? static_cast<uint8_t>(SoilType::Undefined) : static_cast<uint8_t>(types[(i / 3) % 4]);
+        grid.setTaxon(i, taxa[(i / 7) % 3]);
+    }
+}
+
+// Reference: the candidate scan SoilSystem::initialize used to run per cell
+static int referenceMatch(const std::vector<SiBCSUserSelection>& selections, SoilType type, const SoilTaxon& taxon) {
+    SiBCSOrder order = SiBCSOrder::kNone;
+    switch (type) {
+        case SoilType::Latossolo: order = SiBCSOrder::kLatossolo; break;
+        case SoilType::Argissolo: order = SiBCSOrder::kArgissolo; break;
+        case SoilType::Cambissolo: order = SiBCSOrder::kCambissolo; break;
+        case SoilType::Gleissolo: order = SiBCSOrder::kGleissolo; break;
+        default: return -2;
+    }
+    for (size_t c = 0; c < selections.size(); ++c) {
+        const SiBCSUserSelection& s = selections[c];
+        if (s.order != order) continue;
+        if (s.suborder != SiBCSSubOrder::kNone && s.suborder != taxon.suborder) continue;
+        if (s.series != SiBCSSeries::kNone && s.series != taxon.series) continue;
+        return static_cast<int>(c);
+    }
+    return -1;
+}
+
+void test_domain_membership() {
+    std::cout << "Running test_domain_membership..." << std::endl;
+    terrain::TerrainMap terrain(2, 2); // Classification does not read the terrain
+    SoilGrid grid;
+    grid.resize(64, 48);
+    paint(grid);
+    const SoilGrid before = grid;
+
+    const std::vector<SiBCSUserSelection> selections = {
+        makeSelection(SiBCSOrder::kLatossolo),
+        makeSelection(SiBCSOrder::kArgissolo, SiBCSSubOrder::kVermelho),
+        makeSelection(SiBCSOrder::kGleissolo, SiBCSSubOrder::kHaplic, SiBCSSeries::kVarzea),
+        makeSelection(SiBCSOrder::kLatossolo, SiBCSSubOrder::kVermelho), // Shadowed by the first
+    };
+    const SiBCSUserConfig config = confirmed(selections);
+    SoilSystem::initialize(grid, 7, terrain, SiBCSLevel::Series, &config);
+
+    const float baseDepth[3] = {2.5f, 1.5f, 1.2f}; // Latossolo, Argissolo, Gleissolo
+    int counts[3] = {0, 0, 0};
+    for (size_t i = 0; i < grid.taxon.size(); ++i) {
+        const auto type = static_cast<SoilType>(before.soil_type[i]);
+        const int match = referenceMatch(selections, type, before.taxonAt(i));
+        assert(grid.taxon[i] == before.taxon[i]); // Levels 2-6 are never rewritten
+        if (match == -2) {
+            counts[0]++;
+            assert(grid.soil_type[i] == before.soil_type[i] && grid.depth[i] == before.depth[i]);
+        } else if (match == -1) {
+            counts[1]++;
+            assert(grid.soil_type[i] == static_cast<uint8_t>(SoilType::Undefined) && grid.depth[i] == before.depth[i]);
+        } else {
+            counts[2]++;
+            assert(grid.soil_type[i] == before.soil_type[i]);
+            const float base = baseDepth[std::min(match, 2)];
+            assert(grid.depth[i] >= base * 0.9f - 1e-5f && grid.depth[i] < base * 1.1f + 1e-5f);
+            const float sand = grid.sand_fraction[i], clay = grid.clay_fraction[i];
+            assert(sand + clay <= 0.98f + 1e-4f);
+            assert(std::abs(grid.infiltration[i] - (0.05f + sand * 0.2f) * 1000.0f) < 0.05f);
+        }
+    }
+    assert(counts[0] > 0 && counts[1] > 0 && counts[2] > 0);
+    std::cout << "PASSED (" << counts[2] << " applied, " << counts[1] << " out of domain, " << counts[0]
+              << " unclassified)" << std::endl;
+}
+
+void test_noise_is_deterministic() {
+    std::cout << "Running test_noise_is_deterministic..." << std::endl;
+    terrain::TerrainMap terrain(2, 2);
+    SoilGrid a;
+    a.resize(80, 80);
+    std::fill(a.soil_type.begin(), a.soil_type.end(), static_cast<uint8_t>(SoilType::Latossolo));
+    SoilGrid b = a;
+    SoilGrid c = a;
+
+    // Legacy flat list: allowedOrders act as Order-only selections
+    SiBCSUserConfig config = confirmed({});
+    config.allowedOrders = {SiBCSOrder::kLatossolo};
+    SoilSystem::initialize(a, 11, terrain, SiBCSLevel::Order, &config);
+    SoilSystem::initialize(b, 11, terrain, SiBCSLevel::Order, &config);
+    SoilSystem::initialize(c, 12, terrain, SiBCSLevel::Order, &config);
+    assert(a.depth == b.depth && a.organic_matter == b.organic_matter && a.depth != c.depth);
+
+    // Uniform +-10% around the profile value
+    double sum = 0.0;
+    float lo = 10.0f, hi = 0.0f;
+    for (float d : a.depth) {
+        sum += d;
+        lo = std::min(lo, d);
+        hi = std::max(hi, d);
+    }
+    const double mean = sum / static_cast<double>(a.depth.size());
+    assert(lo >= 2.25f && hi < 2.75f && hi - lo > 0.45f && std::abs(mean - 2.5) < 0.01);
+    std::cout << "PASSED" << std::endl;
+}
+
+void bench_domain_apply() {
+    std::cout << "Running bench_domain_apply..." << std::endl;
+    const int n = 4096;
+    terrain::TerrainMap terrain(2, 2);
+    SoilGrid grid;
+    grid.resize(n, n);
+    paint(grid);
+    const SiBCSUserConfig config = confirmed({
+        makeSelection(SiBCSOrder::kLatossolo),
+        makeSelection(SiBCSOrder::kArgissolo, SiBCSSubOrder::kVermelho),
+        makeSelection(SiBCSOrder::kGleissolo, SiBCSSubOrder::kHaplic, SiBCSSeries::kVarzea),
+    });
+
+    const auto t0 = Clock::now();
+    SoilSystem::initialize(grid, 3, terrain, SiBCSLevel::Series, &config);
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::cout << "  " << n << "x" << n << " domain apply: " << ms << " ms" << std::endl;
+    assert(ms < 1000.0);
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_domain_membership();
+    test_noise_is_deterministic();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_domain_apply();
+    }
+    std::cout << "All soil domain tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "../src/terrain/terrain_generator.h"
+#include "../src/core/job_system.h"
+#include "test_helpers.h"
+
+using namespace terrain;
+
+static void makeRamp(TerrainMap& map, float resolution) {
+    // Slope grows along x: every slope class (and so every candidate set) appears
+    for (int z = 0; z < map.getHeight(); ++z) {
+        for (int x = 0; x < map.getWidth(); ++x) {
+            float t = static_cast<float>(x) / static_cast<float>(map.getWidth());
+            map.setHeight(x, z, 0.5f * t * t * static_cast<float>(map.getWidth()) * resolution);
+        }
+    }
+}
+
+void test_slope_classes() {
+    std::cout << "Running test_slope_classes..." << std::endl;
+    TerrainMap map(512, 64);
+    TerrainConfig config;
+    config.resolution = 1.0f;
+    makeRamp(map, config.resolution);
+
+    TerrainGenerator gen(11);
+    gen.classifySoil(map, config);
+
+    for (int z = 0; z < map.getHeight(); ++z) {
+        // Flat end: one of the < 3% candidates; steep end: rock
+        SoilType flat = map.getSoil(0, z);
+        assert(flat == SoilType::Hidromorfico || flat == SoilType::BTextural || flat == SoilType::Argila);
+        assert(map.getSoil(map.getWidth() - 2, z) == SoilType::Rocha);
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_cached_and_thread_independent() {
+    std::cout << "Running test_cached_and_thread_independent..." << std::endl;
+    TerrainMap map(700, 300); // Not a multiple of any lattice step
+    TerrainConfig config;
+    config.resolution = 0.5f;
+    makeRamp(map, config.resolution);
+
+    TerrainGenerator gen(5);
+    {
+        core::JobSystem::ThreadLimit serial(1);
+        gen.classifySoil(map, config);
+    }
+    const core::GridVector<uint8_t> first = map.soilMap();
+
+    // Second pass reuses the cached pattern lattices, on every pool thread
+    gen.classifySoil(map, config);
+    assert(map.soilMap() == first);
+
+    // A fresh generator (cold cache) agrees as well
+    TerrainGenerator other(5);
+    other.classifySoil(map, config);
+    assert(map.soilMap() == first);
+
+    // Patterns vary across the map (competition is not degenerate)
+    size_t changes = 0;
+    for (size_t i = 1; i < first.size(); ++i) changes += first[i] != first[i - 1] ? 1 : 0;
+    assert(changes > 100);
+    std::cout << "PASSED" << std::endl;
+}
+
+void bench_large_map() {
+    std::cout << "Running bench_large_map..." << std::endl;
+    TerrainMap map(2048, 2048);
+    TerrainConfig config;
+    config.resolution = 1.0f;
+    TerrainGenerator gen(config.seed);
+    gen.generateBaseTerrain(map, config);
+
+    using clock = std::chrono::steady_clock;
+    auto ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    auto t0 = clock::now();
+    gen.classifySoil(map, config);
+    auto t1 = clock::now();
+    gen.classifySoil(map, config);
+    auto t2 = clock::now();
+    std::cout << "  2048^2 classifySoil: cold " << ms(t1 - t0) << " ms, cached " << ms(t2 - t1) << " ms" << std::endl;
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_slope_classes();
+    test_cached_and_thread_independent();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_large_map();
+    }
+    std::cout << "All soil pattern tests passed!" << std::endl;
+    return 0;
+}
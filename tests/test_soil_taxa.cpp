@@ -0,0 +1,173 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "../src/terrain/soil_palette.h"
+#include "../src/terrain/terrain_map.h"
+#include "../src/terrain/world_snapshot.h"
+#include "test_helpers.h"
+
+using namespace landscape;
+using Clock = std::chrono::steady_clock;
+
+static SoilTaxon makeTaxon(SiBCSSubOrder sub, SiBCSGreatGroup group = SiBCSGreatGroup::kNone,
+                           SiBCSSeries series = SiBCSSeries::kNone) {
+    SoilTaxon t;
+    t.suborder = sub;
+    t.greatGroup = group;
+    t.series = series;
+    return t;
+}
+
+void test_dictionary() {
+    std::cout << "Running test_dictionary..." << std::endl;
+    TaxonDictionary taxa;
+    assert(taxa.size() == 1 && taxa[TaxonDictionary::kUnrefined] == SoilTaxon());
+    assert(taxa.intern(SoilTaxon()) == TaxonDictionary::kUnrefined);
+
+    const SoilTaxon red = makeTaxon(SiBCSSubOrder::kVermelho, SiBCSGreatGroup::kDistrofico);
+    const SoilTaxon yellow = makeTaxon(SiBCSSubOrder::kAmarelo);
+    const TaxonID a = taxa.intern(red);
+    const TaxonID b = taxa.intern(yellow);
+    assert(a == 1 && b == 2 && taxa.intern(red) == a && taxa.size() == 3);
+    TaxonID found = 0;
+    assert(taxa.find(yellow, found) && found == b);
+    assert(!taxa.find(makeTaxon(SiBCSSubOrder::kBruno), found));
+
+    const std::vector<int> groups = taxa.tabulate([](const SoilTaxon& t) { return static_cast<int>(t.greatGroup); });
+    assert(groups.size() == 3 && groups[a] == static_cast<int>(SiBCSGreatGroup::kDistrofico) && groups[b] == 0);
+
+    // Entry 0 must stay unrefined and entries unique; a rejected assign changes nothing
+    assert(!taxa.assign({red, yellow}));
+    assert(!taxa.assign({SoilTaxon(), red, red}));
+    assert(taxa.size() == 3 && taxa[a] == red);
+    assert(taxa.assign({SoilTaxon(), yellow}) && taxa.size() == 2 && taxa.intern(yellow) == 1);
+    taxa.clear();
+    assert(taxa.size() == 1 && !taxa.find(yellow, found));
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_grid_taxa() {
+    std::cout << "Running test_grid_taxa..." << std::endl;
+    SoilGrid grid;
+    grid.resize(40, 30);
+    assert(grid.taxon.size() == 40 * 30 && grid.taxonAt(77) == SoilTaxon());
+
+    const SoilTaxon sandy = makeTaxon(SiBCSSubOrder::kQuartzarenico, SiBCSGreatGroup::kOrtico, SiBCSSeries::kAreias);
+    for (size_t i = 0; i < grid.taxon.size(); i += 2) grid.setTaxon(i, sandy);
+    assert(grid.taxa.size() == 2 && grid.taxonAt(10) == sandy && grid.taxonAt(11) == SoilTaxon());
+
+    // A new layout resets every cell, so the dictionary starts over with it
+    grid.resize(8, 8);
+    assert(grid.taxa.size() == 1 && grid.taxonAt(10) == SoilTaxon());
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_color_table() {
+    std::cout << "Running test_color_table..." << std::endl;
+    TaxonDictionary taxa;
+    taxa.intern(makeTaxon(SiBCSSubOrder::kVermelho, SiBCSGreatGroup::kFerrico));
+    taxa.intern(makeTaxon(SiBCSSubOrder::kBruno, SiBCSGreatGroup::kAcrico, SiBCSSeries::kSerra));
+    taxa.intern(makeTaxon(SiBCSSubOrder::kTiomorfico, SiBCSGreatGroup::kNone, SiBCSSeries::kVarzea));
+
+    for (int level = 1; level <= 6; ++level) {
+        const SiBCSLevel viewLevel = static_cast<SiBCSLevel>(level);
+        const terrain::SoilColorTable table(viewLevel, taxa);
+        for (int stored = 0; stored < 256; ++stored) {
+            for (size_t t = 0; t < taxa.size(); ++t) {
+                const SoilTaxon& taxon = taxa[static_cast<TaxonID>(t)];
+                float rgb[3];
+                terrain::SoilPalette::getCumulativeColor(viewLevel, terrain::soilTypeOf(static_cast<uint8_t>(stored)),
+                                                         taxon.suborder, taxon.greatGroup, taxon.subGroup,
+                                                         taxon.family, taxon.series, rgb);
+                const float* c = table.color(static_cast<uint8_t>(stored), static_cast<TaxonID>(t));
+                assert(c[0] == rgb[0] && c[1] == rgb[1] && c[2] == rgb[2]);
+            }
+        }
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_snapshot_taxa() {
+    std::cout << "Running test_snapshot_taxa..." << std::endl;
+    const std::string path = (std::filesystem::temp_directory_path() / "sister_soil_taxa.world").string();
+    terrain::TerrainMap map(50, 20);
+    SoilGrid& soil = *map.getLandscapeSoil();
+    const SoilTaxon red = makeTaxon(SiBCSSubOrder::kVermelho, SiBCSGreatGroup::kEutrofico);
+    const SoilTaxon gley = makeTaxon(SiBCSSubOrder::kHaplic, SiBCSGreatGroup::kTbDistrofico, SiBCSSeries::kVarzea);
+    for (size_t i = 0; i < soil.taxon.size(); ++i) soil.setTaxon(i, i % 7 == 0 ? gley : (i % 2 ? red : SoilTaxon()));
+
+    for (bool compress : {false, true}) {
+        terrain::SnapshotOptions options;
+        options.compress = compress;
+        assert(terrain::WorldSnapshot::save(path, map, terrain::SnapshotInfo(), options));
+        terrain::TerrainMap loaded(4, 4);
+        loaded.getLandscapeSoil()->setTaxon(0, makeTaxon(SiBCSSubOrder::kBruno)); // Replaced by the file's
+        assert(terrain::WorldSnapshot::load(path, loaded));
+        const SoilGrid& s = *loaded.getLandscapeSoil();
+        assert(s.taxa.entries() == soil.taxa.entries() && s.taxon == soil.taxon);
+        assert(s.taxonAt(14) == gley && s.taxonAt(15) == red && s.taxonAt(16) == SoilTaxon());
+    }
+
+    // An index past the dictionary is corrupt data
+    soil.taxon[3] = static_cast<TaxonID>(soil.taxa.size());
+    assert(terrain::WorldSnapshot::save(path, map, terrain::SnapshotInfo()));
+    terrain::TerrainMap rejected(4, 4);
+    assert(!terrain::WorldSnapshot::load(path, rejected));
+    std::remove(path.c_str());
+    std::cout << "PASSED" << std::endl;
+}
+
+void bench_color_lookup() {
+    std::cout << "Running bench_color_lookup..." << std::endl;
+    const int n = 2048;
+    SoilGrid grid;
+    grid.resize(n, n);
+    const SoilTaxon taxa[4] = {
+        SoilTaxon(), makeTaxon(SiBCSSubOrder::kVermelho, SiBCSGreatGroup::kDistrofico),
+        makeTaxon(SiBCSSubOrder::kAmarelo, SiBCSGreatGroup::kAcrico, SiBCSSeries::kCerradoNativo),
+        makeTaxon(SiBCSSubOrder::kHaplic, SiBCSGreatGroup::kTbEutrofico)};
+    for (size_t i = 0; i < grid.taxon.size(); ++i) {
+        grid.soil_type[i] = static_cast<uint8_t>(10 + (i / 97) % 7);
+        grid.setTaxon(i, taxa[(i / 331) % 4]);
+    }
+
+    const SiBCSLevel level = SiBCSLevel::Series;
+    float sum[2] = {0.0f, 0.0f};
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < grid.taxon.size(); ++i) {
+        const SoilTaxon& t = grid.taxonAt(i);
+        float rgb[3];
+        terrain::SoilPalette::getCumulativeColor(level, terrain::soilTypeOf(grid.soil_type[i]), t.suborder,
+                                                 t.greatGroup, t.subGroup, t.family, t.series, rgb);
+        sum[0] += rgb[0] + rgb[1] + rgb[2];
+    }
+    const double perCell = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    t0 = Clock::now();
+    const terrain::SoilColorTable table(level, grid.taxa);
+    for (size_t i = 0; i < grid.taxon.size(); ++i) {
+        const float* rgb = table.color(grid.soil_type[i], grid.taxon[i]);
+        sum[1] += rgb[0] + rgb[1] + rgb[2];
+    }
+    const double lookup = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    assert(sum[0] == sum[1]);
+    std::cout << "  " << n << "x" << n << " colours: per cell " << perCell << " ms, table " << lookup << " ms ("
+              << grid.taxa.size() << " taxa)" << std::endl;
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_dictionary();
+    test_grid_taxa();
+    test_color_table();
+    test_snapshot_taxa();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_color_lookup();
+    }
+    std::cout << "All soil taxa tests passed!" << std::endl;
+    return 0;
+}
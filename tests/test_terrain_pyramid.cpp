@@ -0,0 +1,123 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <map>
+#include "../src/terrain/terrain_map.h"
+#include "../src/terrain/terrain_pyramid.h"
+
+using namespace terrain;
+
+// Brute-force stats of level l cell (x, y) straight from the base map
+static void bruteForce(const TerrainMap& map, int l, int x, int y, float& mn, float& mx, float& mean) {
+    const int cs = 1 << l;
+    mn = 1e30f; mx = -1e30f;
+    double sum = 0.0; int n = 0;
+    for (int z = y * cs; z < std::min((y + 1) * cs, map.getHeight()); ++z) {
+        for (int k = x * cs; k < std::min((x + 1) * cs, map.getWidth()); ++k) {
+            float h = map.getHeight(k, z);
+            mn = std::min(mn, h);
+            mx = std::max(mx, h);
+            sum += h; ++n;
+        }
+    }
+    mean = static_cast<float>(sum / n);
+}
+
+static void fill(TerrainMap& map, float phase) {
+    for (int z = 0; z < map.getHeight(); ++z) {
+        for (int x = 0; x < map.getWidth(); ++x) {
+            map.setHeight(x, z, 50.0f + 40.0f * std::sin(x * 0.07f + phase) * std::cos(z * 0.05f) + (x * 7 + z * 13) % 5);
+            map.setSoil(x, z, static_cast<SoilType>(1 + ((x / 3 + z / 5) % 3)));
+        }
+    }
+}
+
+static void checkAgainstBruteForce(const TerrainMap& map) {
+    const TerrainPyramid& p = map.pyramid();
+    for (int l = 1; l <= p.levelCount(); ++l) {
+        const TerrainPyramid::Level& level = p.level(l);
+        for (int y = 0; y < level.height; y += 3) {
+            for (int x = 0; x < level.width; x += 3) {
+                float mn, mx, mean;
+                bruteForce(map, l, x, y, mn, mx, mean);
+                assert(level.minHeight[level.index(x, y)] == mn);
+                assert(level.maxHeight[level.index(x, y)] == mx);
+                assert(std::abs(level.meanHeight[level.index(x, y)] - mean) < 1e-3f);
+            }
+        }
+    }
+}
+
+void test_levels_match_brute_force() {
+    std::cout << "Running test_levels_match_brute_force..." << std::endl;
+    // Non power-of-two: exercises clipped edge blocks
+    TerrainMap map(300, 170);
+    fill(map, 0.0f);
+
+    const TerrainPyramid& p = map.pyramid();
+    assert(p.level(1).width == 150 && p.level(1).height == 85);
+    assert(p.level(p.levelCount()).width == 1 && p.level(p.levelCount()).height == 1);
+    checkAgainstBruteForce(map);
+
+    // Level 1 majority is exact (2x2 blocks)
+    const TerrainPyramid::Level& l1 = p.level(1);
+    for (int y = 0; y < l1.height; ++y) {
+        for (int x = 0; x < l1.width; ++x) {
+            std::map<int, int> counts;
+            for (int z = 2 * y; z < std::min(2 * y + 2, map.getHeight()); ++z)
+                for (int k = 2 * x; k < std::min(2 * x + 2, map.getWidth()); ++k)
+                    counts[static_cast<int>(map.getSoil(k, z))]++;
+            int best = 0;
+            for (auto& kv : counts) best = std::max(best, kv.second);
+            assert(counts[l1.soil[l1.index(x, y)]] == best);
+        }
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_incremental_update() {
+    std::cout << "Running test_incremental_update..." << std::endl;
+    TerrainMap map(257, 129);
+    fill(map, 0.0f);
+    map.pyramid();
+    assert(!map.pyramid().isDirty());
+
+    // Raise a bump inside one region and report only that region
+    for (int z = 70; z < 90; ++z) {
+        for (int x = 200; x < 230; ++x) {
+            map.setHeight(x, z, 500.0f + static_cast<float>(x - z));
+        }
+    }
+    map.markDirty(200, 70, 230, 90);
+    checkAgainstBruteForce(map);
+
+    const TerrainPyramid& p = map.pyramid();
+    const TerrainPyramid::Level& top = p.level(p.levelCount());
+    assert(top.maxHeight[0] == 500.0f + (229 - 70));
+
+    // Max chain leads back to the summit cell
+    int px, py;
+    p.locateMax(p.levelCount(), 0, 0, map.heightMap(), px, py);
+    assert(px == 229 && py == 70);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_level_selection() {
+    std::cout << "Running test_level_selection..." << std::endl;
+    TerrainMap map(4096, 16);
+    const TerrainPyramid& p = map.pyramid();
+    assert(p.levelForFootprint(1.0f) == 0);
+    assert(p.levelForFootprint(8.0f) == 3);   // 4096 -> 512 texels
+    assert(p.levelForFootprint(9.5f) == 3);
+    assert(p.levelForFootprint(1e9f) == p.levelCount());
+    std::cout << "PASSED" << std::endl;
+}
+
+int main() {
+    test_levels_match_brute_force();
+    test_incremental_update();
+    test_level_selection();
+    std::cout << "All terrain pyramid tests passed!" << std::endl;
+    return 0;
+}
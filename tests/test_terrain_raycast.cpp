@@ -0,0 +1,162 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../src/terrain/terrain_map.h"
+#include "../src/terrain/terrain_raycast.h"
+#include "test_helpers.h"
+
+using namespace terrain;
+
+// Pre-v4.7.0 picking (fixed 0.5-cell march, nearest sample), kept as the benchmark baseline
+static bool legacyMarch(const TerrainMap& map, const math::Ray& ray, float maxDist, float gridScale, int& outX, int& outZ, math::Vec3& outHitPos) {
+    float t = 0.0f;
+    float step = 0.5f * gridScale;
+    while (t < maxDist) {
+        math::Vec3 p = ray.origin + ray.direction * t;
+        int x = static_cast<int>(std::round(p.x / gridScale));
+        int z = static_cast<int>(std::round(p.z / gridScale));
+        if (x >= 0 && x < map.getWidth() && z >= 0 && z < map.getHeight()) {
+            if (p.y <= map.getHeight(x, z)) {
+                outX = x; outZ = z; outHitPos = p;
+                return true;
+            }
+        }
+        t += step;
+    }
+    return false;
+}
+
+static float bilinear(const TerrainMap& map, float gx, float gz) {
+    int i = std::min(static_cast<int>(gx), map.getWidth() - 2);
+    int j = std::min(static_cast<int>(gz), map.getHeight() - 2);
+    float u = gx - i, v = gz - j;
+    return map.getHeight(i, j) * (1 - u) * (1 - v) + map.getHeight(i + 1, j) * u * (1 - v) +
+           map.getHeight(i, j + 1) * (1 - u) * v + map.getHeight(i + 1, j + 1) * u * v;
+}
+
+static void fill(TerrainMap& map) {
+    for (int z = 0; z < map.getHeight(); ++z) {
+        for (int x = 0; x < map.getWidth(); ++x) {
+            float h = 60.0f + 30.0f * std::sin(x * 0.031f) * std::cos(z * 0.027f) + 8.0f * std::sin(x * 0.21f + z * 0.17f);
+            map.setHeight(x, z, h);
+        }
+    }
+}
+
+static std::vector<math::Ray> makeRays(const TerrainMap& map, float gridScale, size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> ux(0.0f, (map.getWidth() - 1) * gridScale);
+    std::uniform_real_distribution<float> uz(0.0f, (map.getHeight() - 1) * gridScale);
+    std::vector<math::Ray> rays(n);
+    for (auto& r : rays) {
+        math::Vec3 from{ux(rng), 180.0f, uz(rng)};
+        math::Vec3 to{ux(rng), 0.0f, uz(rng)};
+        r.origin = from;
+        r.direction = math::normalize(to - from);
+    }
+    return rays;
+}
+
+void test_hits_lie_on_surface() {
+    std::cout << "Running test_hits_lie_on_surface..." << std::endl;
+    const float gs = 2.0f;
+    TerrainMap map(301, 203);
+    fill(map);
+
+    auto rays = makeRays(map, gs, 2000, 1);
+    std::vector<RayHit> hits(rays.size());
+    raycastBatch(map, rays.data(), rays.size(), 5000.0f, gs, hits.data());
+
+    for (size_t i = 0; i < rays.size(); ++i) {
+        assert(hits[i].hit); // All rays start above and end below the surface inside the map
+        const RayHit& h = hits[i];
+        float gx = h.position.x / gs, gz = h.position.z / gs;
+        assert(std::abs(h.position.y - bilinear(map, gx, gz)) < 1e-2f);
+        assert(h.cellX == std::min(static_cast<int>(gx), map.getWidth() - 2) || std::abs(gx - std::round(gx)) < 1e-3f);
+
+        // Nothing earlier along the ray is below the surface (dense reference)
+        for (float t = 0.0f; t < h.t - 0.05f; t += 0.05f) {
+            math::Vec3 p = rays[i].origin + rays[i].direction * t;
+            float px = p.x / gs, pz = p.z / gs;
+            if (px < 0 || pz < 0 || px > map.getWidth() - 1 || pz > map.getHeight() - 1) continue;
+            assert(p.y > bilinear(map, px, pz) - 1e-3f);
+        }
+
+        // Batch == single
+        RayHit single = raycast(map, rays[i], 5000.0f, gs);
+        assert(single.hit && single.t == h.t && single.x == h.x && single.z == h.z);
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_thin_ridge_no_tunnelling() {
+    std::cout << "Running test_thin_ridge_no_tunnelling..." << std::endl;
+    TerrainMap map(64, 64);
+    // Flat ground with a single-sample wall at x = 30
+    for (int z = 0; z < 64; ++z) {
+        for (int x = 0; x < 64; ++x) map.setHeight(x, z, x == 30 ? 50.0f : 0.0f);
+    }
+
+    // Nearly horizontal ray at y = 40 crossing the wall between samples
+    math::Ray ray{{10.0f, 40.0f, 20.3f}, math::normalize(math::Vec3{1.0f, -0.001f, 0.0f})};
+    RayHit hit = raycast(map, ray, 100.0f, 1.0f);
+    assert(hit.hit);
+    assert(hit.position.x > 29.0f && hit.position.x <= 30.0f);
+    assert(hit.x == 30 || hit.x == 29);
+
+    // Ray that stays above everything misses
+    math::Ray high{{0.0f, 60.0f, 5.0f}, math::normalize(math::Vec3{1.0f, 0.0f, 0.3f})};
+    assert(!raycast(map, high, 1000.0f, 1.0f).hit);
+
+    // Ray pointing away from the map misses
+    math::Ray away{{-5.0f, 10.0f, -5.0f}, math::normalize(math::Vec3{-1.0f, -0.1f, -1.0f})};
+    assert(!raycast(map, away, 1000.0f, 1.0f).hit);
+    std::cout << "PASSED" << std::endl;
+}
+
+void bench_against_legacy() {
+    std::cout << "Running bench_against_legacy..." << std::endl;
+    const float gs = 1.0f;
+    TerrainMap map(2048, 2048);
+    fill(map);
+    map.pyramid(); // Built once per terrain change; excluded from per-ray timing
+
+    auto rays = makeRays(map, gs, 20000, 7);
+    using clock = std::chrono::steady_clock;
+
+    auto t0 = clock::now();
+    int legacyHits = 0;
+    for (const auto& r : rays) {
+        int x, z; math::Vec3 p;
+        legacyHits += legacyMarch(map, r, 1000.0f * gs, gs, x, z, p) ? 1 : 0;
+    }
+    auto t1 = clock::now();
+    int newHits = 0;
+    for (const auto& r : rays) newHits += raycast(map, r, 1000.0f * gs, gs).hit ? 1 : 0;
+    auto t2 = clock::now();
+    std::vector<RayHit> out(rays.size());
+    raycastBatch(map, rays.data(), rays.size(), 1000.0f * gs, gs, out.data());
+    auto t3 = clock::now();
+
+    auto us = [](clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+    std::cout << "  legacy march : " << us(t1 - t0) / rays.size() << " us/ray (" << legacyHits << " hits)" << std::endl;
+    std::cout << "  quadtree DDA : " << us(t2 - t1) / rays.size() << " us/ray (" << newHits << " hits)" << std::endl;
+    std::cout << "  batch        : " << us(t3 - t2) / rays.size() << " us/ray" << std::endl;
+    // The marcher tests nearest samples (half a cell past the last patch, and
+    // misses thin features), so counts differ slightly at the map borders
+    assert(std::abs(newHits - legacyHits) < static_cast<int>(rays.size()) / 100);
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_hits_lie_on_surface();
+    test_thin_ridge_no_tunnelling();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_against_legacy();
+    }
+    std::cout << "All terrain raycast tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <chrono>
+#include <map>
+#include <utility>
+#include <vector>
+#include "../src/terrain/terrain_map.h"
+#include "../src/terrain/terrain_rtin.h"
+
+using namespace terrain;
+
+static void fill(TerrainMap& map) {
+    for (int z = 0; z < map.getHeight(); ++z) {
+        for (int x = 0; x < map.getWidth(); ++x) {
+            // Broad flat valley floor with a ridge along one side
+            float valley = 20.0f + 0.002f * static_cast<float>((x - 100) * (x - 100));
+            float ridge = x > 300 ? 40.0f * std::sin(x * 0.05f) * std::cos(z * 0.04f) : 0.0f;
+            float rough = (x > 120 && x < 160) ? static_cast<float>((x * 73856093u ^ z * 19349663u) % 1000u) * 0.004f : 0.0f;
+            map.setHeight(x, z, valley + ridge + rough);
+        }
+    }
+}
+
+// Every sample covered by a triangle is within maxError of the planar interpolation,
+// the triangles tile the map exactly, and edges match up (no T-junctions)
+static void checkMesh(const TerrainMap& map, const std::vector<uint32_t>& idx, float maxError) {
+    const int w = map.getWidth();
+    const int h = map.getHeight();
+    assert(idx.size() % 3 == 0);
+
+    double area = 0.0;
+    std::map<std::pair<uint32_t, uint32_t>, int> edges;
+    for (size_t t = 0; t < idx.size(); t += 3) {
+        int px[3], pz[3];
+        for (int k = 0; k < 3; ++k) {
+            assert(idx[t + k] < static_cast<uint32_t>(w * h));
+            px[k] = static_cast<int>(idx[t + k] % static_cast<uint32_t>(w));
+            pz[k] = static_cast<int>(idx[t + k] / static_cast<uint32_t>(w));
+            uint32_t a = idx[t + k], b = idx[t + (k + 1) % 3];
+            edges[{std::min(a, b), std::max(a, b)}]++;
+        }
+        // Same winding as the full grid (negative signed area in x/z)
+        double cross = static_cast<double>(px[1] - px[0]) * (pz[2] - pz[0]) - static_cast<double>(pz[1] - pz[0]) * (px[2] - px[0]);
+        assert(cross < 0.0);
+        area += -0.5 * cross;
+
+        int x0 = std::min({px[0], px[1], px[2]}), x1 = std::max({px[0], px[1], px[2]});
+        int z0 = std::min({pz[0], pz[1], pz[2]}), z1 = std::max({pz[0], pz[1], pz[2]});
+        double denom = static_cast<double>(pz[1] - pz[2]) * (px[0] - px[2]) + static_cast<double>(px[2] - px[1]) * (pz[0] - pz[2]);
+        for (int z = z0; z <= z1; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                // Barycentric coordinates
+                double l1 = (static_cast<double>(pz[1] - pz[2]) * (x - px[2]) + static_cast<double>(px[2] - px[1]) * (z - pz[2])) / denom;
+                double l2 = (static_cast<double>(pz[2] - pz[0]) * (x - px[2]) + static_cast<double>(px[0] - px[2]) * (z - pz[2])) / denom;
+                double l3 = 1.0 - l1 - l2;
+                if (l1 < -1e-9 || l2 < -1e-9 || l3 < -1e-9) continue;
+                double interp = l1 * map.getHeight(px[0], pz[0]) + l2 * map.getHeight(px[1], pz[1]) + l3 * map.getHeight(px[2], pz[2]);
+                assert(std::abs(interp - map.getHeight(x, z)) <= maxError + 1e-3);
+            }
+        }
+    }
+    assert(std::abs(area - static_cast<double>(w - 1) * (h - 1)) < 1e-6);
+
+    // Edges used once must lie on the map border; any other single edge is a crack
+    for (const auto& kv : edges) {
+        assert(kv.second <= 2);
+        if (kv.second == 2) continue;
+        int ax = static_cast<int>(kv.first.first % static_cast<uint32_t>(w)), az = static_cast<int>(kv.first.first / static_cast<uint32_t>(w));
+        int bx = static_cast<int>(kv.first.second % static_cast<uint32_t>(w)), bz = static_cast<int>(kv.first.second / static_cast<uint32_t>(w));
+        bool border = (ax == bx && (ax == 0 || ax == w - 1)) || (az == bz && (az == 0 || az == h - 1));
+        assert(border);
+    }
+}
+
+void test_error_bound_and_crack_free() {
+    std::cout << "Running test_error_bound_and_crack_free..." << std::endl;
+    // Power-of-two-plus-one and arbitrary (padded) sizes
+    const int sizes[][2] = {{129, 129}, {200, 75}, {77, 300}};
+    for (const auto& sz : sizes) {
+        TerrainMap map(sz[0], sz[1]);
+        fill(map);
+        TerrainRtin rtin(map);
+        for (float tol : {0.0f, 0.25f, 2.0f, 10.0f}) {
+            auto idx = rtin.triangulate(tol);
+            checkMesh(map, *idx, tol);
+        }
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_flat_map_collapses() {
+    std::cout << "Running test_flat_map_collapses..." << std::endl;
+    TerrainMap map(257, 257);
+    for (int z = 0; z < 257; ++z)
+        for (int x = 0; x < 257; ++x) map.setHeight(x, z, 5.0f + 0.1f * x);  // Planar
+    auto idx = TerrainRtin(map).triangulate(0.01f);
+    assert(idx->size() == 6); // Two triangles
+    checkMesh(map, *idx, 0.01f);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_reduction_and_determinism() {
+    std::cout << "Running test_reduction_and_determinism..." << std::endl;
+    TerrainMap map(1025, 1025);
+    fill(map);
+
+    auto t0 = std::chrono::steady_clock::now();
+    TerrainRtin rtin(map);
+    auto t1 = std::chrono::steady_clock::now();
+    auto idx = rtin.triangulate(0.5f);
+    auto t2 = std::chrono::steady_clock::now();
+
+    const size_t full = static_cast<size_t>(1024) * 1024 * 2;
+    const size_t tris = idx->size() / 3;
+    auto ms = [](std::chrono::steady_clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << "  " << full << " -> " << tris << " triangles (" << static_cast<double>(full) / tris << "x), error map "
+              << ms(t1 - t0) << " ms, triangulate " << ms(t2 - t1) << " ms" << std::endl;
+    assert(tris * 10 < full);
+    assert(*rtin.triangulate(0.5f) == *idx);
+    std::cout << "PASSED" << std::endl;
+}
+
+int main() {
+    test_error_bound_and_crack_free();
+    test_flat_map_collapses();
+    test_reduction_and_determinism();
+    std::cout << "All terrain RTIN tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "../src/graphics/terrain_vertex.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+using namespace graphics;
+
+void test_layout() {
+    std::cout << "Running test_layout..." << std::endl;
+    assert(sizeof(TerrainVertex) == 20);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_oct_normal_roundtrip() {
+    std::cout << "Running test_oct_normal_roundtrip..." << std::endl;
+    float maxErr = 0.0f;
+    // Sweep the sphere including the lower hemisphere and the poles
+    for (int i = 0; i <= 36; ++i) {
+        float theta = 3.14159265f * static_cast<float>(i) / 36.0f;
+        for (int j = 0; j < 72; ++j) {
+            float phi = 2.0f * 3.14159265f * static_cast<float>(j) / 72.0f;
+            float n[3] = { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+            int16_t enc[2];
+            terrain_vertex::encodeOctNormal(n, enc);
+            float d[3];
+            terrain_vertex::decodeOctNormal(enc, d);
+            float len = std::sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+            assert(std::abs(len - 1.0f) < 1e-4f);
+            for (int c = 0; c < 3; ++c) maxErr = std::max(maxErr, std::abs(d[c] - n[c]));
+        }
+    }
+    assert(maxErr < 1e-3f);
+
+    // Unnormalized input and the degenerate zero vector
+    float scaled[3] = {0.0f, 8.0f, 0.0f};
+    int16_t enc[2];
+    terrain_vertex::encodeOctNormal(scaled, enc);
+    float d[3];
+    terrain_vertex::decodeOctNormal(enc, d);
+    assert(std::abs(d[1] - 1.0f) < 1e-4f);
+
+    float zero[3] = {0.0f, 0.0f, 0.0f};
+    terrain_vertex::encodeOctNormal(zero, enc);
+    terrain_vertex::decodeOctNormal(enc, d);
+    assert(std::abs(d[1] - 1.0f) < 1e-4f);
+    std::cout << "PASSED: max component error " << maxErr << std::endl;
+}
+
+void test_scalar_codecs() {
+    std::cout << "Running test_scalar_codecs..." << std::endl;
+    assert(terrain_vertex::packUnorm16(-1.0f) == 0);
+    assert(terrain_vertex::packUnorm16(2.0f) == 65535);
+    assert(terrain_vertex::packUnorm8(1.0f) == 255);
+    assert(terrain_vertex::unpackSnorm16(-32768) == -1.0f);
+
+    // Flux: relative error stays small across the accumulation range
+    const float fluxes[] = {1.0f, 2.0f, 10.0f, 1000.0f, 250000.0f, 16000000.0f};
+    for (float f : fluxes) {
+        float r = terrain_vertex::unpackFlux(terrain_vertex::packFlux(f));
+        assert(std::abs(r - f) / f < 1e-3f);
+    }
+    // Sub-unit flux collapses to 1 (shader treats flux <= 1 as no drainage)
+    assert(terrain_vertex::unpackFlux(terrain_vertex::packFlux(0.5f)) == 1.0f);
+
+    assert(std::abs(terrain_vertex::unpackSediment(terrain_vertex::packSediment(0.3f)) - 0.3f) < 1e-4f);
+
+    // IDs
+    uint32_t ids = terrain_vertex::packIds(123456, 14);
+    assert(terrain_vertex::unpackBasinId(ids) == 123456u);
+    assert(terrain_vertex::unpackSoilId(ids) == 14);
+    assert(terrain_vertex::unpackBasinId(terrain_vertex::packIds(-1, 3)) == 0u);
+    assert(terrain_vertex::unpackBasinId(terrain_vertex::packIds(0x7FFFFFFF, 3)) == terrain_vertex::kMaxBasinId);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_vertex_roundtrip() {
+    std::cout << "Running test_vertex_roundtrip..." << std::endl;
+    TerrainVertexAttributes a;
+    a.height = 123.456f;
+    a.normal[0] = 0.3f; a.normal[1] = 0.9f; a.normal[2] = -0.2f;
+    a.color[0] = 0.55f; a.color[1] = 0.47f; a.color[2] = 0.36f; a.color[3] = 1.0f;
+    a.flux = 4096.0f;
+    a.sediment = 0.25f;
+    a.basinId = 42;
+    a.soilId = 10;
+
+    TerrainVertex v = terrain_vertex::pack(a);
+    TerrainVertexAttributes b = terrain_vertex::unpack(v);
+
+    assert(b.height == a.height);
+    float len = std::sqrt(a.normal[0]*a.normal[0] + a.normal[1]*a.normal[1] + a.normal[2]*a.normal[2]);
+    for (int c = 0; c < 3; ++c) assert(std::abs(b.normal[c] - a.normal[c] / len) < 1e-3f);
+    for (int c = 0; c < 4; ++c) assert(std::abs(b.color[c] - a.color[c]) <= 0.5f / 255.0f + 1e-6f);
+    assert(std::abs(b.flux - a.flux) / a.flux < 1e-3f);
+    assert(std::abs(b.sediment - a.sediment) < 1e-4f);
+    assert(b.basinId == a.basinId);
+    assert(b.soilId == a.soilId);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_height16_roundtrip() {
+    std::cout << "Running test_height16_roundtrip..." << std::endl;
+    assert(sizeof(TerrainGeometry16) == 6);
+    const float maxHeight = 256.0f;
+    const float step = maxHeight / 65535.0f;
+    for (int i = 0; i <= 1000; ++i) {
+        float h = maxHeight * static_cast<float>(i) / 1000.0f;
+        float r = terrain_vertex::unpackHeight16(terrain_vertex::packHeight16(h, maxHeight), maxHeight);
+        assert(std::abs(r - h) <= 0.5f * step + 1e-4f);
+    }
+    // Out-of-range heights saturate; a degenerate scale packs to 0
+    assert(terrain_vertex::packHeight16(-5.0f, maxHeight) == 0);
+    assert(terrain_vertex::packHeight16(300.0f, maxHeight) == 65535);
+    assert(terrain_vertex::packHeight16(10.0f, 0.0f) == 0);
+
+    // The normal survives the trip through the float geometry unchanged
+    float n[3] = {0.3f, 0.9f, -0.2f};
+    TerrainGeometry16 g16 = terrain_vertex::packGeometry16(123.456f, maxHeight, n);
+    TerrainGeometry g = terrain_vertex::toGeometry(g16, maxHeight);
+    TerrainGeometry ref = terrain_vertex::packGeometry(123.456f, n);
+    assert(std::abs(g.height - ref.height) <= 0.5f * step + 1e-4f);
+    assert(g.normal[0] == ref.normal[0] && g.normal[1] == ref.normal[1]);
+    std::cout << "PASSED" << std::endl;
+}
+
+int main() {
+    std::cout << "[Test] Compact TerrainVertex packing..." << std::endl;
+    test_layout();
+    test_oct_normal_roundtrip();
+    test_scalar_codecs();
+    test_vertex_roundtrip();
+    test_height16_roundtrip();
+    std::cout << "[PASS] All terrain vertex tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include "../src/terrain/timeline_recorder.h"
+#include "../src/terrain/terrain_pipeline.h"
+#include "test_helpers.h"
+#include "../src/landscape/hydro_system.h"
+#include "../src/vegetation/vegetation_system.h"
+
+using namespace terrain;
+namespace fs = std::filesystem;
+
+using test_helpers::tempFile;
+
+// Slowly drifting field; the lower band stays constant so its tiles repeat
+static void step(core::GridVector<float>& a, core::GridVector<float>& b, int w, int h, int tick) {
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            const size_t i = static_cast<size_t>(y) * w + x;
+            if (y >= 64) continue;
+            a[i] = 0.5f + 0.5f * std::sin(0.05f * x + 0.02f * tick) * std::cos(0.03f * y);
+            if ((x + tick) % 7 == 0) b[i] += 0.001f * static_cast<float>(tick);
+        }
+    }
+}
+
+void test_record_and_seek() {
+    std::cout << "Running test_record_and_seek..." << std::endl;
+    const int w = 150, h = 90;
+    core::GridVector<float> a(static_cast<size_t>(w) * h, 0.25f), b(a.size(), 1.0f);
+    const std::string path = tempFile("sister_test_timeline.tl");
+
+    TimelineOptions options;
+    options.keyframeInterval = 10;
+    options.tileSize = 32;
+    options.maxPendingFrames = 200; // Never drop here
+    TimelineRecorder recorder;
+    assert(recorder.start(path, w, h, {{"a", &a}, {"b", &b}}, options));
+
+    std::map<uint64_t, std::pair<std::vector<float>, std::vector<float>>> expected;
+    for (int tick = 0; tick < 95; ++tick) {
+        step(a, b, w, h, tick);
+        if (tick % 3 == 0) continue; // Not every tick is recorded
+        assert(recorder.capture(static_cast<uint64_t>(tick), tick * 0.1));
+        expected[static_cast<uint64_t>(tick)] = {std::vector<float>(a.begin(), a.end()), std::vector<float>(b.begin(), b.end())};
+    }
+    assert(recorder.stop());
+    const TimelineStats stats = recorder.stats();
+    assert(stats.written == expected.size() && stats.dropped == 0);
+    assert(stats.keyframes == (expected.size() + 9) / 10);
+    assert(stats.bytes == fs::file_size(path));
+    // Deltas are much smaller than raw frames
+    assert(stats.bytes < expected.size() * a.size() * 8 / 3);
+
+    TimelineReader reader;
+    assert(reader.open(path));
+    assert(reader.width() == w && reader.height() == h && reader.channelCount() == 2);
+    assert(reader.channelIndex("b") == 1 && reader.channelIndex("c") == -1);
+    assert(reader.frameCount() == expected.size());
+    assert(reader.isKeyframe(0) && reader.isKeyframe(10) && !reader.isKeyframe(11));
+
+    // Forward scrub, backwards jumps, repeated reads
+    std::vector<size_t> order;
+    for (size_t f = 0; f < reader.frameCount(); ++f) order.push_back(f);
+    for (size_t f : {size_t(40), size_t(3), size_t(59), size_t(59), size_t(21), size_t(0), size_t(62)}) order.push_back(f);
+    for (size_t f : order) {
+        const auto* frame = reader.read(f);
+        assert(frame);
+        const auto& want = expected.at(reader.tickOf(f));
+        assert((*frame)[0] == want.first && (*frame)[1] == want.second);
+        assert(std::fabs(reader.timeOf(f) - static_cast<double>(reader.tickOf(f)) * 0.1) < 1e-12);
+    }
+    assert(!reader.read(reader.frameCount()));
+
+    assert(reader.tickOf(reader.frameAtTick(0)) == 1);
+    assert(reader.tickOf(reader.frameAtTick(6)) == 5);
+    assert(reader.tickOf(reader.frameAtTick(7)) == 7);
+    assert(reader.tickOf(reader.frameAtTick(1000)) == 94);
+
+    // A recording cut mid-frame is readable up to its last complete frame
+    fs::resize_file(path, fs::file_size(path) - 10);
+    TimelineReader truncated;
+    assert(truncated.open(path));
+    assert(truncated.frameCount() == expected.size() - 1);
+    const auto* last = truncated.read(truncated.frameCount() - 1);
+    assert(last && (*last)[0] == expected.at(truncated.tickOf(truncated.frameCount() - 1)).first);
+    fs::remove(path);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_bounded_memory() {
+    std::cout << "Running test_bounded_memory..." << std::endl;
+    const int w = 1024, h = 1024;
+    core::GridVector<float> a(static_cast<size_t>(w) * h, 0.0f);
+    const std::string path = tempFile("sister_test_timeline_drop.tl");
+    TimelineOptions options;
+    options.maxPendingFrames = 1;
+    TimelineRecorder recorder;
+    assert(recorder.start(path, w, h, {{"a", &a}}, options));
+
+    // Capturing much faster than frames can be encoded: extra frames are dropped
+    std::map<uint64_t, float> valueAt;
+    for (int tick = 0; tick < 40; ++tick) {
+        for (size_t i = 0; i < a.size(); i += 3) a[i] = static_cast<float>(tick) + static_cast<float>(i % 1000) * 1e-3f;
+        if (recorder.capture(static_cast<uint64_t>(tick), tick)) valueAt[static_cast<uint64_t>(tick)] = a[3];
+    }
+    assert(recorder.stop());
+    const TimelineStats stats = recorder.stats();
+    assert(stats.captured == 40 && stats.written + stats.dropped == 40);
+    assert(stats.written == valueAt.size());
+
+    TimelineReader reader;
+    assert(reader.open(path));
+    for (size_t f = 0; f < reader.frameCount(); ++f) assert((*reader.read(f))[0][3] == valueAt.at(reader.tickOf(f)));
+
+    // Mismatched grid is refused up front
+    core::GridVector<float> small(10);
+    std::string error;
+    assert(!recorder.start(path, w, h, {{"small", &small}}, options, &error) && !error.empty());
+    fs::remove(path);
+    std::cout << "PASSED" << std::endl;
+}
+
+void bench_capture_overhead() {
+    std::cout << "Running bench_capture_overhead..." << std::endl;
+    RegenerationInputs in;
+    in.config.width = 1024;
+    in.config.height = 1024;
+    in.config.seed = 9;
+    in.soilMode = 1;
+    TerrainMap map(in.config.width, in.config.height);
+    TerrainPipeline pipeline;
+    pipeline.regenerate(map, in);
+    auto* veg = map.getVegetation();
+    auto* soil = map.getLandscapeSoil();
+    auto* hydro = map.getLandscapeHydro();
+
+    const std::string path = tempFile("sister_bench_timeline.tl");
+    TimelineRecorder recorder;
+    assert(recorder.start(path, map.getWidth(), map.getHeight(),
+                          {{"vegetation_ei", nullptr, &veg->ei_coverage}, {"vegetation_es", nullptr, &veg->es_coverage},
+                           {"soil_depth", &soil->depth}, {"erosion_risk", &hydro->erosion_risk}}));
+    vegetation::DisturbanceRegime regime;
+    double simMs = 0.0;
+    const int ticks = 20;
+    for (int t = 0; t < ticks; ++t) {
+        auto t0 = std::chrono::steady_clock::now();
+        landscape::HydroSystem::update(*hydro, *soil, *veg, 1.0f, 0.1f);
+        vegetation::VegetationSystem::update(*veg, 0.1f, regime, soil, hydro);
+        simMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        recorder.capture(static_cast<uint64_t>(t), t * 0.1);
+    }
+    recorder.stop();
+    const TimelineStats stats = recorder.stats();
+    std::cout << "  1024x1024, 4 channels: sim " << simMs / ticks << " ms/tick, capture " << stats.captureMs / static_cast<double>(stats.captured)
+              << " ms/tick (" << 100.0 * stats.captureMs / simMs << "%), encode " << stats.encodeMs / static_cast<double>(std::max<uint64_t>(1, stats.written))
+              << " ms/frame, " << stats.written << " written, " << stats.dropped << " dropped, "
+              << static_cast<double>(stats.bytes) / (1024.0 * 1024.0) << " MB" << std::endl;
+    fs::remove(path);
+    std::cout << "PASSED" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    test_record_and_seek();
+    test_bounded_memory();
+    if (test_helpers::benchRequested(argc, argv)) {
+        bench_capture_overhead();
+    }
+    std::cout << "All timeline recorder tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include "../src/vegetation/vegetation_types.h"
+#include "../src/vegetation/vegetation_system.h"
+#include "../src/vegetation/vegetation_texture.h"
+
+using namespace vegetation;
+
+static uint8_t referencePack(float v) {
+    return static_cast<uint8_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f);
+}
+
+void test_pack_matches_scalar() {
+    std::cout << "Running test_pack_matches_scalar..." << std::endl;
+    // Odd count exercises the SIMD body and the scalar tail
+    const size_t n = 1031;
+    std::vector<float> r(n), g(n), b(n), a(n);
+    for (size_t i = 0; i < n; ++i) {
+        float t = static_cast<float>(i) / static_cast<float>(n);
+        r[i] = t * 1.4f - 0.2f;          // includes < 0 and > 1
+        g[i] = 1.0f - t;
+        b[i] = std::fmod(t * 7.3f, 1.0f);
+        a[i] = (i % 3 == 0) ? 1.0f : 0.5f;
+    }
+    std::vector<uint8_t> out(n * 4);
+    packRGBA8(r.data(), g.data(), b.data(), a.data(), n, out.data());
+
+    for (size_t i = 0; i < n; ++i) {
+        assert(out[i * 4 + 0] == referencePack(r[i]));
+        assert(out[i * 4 + 1] == referencePack(g[i]));
+        assert(out[i * 4 + 2] == referencePack(b[i]));
+        assert(out[i * 4 + 3] == referencePack(a[i]));
+    }
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_tile_diff() {
+    std::cout << "Running test_tile_diff..." << std::endl;
+    // 2x2 tiles, the right/bottom ones clipped
+    const int w = VegetationGrid::kTileSize + 10;
+    const int h = VegetationGrid::kTileSize + 5;
+    VegetationGrid grid;
+    grid.resize(w, h);
+    assert(grid.tileCount() == 4);
+
+    VegetationTextureCache cache;
+
+    // First use: every tile
+    assert(cache.update(grid).size() == 4);
+    // Nothing touched: nothing to upload
+    assert(cache.update(grid).empty());
+
+    // Touched but texels unchanged: filtered out by the diff
+    grid.touchTile(0);
+    assert(cache.update(grid).empty());
+
+    // Change one cell in the bottom-right tile
+    const int x = VegetationGrid::kTileSize + 3;
+    const int y = VegetationGrid::kTileSize + 2;
+    const size_t idx = static_cast<size_t>(y * w + x);
+    grid.es_coverage[idx] = 0.5f;
+    grid.touchTile(grid.tileOfIndex(idx));
+
+    const std::vector<TextureTile>& tiles = cache.update(grid);
+    assert(tiles.size() == 1);
+    assert(tiles[0].x == VegetationGrid::kTileSize && tiles[0].y == VegetationGrid::kTileSize);
+    assert(tiles[0].width == 10 && tiles[0].height == 5);
+
+    // Tight copy of the tile carries the new texel
+    std::vector<uint8_t> copy(tiles[0].byteSize());
+    cache.copyTile(tiles[0], copy.data());
+    const size_t local = (static_cast<size_t>(y - tiles[0].y) * 10 + static_cast<size_t>(x - tiles[0].x)) * 4;
+    assert(copy[local + 1] == referencePack(0.5f));
+    assert(cache.pixels()[idx * 4 + 1] == referencePack(0.5f));
+
+    // A new grid of the same size is a new generation: full upload
+    VegetationGrid other;
+    other.resize(w, h);
+    assert(cache.update(other).size() == 4);
+
+    cache.invalidate();
+    assert(cache.update(other).size() == 4);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_system_marks_tiles() {
+    std::cout << "Running test_system_marks_tiles..." << std::endl;
+    VegetationGrid grid;
+    grid.resize(VegetationGrid::kTileSize * 2, VegetationGrid::kTileSize);
+    VegetationSystem::initialize(grid, 7);
+
+    VegetationTextureCache cache;
+    cache.update(grid);
+
+    // Grazing on every cell changes coverage everywhere
+    DisturbanceRegime regime;
+    regime.type = DisturbanceType::Grazing;
+    regime.grazingIntensity = 0.3f;
+    regime.spatialExtent = 1.0f;
+    core::GridVector<uint32_t> before = grid.tile_version;
+    VegetationSystem::applyDisturbance(grid, regime);
+    assert(grid.tile_version != before);
+
+    // Cache output matches a full repack
+    cache.update(grid);
+    std::vector<uint8_t> full(grid.getSize() * 4);
+    std::vector<float> r(grid.getSize()), g(grid.getSize()), b(grid.getSize()), a(grid.getSize());
+    grid.ei_coverage.load(0, grid.getSize(), r.data());
+    grid.es_coverage.load(0, grid.getSize(), g.data());
+    grid.ei_vigor.load(0, grid.getSize(), b.data());
+    grid.es_vigor.load(0, grid.getSize(), a.data());
+    packRGBA8(r.data(), g.data(), b.data(), a.data(), grid.getSize(), full.data());
+    assert(cache.pixels() == full);
+    std::cout << "PASSED" << std::endl;
+}
+
+int main() {
+    test_pack_matches_scalar();
+    test_tile_diff();
+    test_system_marks_tiles();
+    std::cout << "All vegetation texture tests passed!" << std::endl;
+    return 0;
+}
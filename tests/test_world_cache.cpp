@@ -0,0 +1,201 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../src/terrain/terrain_pipeline.h"
+#include "../src/terrain/world_snapshot.h"
+#include "test_helpers.h"
+
+using namespace terrain;
+namespace fs = std::filesystem;
+
+using test_helpers::tempDir;
+
+static RegenerationInputs smallInputs() {
+    RegenerationInputs in = test_helpers::smallInputs(160, 96, 31);
+    in.config.maxHeight = 90.0f;
+    return in;
+}
+
+static bool sameGrids(const TerrainMap& a, const TerrainMap& b) {
+    return a.heightMap() == b.heightMap() && a.fluxMap() == b.fluxMap() && a.flowDirMap() == b.flowDirMap() &&
+           a.soilMap() == b.soilMap() &&
+           a.getLandscapeSoil()->depth == b.getLandscapeSoil()->depth &&
+           a.getLandscapeSoil()->soil_type == b.getLandscapeSoil()->soil_type &&
+           a.getLandscapeHydro()->receiver_index == b.getLandscapeHydro()->receiver_index &&
+           a.getLandscapeHydro()->sort_order == b.getLandscapeHydro()->sort_order &&
+           a.getVegetation()->ei_capacity == b.getVegetation()->ei_capacity;
+}
+
+void test_snapshot_roundtrip() {
+    std::cout << "Running test_snapshot_roundtrip..." << std::endl;
+    const std::string dir = tempDir("sisterapp_snapshot_test");
+    fs::create_directories(dir);
+    const std::string path = dir + "/a.world";
+
+    TerrainMap map(67, 41); // Odd sizes: channel blocks need padding
+    for (size_t i = 0; i < map.heightMap().size(); ++i) {
+        map.heightMap()[i] = static_cast<float>(i) * 0.25f;
+        map.flowDirMap()[i] = static_cast<int>(i) - 7;
+        map.soilMap()[i] = static_cast<uint8_t>(i % 7);
+        landscape::SoilTaxon taxon;
+        taxon.series = static_cast<landscape::SiBCSSeries>(i % 5);
+        map.getLandscapeSoil()->setTaxon(i, taxon);
+        map.getVegetation()->es_vigor[i] = 0.5f;
+    }
+    map.setSoilDomain(terrain::soilMaskOf(terrain::SoilType::Argissolo));
+    SnapshotInfo info;
+    info.key = 42;
+    info.resolution = 2.5f;
+    info.seed = 9;
+    assert(WorldSnapshot::save(path, map, info));
+    assert(!fs::exists(path + ".tmp"));
+
+    // Channel blocks are aligned for direct use from the mapping
+    MappedFile file;
+    assert(file.open(path));
+    assert(file.size() % WorldSnapshot::kAlignment == 0);
+    file.close();
+
+    TerrainMap loaded(8, 8); // Resized by load
+    const uint64_t generation = loaded.getVegetation()->generation;
+    SnapshotInfo loadedInfo;
+    assert(WorldSnapshot::load(path, loaded, &loadedInfo));
+    assert(loadedInfo.key == 42 && loadedInfo.resolution == 2.5f && loadedInfo.seed == 9);
+    assert(loadedInfo.width == 67 && loadedInfo.height == 41);
+    assert(loaded.getWidth() == 67 && loaded.getHeight() == 41);
+    assert(sameGrids(map, loaded));
+    assert(loaded.soilDomain() == map.soilDomain());
+    assert(loaded.getLandscapeSoil()->taxon == map.getLandscapeSoil()->taxon &&
+           loaded.getLandscapeSoil()->taxa.entries() == map.getLandscapeSoil()->taxa.entries());
+    assert(loaded.getLandscapeSoil()->taxonAt(13).series == static_cast<landscape::SiBCSSeries>(13 % 5));
+    assert(loaded.getVegetation()->es_vigor == map.getVegetation()->es_vigor);
+    assert(loaded.getVegetation()->generation != generation);
+
+    // Truncated or missing files are rejected, not read out of bounds
+    fs::resize_file(path, fs::file_size(path) / 2);
+    assert(!WorldSnapshot::load(path, loaded));
+    assert(!WorldSnapshot::load(dir + "/missing.world", loaded));
+    fs::remove_all(dir);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_snapshot_compressed_and_views() {
+    std::cout << "Running test_snapshot_compressed_and_views..." << std::endl;
+    const std::string dir = tempDir("sisterapp_snapshot_views");
+    fs::create_directories(dir);
+
+    RegenerationInputs in;
+    in.config.width = 257;
+    in.config.height = 129;
+    TerrainMap map(in.config.width, in.config.height);
+    TerrainPipeline pipeline;
+    pipeline.regenerate(map, in);
+
+    SnapshotInfo info;
+    info.resolution = in.config.resolution;
+    SnapshotOptions packed;
+    packed.compress = true;
+    assert(WorldSnapshot::save(dir + "/raw.world", map, info));
+    assert(WorldSnapshot::save(dir + "/packed.world", map, info, packed));
+    assert(fs::file_size(dir + "/packed.world") < fs::file_size(dir + "/raw.world") / 2);
+
+    TerrainMap fromPacked(1, 1);
+    assert(WorldSnapshot::load(dir + "/packed.world", fromPacked));
+    assert(sameGrids(map, fromPacked));
+
+    // Raw channels are served from the mapping, aligned; compressed ones only through read()
+    SnapshotReader raw;
+    assert(raw.open(dir + "/raw.world"));
+    const float* heights = raw.view<float>("height");
+    assert(heights && reinterpret_cast<uintptr_t>(heights) % WorldSnapshot::kAlignment == 0);
+    assert(std::equal(map.heightMap().begin(), map.heightMap().end(), heights));
+    assert(raw.view<int32_t>("height") == nullptr); // Wrong type
+    assert(raw.view<float>("no_such_channel") == nullptr);
+
+    SnapshotReader reader;
+    assert(reader.open(dir + "/packed.world"));
+    assert(reader.view<float>("height") == nullptr);
+    std::vector<float> depth;
+    const auto& soilDepth = map.getLandscapeSoil()->depth;
+    assert(reader.read("soil.depth", depth) && std::equal(depth.begin(), depth.end(), soilDepth.begin(), soilDepth.end()));
+    fs::remove_all(dir);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_pipeline_warm_start() {
+    std::cout << "Running test_pipeline_warm_start..." << std::endl;
+    const std::string dir = tempDir("sisterapp_world_cache_test");
+    auto cache = std::make_shared<WorldCache>(dir);
+    RegenerationInputs in = smallInputs();
+
+    // Cold: everything runs and the result lands on disk
+    TerrainPipeline cold;
+    cold.setDiskCache(cache);
+    TerrainMap first(in.config.width, in.config.height);
+    cold.regenerate(first, in);
+    const uint64_t key = cold.worldKey(in);
+    assert(cache->contains(key));
+
+    // New session (fresh pipeline, same inputs): the terrain stages are not run
+    TerrainPipeline warm;
+    warm.setDiskCache(cache);
+    assert(warm.worldKey(in) == key);
+    assert(warm.reusesBaseTerrain(in));
+    TerrainMap second(in.config.width, in.config.height);
+    auto reports = warm.regenerate(second, in);
+    for (const auto& r : reports) {
+        if (r.name != TerrainPipeline::kDiskCache) assert(r.reused);
+    }
+    assert(sameGrids(first, second));
+
+    // Downstream changes still work after a warm start (generator is available)
+    in.soilMode = 0;
+    TerrainMap third(in.config.width, in.config.height);
+    reports = warm.regenerate(third, in);
+    for (const auto& r : reports) {
+        if (r.name == TerrainPipeline::kScorpan) assert(!r.reused);
+        if (r.name == TerrainPipeline::kBase) assert(r.reused);
+    }
+    assert(third.heightMap() == first.heightMap());
+
+    // Different seed: different key
+    in.config.seed = 32;
+    assert(warm.worldKey(in) != key);
+    fs::remove_all(dir);
+    std::cout << "PASSED" << std::endl;
+}
+
+void test_eviction() {
+    std::cout << "Running test_eviction..." << std::endl;
+    const std::string dir = tempDir("sisterapp_world_cache_evict");
+    WorldCache cache(dir, 2);
+    TerrainMap map(16, 16);
+    for (uint64_t key = 1; key <= 3; ++key) {
+        assert(cache.store(key, map));
+        // Distinct modification times
+        fs::last_write_time(cache.pathFor(key), fs::file_time_type::clock::now() - std::chrono::hours(10 - static_cast<int>(key)));
+    }
+    // Over the limit, the least recently used entries go (keys 1, then 2)
+    assert(cache.store(4, map));
+    int count = 0;
+    for (const auto& item : fs::directory_iterator(dir)) count += item.path().extension() == ".world" ? 1 : 0;
+    assert(count == 2);
+    assert(cache.contains(3) && cache.contains(4) && !cache.contains(1) && !cache.contains(2));
+    fs::remove_all(dir);
+    std::cout << "PASSED" << std::endl;
+}
+
+int main() {
+    test_snapshot_roundtrip();
+    test_snapshot_compressed_and_views();
+    test_pipeline_warm_start();
+    test_eviction();
+    std::cout << "All world cache tests passed!" << std::endl;
+    return 0;
+}